@@ -25,6 +25,8 @@
 
 #include "CBot/CBotFileUtils.h"
 #include "CBot/CBotClass.h"
+#include "CBot/CBotContext.h"
+#include "CBot/CBotMemoryPool.h"
 #include "CBot/CBotToken.h"
 #include "CBot/CBotProgram.h"
 #include "CBot/CBotTypResult.h"
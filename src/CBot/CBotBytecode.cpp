@@ -0,0 +1,713 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2023, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+
+#include "CBot/CBotBytecode.h"
+
+#include "CBot/CBotInstr/CBotInstr.h"
+
+#include "CBot/CBotVar/CBotVar.h"
+
+#include "CBot/CBotStack.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace CBot
+{
+
+namespace
+{
+
+//! Number of variables and operand stack entries kept on the native stack, bigger functions use the heap
+const int INLINE_VALUES = 32;
+
+//! State of one variable slot during execution
+struct SlotState
+{
+    CBotVar* var;
+    CBotBytecodeValue value;
+    bool defined;
+};
+
+//! Integer arithmetic wraps around like the instruction tree does in practice, without relying on signed overflow
+inline int WrapAdd(int a, int b) { return static_cast<int>(static_cast<unsigned>(a) + static_cast<unsigned>(b)); }
+inline int WrapSub(int a, int b) { return static_cast<int>(static_cast<unsigned>(a) - static_cast<unsigned>(b)); }
+inline int WrapMul(int a, int b) { return static_cast<int>(static_cast<unsigned>(a) * static_cast<unsigned>(b)); }
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+CBotBytecode::CBotBytecode()
+{
+}
+
+CBotBytecode::~CBotBytecode()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool CBotBytecode::Execute(CBotStack* pile)
+{
+    CBotStack* pvm = pile->AddStack(nullptr, CBotStack::BlockVisibilityType::BLOCK);
+
+    // state of the stack level is the position to resume at, plus one
+    int pc = pvm->GetState() - 1;
+    if (pc < 0)
+    {
+        // first run, create the local variables
+        for (std::size_t i = m_paramCount; i < m_slots.size(); i++)
+        {
+            pvm->AddVar(CBotVar::Create(m_slots[i].name, CBotTypResult(m_slots[i].type)));
+        }
+        pc = 0;
+    }
+
+    const int slotCount = static_cast<int>(m_slots.size());
+    SlotState inlineSlots[INLINE_VALUES];
+    CBotBytecodeValue inlineStack[INLINE_VALUES];
+    std::vector<SlotState> heapSlots;
+    std::vector<CBotBytecodeValue> heapStack;
+    SlotState* slots = inlineSlots;
+    CBotBytecodeValue* stack = inlineStack;
+    if (slotCount > INLINE_VALUES)
+    {
+        heapSlots.resize(slotCount);
+        slots = heapSlots.data();
+    }
+    if (m_maxDepth > INLINE_VALUES)
+    {
+        heapStack.resize(m_maxDepth);
+        stack = heapStack.data();
+    }
+
+    // load the variables, parameters are on the level of the function
+    CBotVar* var = pile->GetListVar();
+    for (int i = 0; i < slotCount; i++)
+    {
+        if (i == m_paramCount) var = pvm->GetListVar();
+        assert(var != nullptr);
+        slots[i].var = var;
+        slots[i].defined = !var->IsUndefined();
+        if (m_slots[i].type == CBotTypFloat)
+            slots[i].value.f = var->GetValFloat();
+        else
+            slots[i].value.i = var->GetValInt();
+        var = var->GetNext();
+    }
+
+    // writes values back to the variables, before leaving the function in the middle
+    auto sync = [&]()
+    {
+        for (int i = 0; i < slotCount; i++)
+        {
+            if (!slots[i].defined)
+            {
+                if (!slots[i].var->IsUndefined()) slots[i].var->SetInit(CBotVar::InitType::UNDEF);
+                continue;
+            }
+            if (m_slots[i].type == CBotTypFloat)
+                slots[i].var->SetValFloat(slots[i].value.f);
+            else
+                slots[i].var->SetValInt(slots[i].value.i);
+        }
+    };
+
+    // stops on a runtime error
+    auto fail = [&](CBotError error, CBotToken* token)
+    {
+        pvm->SetError(error, token);
+        sync();
+        return false;
+    };
+
+    const bool stepMode = (pvm->GetTimer() <= 0);
+    const CBotBytecodeOp* code = m_code.data();
+    int sp = 0;     // number of values on the operand stack
+    int ticks = 0;  // operations executed since the last statement boundary
+
+    while (true)
+    {
+        const CBotBytecodeOp& op = code[pc++];
+        ticks++;
+
+        switch (op.code)
+        {
+        case CBotOpcode::TICK:
+            if (stepMode)
+            {
+                CBotStack* ps = pvm->AddStack(op.instr);
+                if (ps->IfStep())
+                {
+                    // shows the statement, and executes it on next call
+                    sync();
+                    pvm->SetState(pc);
+                    return false;
+                }
+                pvm->Return(ps);
+            }
+            if (!pvm->CountTicks(ticks, op.arg))
+            {
+                sync();
+                pvm->SetState(pc + 1);
+                return false;
+            }
+            ticks = 0;
+            break;
+
+        case CBotOpcode::PUSH_INT:
+        case CBotOpcode::PUSH_FLOAT:
+            stack[sp++] = op.value;
+            break;
+        case CBotOpcode::LOAD:
+            if (op.token != nullptr && !slots[op.arg].defined) return fail(CBotErrNotInit, op.token);
+            stack[sp++] = slots[op.arg].value;
+            break;
+        case CBotOpcode::STORE:
+            slots[op.arg].value = stack[--sp];
+            slots[op.arg].defined = true;
+            break;
+        case CBotOpcode::UNDEFINE:
+            slots[op.arg].value.i = 0;
+            slots[op.arg].defined = false;
+            break;
+        case CBotOpcode::DUP:
+            stack[sp] = stack[sp - 1];
+            sp++;
+            break;
+        case CBotOpcode::POP:
+            sp--;
+            break;
+
+        case CBotOpcode::INT_TO_FLOAT:
+        {
+            CBotBytecodeValue& v = stack[sp - 1 - op.arg];
+            v.f = static_cast<float>(v.i);
+            break;
+        }
+        case CBotOpcode::FLOAT_TO_INT:
+        {
+            CBotBytecodeValue& v = stack[sp - 1 - op.arg];
+            v.i = static_cast<int>(v.f);
+            break;
+        }
+        case CBotOpcode::INT_TO_BOOL:
+        {
+            CBotBytecodeValue& v = stack[sp - 1 - op.arg];
+            v.i = (v.i != 0);
+            break;
+        }
+        case CBotOpcode::FLOAT_TO_BOOL:
+        {
+            CBotBytecodeValue& v = stack[sp - 1 - op.arg];
+            v.i = (v.f != 0.0f);
+            break;
+        }
+        case CBotOpcode::BOOL_TO_FLOAT:
+        {
+            CBotBytecodeValue& v = stack[sp - 1 - op.arg];
+            v.f = static_cast<float>(v.i);
+            break;
+        }
+
+#define CBOT_BINARY_INT(expr) \
+        { \
+            int b = stack[--sp].i; \
+            int a = stack[sp - 1].i; \
+            stack[sp - 1].i = (expr); \
+            break; \
+        }
+#define CBOT_BINARY_FLOAT(result, expr) \
+        { \
+            float b = stack[--sp].f; \
+            float a = stack[sp - 1].f; \
+            if (op.arg != 0 && (std::isnan(a) || std::isnan(b))) return fail(CBotErrNan, op.token); \
+            stack[sp - 1].result = (expr); \
+            break; \
+        }
+
+        case CBotOpcode::ADD_INT: CBOT_BINARY_INT(WrapAdd(a, b))
+        case CBotOpcode::SUB_INT: CBOT_BINARY_INT(WrapSub(a, b))
+        case CBotOpcode::MUL_INT: CBOT_BINARY_INT(WrapMul(a, b))
+        case CBotOpcode::DIV_INT:
+        case CBotOpcode::MOD_INT:
+        {
+            int b = stack[--sp].i;
+            int a = stack[sp - 1].i;
+            if (b == 0) return fail(CBotErrZeroDiv, op.token);
+            stack[sp - 1].i = (op.code == CBotOpcode::DIV_INT) ? a / b : a % b;
+            break;
+        }
+        case CBotOpcode::POW_INT: CBOT_BINARY_INT(static_cast<int>(pow(a, b)))
+        case CBotOpcode::AND_INT: CBOT_BINARY_INT(a & b)
+        case CBotOpcode::OR_INT:  CBOT_BINARY_INT(a | b)
+        case CBotOpcode::XOR_INT: CBOT_BINARY_INT(a ^ b)
+        case CBotOpcode::SL_INT:  CBOT_BINARY_INT(a << b)
+        case CBotOpcode::SR_INT:  CBOT_BINARY_INT(static_cast<int>(static_cast<unsigned>(a) >> b))
+        case CBotOpcode::ASR_INT: CBOT_BINARY_INT(a >> b)
+        case CBotOpcode::LO_INT:  CBOT_BINARY_INT(a < b)
+        case CBotOpcode::HI_INT:  CBOT_BINARY_INT(a > b)
+        case CBotOpcode::LS_INT:  CBOT_BINARY_INT(a <= b)
+        case CBotOpcode::HS_INT:  CBOT_BINARY_INT(a >= b)
+        case CBotOpcode::EQ_INT:  CBOT_BINARY_INT(a == b)
+        case CBotOpcode::NE_INT:  CBOT_BINARY_INT(a != b)
+        case CBotOpcode::NEG_INT:
+            stack[sp - 1].i = WrapSub(0, stack[sp - 1].i);
+            break;
+        case CBotOpcode::NOT_INT:
+            stack[sp - 1].i = ~stack[sp - 1].i;
+            break;
+
+        case CBotOpcode::ADD_FLOAT: CBOT_BINARY_FLOAT(f, a + b)
+        case CBotOpcode::SUB_FLOAT: CBOT_BINARY_FLOAT(f, a - b)
+        case CBotOpcode::MUL_FLOAT: CBOT_BINARY_FLOAT(f, a * b)
+        case CBotOpcode::DIV_FLOAT:
+        case CBotOpcode::MOD_FLOAT:
+        {
+            float b = stack[--sp].f;
+            float a = stack[sp - 1].f;
+            if (op.arg != 0 && (std::isnan(a) || std::isnan(b))) return fail(CBotErrNan, op.token);
+            if (b == 0.0f) return fail(CBotErrZeroDiv, op.token);
+            stack[sp - 1].f = (op.code == CBotOpcode::DIV_FLOAT) ? a / b : static_cast<float>(fmod(a, b));
+            break;
+        }
+        case CBotOpcode::POW_FLOAT: CBOT_BINARY_FLOAT(f, static_cast<float>(pow(a, b)))
+        case CBotOpcode::LO_FLOAT:  CBOT_BINARY_FLOAT(i, a < b)
+        case CBotOpcode::HI_FLOAT:  CBOT_BINARY_FLOAT(i, a > b)
+        case CBotOpcode::LS_FLOAT:  CBOT_BINARY_FLOAT(i, a <= b)
+        case CBotOpcode::HS_FLOAT:  CBOT_BINARY_FLOAT(i, a >= b)
+        case CBotOpcode::EQ_FLOAT:
+        case CBotOpcode::NE_FLOAT:
+        {
+            float b = stack[--sp].f;
+            float a = stack[sp - 1].f;
+            bool equal = (a == b);
+            if (op.arg != 0 && (std::isnan(a) || std::isnan(b))) equal = (std::isnan(a) == std::isnan(b));
+            stack[sp - 1].i = (op.code == CBotOpcode::EQ_FLOAT) ? equal : !equal;
+            break;
+        }
+        case CBotOpcode::NEG_FLOAT:
+            stack[sp - 1].f = -stack[sp - 1].f;
+            break;
+
+#undef CBOT_BINARY_INT
+#undef CBOT_BINARY_FLOAT
+
+        case CBotOpcode::NOT_BOOL:
+            stack[sp - 1].i = !stack[sp - 1].i;
+            break;
+
+        case CBotOpcode::JUMP:
+            pc = op.arg;
+            break;
+        case CBotOpcode::JUMP_FALSE:
+            if (stack[--sp].i == 0) pc = op.arg;
+            break;
+        case CBotOpcode::JUMP_TRUE:
+            if (stack[--sp].i != 0) pc = op.arg;
+            break;
+
+        case CBotOpcode::RETURN:
+        {
+            CBotVar* result = CBotVar::Create("", static_cast<CBotType>(op.arg));
+            if (op.arg == CBotTypFloat)
+                result->SetValFloat(stack[--sp].f);
+            else
+                result->SetValInt(stack[--sp].i);
+            pvm->SetVar(result);
+            pvm->SetBreak(3, std::string());
+            return false;
+        }
+        case CBotOpcode::END:
+            return true;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CBotBytecode::RestoreState(CBotStack* pile)
+{
+    CBotStack* pvm = pile->RestoreStack(nullptr);
+    if (pvm == nullptr) return;
+
+    // when stopped on a statement in step by step mode, the level showing it is above
+    int pc = pvm->GetState() - 1;
+    if (pc >= 0 && pc < static_cast<int>(m_code.size()) && m_code[pc].code == CBotOpcode::TICK)
+        pvm->RestoreStack(m_code[pc].instr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+CBotBytecodeBuilder::CBotBytecodeBuilder()
+    : m_bytecode(new CBotBytecode())
+{
+}
+
+CBotBytecodeBuilder::~CBotBytecodeBuilder()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool CBotBytecodeBuilder::AddParam(long ident, CBotType type, const std::string& name)
+{
+    assert(m_bytecode->m_paramCount == static_cast<int>(m_bytecode->m_slots.size()));
+    if (AddLocal(ident, type, name) < 0) return false;
+    m_bytecode->m_paramCount++;
+    return true;
+}
+
+int CBotBytecodeBuilder::AddLocal(long ident, CBotType type, const std::string& name)
+{
+    if (type != CBotTypInt && type != CBotTypFloat && type != CBotTypBoolean) return -1;
+
+    int slot = static_cast<int>(m_bytecode->m_slots.size());
+    m_bytecode->m_slots.push_back({type, name});
+    m_slotByIdent[ident] = slot;
+    return slot;
+}
+
+int CBotBytecodeBuilder::FindSlot(long ident)
+{
+    auto it = m_slotByIdent.find(ident);
+    if (it == m_slotByIdent.end()) return -1;
+    return it->second;
+}
+
+CBotType CBotBytecodeBuilder::GetSlotType(int slot)
+{
+    return m_bytecode->m_slots[slot].type;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+CBotType CBotBytecodeBuilder::GetType(int depth)
+{
+    assert(depth < static_cast<int>(m_types.size()));
+    return m_types[m_types.size() - 1 - depth];
+}
+
+int CBotBytecodeBuilder::GetDepth()
+{
+    return static_cast<int>(m_types.size());
+}
+
+void CBotBytecodeBuilder::PushInt(int value)
+{
+    Emit(CBotOpcode::PUSH_INT);
+    m_bytecode->m_code.back().value.i = value;
+    PushType(CBotTypInt);
+}
+
+void CBotBytecodeBuilder::PushFloat(float value)
+{
+    Emit(CBotOpcode::PUSH_FLOAT);
+    m_bytecode->m_code.back().value.f = value;
+    PushType(CBotTypFloat);
+}
+
+void CBotBytecodeBuilder::PushBool(bool value)
+{
+    Emit(CBotOpcode::PUSH_INT);
+    m_bytecode->m_code.back().value.i = value;
+    PushType(CBotTypBoolean);
+}
+
+void CBotBytecodeBuilder::Load(int slot, CBotToken* token)
+{
+    Emit(CBotOpcode::LOAD, slot, token);
+    PushType(GetSlotType(slot));
+}
+
+bool CBotBytecodeBuilder::Store(int slot)
+{
+    if (!Convert(GetSlotType(slot))) return false;
+    Emit(CBotOpcode::STORE, slot);
+    PopTypes(1);
+    return true;
+}
+
+void CBotBytecodeBuilder::Undefine(int slot)
+{
+    Emit(CBotOpcode::UNDEFINE, slot);
+}
+
+void CBotBytecodeBuilder::Dup()
+{
+    Emit(CBotOpcode::DUP);
+    PushType(GetType());
+}
+
+void CBotBytecodeBuilder::Pop()
+{
+    Emit(CBotOpcode::POP);
+    PopTypes(1);
+}
+
+void CBotBytecodeBuilder::Forget()
+{
+    PopTypes(1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool CBotBytecodeBuilder::Convert(CBotType type, int depth)
+{
+    CBotType& current = m_types[m_types.size() - 1 - depth];
+    if (current == type) return true;
+
+    switch (type)
+    {
+    case CBotTypInt:
+        if (current == CBotTypFloat) Emit(CBotOpcode::FLOAT_TO_INT, depth);
+        else if (current != CBotTypBoolean) return false;
+        break;
+    case CBotTypFloat:
+        if (current == CBotTypInt) Emit(CBotOpcode::INT_TO_FLOAT, depth);
+        else if (current == CBotTypBoolean) Emit(CBotOpcode::BOOL_TO_FLOAT, depth);
+        else return false;
+        break;
+    case CBotTypBoolean:
+        if (current == CBotTypInt) Emit(CBotOpcode::INT_TO_BOOL, depth);
+        else if (current == CBotTypFloat) Emit(CBotOpcode::FLOAT_TO_BOOL, depth);
+        else return false;
+        break;
+    default:
+        return false;
+    }
+    current = type;
+    return true;
+}
+
+bool CBotBytecodeBuilder::Binary(int op, CBotToken* token, CBotType type)
+{
+    CBotType left = GetType(1);
+    CBotType right = GetType(0);
+
+    CBotOpcode code;
+    CBotType result;
+    bool checkNan = false;
+
+    if (left == CBotTypBoolean || right == CBotTypBoolean)
+    {
+        // logical operations, both operands must be boolean
+        if (left != right) return false;
+        if (type != CBotTypVoid && type != CBotTypBoolean) return false;
+
+        switch (op)
+        {
+        case ID_EQ:         code = CBotOpcode::EQ_INT; break;
+        case ID_NE:         code = CBotOpcode::NE_INT; break;
+        case ID_AND:
+        case ID_LOG_AND:
+        case ID_TXT_AND:    code = CBotOpcode::AND_INT; break;
+        case ID_OR:
+        case ID_LOG_OR:
+        case ID_TXT_OR:     code = CBotOpcode::OR_INT; break;
+        case ID_XOR:        code = CBotOpcode::XOR_INT; break;
+        default:
+            return false;
+        }
+        result = CBotTypBoolean;
+    }
+    else
+    {
+        if (type == CBotTypVoid)
+        {
+            type = std::max(left, right);
+            checkNan = true;
+        }
+        if (type != CBotTypInt && type != CBotTypFloat) return false;
+        if (!Convert(type, 1) || !Convert(type, 0)) return false;
+
+        bool isFloat = (type == CBotTypFloat);
+        result = type;
+        switch (op)
+        {
+        case ID_ADD:        code = isFloat ? CBotOpcode::ADD_FLOAT : CBotOpcode::ADD_INT; break;
+        case ID_SUB:        code = isFloat ? CBotOpcode::SUB_FLOAT : CBotOpcode::SUB_INT; break;
+        case ID_MUL:        code = isFloat ? CBotOpcode::MUL_FLOAT : CBotOpcode::MUL_INT; break;
+        case ID_DIV:        code = isFloat ? CBotOpcode::DIV_FLOAT : CBotOpcode::DIV_INT; break;
+        case ID_MODULO:     code = isFloat ? CBotOpcode::MOD_FLOAT : CBotOpcode::MOD_INT; break;
+        case ID_POWER:      code = isFloat ? CBotOpcode::POW_FLOAT : CBotOpcode::POW_INT; break;
+        case ID_LO:         code = isFloat ? CBotOpcode::LO_FLOAT : CBotOpcode::LO_INT; result = CBotTypBoolean; break;
+        case ID_HI:         code = isFloat ? CBotOpcode::HI_FLOAT : CBotOpcode::HI_INT; result = CBotTypBoolean; break;
+        case ID_LS:         code = isFloat ? CBotOpcode::LS_FLOAT : CBotOpcode::LS_INT; result = CBotTypBoolean; break;
+        case ID_HS:         code = isFloat ? CBotOpcode::HS_FLOAT : CBotOpcode::HS_INT; result = CBotTypBoolean; break;
+        case ID_EQ:         code = isFloat ? CBotOpcode::EQ_FLOAT : CBotOpcode::EQ_INT; result = CBotTypBoolean; break;
+        case ID_NE:         code = isFloat ? CBotOpcode::NE_FLOAT : CBotOpcode::NE_INT; result = CBotTypBoolean; break;
+        default:
+            if (isFloat) return false;
+            switch (op)
+            {
+            case ID_AND:    code = CBotOpcode::AND_INT; break;
+            case ID_OR:     code = CBotOpcode::OR_INT; break;
+            case ID_XOR:    code = CBotOpcode::XOR_INT; break;
+            case ID_SL:     code = CBotOpcode::SL_INT; break;
+            case ID_SR:     code = CBotOpcode::SR_INT; break;
+            case ID_ASR:    code = CBotOpcode::ASR_INT; break;
+            default:
+                return false;
+            }
+        }
+    }
+
+    Emit(code, checkNan ? 1 : 0, token);
+    PopTypes(2);
+    PushType(result);
+    return true;
+}
+
+bool CBotBytecodeBuilder::Unary(int op)
+{
+    CBotType type = GetType();
+    switch (op)
+    {
+    case ID_SUB:
+        if (type == CBotTypInt) Emit(CBotOpcode::NEG_INT);
+        else if (type == CBotTypFloat) Emit(CBotOpcode::NEG_FLOAT);
+        else return false;
+        return true;
+    case ID_NOT:
+    case ID_LOG_NOT:
+    case ID_TXT_NOT:
+        if (type == CBotTypInt) Emit(CBotOpcode::NOT_INT);
+        else if (type == CBotTypBoolean) Emit(CBotOpcode::NOT_BOOL);
+        else return false;
+        return true;
+    }
+    return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int CBotBytecodeBuilder::NewLabel()
+{
+    m_labels.push_back(-1);
+    return static_cast<int>(m_labels.size()) - 1;
+}
+
+void CBotBytecodeBuilder::SetLabel(int label)
+{
+    m_labels[label] = static_cast<int>(m_bytecode->m_code.size());
+}
+
+void CBotBytecodeBuilder::Jump(int label)
+{
+    Emit(CBotOpcode::JUMP, label);
+}
+
+void CBotBytecodeBuilder::JumpIfFalse(int label)
+{
+    Emit(CBotOpcode::JUMP_FALSE, label);
+    PopTypes(1);
+}
+
+void CBotBytecodeBuilder::JumpIfTrue(int label)
+{
+    Emit(CBotOpcode::JUMP_TRUE, label);
+    PopTypes(1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CBotBytecodeBuilder::Tick(CBotInstr* instr, int limit)
+{
+    assert(m_types.empty()); // execution can only be suspended between statements
+    Emit(CBotOpcode::TICK, limit);
+    m_bytecode->m_code.back().instr = instr;
+}
+
+bool CBotBytecodeBuilder::Statement(CBotInstr* instr, bool tick)
+{
+    if (tick) Tick(instr);
+
+    int depth = GetDepth();
+    if (!instr->GenerateBytecode(*this)) return false;
+    while (GetDepth() > depth) Pop();
+    return true;
+}
+
+void CBotBytecodeBuilder::BeginLoop(const std::string& label, int breakLabel, int continueLabel)
+{
+    m_loops.push_back({label, breakLabel, continueLabel});
+}
+
+void CBotBytecodeBuilder::EndLoop()
+{
+    m_loops.pop_back();
+}
+
+bool CBotBytecodeBuilder::Break(const std::string& label, bool bContinue)
+{
+    for (auto it = m_loops.rbegin(); it != m_loops.rend(); ++it)
+    {
+        if (!label.empty() && it->label != label) continue;
+        Jump(bContinue ? it->continueLabel : it->breakLabel);
+        return true;
+    }
+    return false;
+}
+
+void CBotBytecodeBuilder::Return()
+{
+    Emit(CBotOpcode::RETURN, GetType());
+    PopTypes(1);
+}
+
+void CBotBytecodeBuilder::ReturnVoid()
+{
+    Emit(CBotOpcode::END);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::unique_ptr<CBotBytecode> CBotBytecodeBuilder::Finish()
+{
+    Emit(CBotOpcode::END);
+
+    for (CBotBytecodeOp& op : m_bytecode->m_code)
+    {
+        if (op.code == CBotOpcode::JUMP || op.code == CBotOpcode::JUMP_FALSE || op.code == CBotOpcode::JUMP_TRUE)
+        {
+            assert(m_labels[op.arg] >= 0);
+            op.arg = m_labels[op.arg];
+        }
+    }
+
+    return std::move(m_bytecode);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CBotBytecodeBuilder::Emit(CBotOpcode code, int arg, CBotToken* token)
+{
+    CBotBytecodeOp op;
+    op.code = code;
+    op.arg = arg;
+    op.token = token;
+    m_bytecode->m_code.push_back(op);
+}
+
+void CBotBytecodeBuilder::PushType(CBotType type)
+{
+    m_types.push_back(type);
+    m_bytecode->m_maxDepth = std::max(m_bytecode->m_maxDepth, static_cast<int>(m_types.size()));
+}
+
+void CBotBytecodeBuilder::PopTypes(int count)
+{
+    assert(count <= static_cast<int>(m_types.size()));
+    m_types.resize(m_types.size() - count);
+}
+
+} // namespace CBot
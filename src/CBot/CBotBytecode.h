@@ -0,0 +1,290 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2023, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+#pragma once
+
+#include "CBot/CBotEnums.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace CBot
+{
+
+class CBotInstr;
+class CBotStack;
+class CBotToken;
+
+/**
+ * \brief Instructions of the bytecode engine, see CBotBytecode
+ *
+ * Operands are taken from and results pushed onto the operand stack.
+ * _INT, _FLOAT and _BOOL suffixes give the type of the operands.
+ */
+enum class CBotOpcode : unsigned char
+{
+    TICK,           //!< statement boundary, counts timer ticks and may suspend execution; arg = timer limit
+    PUSH_INT,       //!< push constant value.i
+    PUSH_FLOAT,     //!< push constant value.f
+    LOAD,           //!< push variable in slot arg; if token is set, fails with CBotErrNotInit when the variable is undefined
+    STORE,          //!< pop into variable in slot arg
+    UNDEFINE,       //!< mark variable in slot arg as undefined (declaration without initial value)
+    DUP,            //!< duplicate top value
+    POP,            //!< drop top value
+
+    INT_TO_FLOAT,   //!< convert value at depth arg
+    FLOAT_TO_INT,
+    INT_TO_BOOL,
+    FLOAT_TO_BOOL,
+    BOOL_TO_FLOAT,
+
+    ADD_INT,
+    SUB_INT,
+    MUL_INT,
+    DIV_INT,        //!< fails with CBotErrZeroDiv at token
+    MOD_INT,        //!< fails with CBotErrZeroDiv at token
+    POW_INT,
+    AND_INT,
+    OR_INT,
+    XOR_INT,
+    SL_INT,
+    SR_INT,
+    ASR_INT,
+    NEG_INT,
+    NOT_INT,
+    LO_INT,
+    HI_INT,
+    LS_INT,
+    HS_INT,
+    EQ_INT,         //!< also used for bool
+    NE_INT,         //!< also used for bool
+
+    // float operations fail with CBotErrNan at token if arg is not 0 and an operand is nan (except EQ and NE, which compare nan as equal)
+    ADD_FLOAT,
+    SUB_FLOAT,
+    MUL_FLOAT,
+    DIV_FLOAT,      //!< fails with CBotErrZeroDiv at token
+    MOD_FLOAT,      //!< fails with CBotErrZeroDiv at token
+    POW_FLOAT,
+    NEG_FLOAT,
+    LO_FLOAT,
+    HI_FLOAT,
+    LS_FLOAT,
+    HS_FLOAT,
+    EQ_FLOAT,
+    NE_FLOAT,
+
+    NOT_BOOL,
+
+    JUMP,           //!< continue at arg
+    JUMP_FALSE,     //!< pop, continue at arg if zero
+    JUMP_TRUE,      //!< pop, continue at arg if not zero
+
+    RETURN,         //!< pop and return the value, arg = CBotType of the value
+    END,            //!< end of function without a value
+};
+
+//! A value on the operand stack or in a variable slot
+union CBotBytecodeValue
+{
+    int i;
+    float f;
+};
+
+//! One instruction of the bytecode engine
+struct CBotBytecodeOp
+{
+    CBotOpcode code;
+    int arg = 0;
+    CBotBytecodeValue value = {0};
+    //! Position reported with runtime errors
+    CBotToken* token = nullptr;
+    //! Statement shown while executing step by step (TICK only)
+    CBotInstr* instr = nullptr;
+};
+
+/**
+ * \brief A function body compiled for the bytecode engine
+ *
+ * The bytecode engine is an alternative to walking the CBotInstr tree (see
+ * CBotProgram::SetEngine()). Functions using only local variables of type
+ * int, float and bool, arithmetic, comparisons, assignments and the
+ * if / while / do / for / break / continue / return statements are lowered
+ * to a flat list of CBotBytecodeOp by CBotInstr::GenerateBytecode(), and run
+ * in a simple dispatch loop. Anything else (calls, strings, arrays, classes...)
+ * keeps using the instruction tree.
+ *
+ * Execution can only be suspended between statements, when the operand stack
+ * is empty. Variables are kept as normal CBotVar instances on the stack while
+ * suspended, and the position in the bytecode is the state of the stack level,
+ * so SaveState()/RestoreState() of the program work as usual.
+ */
+class CBotBytecode
+{
+public:
+    CBotBytecode();
+    ~CBotBytecode();
+
+    /**
+     * \brief Execute or resume the function body
+     * \param pile Stack level of the function
+     * \return false if interrupted, or on error or return (see CBotStack::GetRetVar())
+     */
+    bool Execute(CBotStack* pile);
+
+    /**
+     * \brief Restore the stack level of the function body after loading the stack from file
+     * \param pile Stack level of the function
+     */
+    void RestoreState(CBotStack* pile);
+
+private:
+    friend class CBotBytecodeBuilder;
+
+    //! A variable used by the function
+    struct Slot
+    {
+        CBotType type;
+        std::string name;
+    };
+
+    //! Parameters then local variables
+    std::vector<Slot> m_slots;
+    //! Number of parameters at the beginning of m_slots
+    int m_paramCount = 0;
+    //! The code
+    std::vector<CBotBytecodeOp> m_code;
+    //! Maximum depth of the operand stack
+    int m_maxDepth = 0;
+};
+
+/**
+ * \brief Helper used by CBotInstr::GenerateBytecode() to produce a CBotBytecode
+ *
+ * Keeps track of variable slots, the types of values on the operand stack,
+ * jump labels and the enclosing loops. Methods return false for constructs
+ * the bytecode engine can't handle, in which case the whole function stays
+ * on the instruction tree.
+ */
+class CBotBytecodeBuilder
+{
+public:
+    CBotBytecodeBuilder();
+    ~CBotBytecodeBuilder();
+
+    //! Declare the next parameter of the function
+    bool AddParam(long ident, CBotType type, const std::string& name);
+    //! Declare a local variable, returns its slot or -1 if the type is not supported
+    int AddLocal(long ident, CBotType type, const std::string& name);
+    //! Slot of the variable with given unique identifier, -1 if it is not a local variable
+    int FindSlot(long ident);
+    //! Type of the variable in the slot
+    CBotType GetSlotType(int slot);
+
+    //! Type of the value at given depth of the operand stack
+    CBotType GetType(int depth = 0);
+    //! Current depth of the operand stack
+    int GetDepth();
+
+    void PushInt(int value);
+    void PushFloat(float value);
+    void PushBool(bool value);
+    //! Push a variable, failing with CBotErrNotInit at \a token if it is undefined (nullptr for no check)
+    void Load(int slot, CBotToken* token);
+    //! Convert the top value to the type of the slot, and pop it into the slot
+    bool Store(int slot);
+    void Undefine(int slot);
+    void Dup();
+    void Pop();
+    //! Forget the top value without generating code, at the start of an alternative branch pushing its own value
+    void Forget();
+
+    //! Convert the value at given depth to \a type
+    bool Convert(CBotType type, int depth = 0);
+
+    /**
+     * \brief Apply a binary operator to the two top values
+     *
+     * Operands are converted to a common type and nan values are checked, as
+     * done by CBotTwoOpExpr, or converted to \a type if given (compound
+     * assignments compute in the type of the variable, without checks).
+     *
+     * \param op Operator (ID_ADD, ID_LO, ...)
+     * \param token Position of errors such as division by zero
+     * \param type Type to compute in, CBotTypVoid for the common type of the operands
+     */
+    bool Binary(int op, CBotToken* token, CBotType type = CBotTypVoid);
+    //! Apply an unary operator (ID_SUB, ID_NOT, ID_LOG_NOT, ID_TXT_NOT) to the top value
+    bool Unary(int op);
+
+    //! Create a new jump target
+    int NewLabel();
+    //! Place the label at the current position
+    void SetLabel(int label);
+    void Jump(int label);
+    //! Pop the top value and jump if it is false
+    void JumpIfFalse(int label);
+    //! Pop the top value and jump if it is true
+    void JumpIfTrue(int label);
+
+    //! Mark a statement boundary, where execution can be suspended
+    void Tick(CBotInstr* instr, int limit = -10);
+    //! Generate a statement, discarding the value left by an expression
+    bool Statement(CBotInstr* instr, bool tick = true);
+
+    //! Enter a loop, break and continue jump to given labels
+    void BeginLoop(const std::string& label, int breakLabel, int continueLabel);
+    void EndLoop();
+    //! Generate break (or continue) for the loop with given label, or the innermost loop
+    bool Break(const std::string& label, bool bContinue);
+
+    //! Return the top value from the function
+    void Return();
+    //! Return from the function without a value
+    void ReturnVoid();
+
+    //! Finish the function and return the result
+    std::unique_ptr<CBotBytecode> Finish();
+
+private:
+    void Emit(CBotOpcode code, int arg = 0, CBotToken* token = nullptr);
+    void PushType(CBotType type);
+    void PopTypes(int count);
+
+private:
+    std::unique_ptr<CBotBytecode> m_bytecode;
+    //! Slots of variables by their unique identifier
+    std::map<long, int> m_slotByIdent;
+    //! Types of values on the operand stack
+    std::vector<CBotType> m_types;
+    //! Position of each label in the code, -1 if not placed yet
+    std::vector<int> m_labels;
+
+    struct Loop
+    {
+        std::string label;
+        int breakLabel;
+        int continueLabel;
+    };
+    std::vector<Loop> m_loops;
+};
+
+} // namespace CBot
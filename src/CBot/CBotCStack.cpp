@@ -21,6 +21,7 @@
 #include "CBot/CBotCStack.h"
 
 #include "CBot/CBotClass.h"
+#include "CBot/CBotContext.h"
 #include "CBot/CBotToken.h"
 #include "CBot/CBotExternalCall.h"
 
@@ -393,30 +394,24 @@ bool CBotCStack::CheckCall(CBotToken* &pToken, CBotDefParam* pParam, const std::
 
     if ( GetProgram()->GetExternalCalls()->CheckCall(name) ) return true;
 
-    for (CBotFunction* pp : GetProgram()->GetFunctions())
+    for (CBotFunction* pp : GetProgram()->m_functionIndex.Find(name))
     {
-        if ( name == pp->GetName() )
-        {
-            // ignore methods for a different class
-            if ( className != pp->GetClassName() )
-                continue;
-            // are parameters exactly the same?
-            if ( pp->CheckParam( pParam ) )
-                return true;
-        }
+        // ignore methods for a different class
+        if ( className != pp->GetClassName() )
+            continue;
+        // are parameters exactly the same?
+        if ( pp->CheckParam( pParam ) )
+            return true;
     }
 
-    for (CBotFunction* pp : CBotFunction::m_publicFunctions)
+    for (CBotFunction* pp : GetProgram()->GetContext().m_publicFunctions.Find(name))
     {
-        if ( name == pp->GetName() )
-        {
-            // ignore methods for a different class
-            if ( className != pp->GetClassName() )
-                continue;
-            // are parameters exactly the same?
-            if ( pp->CheckParam( pParam ) )
-                return true;
-        }
+        // ignore methods for a different class
+        if ( className != pp->GetClassName() )
+            continue;
+        // are parameters exactly the same?
+        if ( pp->CheckParam( pParam ) )
+            return true;
     }
 
     return false;
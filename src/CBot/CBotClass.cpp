@@ -31,7 +31,9 @@
 
 #include "CBot/CBotVar/CBotVar.h"
 
+#include "CBot/CBotContext.h"
 #include "CBot/CBotExternalCall.h"
+#include "CBot/CBotProgram.h"
 #include "CBot/CBotStack.h"
 #include "CBot/CBotCStack.h"
 #include "CBot/CBotDefParam.h"
@@ -43,7 +45,7 @@ namespace CBot
 {
 
 ////////////////////////////////////////////////////////////////////////////////
-std::set<CBotClass*> CBotClass::m_publicClasses{};
+std::mutex CBotClass::m_lockMutex{};
 
 ////////////////////////////////////////////////////////////////////////////////
 CBotClass::CBotClass(const std::string& name,
@@ -58,14 +60,17 @@ CBotClass::CBotClass(const std::string& name,
     m_IsDef     = true;
     m_bIntrinsic= bIntrinsic;
     m_nbVar     = m_parent == nullptr ? 0 : m_parent->m_nbVar;
+    m_context   = &CBotContext::GetCurrent();
 
-    m_publicClasses.insert(this);
+    m_context->m_classes.insert(this);
+    m_context->InvalidateCompileCache();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 CBotClass::~CBotClass()
 {
-    m_publicClasses.erase(this);
+    m_context->m_classes.erase(this);
+    m_context->InvalidateCompileCache();
 
     delete  m_pVar;
     delete  m_externalMethods;
@@ -82,9 +87,10 @@ CBotClass* CBotClass::Create(const std::string& name,
 ////////////////////////////////////////////////////////////////////////////////
 void CBotClass::ClearPublic()
 {
-    while ( !m_publicClasses.empty() )
+    std::set<CBotClass*>& classes = CBotContext::GetCurrent().m_classes;
+    while ( !classes.empty() )
     {
-        auto it = m_publicClasses.begin();
+        auto it = classes.begin();
         delete *it; // calling destructor removes the class from the list
     }
 }
@@ -92,6 +98,8 @@ void CBotClass::ClearPublic()
 ////////////////////////////////////////////////////////////////////////////////
 void CBotClass::Purge()
 {
+    m_context->InvalidateCompileCache();
+
     delete      m_pVar;
     m_pVar      = nullptr;
     m_externalMethods->Clear();
@@ -105,6 +113,8 @@ void CBotClass::Purge()
 ////////////////////////////////////////////////////////////////////////////////
 bool CBotClass::Lock(CBotProgram* prog)
 {
+    std::lock_guard<std::mutex> lock(m_lockMutex);
+
     if (m_lockProg.size() == 0)
     {
         m_lockCurrentCount = 1;
@@ -130,6 +140,8 @@ bool CBotClass::Lock(CBotProgram* prog)
 ////////////////////////////////////////////////////////////////////////////////
 void CBotClass::Unlock()
 {
+    std::lock_guard<std::mutex> lock(m_lockMutex);
+
     if (--m_lockCurrentCount > 0) return; // if called Lock() multiple times, wait for all to unlock
 
     m_lockProg.pop_front();
@@ -138,7 +150,9 @@ void CBotClass::Unlock()
 ////////////////////////////////////////////////////////////////////////////////
 void CBotClass::FreeLock(CBotProgram* prog)
 {
-    for (CBotClass* pClass : m_publicClasses)
+    std::lock_guard<std::mutex> lock(m_lockMutex);
+
+    for (CBotClass* pClass : prog->GetContext().m_classes)
     {
         if (pClass->m_lockProg.size() > 0 && prog == pClass->m_lockProg[0])
         {
@@ -182,6 +196,7 @@ bool CBotClass::AddItem(std::string name,
 ////////////////////////////////////////////////////////////////////////////////
 bool CBotClass::AddItem(CBotVar* pVar)
 {
+    m_context->InvalidateCompileCache();
     pVar->SetUniqNum(++m_nbVar);
 
     if ( m_pVar == nullptr ) m_pVar = pVar;
@@ -220,6 +235,12 @@ CBotVar* CBotClass::GetVar()
     return  m_pVar;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+int CBotClass::GetFieldCount()
+{
+    return m_nbVar;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 CBotVar* CBotClass::GetItem(const std::string& name)
 {
@@ -276,7 +297,7 @@ CBotClass* CBotClass::Find(CBotToken* &pToken)
 ////////////////////////////////////////////////////////////////////////////////
 CBotClass* CBotClass::Find(const std::string& name)
 {
-    for (CBotClass* p : m_publicClasses)
+    for (CBotClass* p : CBotContext::GetCurrent().m_classes)
     {
         if ( p->GetName() == name ) return p;
     }
@@ -287,9 +308,13 @@ CBotClass* CBotClass::Find(const std::string& name)
 ////////////////////////////////////////////////////////////////////////////////
 bool CBotClass::AddFunction(const std::string& name,
                             bool rExec(CBotVar* pThis, CBotVar* pVar, CBotVar* pResult, int& Exception, void* user),
-                            CBotTypResult rCompile(CBotVar* pThis, CBotVar*& pVar))
+                            CBotTypResult rCompile(CBotVar* pThis, CBotVar*& pVar),
+                            bool threadSafe)
 {
-    return m_externalMethods->AddFunction(name, std::unique_ptr<CBotExternalCall>(new CBotExternalCallClass(rExec, rCompile)));
+    m_context->InvalidateCompileCache();
+    std::unique_ptr<CBotExternalCall> call(new CBotExternalCallClass(rExec, rCompile));
+    call->SetThreadSafe(threadSafe);
+    return m_externalMethods->AddFunction(name, std::move(call));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -327,18 +352,21 @@ bool CBotClass::ExecuteMethode(long& nIdent,
                                CBotVar** ppParams,
                                CBotTypResult pResultType,
                                CBotStack*& pStack,
-                               CBotToken* pToken)
+                               CBotToken* pToken,
+                               CBotCallCache* cache)
 {
-    int ret = m_externalMethods->DoCall(pToken, pThis, ppParams, pStack, pResultType);
-    if (ret >= 0) return ret;
+    // the identifier is kept in the calling instruction, which may be shared by programs running concurrently
+    long ident = nIdent;
 
-    ret = CBotFunction::DoCall(nIdent, pToken->GetString(), pThis, ppParams, pStack, pToken, this);
-    if (ret >= 0) return ret;
+    int ret = m_externalMethods->DoCall(pToken, pThis, ppParams, pStack, pResultType);
+    if (ret < 0) ret = CBotFunction::DoCall(ident, pToken->GetString(), pThis, ppParams, pStack, pToken, this, cache);
 
-    if (m_parent != nullptr)
+    if (ret < 0 && m_parent != nullptr)
     {
-        ret = m_parent->ExecuteMethode(nIdent, pThis, ppParams, pResultType, pStack, pToken);
+        ret = m_parent->ExecuteMethode(ident, pThis, ppParams, pResultType, pStack, pToken, cache);
     }
+
+    if (ident != nIdent && !CBotProgram::IsRunningConcurrently()) nIdent = ident;
     return ret;
 }
 
@@ -347,7 +375,8 @@ void CBotClass::RestoreMethode(long& nIdent,
                                CBotToken* name,
                                CBotVar* pThis,
                                CBotVar** ppParams,
-                               CBotStack*& pStack)
+                               CBotStack*& pStack,
+                               CBotCallCache* cache)
 {
     if (m_externalMethods->RestoreCall(name, pThis, ppParams, pStack))
         return;
@@ -355,7 +384,7 @@ void CBotClass::RestoreMethode(long& nIdent,
     CBotClass* pClass = this;
     while (pClass != nullptr)
     {
-        bool ok = CBotFunction::RestoreCall(nIdent, name->GetString(), pThis, ppParams, pStack, pClass);
+        bool ok = CBotFunction::RestoreCall(nIdent, name->GetString(), pThis, ppParams, pStack, pClass, cache);
         if (ok) return;
         pClass = pClass->m_parent;
     }
@@ -368,7 +397,7 @@ bool CBotClass::SaveStaticState(std::ostream &ostr)
     if (!WriteLong(ostr, CBOTVERSION*2)) return false;
 
     // saves the state of static variables in classes
-    for (CBotClass* p : m_publicClasses)
+    for (CBotClass* p : CBotContext::GetCurrent().m_classes)
     {
         if (!WriteWord(ostr, 1)) return false;
         // save the name of the class
@@ -27,6 +27,7 @@
 #include <deque>
 #include <set>
 #include <list>
+#include <mutex>
 
 namespace CBot
 {
@@ -39,6 +40,8 @@ class CBotDefParam;
 class CBotToken;
 class CBotCStack;
 class CBotExternalCallList;
+class CBotCallCache;
+class CBotContext;
 
 /**
  * \brief A CBot class definition
@@ -109,6 +112,7 @@ class CBotClass
 public:
     /*!
      * \brief CBotClass Constructor. Once a class is created, it is known around
+     * the current context (see CBotContext::GetCurrent()).
      * CBot intrinsic mode gives a class that is not managed by pointers.
      * \param name
      * \param parent
@@ -140,7 +144,8 @@ public:
      */
     bool AddFunction(const std::string& name,
                      bool rExec(CBotVar* pThis, CBotVar* pVar, CBotVar* pResult, int& Exception, void* user),
-                     CBotTypResult rCompile(CBotVar* pThis, CBotVar*& pVar));
+                     CBotTypResult rCompile(CBotVar* pThis, CBotVar*& pVar),
+                     bool threadSafe = false);
 
     /*!
      * \brief SetUpdateFunc Defines routine to be called to update the elements
@@ -196,7 +201,7 @@ public:
     static CBotClass* Find(CBotToken* &pToken);
 
     /*!
-     * \brief Find
+     * \brief Find a class of the current context (see CBotContext::GetCurrent())
      * \param name
      * \return
      */
@@ -207,6 +212,16 @@ public:
      * \return
      */
     CBotVar* GetVar();
+
+    /*!
+     * \brief Number of fields of an instance, including inherited ones
+     *
+     * Fields are numbered from 1, parent class fields first; the number of
+     * a field is its unique number (see CBotVar::GetUniqNum()) and selects
+     * its slot in the instance, see CBotVarClass::GetItemRef().
+     * \return Highest field number
+     */
+    int GetFieldCount();
     /*!
      * \brief GetItem One of the variables according to its name.
      * \param name
@@ -253,10 +268,11 @@ public:
      * \param pResultType
      * \param pStack
      * \param pToken
+     * \param cache Inline cache of the call site, can be null
      * \return
      */
     bool ExecuteMethode(long &nIdent, CBotVar* pThis, CBotVar** ppParams, CBotTypResult pResultType,
-                        CBotStack*&pStack, CBotToken* pToken);
+                        CBotStack*&pStack, CBotToken* pToken, CBotCallCache* cache = nullptr);
 
     /*!
      * \brief RestoreMethode Restored the execution stack.
@@ -265,12 +281,14 @@ public:
      * \param pThis
      * \param ppParams
      * \param pStack
+     * \param cache Inline cache of the call site, can be null
      */
     void RestoreMethode(long &nIdent,
                         CBotToken* name,
                         CBotVar* pThis,
                         CBotVar** ppParams,
-                        CBotStack*&pStack);
+                        CBotStack*&pStack,
+                        CBotCallCache* cache = nullptr);
 
     /*!
      * \brief Compile Compiles a class declared by the user.
@@ -332,19 +350,19 @@ public:
     void Purge();
 
     /*!
-     * \brief Free
+     * \brief Delete all classes of the current context
      */
     static void ClearPublic();
 
     /*!
-     * \brief Save all static variables from each public class
+     * \brief Save all static variables from each class of the current context
      * \param ostr Output stream
      * \return true on success
      */
     static bool SaveStaticState(std::ostream &ostr);
 
     /*!
-     * \brief Restore all static variables in each public class
+     * \brief Restore all static variables in each class of the current context
      * \param istr Input stream
      * \return true on success
      */
@@ -381,9 +399,8 @@ public:
     void Update(CBotVar* var, void* user);
 
 private:
-    //! List of all public classes
-    static std::set<CBotClass*> m_publicClasses;
-
+    //! Context this class is registered in
+    CBotContext* m_context;
 
     //! true if this class is fully compiled, false if only precompiled
     bool m_IsDef;
@@ -409,6 +426,8 @@ private:
     int m_lockCurrentCount = 0;
     //! Programs waiting for lock. m_lockProg[0] is the program currently holding the lock, if any
     std::deque<CBotProgram*> m_lockProg{};
+    //! Protects the locks of all classes, programs can finish concurrently (see CBotProgram::RunConcurrent())
+    static std::mutex m_lockMutex;
 };
 
 } // namespace CBot
@@ -0,0 +1,80 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2023, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+#include "CBot/CBotContext.h"
+
+#include "CBot/CBotExternalCall.h"
+
+namespace CBot
+{
+
+namespace
+{
+//! Context selected by CBotContext::Scope on this thread
+thread_local CBotContext* t_currentContext = nullptr;
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+CBotContext::CBotContext()
+: m_externalCalls(new CBotExternalCallList)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+CBotContext::~CBotContext()
+{
+    Scope scope(*this);
+    CBotProgram::Free();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+CBotContext& CBotContext::GetDefault()
+{
+    // never deleted, classes and variables may outlive static destructors
+    static CBotContext* context = new CBotContext();
+    return *context;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+CBotContext& CBotContext::GetCurrent()
+{
+    if (t_currentContext != nullptr) return *t_currentContext;
+    return GetDefault();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CBotContext::InvalidateCompileCache()
+{
+    m_compileGeneration++;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+CBotContext::Scope::Scope(CBotContext& context)
+: m_previous(t_currentContext)
+{
+    t_currentContext = &context;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+CBotContext::Scope::~Scope()
+{
+    t_currentContext = m_previous;
+}
+
+} // namespace CBot
@@ -0,0 +1,127 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2023, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+#pragma once
+
+#include "CBot/CBotFunctionIndex.h"
+#include "CBot/CBotProgram.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+namespace CBot
+{
+
+class CBotClass;
+class CBotExternalCallList;
+class CBotVarClass;
+
+/**
+ * \brief Everything CBot programs can see of each other
+ *
+ * A context holds the external functions added with CBotProgram::AddFunction(),
+ * the constants from CBotProgram::DefineNum(), the classes made with
+ * CBotClass::Create() or compiled, the public functions and all class
+ * instances. Programs in different contexts can't see each other's classes,
+ * public functions or instances, so each context is a separate CBot engine.
+ *
+ * Every program uses the context it was constructed in (see
+ * CBotProgram::CBotProgram(CBotVar*, CBotContext&)). The static functions
+ * like CBotProgram::Init(), CBotProgram::AddFunction() or CBotClass::Find()
+ * work on the current context of the calling thread, which is the default
+ * context unless a Scope selects another one:
+ *
+ * \code
+ * CBotContext context;
+ * CBotContext::Scope scope(context);
+ * CBotProgram::Init();                 // functions and constants go to context
+ * CBotProgram program;                 // runs in context
+ * \endcode
+ *
+ * A context, with its programs, must be used by one thread at a time, except
+ * for CBotProgram::RunConcurrent(). Different contexts can be used on
+ * different threads at the same time. Delete all programs and variables of a
+ * context before the context itself.
+ */
+class CBotContext
+{
+public:
+    CBotContext();
+    //! Deletes the classes of this context, see CBotProgram::Free()
+    ~CBotContext();
+
+    CBotContext(const CBotContext&) = delete;
+    CBotContext& operator=(const CBotContext&) = delete;
+
+    //! The context used when no Scope is active, it is never deleted
+    static CBotContext& GetDefault();
+
+    //! The context selected by the innermost Scope on this thread, or the default context
+    static CBotContext& GetCurrent();
+
+    /**
+     * \brief Makes a context the current one on this thread while the Scope exists
+     */
+    class Scope
+    {
+    public:
+        explicit Scope(CBotContext& context);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        CBotContext* m_previous;
+    };
+
+private:
+    //! Drop all shared code, called when anything it was compiled against changes
+    void InvalidateCompileCache();
+
+    //! All external calls
+    std::unique_ptr<CBotExternalCallList> m_externalCalls;
+    //! Constants by name (see CBotToken::DefineNum())
+    std::map<std::string, long> m_defineNum{};
+    //! All public functions
+    CBotFunctionIndex m_publicFunctions{};
+    //! All classes
+    std::set<CBotClass*> m_classes{};
+    //! All class instances by identifier; identifiers are never reused, but copies share them
+    std::unordered_multimap<long, CBotVarClass*> m_instances{};
+    //! Protects m_instances, instances are created and deleted by programs running concurrently
+    std::mutex m_instancesMutex{};
+    //! Shared code by cache key and source text, see CBotProgram::Compile()
+    std::unordered_map<std::string, CBotProgram::CompileCacheEntry> m_compileCache{};
+    //! Incremented by InvalidateCompileCache()
+    long m_compileGeneration = 0;
+
+    friend class CBotProgram;
+    friend class CBotClass;
+    friend class CBotFunction;
+    friend class CBotCStack;
+    friend class CBotToken;
+    friend class CBotVarClass;
+};
+
+} // namespace CBot
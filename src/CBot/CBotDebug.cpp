@@ -27,6 +27,7 @@
 #include <sstream>
 #include <iostream>
 #include <iomanip>
+#include <set>
 #include <boost/algorithm/string/replace.hpp>
 
 namespace CBot
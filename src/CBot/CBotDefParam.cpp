@@ -22,6 +22,7 @@
 #include "CBot/CBotInstr/CBotInstrUtils.h"
 #include "CBot/CBotInstr/CBotParExpr.h"
 
+#include "CBot/CBotBytecode.h"
 #include "CBot/CBotUtils.h"
 #include "CBot/CBotCStack.h"
 
@@ -288,4 +289,14 @@ std::string CBotDefParam::GetParamString()
     return param;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool CBotDefParam::GenerateBytecode(CBotBytecodeBuilder& builder)
+{
+    for (CBotDefParam* p = this; p != nullptr; p = p->m_next)
+    {
+        if (!builder.AddParam(p->m_nIdent, static_cast<CBotType>(p->m_type.GetType()), p->m_token.GetString())) return false;
+    }
+    return true;
+}
+
 } // namespace CBot
@@ -26,6 +26,7 @@
 namespace CBot
 {
 
+class CBotBytecodeBuilder;
 class CBotCStack;
 class CBotStack;
 class CBotVar;
@@ -76,6 +77,13 @@ public:
      */
     void RestoreState(CBotStack* &pj, bool bMain);
 
+    /*!
+     * \brief Declare the parameters as variables of the bytecode engine
+     * \param builder
+     * \return false if a parameter has a type not supported by the bytecode engine
+     */
+    bool GenerateBytecode(CBotBytecodeBuilder& builder);
+
     /*!
      * \brief GetType
      * \return
@@ -19,6 +19,7 @@
 
 #include "CBot/CBotExternalCall.h"
 
+#include "CBot/CBotProgram.h"
 #include "CBot/CBotToken.h"
 #include "CBot/CBotStack.h"
 #include "CBot/CBotCStack.h"
@@ -40,13 +41,18 @@ bool CBotExternalCallList::AddFunction(const std::string& name, std::unique_ptr<
     return true;
 }
 
+CBotExternalCall* CBotExternalCallList::Find(const std::string& name)
+{
+    auto it = m_list.find(name);
+    return it != m_list.end() ? it->second.get() : nullptr;
+}
+
 CBotTypResult CBotExternalCallList::CompileCall(CBotToken*& p, CBotVar* thisVar, CBotVar** ppVar, CBotCStack* pStack)
 {
-    if (m_list.count(p->GetString()) == 0)
+    CBotExternalCall* pt = Find(p->GetString());
+    if (pt == nullptr)
         return -1;
 
-    CBotExternalCall* pt = m_list[p->GetString()].get();
-
     std::unique_ptr<CBotVar> args = std::unique_ptr<CBotVar>(MakeListVars(ppVar));
     CBotTypResult r = pt->Compile(thisVar, args.get(), m_user);
 
@@ -77,13 +83,15 @@ int CBotExternalCallList::DoCall(CBotToken* token, CBotVar* thisVar, CBotVar** p
     if (token == nullptr)
         return -1;
 
-    if (m_list.count(token->GetString()) == 0)
+    // this runs concurrently in CBotProgram::RunConcurrent(), so the list must not be modified
+    CBotExternalCall* pt = Find(token->GetString());
+    if (pt == nullptr)
         return -1;
 
-    CBotExternalCall* pt = m_list[token->GetString()].get();
-
     if (thisVar == nullptr && pStack->IsCallFinished()) return true;  // only for non-method external call
 
+    if (!pt->IsThreadSafe() && CBotProgram::DeferIfConcurrent()) return 0;
+
     // if this is a method call we need to use AddStack()
     CBotStack* pile = (thisVar != nullptr) ? pStack->AddStack() : pStack->AddStackExternalCall(pt);
 
@@ -106,11 +114,10 @@ int CBotExternalCallList::DoCall(CBotToken* token, CBotVar* thisVar, CBotVar** p
 
 bool CBotExternalCallList::RestoreCall(CBotToken* token, CBotVar* thisVar, CBotVar** ppVar, CBotStack* pStack)
 {
-    if (m_list.count(token->GetString()) == 0)
+    CBotExternalCall* pt = Find(token->GetString());
+    if (pt == nullptr)
         return false;
 
-    CBotExternalCall* pt = m_list[token->GetString()].get();
-
     // if this is a method call we need to use RestoreStack()
     CBotStack* pile = (thisVar != nullptr) ? pStack->RestoreStack() : pStack->RestoreStackEOX(pt);
     if (pile == nullptr) return true;
@@ -129,6 +136,16 @@ CBotExternalCall::~CBotExternalCall()
 {
 }
 
+void CBotExternalCall::SetThreadSafe(bool threadSafe)
+{
+    m_threadSafe = threadSafe;
+}
+
+bool CBotExternalCall::IsThreadSafe()
+{
+    return m_threadSafe;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 CBotExternalCallDefault::CBotExternalCallDefault(RuntimeFunc rExec, CompileFunc rCompile)
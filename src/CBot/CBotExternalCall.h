@@ -73,6 +73,20 @@ public:
      * \return false to request program interruption, true otherwise
      */
     virtual bool Run(CBotVar* thisVar, CBotStack* pStack) = 0;
+
+    /**
+     * \brief Mark the function as safe to call from programs running concurrently
+     *
+     * Only functions which don't touch anything but their arguments and result
+     * are thread safe. Calls to other functions are deferred by CBotProgram::RunConcurrent().
+     */
+    void SetThreadSafe(bool threadSafe);
+
+    //! True if the function was marked with SetThreadSafe()
+    bool IsThreadSafe();
+
+private:
+    bool m_threadSafe = false;
 };
 
 /**
@@ -152,6 +166,13 @@ public:
      */
     bool AddFunction(const std::string& name, std::unique_ptr<CBotExternalCall> call);
 
+    /**
+     * \brief Find a function by name
+     * \param name Function name
+     * \return The function, nullptr if it was not added
+     */
+    CBotExternalCall* Find(const std::string& name);
+
     /**
      * \brief Find and call compile function
      *
@@ -0,0 +1,114 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2023, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+
+#include "CBot/CBotFunctionIndex.h"
+
+#include "CBot/CBotProgram.h"
+
+#include "CBot/CBotInstr/CBotFunction.h"
+
+#include <algorithm>
+
+namespace CBot
+{
+
+namespace
+{
+const std::vector<CBotFunction*> EMPTY_LIST;
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+void CBotFunctionIndex::Add(CBotFunction* func)
+{
+    if (m_byIdent.count(func->m_nFuncIdent) != 0) return; // already known
+
+    m_byName[func->GetName()].push_back(func);
+    m_byIdent[func->m_nFuncIdent] = func;
+    CBotCallCache::InvalidateAll();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CBotFunctionIndex::Remove(CBotFunction* func)
+{
+    auto it = m_byName.find(func->GetName());
+    if (it == m_byName.end()) return;
+
+    auto& list = it->second;
+    list.erase(std::remove(list.begin(), list.end(), func), list.end());
+    if (list.empty()) m_byName.erase(it);
+
+    auto identIt = m_byIdent.find(func->m_nFuncIdent);
+    if (identIt != m_byIdent.end() && identIt->second == func) m_byIdent.erase(identIt);
+
+    CBotCallCache::InvalidateAll();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CBotFunctionIndex::Clear()
+{
+    m_byName.clear();
+    m_byIdent.clear();
+    CBotCallCache::InvalidateAll();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+CBotFunction* CBotFunctionIndex::Find(long nIdent) const
+{
+    auto it = m_byIdent.find(nIdent);
+    return it != m_byIdent.end() ? it->second : nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+const std::vector<CBotFunction*>& CBotFunctionIndex::Find(const std::string& name) const
+{
+    auto it = m_byName.find(name);
+    return it != m_byName.end() ? it->second : EMPTY_LIST;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::atomic<long> CBotCallCache::m_currentGeneration{0};
+
+////////////////////////////////////////////////////////////////////////////////
+CBotFunction* CBotCallCache::Get(long nIdent, CBotClass* pClass) const
+{
+    if (m_generation != m_currentGeneration) return nullptr;
+    if (m_ident != nIdent || m_class != pClass) return nullptr;
+    return m_function;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CBotCallCache::Set(CBotFunction* func, long nIdent, CBotClass* pClass)
+{
+    // the instruction may be shared by programs running concurrently, the lookup is just repeated
+    if (CBotProgram::IsRunningConcurrently()) return;
+
+    m_function = func;
+    m_ident = nIdent;
+    m_class = pClass;
+    m_generation = m_currentGeneration;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CBotCallCache::InvalidateAll()
+{
+    ++m_currentGeneration;
+}
+
+} // namespace CBot
@@ -0,0 +1,97 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2023, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace CBot
+{
+
+class CBotFunction;
+class CBotClass;
+
+/**
+ * \brief Index of functions by name and by unique identifier
+ *
+ * Used for the functions of a CBotProgram and for the list of public
+ * functions, so that resolving a call doesn't have to go through every
+ * function that exists. Functions with the same name are kept in the order
+ * they were added in.
+ */
+class CBotFunctionIndex
+{
+public:
+    //! Add a function to the index
+    void Add(CBotFunction* func);
+    //! Remove a function from the index, does nothing for unknown functions
+    void Remove(CBotFunction* func);
+    //! Remove all functions
+    void Clear();
+
+    //! Find a function by its unique identifier, nullptr if not found
+    CBotFunction* Find(long nIdent) const;
+    //! All functions with given name, empty if none
+    const std::vector<CBotFunction*>& Find(const std::string& name) const;
+
+private:
+    std::unordered_map<std::string, std::vector<CBotFunction*>> m_byName;
+    std::unordered_map<long, CBotFunction*> m_byIdent;
+};
+
+/**
+ * \brief Inline cache of a call site
+ *
+ * Remembers the function a call instruction was resolved to, for the
+ * unique identifier it resolved with and the class of the object for method
+ * calls. Any function being created, destroyed or made visible invalidates
+ * all caches at once, see InvalidateAll().
+ */
+class CBotCallCache
+{
+public:
+    /**
+     * \brief Get the cached function
+     * \param nIdent Identifier of the function the call site currently refers to
+     * \param pClass Class the method is looked up in, nullptr for functions
+     * \return The function, or nullptr if the cache doesn't apply
+     */
+    CBotFunction* Get(long nIdent, CBotClass* pClass = nullptr) const;
+
+    //! Remember the function found for given identifier and class
+    void Set(CBotFunction* func, long nIdent, CBotClass* pClass = nullptr);
+
+    //! Invalidate all call caches, called when the set of existing functions changes
+    static void InvalidateAll();
+
+private:
+    CBotFunction* m_function = nullptr;
+    long m_ident = 0;
+    CBotClass* m_class = nullptr;
+    long m_generation = -1;
+
+    //! Current generation, caches filled in an older one are stale; shared by all contexts
+    static std::atomic<long> m_currentGeneration;
+};
+
+} // namespace CBot
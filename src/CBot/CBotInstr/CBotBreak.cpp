@@ -19,6 +19,7 @@
 
 #include "CBot/CBotInstr/CBotBreak.h"
 
+#include "CBot/CBotBytecode.h"
 #include "CBot/CBotStack.h"
 #include "CBot/CBotCStack.h"
 
@@ -97,4 +98,10 @@ std::string CBotBreak::GetDebugData()
     return !m_label.empty() ? "m_label = "+m_label : "";
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool CBotBreak::GenerateBytecode(CBotBytecodeBuilder& builder)
+{
+    return builder.Break(m_label, m_token.GetType() != ID_BREAK);
+}
+
 } // namespace CBot
@@ -56,6 +56,13 @@ public:
      */
     void RestoreState(CBotStack* &pj, bool bMain) override;
 
+    /*!
+     * \brief Generate bytecode jumping out of the loop, or to its next pass
+     * \param builder
+     * \return false if not supported by the bytecode engine
+     */
+    bool GenerateBytecode(CBotBytecodeBuilder& builder) override;
+
 protected:
     virtual const std::string GetDebugName() override { return "CBotBreak"; }
     virtual std::string GetDebugData() override;
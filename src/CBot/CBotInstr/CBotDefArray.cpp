@@ -185,10 +185,11 @@ bool CBotDefArray::Execute(CBotStack* &pj)
         }
         while (n<100) max[n++] = 0;
 
-        m_typevar.SetArray(max);                                    // store the limitations
+        CBotTypResult type = m_typevar;                             // the instruction can be shared by programs running concurrently
+        type.SetArray(max);                                         // store the limitations
 
         // create simply a nullptr pointer
-        CBotVar*    var = CBotVar::Create(*(m_var->GetToken()), m_typevar);
+        CBotVar*    var = CBotVar::Create(*(m_var->GetToken()), type);
         var->SetPointer(nullptr);
         var->SetUniqNum((static_cast<CBotLeftExprVar*>(m_var))->m_nIdent);
         pj->AddVar(var);
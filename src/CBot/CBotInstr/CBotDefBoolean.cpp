@@ -23,6 +23,7 @@
 #include "CBot/CBotInstr/CBotTwoOpExpr.h"
 #include "CBot/CBotInstr/CBotDefArray.h"
 
+#include "CBot/CBotBytecode.h"
 #include "CBot/CBotStack.h"
 #include "CBot/CBotCStack.h"
 
@@ -182,4 +183,13 @@ std::map<std::string, CBotInstr*> CBotDefBoolean::GetDebugLinks()
     return links;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool CBotDefBoolean::GenerateBytecode(CBotBytecodeBuilder& builder)
+{
+    if (m_expr != nullptr && !m_expr->GenerateBytecode(builder)) return false;
+    if (!static_cast<CBotLeftExprVar*>(m_var)->GenerateBytecodeDeclaration(builder, m_expr != nullptr)) return false;
+
+    return m_next2b == nullptr || m_next2b->GenerateBytecode(builder);
+}
+
 } // namespace CBot
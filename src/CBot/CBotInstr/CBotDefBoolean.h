@@ -57,6 +57,13 @@ public:
      */
     void RestoreState(CBotStack* &pj, bool bMain) override;
 
+    /*!
+     * \brief Generate bytecode for the definition
+     * \param builder
+     * \return false if not supported by the bytecode engine
+     */
+    bool GenerateBytecode(CBotBytecodeBuilder& builder) override;
+
 protected:
     virtual const std::string GetDebugName() override { return "CBotDefBoolean"; }
     virtual std::map<std::string, CBotInstr*> GetDebugLinks() override;
@@ -23,6 +23,7 @@
 #include "CBot/CBotInstr/CBotDefArray.h"
 #include "CBot/CBotInstr/CBotTwoOpExpr.h"
 
+#include "CBot/CBotBytecode.h"
 #include "CBot/CBotStack.h"
 #include "CBot/CBotCStack.h"
 
@@ -198,4 +199,13 @@ std::map<std::string, CBotInstr*> CBotDefInt::GetDebugLinks()
     return links;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool CBotDefInt::GenerateBytecode(CBotBytecodeBuilder& builder)
+{
+    if (m_expr != nullptr && !m_expr->GenerateBytecode(builder)) return false;
+    if (!static_cast<CBotLeftExprVar*>(m_var)->GenerateBytecodeDeclaration(builder, m_expr != nullptr)) return false;
+
+    return m_next2b == nullptr || m_next2b->GenerateBytecode(builder);
+}
+
 } // namespace CBot
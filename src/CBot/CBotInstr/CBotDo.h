@@ -55,6 +55,13 @@ public:
      */
     void RestoreState(CBotStack* &pj, bool bMain) override;
 
+    /*!
+     * \brief Generate bytecode for the loop
+     * \param builder
+     * \return false if not supported by the bytecode engine
+     */
+    bool GenerateBytecode(CBotBytecodeBuilder& builder) override;
+
 protected:
     virtual const std::string GetDebugName() override { return "CBotDo"; }
     virtual std::string GetDebugData() override;
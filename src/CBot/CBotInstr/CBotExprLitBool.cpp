@@ -19,6 +19,7 @@
 
 #include "CBot/CBotInstr/CBotExprLitBool.h"
 
+#include "CBot/CBotBytecode.h"
 #include "CBot/CBotStack.h"
 #include "CBot/CBotCStack.h"
 
@@ -79,4 +80,11 @@ void CBotExprLitBool::RestoreState(CBotStack* &pj, bool bMain)
     if (bMain) pj->RestoreStack(this);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool CBotExprLitBool::GenerateBytecode(CBotBytecodeBuilder& builder)
+{
+    builder.PushBool(GetTokenType() == ID_TRUE);
+    return true;
+}
+
 } // namespace CBot
@@ -18,6 +18,7 @@
  */
 
 #include "CBot/CBotInstr/CBotExprLitNum.h"
+#include "CBot/CBotBytecode.h"
 #include "CBot/CBotStack.h"
 
 #include "CBot/CBotCStack.h"
@@ -196,4 +197,22 @@ std::string CBotExprLitNum<T>::GetDebugData()
     return ss.str();
 }
 
+template <typename T>
+bool CBotExprLitNum<T>::GenerateBytecode(CBotBytecodeBuilder& builder)
+{
+    if (m_token.GetType() == TokenTypDef) return false;     // keeps the name of the constant, see CBotVarInt
+
+    switch (m_numtype)
+    {
+    case CBotTypInt:
+        builder.PushInt(static_cast<int>(m_value));
+        return true;
+    case CBotTypFloat:
+        builder.PushFloat(static_cast<float>(m_value));
+        return true;
+    default:
+        return false;
+    }
+}
+
 } // namespace CBot
@@ -20,6 +20,7 @@
 #include "CBot/CBotInstr/CBotExprUnaire.h"
 #include "CBot/CBotInstr/CBotParExpr.h"
 
+#include "CBot/CBotBytecode.h"
 #include "CBot/CBotStack.h"
 #include "CBot/CBotCStack.h"
 
@@ -130,4 +131,12 @@ std::map<std::string, CBotInstr*> CBotExprUnaire::GetDebugLinks()
     return links;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool CBotExprUnaire::GenerateBytecode(CBotBytecodeBuilder& builder)
+{
+    if (!m_expr->GenerateBytecode(builder)) return false;
+    if (GetTokenType() == ID_ADD) return true;
+    return builder.Unary(GetTokenType());
+}
+
 } // namespace CBot
@@ -24,6 +24,7 @@
 #include "CBot/CBotInstr/CBotIndexExpr.h"
 #include "CBot/CBotInstr/CBotFieldExpr.h"
 
+#include "CBot/CBotBytecode.h"
 #include "CBot/CBotStack.h"
 #include "CBot/CBotCStack.h"
 
@@ -36,6 +37,8 @@ namespace CBot
 CBotExprVar::CBotExprVar()
 {
     m_nIdent = 0;
+    m_varLevel = -1;
+    m_varSlot = 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -286,7 +289,7 @@ bool CBotExprVar::ExecuteVar(CBotVar* &pVar, CBotStack* &pj, CBotToken* prevToke
 
     if (bStep && m_nIdent>0 && pj->IfStep()) return false;
 
-    pVar = pj->FindVar(m_nIdent, true);     // tries with the variable update if necessary
+    pVar = pj->FindVar(m_nIdent, true, m_varLevel, m_varSlot);     // tries with the variable update if necessary
     if (pVar == nullptr)
     {
         assert(false);
@@ -318,4 +321,21 @@ std::string CBotExprVar::GetDebugData()
     return ss.str();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool CBotExprVar::GenerateBytecode(CBotBytecodeBuilder& builder)
+{
+    int slot = GetBytecodeSlot(builder);
+    if (slot < 0) return false;
+
+    builder.Load(slot, &m_token);
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int CBotExprVar::GetBytecodeSlot(CBotBytecodeBuilder& builder)
+{
+    if (m_next3 != nullptr) return -1;
+    return builder.FindSlot(m_nIdent);
+}
+
 } // namespace CBot
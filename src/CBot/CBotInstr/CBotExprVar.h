@@ -70,6 +70,20 @@ public:
      */
     void RestoreState(CBotStack* &pj, bool bMain) override;
 
+    /*!
+     * \brief Generate bytecode reading a local variable
+     * \param builder
+     * \return false if not supported by the bytecode engine
+     */
+    bool GenerateBytecode(CBotBytecodeBuilder& builder) override;
+
+    /*!
+     * \brief Get the slot of the variable in the bytecode engine
+     * \param builder
+     * \return -1 if this is not a local variable of a supported type, or has fields or indexes
+     */
+    int GetBytecodeSlot(CBotBytecodeBuilder& builder);
+
     /*!
      * \brief ExecuteVar Fetch a variable at runtime.
      * \param pVar
@@ -95,6 +109,9 @@ protected:
 
 private:
     long m_nIdent;
+    //! Cached position of the variable on the stack, see CBotStack::FindVar(long, bool, int&, int&)
+    int m_varLevel;
+    int m_varSlot;
     friend class CBotPostIncExpr;
     friend class CBotPreIncExpr;
 
@@ -23,6 +23,7 @@
 
 #include "CBot/CBotInstr/CBotTwoOpExpr.h"
 
+#include "CBot/CBotBytecode.h"
 #include "CBot/CBotStack.h"
 #include "CBot/CBotCStack.h"
 
@@ -316,4 +317,44 @@ std::map<std::string, CBotInstr*> CBotExpression::GetDebugLinks()
     return links;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool CBotExpression::GenerateBytecode(CBotBytecodeBuilder& builder)
+{
+    int slot = m_leftop->GetBytecodeSlot(builder);
+    if (slot < 0 || m_rightop == nullptr) return false;
+
+    if (m_token.GetType() == ID_ASS)
+    {
+        // the value of the expression is the one on the right, before conversion
+        if (!m_rightop->GenerateBytecode(builder)) return false;
+        builder.Dup();
+        return builder.Store(slot);
+    }
+
+    int op;
+    switch (m_token.GetType())
+    {
+    case ID_ASSADD:     op = ID_ADD; break;
+    case ID_ASSSUB:     op = ID_SUB; break;
+    case ID_ASSMUL:     op = ID_MUL; break;
+    case ID_ASSDIV:     op = ID_DIV; break;
+    case ID_ASSMODULO:  op = ID_MODULO; break;
+    case ID_ASSAND:     op = ID_AND; break;
+    case ID_ASSXOR:     op = ID_XOR; break;
+    case ID_ASSOR:      op = ID_OR; break;
+    case ID_ASSSL:      op = ID_SL; break;
+    case ID_ASSSR:      op = ID_SR; break;
+    case ID_ASSASR:     op = ID_ASR; break;
+    default:
+        return false;
+    }
+
+    // computed in the type of the variable
+    builder.Load(slot, nullptr);
+    if (!m_rightop->GenerateBytecode(builder)) return false;
+    if (!builder.Binary(op, &m_token, builder.GetSlotType(slot))) return false;
+    builder.Dup();
+    return builder.Store(slot);
+}
+
 } // namespace CBot
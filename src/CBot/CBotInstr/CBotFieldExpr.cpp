@@ -22,6 +22,7 @@
 #include "CBot/CBotStack.h"
 #include "CBot/CBotCStack.h"
 #include "CBot/CBotClass.h"
+#include "CBot/CBotProgram.h"
 
 #include "CBot/CBotVar/CBotVarClass.h"
 
@@ -100,6 +101,9 @@ bool CBotFieldExpr::ExecuteVar(CBotVar* &pVar, CBotStack* &pile, CBotToken* prev
 
     if (pVar->IsStatic())
     {
+        // static variables are shared by all programs, access them in order
+        if (CBotProgram::DeferIfConcurrent()) return false;
+
         // for a static variable, takes it in the class itself
         CBotClass* pClass = pItem->GetClass();
         pVar = pClass->GetItem(m_token.GetString());
@@ -22,6 +22,7 @@
 #include "CBot/CBotInstr/CBotBlock.h"
 #include "CBot/CBotInstr/CBotBoolExpr.h"
 
+#include "CBot/CBotBytecode.h"
 #include "CBot/CBotStack.h"
 #include "CBot/CBotCStack.h"
 
@@ -225,4 +226,32 @@ std::map<std::string, CBotInstr*> CBotFor::GetDebugLinks()
     return links;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool CBotFor::GenerateBytecode(CBotBytecodeBuilder& builder)
+{
+    int labelTest = builder.NewLabel();
+    int labelIncr = builder.NewLabel();
+    int labelEnd = builder.NewLabel();
+
+    if (m_init != nullptr && !builder.Statement(m_init, false)) return false;
+
+    builder.SetLabel(labelTest);
+    if (m_test != nullptr)
+    {
+        if (!m_test->GenerateBytecode(builder)) return false;
+        builder.JumpIfFalse(labelEnd);
+    }
+
+    builder.BeginLoop(m_label, labelEnd, labelIncr);
+    if (m_block != nullptr && !builder.Statement(m_block, false)) return false;
+    builder.EndLoop();
+
+    builder.SetLabel(labelIncr);
+    if (m_incr != nullptr && !builder.Statement(m_incr, false)) return false;
+    builder.Tick(this, 0);          // each pass may be interrupted
+    builder.Jump(labelTest);
+    builder.SetLabel(labelEnd);
+    return true;
+}
+
 } // namespace CBot
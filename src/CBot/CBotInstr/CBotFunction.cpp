@@ -27,20 +27,32 @@
 #include "CBot/CBotInstr/CBotEmpty.h"
 #include "CBot/CBotInstr/CBotListArray.h"
 
+#include "CBot/CBotBytecode.h"
 #include "CBot/CBotStack.h"
 #include "CBot/CBotCStack.h"
 #include "CBot/CBotClass.h"
+#include "CBot/CBotContext.h"
+#include "CBot/CBotProgram.h"
 #include "CBot/CBotDefParam.h"
 #include "CBot/CBotUtils.h"
 
 #include "CBot/CBotVar/CBotVar.h"
 
 #include <cassert>
+#include <mutex>
 #include <sstream>
 
 namespace CBot
 {
 
+namespace
+{
+
+//! State of the function level while the body runs on the bytecode engine, see CBotBytecode
+const int STATE_BYTECODE = -1;
+
+} // namespace
+
 ////////////////////////////////////////////////////////////////////////////////
 CBotFunction::CBotFunction()
 {
@@ -54,9 +66,6 @@ CBotFunction::CBotFunction()
     m_bSynchro    = false;
 }
 
-////////////////////////////////////////////////////////////////////////////////
-std::set<CBotFunction*> CBotFunction::m_publicFunctions{};
-
 ////////////////////////////////////////////////////////////////////////////////
 CBotFunction::~CBotFunction()
 {
@@ -64,10 +73,13 @@ CBotFunction::~CBotFunction()
     delete m_block;                // the instruction block
 
     // remove public list if there is
-    if (m_bPublic)
+    if (m_publicContext != nullptr)
     {
-        m_publicFunctions.erase(this);
+        m_publicContext->m_publicFunctions.Remove(this);
+        m_publicContext->InvalidateCompileCache();
     }
+
+    CBotCallCache::InvalidateAll();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -398,7 +410,7 @@ bool CBotFunction::Execute(CBotVar** ppVars, CBotStack* &pj, CBotVar* pInstance)
     CBotStack*  pile = pj->AddStack(this, CBotStack::BlockVisibilityType::FUNCTION);               // one end of stack local to this function
 //  if ( pile == EOX ) return true;
 
-    pile->SetProgram(m_pProg);                              // bases for routines
+    pile->SetProgram(GetRunProgram(pj->GetProgram()));      // bases for routines
 
     if ( pile->IfStep() ) return false;
 
@@ -414,6 +426,8 @@ bool CBotFunction::Execute(CBotVar** ppVars, CBotStack* &pj, CBotVar* pInstance)
             pile3b->Delete(); // done with param stack
         }
         pile->IncState();
+
+        if (UseBytecode(pile->GetProgram())) pile->SetState(STATE_BYTECODE);
     }
 
     if ( pile->GetState() == 1 && !m_MasterClass.empty() )
@@ -445,7 +459,13 @@ bool CBotFunction::Execute(CBotVar** ppVars, CBotStack* &pj, CBotVar* pInstance)
         pile->IncState();
     }
 
-    if (!pile->GetRetVar(m_block->Execute(pile)))
+    bool ok;
+    if (pile->GetState() == STATE_BYTECODE)
+        ok = m_bytecode->Execute(pile);
+    else
+        ok = m_block->Execute(pile);
+
+    if (!pile->GetRetVar(ok))
     {
         if ( pile->GetError() < 0 )
             pile->SetError( CBotNoErr );
@@ -463,7 +483,7 @@ void CBotFunction::RestoreState(CBotVar** ppVars, CBotStack* &pj, CBotVar* pInst
     if ( pile == nullptr ) return;
     CBotStack*  pile2 = pile;
 
-    pile->SetProgram(m_pProg);                          // bases for routines
+    pile->SetProgram(GetRunProgram(pj->GetProgram()));  // bases for routines
 
     if ( pile->GetBlock() != CBotStack::BlockVisibilityType::FUNCTION)
     {
@@ -490,6 +510,14 @@ void CBotFunction::RestoreState(CBotVar** ppVars, CBotStack* &pj, CBotVar* pInst
     if (m_param != nullptr)
         m_param->RestoreState(pile2, false); // restore parameter IDs
 
+    if (pile->GetState() == STATE_BYTECODE)
+    {
+        CBotBytecode* bytecode = GetBytecode();
+        assert(bytecode != nullptr); // the lowering doesn't change between saving and loading
+        bytecode->RestoreState(pile2);
+        return;
+    }
+
     if ( !m_MasterClass.empty() )
     {
         CBotVar* pThis = pile->FindVar("this");
@@ -501,11 +529,47 @@ void CBotFunction::RestoreState(CBotVar** ppVars, CBotStack* &pj, CBotVar* pInst
     m_block->RestoreState(pile2, true);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool CBotFunction::UseBytecode(CBotProgram* program)
+{
+    if (!m_MasterClass.empty()) return false;   // methods always run on the instruction tree
+    if (program == nullptr || program->GetEngine() != CBotProgram::Engine::BYTECODE) return false;
+    return GetBytecode() != nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+CBotProgram* CBotFunction::GetRunProgram(CBotProgram* caller)
+{
+    return m_pProg != nullptr ? m_pProg : caller;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+CBotBytecode* CBotFunction::GetBytecode()
+{
+    if (!m_bytecodeChecked.load(std::memory_order_acquire))
+    {
+        // shared code can be called by programs running concurrently
+        static std::mutex mutex;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!m_bytecodeChecked.load(std::memory_order_relaxed))
+        {
+            CBotBytecodeBuilder builder;
+            if ((m_param == nullptr || m_param->GenerateBytecode(builder)) &&
+                (m_block == nullptr || builder.Statement(m_block, false)))
+            {
+                m_bytecode = builder.Finish();
+            }
+            m_bytecodeChecked.store(true, std::memory_order_release);
+        }
+    }
+    return m_bytecode.get();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 CBotTypResult CBotFunction::CompileCall(const std::string &name, CBotVar** ppVars, long &nIdent, CBotProgram* program)
 {
     CBotTypResult type;
-    if (!FindLocalOrPublic(program->GetFunctions(), nIdent, name, ppVars, type, program))
+    if (!FindLocalOrPublic(program, nIdent, name, ppVars, type, program))
     {
         // Reset the identifier to "not found" value
         nIdent = 0;
@@ -514,30 +578,25 @@ CBotTypResult CBotFunction::CompileCall(const std::string &name, CBotVar** ppVar
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-CBotFunction* CBotFunction::FindLocalOrPublic(const std::list<CBotFunction*>& localFunctionList, long &nIdent, const std::string &name,
-                                              CBotVar** ppVars, CBotTypResult &TypeOrError, CBotProgram* baseProg)
+CBotFunction* CBotFunction::FindLocalOrPublic(CBotProgram* program, long &nIdent, const std::string &name,
+                                              CBotVar** ppVars, CBotTypResult &TypeOrError, CBotProgram* baseProg,
+                                              CBotCallCache* cache)
 {
     TypeOrError.SetType(CBotErrUndefCall);      // no routine of the name
 
     if ( nIdent )
     {
-        for (CBotFunction* pt : localFunctionList)
-        {
-            if (pt->m_nFuncIdent == nIdent)
-            {
-                TypeOrError = pt->m_retTyp;
-                return pt;
-            }
-        }
+        CBotFunction* pt = (cache != nullptr) ? cache->Get(nIdent) : nullptr;
 
-        // search the list of public functions
-        for (CBotFunction* pt : m_publicFunctions)
+        // search the local functions, then the list of public functions
+        if (pt == nullptr && program != nullptr) pt = program->m_functionIndex.Find(nIdent);
+        if (pt == nullptr) pt = CBotContext::GetCurrent().m_publicFunctions.Find(nIdent);
+
+        if (pt != nullptr)
         {
-            if (pt->m_nFuncIdent == nIdent)
-            {
-                TypeOrError = pt->m_retTyp;
-                return pt;
-            }
+            if (cache != nullptr) cache->Set(pt, nIdent);
+            TypeOrError = pt->m_retTyp;
+            return pt;
         }
     }
 
@@ -545,7 +604,8 @@ CBotFunction* CBotFunction::FindLocalOrPublic(const std::list<CBotFunction*>& lo
 
     std::map<CBotFunction*, int> funcMap;
 
-    CBotFunction::SearchList(localFunctionList, name, ppVars, TypeOrError, funcMap);
+    if (program != nullptr)
+        CBotFunction::SearchIndex(program->m_functionIndex, name, ppVars, TypeOrError, funcMap);
 
     CBotFunction::SearchPublic(name, ppVars, TypeOrError, funcMap);
 
@@ -553,11 +613,14 @@ CBotFunction* CBotFunction::FindLocalOrPublic(const std::list<CBotFunction*>& lo
     {
         // find object:: functions
         CBotClass* pClass = baseProg->m_thisVar->GetClass();
-        CBotFunction::SearchList(localFunctionList, name, ppVars, TypeOrError, funcMap, pClass);
+        if (program != nullptr)
+            CBotFunction::SearchIndex(program->m_functionIndex, name, ppVars, TypeOrError, funcMap, pClass);
         CBotFunction::SearchPublic(name, ppVars, TypeOrError, funcMap, pClass);
     }
 
-    return CBotFunction::BestFunction(funcMap, nIdent, TypeOrError);
+    CBotFunction* pt = CBotFunction::BestFunction(funcMap, nIdent, TypeOrError);
+    if (pt != nullptr && cache != nullptr) cache->Set(pt, nIdent);
+    return pt;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -568,71 +631,18 @@ void CBotFunction::SearchList(const std::list<CBotFunction*>& functionList,
     for (CBotFunction* pt : functionList)
     {
         if ( pt->m_token.GetString() == name )
-        {
-            if (pClass != nullptr) // looking for a method ?
-            {
-                if (pt->m_MasterClass != pClass->GetName()) continue;
-            }
-            else                   // looking for a function
-            {
-                if (!pt->m_MasterClass.empty()) continue;
-            }
-
-            int i = 0;
-            int alpha = 0;                          // signature of parameters
-            // parameters are compatible?
-            CBotDefParam* pv = pt->m_param;         // expected list of parameters
-            CBotVar* pw = ppVars[i++];              // provided list parameter
-            while ( pv != nullptr && (pw != nullptr || pv->HasDefault()) )
-            {
-                if (pw == nullptr)     // end of arguments
-                {
-                    pv = pv->GetNext();
-                    continue;          // skip params with default values
-                }
-                CBotTypResult paramType = pv->GetTypResult();
-                CBotTypResult argType = pw->GetTypResult(CBotVar::GetTypeMode::CLASS_AS_INTRINSIC);
-
-                if (!TypesCompatibles(paramType, argType))
-                {
-                    if ( funcMap.empty() ) TypeOrError.SetType(CBotErrBadParam);
-                    break;
-                }
+            CheckCandidate(pt, ppVars, TypeOrError, funcMap, pClass);
+    }
+}
 
-                if (paramType.Eq(CBotTypPointer) && !argType.Eq(CBotTypNullPointer))
-                {
-                    CBotClass* c1 = paramType.GetClass();
-                    CBotClass* c2 = argType.GetClass();
-                    while (c2 != c1 && c2 != nullptr)    // implicit cast
-                    {
-                        alpha += 10;
-                        c2 = c2->GetParent();
-                    }
-                }
-                else
-                {
-                    int d = pv->GetType() - pw->GetType(CBotVar::GetTypeMode::CLASS_AS_INTRINSIC);
-                    alpha += d>0 ? d : -10*d;       // quality loss, 10 times more expensive!
-                }
-                pv = pv->GetNext();
-                pw = ppVars[i++];
-            }
-            if ( pw != nullptr )
-            {
-                if ( !funcMap.empty() ) continue;
-                if ( TypeOrError.Eq(CBotErrLowParam) ) TypeOrError.SetType(CBotErrNbParam);
-                if ( TypeOrError.Eq(CBotErrUndefCall)) TypeOrError.SetType(CBotErrOverParam);
-                continue;                   // too many parameters
-            }
-            if ( pv != nullptr )
-            {
-                if ( !funcMap.empty() ) continue;
-                if ( TypeOrError.Eq(CBotErrOverParam) ) TypeOrError.SetType(CBotErrNbParam);
-                if ( TypeOrError.Eq(CBotErrUndefCall) ) TypeOrError.SetType(CBotErrLowParam);
-                continue;                   // not enough parameters
-            }
-            funcMap.insert( std::pair<CBotFunction*, int>(pt, alpha) );
-        }
+////////////////////////////////////////////////////////////////////////////////
+void CBotFunction::SearchIndex(const CBotFunctionIndex& index,
+                               const std::string& name, CBotVar** ppVars, CBotTypResult& TypeOrError,
+                               std::map<CBotFunction*, int>& funcMap, CBotClass* pClass)
+{
+    for (CBotFunction* pt : index.Find(name))
+    {
+        CheckCandidate(pt, ppVars, TypeOrError, funcMap, pClass);
     }
 }
 
@@ -640,77 +650,76 @@ void CBotFunction::SearchList(const std::list<CBotFunction*>& functionList,
 void CBotFunction::SearchPublic(const std::string& name, CBotVar** ppVars, CBotTypResult& TypeOrError,
                                 std::map<CBotFunction*, int>& funcMap, CBotClass* pClass)
 {
+    SearchIndex(CBotContext::GetCurrent().m_publicFunctions, name, ppVars, TypeOrError, funcMap, pClass);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CBotFunction::CheckCandidate(CBotFunction* pt, CBotVar** ppVars, CBotTypResult& TypeOrError,
+                                  std::map<CBotFunction*, int>& funcMap, CBotClass* pClass)
+{
+    if (pClass != nullptr) // looking for a method ?
     {
-        for (CBotFunction* pt : m_publicFunctions)
-        {
-            if ( pt->m_token.GetString() == name )
-            {
-                if (pClass != nullptr) // looking for a method ?
-                {
-                    if (pt->m_MasterClass != pClass->GetName()) continue;
-                }
-                else                   // looking for a function
-                {
-                    if (!pt->m_MasterClass.empty()) continue;
-                }
+        if (pt->m_MasterClass != pClass->GetName()) return;
+    }
+    else                   // looking for a function
+    {
+        if (!pt->m_MasterClass.empty()) return;
+    }
 
-                int i = 0;
-                int alpha = 0;                          // signature of parameters
-                // are parameters compatible ?
-                CBotDefParam* pv = pt->m_param;         // list of expected parameters
-                CBotVar* pw = ppVars[i++];              // list of provided parameters
-                while ( pv != nullptr && (pw != nullptr || pv->HasDefault()) )
-                {
-                    if (pw == nullptr)     // end of arguments
-                    {
-                        pv = pv->GetNext();
-                        continue;          // skip params with default values
-                    }
-                    CBotTypResult paramType = pv->GetTypResult();
-                    CBotTypResult argType = pw->GetTypResult(CBotVar::GetTypeMode::CLASS_AS_INTRINSIC);
+    int i = 0;
+    int alpha = 0;                          // signature of parameters
+    // parameters are compatible?
+    CBotDefParam* pv = pt->m_param;         // expected list of parameters
+    CBotVar* pw = ppVars[i++];              // provided list parameter
+    while ( pv != nullptr && (pw != nullptr || pv->HasDefault()) )
+    {
+        if (pw == nullptr)     // end of arguments
+        {
+            pv = pv->GetNext();
+            continue;          // skip params with default values
+        }
+        CBotTypResult paramType = pv->GetTypResult();
+        CBotTypResult argType = pw->GetTypResult(CBotVar::GetTypeMode::CLASS_AS_INTRINSIC);
 
-                    if (!TypesCompatibles(paramType, argType))
-                    {
-                        if ( funcMap.empty() ) TypeOrError.SetType(CBotErrBadParam);
-                        break;
-                    }
+        if (!TypesCompatibles(paramType, argType))
+        {
+            if ( funcMap.empty() ) TypeOrError.SetType(CBotErrBadParam);
+            break;
+        }
 
-                    if (paramType.Eq(CBotTypPointer) && !argType.Eq(CBotTypNullPointer))
-                    {
-                        CBotClass* c1 = paramType.GetClass();
-                        CBotClass* c2 = argType.GetClass();
-                        while (c2 != c1 && c2 != nullptr)    // implicit cast
-                        {
-                            alpha += 10;
-                            c2 = c2->GetParent();
-                        }
-                    }
-                    else
-                    {
-                        int d = pv->GetType() - pw->GetType(CBotVar::GetTypeMode::CLASS_AS_INTRINSIC);
-                        alpha += d>0 ? d : -10*d;       // quality loss, 10 times more expensive!
-                    }
-                    pv = pv->GetNext();
-                    pw = ppVars[i++];
-                }
-                if ( pw != nullptr )
-                {
-                    if ( !funcMap.empty() ) continue; // previous useable function
-                    if ( TypeOrError.Eq(CBotErrLowParam) ) TypeOrError.SetType(CBotErrNbParam);
-                    if ( TypeOrError.Eq(CBotErrUndefCall)) TypeOrError.SetType(CBotErrOverParam);
-                    continue;                   // to many parameters
-                }
-                if ( pv != nullptr )
-                {
-                    if ( !funcMap.empty() ) continue; // previous useable function
-                    if ( TypeOrError.Eq(CBotErrOverParam) ) TypeOrError.SetType(CBotErrNbParam);
-                    if ( TypeOrError.Eq(CBotErrUndefCall) ) TypeOrError.SetType(CBotErrLowParam);
-                    continue;                   // not enough parameters
-                }
-                funcMap.insert( std::pair<CBotFunction*, int>(pt, alpha) );
+        if (paramType.Eq(CBotTypPointer) && !argType.Eq(CBotTypNullPointer))
+        {
+            CBotClass* c1 = paramType.GetClass();
+            CBotClass* c2 = argType.GetClass();
+            while (c2 != c1 && c2 != nullptr)    // implicit cast
+            {
+                alpha += 10;
+                c2 = c2->GetParent();
             }
         }
+        else
+        {
+            int d = pv->GetType() - pw->GetType(CBotVar::GetTypeMode::CLASS_AS_INTRINSIC);
+            alpha += d>0 ? d : -10*d;       // quality loss, 10 times more expensive!
+        }
+        pv = pv->GetNext();
+        pw = ppVars[i++];
+    }
+    if ( pw != nullptr )
+    {
+        if ( !funcMap.empty() ) return; // previous useable function
+        if ( TypeOrError.Eq(CBotErrLowParam) ) TypeOrError.SetType(CBotErrNbParam);
+        if ( TypeOrError.Eq(CBotErrUndefCall)) TypeOrError.SetType(CBotErrOverParam);
+        return;                   // too many parameters
+    }
+    if ( pv != nullptr )
+    {
+        if ( !funcMap.empty() ) return; // previous useable function
+        if ( TypeOrError.Eq(CBotErrOverParam) ) TypeOrError.SetType(CBotErrNbParam);
+        if ( TypeOrError.Eq(CBotErrUndefCall) ) TypeOrError.SetType(CBotErrLowParam);
+        return;                   // not enough parameters
     }
+    funcMap.insert( std::pair<CBotFunction*, int>(pt, alpha) );
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -745,21 +754,21 @@ CBotFunction* CBotFunction::BestFunction(std::map<CBotFunction*, int>& funcMap,
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-int CBotFunction::DoCall(CBotProgram* program, const std::list<CBotFunction*>& localFunctionList, long &nIdent, const std::string &name,
-                         CBotVar** ppVars, CBotStack* pStack, CBotToken* pToken)
+int CBotFunction::DoCall(CBotProgram* program, long &nIdent, const std::string &name,
+                         CBotVar** ppVars, CBotStack* pStack, CBotToken* pToken, CBotCallCache* cache)
 {
     CBotTypResult   type;
     CBotFunction*   pt = nullptr;
     CBotProgram*    baseProg = pStack->GetProgram(true);
 
-    pt = FindLocalOrPublic(localFunctionList, nIdent, name, ppVars, type, baseProg);
+    pt = FindLocalOrPublic(program, nIdent, name, ppVars, type, baseProg, cache);
 
     if ( pt != nullptr )
     {
         CBotStack*  pStk1 = pStack->AddStack(pt, CBotStack::BlockVisibilityType::FUNCTION);    // to put "this"
 //      if ( pStk1 == EOX ) return true;
 
-        pStk1->SetProgram(pt->m_pProg);                 // it may have changed module
+        pStk1->SetProgram(pt->GetRunProgram(program));  // it may have changed module
 
         if ( pStk1->IfStep() ) return false;
 
@@ -805,7 +814,7 @@ int CBotFunction::DoCall(CBotProgram* program, const std::list<CBotFunction*>& l
             {
                 if (!pt->m_param->Execute(ppVars, pStk3)) // interupt here
                 {
-                    if (!pStk3->IsOk() && pt->m_pProg != program)
+                    if (!pStk3->IsOk() && pt->GetRunProgram(program) != program)
                     {
                         pStk3->SetPosError(pToken);       // indicates the error on the procedure call
                     }
@@ -814,14 +823,21 @@ int CBotFunction::DoCall(CBotProgram* program, const std::list<CBotFunction*>& l
             }
             pStk3b->Delete(); // done with param stack
             pStk1->IncState();
+
+            if (pt->UseBytecode(pStk1->GetProgram())) pStk1->SetState(STATE_BYTECODE);
         }
 
         // finally execution of the found function
 
-        if ( !pStk3->GetRetVar(                     // puts the result on the stack
-            pt->m_block->Execute(pStk3) ))          // GetRetVar said if it is interrupted
+        bool ok;
+        if (pStk1->GetState() == STATE_BYTECODE)
+            ok = pt->m_bytecode->Execute(pStk3);
+        else
+            ok = pt->m_block->Execute(pStk3);
+
+        if ( !pStk3->GetRetVar(ok) )                // puts the result on the stack, GetRetVar said if it is interrupted
         {
-            if ( !pStk3->IsOk() && pt->m_pProg != program )
+            if ( !pStk3->IsOk() && pt->GetRunProgram(program) != program )
             {
                 pStk3->SetPosError(pToken);         // indicates the error on the procedure call
             }
@@ -834,8 +850,8 @@ int CBotFunction::DoCall(CBotProgram* program, const std::list<CBotFunction*>& l
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-void CBotFunction::RestoreCall(const std::list<CBotFunction*>& localFunctionList,
-                               long &nIdent, const std::string &name, CBotVar** ppVars, CBotStack* pStack)
+void CBotFunction::RestoreCall(CBotProgram* program, long &nIdent, const std::string &name,
+                               CBotVar** ppVars, CBotStack* pStack, CBotCallCache* cache)
 {
     CBotTypResult   type;
     CBotFunction*   pt = nullptr;
@@ -843,14 +859,14 @@ void CBotFunction::RestoreCall(const std::list<CBotFunction*>& localFunctionList
     CBotStack*      pStk3;
     CBotProgram*    baseProg = pStack->GetProgram(true);
 
-    pt = FindLocalOrPublic(localFunctionList, nIdent, name, ppVars, type, baseProg);
+    pt = FindLocalOrPublic(program, nIdent, name, ppVars, type, baseProg, cache);
 
     if ( pt != nullptr )
     {
         pStk1 = pStack->RestoreStack(pt);
         if ( pStk1 == nullptr ) return;
 
-        pStk1->SetProgram(pt->m_pProg);                 // it may have changed module
+        pStk1->SetProgram(pt->GetRunProgram(program));  // it may have changed module
 
         if ( pStk1->GetBlock() != CBotStack::BlockVisibilityType::FUNCTION)
         {
@@ -896,6 +912,14 @@ void CBotFunction::RestoreCall(const std::list<CBotFunction*>& localFunctionList
         // initializes the variables as parameters
         if (pt->m_param != nullptr)
             pt->m_param->RestoreState(pStk3, false); // restore parameter IDs
+
+        if (pStk1->GetState() == STATE_BYTECODE)
+        {
+            CBotBytecode* bytecode = pt->GetBytecode();
+            assert(bytecode != nullptr); // the lowering doesn't change between saving and loading
+            bytecode->RestoreState(pStk3);
+            return;
+        }
         pt->m_block->RestoreState(pStk3, true);
     }
 }
@@ -938,21 +962,29 @@ CBotTypResult CBotFunction::CompileMethodCall(const std::string& name, CBotVar**
 ////////////////////////////////////////////////////////////////////////////////
 CBotFunction* CBotFunction::FindMethod(long& nIdent, const std::string& name,
                                        CBotVar** ppVars, CBotTypResult& TypeOrError,
-                                       CBotClass* pClass, CBotProgram* program)
+                                       CBotClass* pClass, CBotProgram* program, CBotCallCache* cache)
 {
     TypeOrError.SetType(CBotErrUndefCall);      // no routine of the name
 
-    auto methods = pClass->GetFunctions();
+    const auto& methods = pClass->GetFunctions();
 
     if ( nIdent )
     {
+        CBotFunction* pt = (cache != nullptr) ? cache->Get(nIdent, pClass) : nullptr;
+        if (pt != nullptr)
+        {
+            TypeOrError = pt->m_retTyp;
+            return pt;
+        }
+
         // search methods in the class
-        for (CBotFunction* pt : methods)
+        for (CBotFunction* method : methods)
         {
-            if ( pt->m_nFuncIdent == nIdent )
+            if ( method->m_nFuncIdent == nIdent )
             {
-                TypeOrError = pt->m_retTyp;
-                return pt;
+                if (cache != nullptr) cache->Set(method, nIdent, pClass);
+                TypeOrError = method->m_retTyp;
+                return method;
             }
         }
 
@@ -960,16 +992,17 @@ CBotFunction* CBotFunction::FindMethod(long& nIdent, const std::string& name,
         if (program != nullptr)
         {
             // search the current program
-            for (CBotFunction* pt : program->GetFunctions())
+            pt = program->m_functionIndex.Find(nIdent);
+            if (pt != nullptr)
             {
-                if ( pt->m_nFuncIdent == nIdent )
+                // check if the method is inherited
+                if ( pt->GetClassName() != pClass->GetName() )
                 {
-                    // check if the method is inherited
-                    if ( pt->GetClassName() != pClass->GetName() )
-                    {
-                        skipPublic = true;
-                        break; // break in case there is an override
-                    }
+                    skipPublic = true; // in case there is an override
+                }
+                else
+                {
+                    if (cache != nullptr) cache->Set(pt, nIdent, pClass);
                     TypeOrError = pt->m_retTyp;
                     return pt;
                 }
@@ -979,15 +1012,13 @@ CBotFunction* CBotFunction::FindMethod(long& nIdent, const std::string& name,
         // search the list of public functions
         if (!skipPublic)
         {
-            for (CBotFunction* pt : m_publicFunctions)
+            pt = CBotContext::GetCurrent().m_publicFunctions.Find(nIdent);
+            // check if the method is inherited, skip in case there is an override
+            if (pt != nullptr && pt->GetClassName() == pClass->GetName())
             {
-                if (pt->m_nFuncIdent == nIdent)
-                {
-                    // check if the method is inherited, break in case there is an override
-                    if ( pt->GetClassName() != pClass->GetName() ) break;
-                    TypeOrError = pt->m_retTyp;
-                    return pt;
-                }
+                if (cache != nullptr) cache->Set(pt, nIdent, pClass);
+                TypeOrError = pt->m_retTyp;
+                return pt;
             }
         }
     }
@@ -1001,21 +1032,24 @@ CBotFunction* CBotFunction::FindMethod(long& nIdent, const std::string& name,
 
     // search the current program for methods
     if (program != nullptr)
-        CBotFunction::SearchList(program->GetFunctions(), name, ppVars, TypeOrError, funcMap, pClass);
+        CBotFunction::SearchIndex(program->m_functionIndex, name, ppVars, TypeOrError, funcMap, pClass);
 
     CBotFunction::SearchPublic(name, ppVars, TypeOrError, funcMap, pClass);
 
-    return CBotFunction::BestFunction(funcMap, nIdent, TypeOrError);
+    CBotFunction* pt = CBotFunction::BestFunction(funcMap, nIdent, TypeOrError);
+    if (pt != nullptr && cache != nullptr) cache->Set(pt, nIdent, pClass);
+    return pt;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 int CBotFunction::DoCall(long &nIdent, const std::string &name, CBotVar* pThis,
-                         CBotVar** ppVars, CBotStack* pStack, CBotToken* pToken, CBotClass* pClass)
+                         CBotVar** ppVars, CBotStack* pStack, CBotToken* pToken, CBotClass* pClass,
+                         CBotCallCache* cache)
 {
     CBotTypResult   type;
     CBotProgram*    pProgCurrent = pStack->GetProgram();
 
-    CBotFunction*   pt = FindMethod(nIdent, name, ppVars, type, pClass, pProgCurrent);
+    CBotFunction*   pt = FindMethod(nIdent, name, ppVars, type, pClass, pProgCurrent, cache);
 
     if ( pt != nullptr )
     {
@@ -1074,6 +1108,9 @@ int CBotFunction::DoCall(long &nIdent, const std::string &name, CBotVar* pThis,
         {
             if ( pt->m_bSynchro )
             {
+                // which program gets the lock must not depend on the order the threads run in
+                if ( CBotProgram::DeferIfConcurrent() ) return false;
+
                 CBotProgram* pProgBase = pStk->GetProgram(true);
                 if ( !pClass->Lock(pProgBase) ) return false; // try to lock, interrupt if failed
             }
@@ -1111,10 +1148,11 @@ int CBotFunction::DoCall(long &nIdent, const std::string &name, CBotVar* pThis,
 
 ////////////////////////////////////////////////////////////////////////////////
 bool CBotFunction::RestoreCall(long &nIdent, const std::string &name, CBotVar* pThis,
-                               CBotVar** ppVars, CBotStack* pStack, CBotClass* pClass)
+                               CBotVar** ppVars, CBotStack* pStack, CBotClass* pClass,
+                               CBotCallCache* cache)
 {
     CBotTypResult   type;
-    CBotFunction*   pt = FindMethod(nIdent, name, ppVars, type, pClass, pStack->GetProgram());
+    CBotFunction*   pt = FindMethod(nIdent, name, ppVars, type, pClass, pStack->GetProgram(), cache);
 
     if ( pt != nullptr )
     {
@@ -1214,7 +1252,10 @@ const std::string& CBotFunction::GetClassName() const
 ////////////////////////////////////////////////////////////////////////////////
 void CBotFunction::AddPublic(CBotFunction* func)
 {
-    m_publicFunctions.insert(func);
+    CBotContext& context = CBotContext::GetCurrent();
+    context.m_publicFunctions.Add(func);
+    context.InvalidateCompileCache();
+    func->m_publicContext = &context;
 }
 
 bool CBotFunction::HasReturn()
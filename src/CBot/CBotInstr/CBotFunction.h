@@ -20,12 +20,17 @@
 #pragma once
 
 #include "CBot/CBotInstr/CBotInstr.h"
+#include "CBot/CBotFunctionIndex.h"
 
-#include <set>
+#include <atomic>
+#include <memory>
 
 namespace CBot
 {
 
+class CBotBytecode;
+class CBotContext;
+
 /**
  * \brief A function declaration in the code
  *
@@ -121,16 +126,18 @@ public:
      * <p>First, it looks for a function according to its unique identifier.<br>
      * If the identifier is not found, looks by name and parameters.
      *
-     * \param localFunctionList Linked list of local functions to search in, can be null
+     * \param program Program whose functions are searched first, can be null
      * \param nIdent[in, out] Unique identifier of the function
      * \param name Name of the function
      * \param ppVars List of function arguments
      * \param TypeOrError Type returned by the function or error code
      * \param baseProg Initial program, for context of the object/bot
+     * \param cache Inline cache of the call site, can be null
      * \return Pointer to found CBotFunction instance, or nullptr in case of no match or ambiguity (see TypeOrError for error code)
      */
-    static CBotFunction* FindLocalOrPublic(const std::list<CBotFunction*>& localFunctionList, long &nIdent, const std::string &name,
-                                           CBotVar** ppVars, CBotTypResult &TypeOrError, CBotProgram* baseProg);
+    static CBotFunction* FindLocalOrPublic(CBotProgram* program, long &nIdent, const std::string &name,
+                                           CBotVar** ppVars, CBotTypResult &TypeOrError, CBotProgram* baseProg,
+                                           CBotCallCache* cache = nullptr);
 
     /*!
      * \brief Find all functions that match the name and arguments.
@@ -145,6 +152,14 @@ public:
                            const std::string& name, CBotVar** ppVars, CBotTypResult& TypeOrError,
                            std::map<CBotFunction*, int>& funcMap, CBotClass* pClass = nullptr);
 
+    /*!
+     * \brief Same as SearchList(), for functions in an index.
+     * \see SearchList
+     */
+    static void SearchIndex(const CBotFunctionIndex& index,
+                            const std::string& name, CBotVar** ppVars, CBotTypResult& TypeOrError,
+                            std::map<CBotFunction*, int>& funcMap, CBotClass* pClass = nullptr);
+
     /*!
      * \brief Find all public functions that match the name and arguments.
      * \param name Name of the function to find.
@@ -170,28 +185,29 @@ public:
     /*!
      * \brief DoCall Fait un appel à une fonction.
      * \param program
-     * \param localFunctionList
      * \param nIdent
      * \param name
      * \param ppVars
      * \param pStack
      * \param pToken
+     * \param cache
      * \return
      */
 
-    static int DoCall(CBotProgram* program, const std::list<CBotFunction*>& localFunctionList, long &nIdent, const std::string &name,
-                      CBotVar** ppVars, CBotStack* pStack, CBotToken* pToken);
+    static int DoCall(CBotProgram* program, long &nIdent, const std::string &name,
+                      CBotVar** ppVars, CBotStack* pStack, CBotToken* pToken, CBotCallCache* cache = nullptr);
 
     /*!
      * \brief RestoreCall
-     * \param localFunctionList
+     * \param program
      * \param nIdent
      * \param name
      * \param ppVars
      * \param pStack
+     * \param cache
      */
-    static void RestoreCall(const std::list<CBotFunction*>& localFunctionList,
-                            long &nIdent, const std::string &name, CBotVar** ppVars, CBotStack* pStack);
+    static void RestoreCall(CBotProgram* program, long &nIdent, const std::string &name,
+                            CBotVar** ppVars, CBotStack* pStack, CBotCallCache* cache = nullptr);
 
     /*!
      * \brief Find a method matching the name and arguments.
@@ -213,11 +229,13 @@ public:
      * \param TypeOrError The return type for the method or a CBotError.
      * \param pClass Pointer to the class.
      * \param program The current program, to search for out-of-class methods.
+     * \param cache Inline cache of the call site, can be null.
      * \return Pointer to the method that best matches the given arguments or nullptr.
      */
     static CBotFunction* FindMethod(long& nIdent, const std::string& name,
                                     CBotVar** ppVars, CBotTypResult& TypeOrError,
-                                    CBotClass* pClass, CBotProgram* program);
+                                    CBotClass* pClass, CBotProgram* program,
+                                    CBotCallCache* cache = nullptr);
 
     /*!
      * \brief DoCall Makes call of a method
@@ -228,10 +246,12 @@ public:
      * \param pStack
      * \param pToken
      * \param pClass
+     * \param cache
      * \return
      */
     static int DoCall(long &nIdent, const std::string &name, CBotVar* pThis,
-                      CBotVar** ppVars, CBotStack* pStack, CBotToken* pToken, CBotClass* pClass);
+                      CBotVar** ppVars, CBotStack* pStack, CBotToken* pToken, CBotClass* pClass,
+                      CBotCallCache* cache = nullptr);
 
     /*!
      * \brief RestoreCall
@@ -241,10 +261,12 @@ public:
      * \param ppVars
      * \param pStack
      * \param pClass
+     * \param cache
      * \return Returns true if the method call was restored.
      */
     static bool RestoreCall(long &nIdent, const std::string &name, CBotVar* pThis,
-                            CBotVar** ppVars, CBotStack* pStack, CBotClass* pClass);
+                            CBotVar** ppVars, CBotStack* pStack, CBotClass* pClass,
+                            CBotCallCache* cache = nullptr);
 
     /*!
      * \brief CheckParam See if the "signature" of parameters is identical.
@@ -254,7 +276,7 @@ public:
     bool CheckParam(CBotDefParam* pParam);
 
     /*!
-     * \brief AddPublic
+     * \brief Add to the public functions of the current context (see CBotContext::GetCurrent())
      * \param pfunc
      */
     static void AddPublic(CBotFunction* pfunc);
@@ -324,6 +346,33 @@ protected:
     virtual std::string GetDebugData() override;
     virtual std::map<std::string, CBotInstr*> GetDebugLinks() override;
 
+private:
+    /*!
+     * \brief Check if the function can be called with given arguments, and add it to funcMap if so
+     * \see SearchList
+     */
+    static void CheckCandidate(CBotFunction* pt, CBotVar** ppVars, CBotTypResult& TypeOrError,
+                               std::map<CBotFunction*, int>& funcMap, CBotClass* pClass);
+
+    /*!
+     * \brief Get the body compiled for the bytecode engine, compiling it on first use
+     * \return nullptr if the function can't run on the bytecode engine
+     */
+    CBotBytecode* GetBytecode();
+
+    /*!
+     * \brief Check whether the function should run on the bytecode engine, see CBotProgram::SetEngine()
+     * \param program Program the function is executed in
+     */
+    bool UseBytecode(CBotProgram* program);
+
+    /*!
+     * \brief Get the program the function is executed in
+     * \param caller Program calling the function
+     * \return The program the function was compiled in, or \a caller if the code is shared between programs (see CBotProgram::Compile())
+     */
+    CBotProgram* GetRunProgram(CBotProgram* caller);
+
 private:
     friend class CBotDebug;
     long m_nFuncIdent;
@@ -350,6 +399,7 @@ private:
     std::string m_MasterClass;
     //! Token of the class we are part of
     CBotToken m_classToken;
+    //! Program the function was compiled in, nullptr if the code is shared
     CBotProgram* m_pProg;
     //! For the position of the word "extern".
     CBotToken m_extern;
@@ -358,10 +408,16 @@ private:
     CBotToken m_openblk;
     CBotToken m_closeblk;
 
-    //! List of public functions
-    static std::set<CBotFunction*> m_publicFunctions;
+    //! Body compiled for the bytecode engine, see GetBytecode()
+    std::unique_ptr<CBotBytecode> m_bytecode;
+    //! True once the body was checked for the bytecode engine
+    std::atomic<bool> m_bytecodeChecked{false};
+
+    //! Context listing this function as public, nullptr if not listed
+    CBotContext* m_publicContext = nullptr;
 
     friend class CBotProgram;
+    friend class CBotFunctionIndex;
     friend class CBotClass;
     friend class CBotCStack;
 
@@ -21,6 +21,7 @@
 #include "CBot/CBotInstr/CBotBlock.h"
 #include "CBot/CBotInstr/CBotCondition.h"
 
+#include "CBot/CBotBytecode.h"
 #include "CBot/CBotStack.h"
 #include "CBot/CBotCStack.h"
 
@@ -181,4 +182,20 @@ std::map<std::string, CBotInstr*> CBotIf::GetDebugLinks()
     return links;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool CBotIf::GenerateBytecode(CBotBytecodeBuilder& builder)
+{
+    if (!m_condition->GenerateBytecode(builder)) return false;
+
+    int labelElse = builder.NewLabel();
+    int labelEnd = builder.NewLabel();
+    builder.JumpIfFalse(labelElse);
+    if (m_block != nullptr && !builder.Statement(m_block, false)) return false;
+    builder.Jump(labelEnd);
+    builder.SetLabel(labelElse);
+    if (m_blockElse != nullptr && !builder.Statement(m_blockElse, false)) return false;
+    builder.SetLabel(labelEnd);
+    return true;
+}
+
 } // namespace CBot
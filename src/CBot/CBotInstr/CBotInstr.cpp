@@ -48,8 +48,8 @@ namespace CBot
 {
 
 ////////////////////////////////////////////////////////////////////////////////
-int CBotInstr::m_LoopLvl = 0;
-std::vector<std::string> CBotInstr::m_labelLvl = std::vector<std::string>();
+thread_local int CBotInstr::m_LoopLvl = 0;
+thread_local std::vector<std::string> CBotInstr::m_labelLvl = std::vector<std::string>();
 
 ////////////////////////////////////////////////////////////////////////////////
 CBotInstr::CBotInstr()
@@ -367,6 +367,11 @@ bool CBotInstr::HasReturn()
     return false; // end of the list
 }
 
+bool CBotInstr::GenerateBytecode(CBotBytecodeBuilder& builder)
+{
+    return false; // runs on the instruction tree only
+}
+
 std::map<std::string, CBotInstr*> CBotInstr::GetDebugLinks()
 {
     return {
@@ -27,6 +27,7 @@
 namespace CBot
 {
 class CBotDebug;
+class CBotBytecodeBuilder;
 
 /**
  * \brief Class for one CBot instruction
@@ -276,6 +277,13 @@ public:
      */
     virtual bool HasReturn();
 
+    /**
+     * \brief Generate code for the bytecode engine, see CBotBytecode
+     * \param builder Builder of the function being compiled
+     * \return false if the instruction is not supported by the bytecode engine
+     */
+    virtual bool GenerateBytecode(CBotBytecodeBuilder& builder);
+
 protected:
     friend class CBotDebug;
     /**
@@ -307,14 +315,15 @@ protected:
     CBotInstr* m_next3b;
 
     //! Counter of nested loops, to determine the break and continue valid.
-    static int m_LoopLvl;
+    //! Per thread, programs of different contexts can compile at the same time.
+    static thread_local int m_LoopLvl;
     friend class CBotDefClass;
     friend class CBotDefInt;
     friend class CBotListArray;
 
 private:
     //! List of labels used.
-    static std::vector<std::string> m_labelLvl;
+    static thread_local std::vector<std::string> m_labelLvl;
 };
 
 } // namespace CBot
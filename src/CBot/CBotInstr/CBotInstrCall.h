@@ -20,6 +20,7 @@
 #pragma once
 
 #include "CBot/CBotInstr/CBotInstr.h"
+#include "CBot/CBotFunctionIndex.h"
 
 namespace CBot
 {
@@ -69,6 +70,8 @@ private:
     CBotTypResult m_typRes;
     //! Id of a function.
     long m_nFuncIdent;
+    //! Function the call was last resolved to.
+    CBotCallCache m_cache;
 
     //! Instruction to return a member of the returned object.
     CBotInstr* m_exprRetVar;
@@ -20,6 +20,7 @@
 #pragma once
 
 #include "CBot/CBotInstr/CBotInstr.h"
+#include "CBot/CBotFunctionIndex.h"
 
 namespace CBot
 {
@@ -82,6 +83,8 @@ private:
     std::string m_methodName;
     //! Identifier of the method.
     long m_MethodeIdent;
+    //! Method the call was last resolved to.
+    CBotCallCache m_cache;
     //! Name of the class.
     std::string m_className;
     //! Variable ID
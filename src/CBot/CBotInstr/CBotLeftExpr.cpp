@@ -23,6 +23,7 @@
 #include "CBot/CBotInstr/CBotIndexExpr.h"
 #include "CBot/CBotInstr/CBotExpression.h"
 
+#include "CBot/CBotBytecode.h"
 #include "CBot/CBotStack.h"
 #include "CBot/CBotCStack.h"
 #include "CBot/CBotClass.h"
@@ -36,6 +37,8 @@ namespace CBot
 CBotLeftExpr::CBotLeftExpr()
 {
     m_nIdent = 0;
+    m_varLevel = -1;
+    m_varSlot = 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -220,7 +223,7 @@ bool CBotLeftExpr::ExecuteVar(CBotVar* &pVar, CBotStack* &pile, CBotToken* prevT
 {
     pile = pile->AddStack(this);
 
-    pVar = pile->FindVar(m_nIdent, false);
+    pVar = pile->FindVar(m_nIdent, false, m_varLevel, m_varSlot);
     if (pVar == nullptr)
     {
         assert(false);
@@ -254,4 +257,11 @@ std::string CBotLeftExpr::GetDebugData()
     return ss.str();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+int CBotLeftExpr::GetBytecodeSlot(CBotBytecodeBuilder& builder)
+{
+    if (m_next3 != nullptr) return -1;
+    return builder.FindSlot(m_nIdent);
+}
+
 } // namespace CBot
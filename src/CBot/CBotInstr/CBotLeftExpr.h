@@ -90,12 +90,22 @@ public:
      */
     void RestoreStateVar(CBotStack* &pile, bool bMain) override;
 
+    /*!
+     * \brief Get the slot of the variable in the bytecode engine
+     * \param builder
+     * \return -1 if this is not a local variable of a supported type, or has fields or indexes
+     */
+    int GetBytecodeSlot(CBotBytecodeBuilder& builder);
+
 protected:
     virtual const std::string GetDebugName() override { return "CBotLeftExpr"; }
     virtual std::string GetDebugData() override;
 
 private:
     long m_nIdent;
+    //! Cached position of the variable on the stack, see CBotStack::FindVar(long, bool, int&, int&)
+    int m_varLevel;
+    int m_varSlot;
 };
 
 } // namespace CBot
@@ -19,6 +19,7 @@
 
 #include "CBot/CBotInstr/CBotLeftExprVar.h"
 
+#include "CBot/CBotBytecode.h"
 #include "CBot/CBotStack.h"
 #include "CBot/CBotCStack.h"
 
@@ -95,4 +96,15 @@ std::string CBotLeftExprVar::GetDebugData()
     return ss.str();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool CBotLeftExprVar::GenerateBytecodeDeclaration(CBotBytecodeBuilder& builder, bool bInit)
+{
+    int slot = builder.AddLocal(m_nIdent, static_cast<CBotType>(m_typevar.GetType()), m_token.GetString());
+    if (slot < 0) return false;
+
+    if (bInit) return builder.Store(slot);
+    builder.Undefine(slot);
+    return true;
+}
+
 } // namespace CBot
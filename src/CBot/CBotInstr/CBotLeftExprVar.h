@@ -50,6 +50,14 @@ public:
      */
     void RestoreState(CBotStack* &pj, bool bMain) override;
 
+    /*!
+     * \brief Declare the variable in the bytecode engine, and generate its initialization
+     * \param builder
+     * \param bInit true if the initial value is on the operand stack
+     * \return false if the type is not supported by the bytecode engine
+     */
+    bool GenerateBytecodeDeclaration(CBotBytecodeBuilder& builder, bool bInit);
+
 protected:
     virtual const std::string GetDebugName() override { return "CBotLeftExprVar"; }
     virtual std::string GetDebugData() override;
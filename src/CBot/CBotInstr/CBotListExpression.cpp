@@ -24,6 +24,7 @@
 #include "CBot/CBotInstr/CBotExpression.h"
 #include "CBot/CBotInstr/CBotListExpression.h"
 
+#include "CBot/CBotBytecode.h"
 #include "CBot/CBotStack.h"
 #include "CBot/CBotCStack.h"
 
@@ -134,4 +135,14 @@ std::map<std::string, CBotInstr*> CBotListExpression::GetDebugLinks()
     return links;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool CBotListExpression::GenerateBytecode(CBotBytecodeBuilder& builder)
+{
+    for (CBotInstr* p = m_expr; p != nullptr; p = p->GetNext())
+    {
+        if (!builder.Statement(p, false)) return false;
+    }
+    return true;
+}
+
 } // namespace CBot
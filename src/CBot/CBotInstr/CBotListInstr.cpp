@@ -20,6 +20,7 @@
 #include "CBot/CBotInstr/CBotListInstr.h"
 #include "CBot/CBotInstr/CBotBlock.h"
 
+#include "CBot/CBotBytecode.h"
 #include "CBot/CBotStack.h"
 #include "CBot/CBotCStack.h"
 
@@ -130,4 +131,14 @@ std::map<std::string, CBotInstr*> CBotListInstr::GetDebugLinks()
     return links;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool CBotListInstr::GenerateBytecode(CBotBytecodeBuilder& builder)
+{
+    for (CBotInstr* p = m_instr; p != nullptr; p = p->GetNext())
+    {
+        if (!builder.Statement(p)) return false;
+    }
+    return true;
+}
+
 } // namespace CBot
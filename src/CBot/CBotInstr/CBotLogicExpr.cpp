@@ -19,6 +19,7 @@
 
 #include "CBot/CBotInstr/CBotLogicExpr.h"
 
+#include "CBot/CBotBytecode.h"
 #include "CBot/CBotStack.h"
 
 namespace CBot
@@ -98,4 +99,25 @@ std::map<std::string, CBotInstr*> CBotLogicExpr::GetDebugLinks()
     return links;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool CBotLogicExpr::GenerateBytecode(CBotBytecodeBuilder& builder)
+{
+    if (!m_condition->GenerateBytecode(builder)) return false;
+
+    int labelElse = builder.NewLabel();
+    int labelEnd = builder.NewLabel();
+    builder.JumpIfFalse(labelElse);
+
+    if (!m_op1->GenerateBytecode(builder)) return false;
+    CBotType type = builder.GetType();
+    builder.Jump(labelEnd);
+
+    builder.Forget();
+    builder.SetLabel(labelElse);
+    if (!m_op2->GenerateBytecode(builder)) return false;
+    if (builder.GetType() != type) return false;   // no conversion, both values must have the same type
+    builder.SetLabel(labelEnd);
+    return true;
+}
+
 } // namespace CBot
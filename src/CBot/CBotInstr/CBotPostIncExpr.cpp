@@ -20,6 +20,7 @@
 #include "CBot/CBotInstr/CBotPostIncExpr.h"
 #include "CBot/CBotInstr/CBotExprVar.h"
 
+#include "CBot/CBotBytecode.h"
 #include "CBot/CBotStack.h"
 
 #include "CBot/CBotVar/CBotVar.h"
@@ -87,4 +88,17 @@ std::map<std::string, CBotInstr*> CBotPostIncExpr::GetDebugLinks()
     return links;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool CBotPostIncExpr::GenerateBytecode(CBotBytecodeBuilder& builder)
+{
+    int slot = static_cast<CBotExprVar*>(m_instr)->GetBytecodeSlot(builder);
+    if (slot < 0) return false;
+
+    builder.Load(slot, &m_token);
+    builder.Dup();                  // the result is the value before incrementation
+    builder.PushInt(1);
+    if (!builder.Binary(GetTokenType() == ID_INC ? ID_ADD : ID_SUB, nullptr, builder.GetSlotType(slot))) return false;
+    return builder.Store(slot);
+}
+
 } // namespace CBot
@@ -20,6 +20,7 @@
 #include "CBot/CBotInstr/CBotPreIncExpr.h"
 #include "CBot/CBotInstr/CBotExprVar.h"
 
+#include "CBot/CBotBytecode.h"
 #include "CBot/CBotStack.h"
 
 #include "CBot/CBotVar/CBotVar.h"
@@ -94,4 +95,17 @@ std::map<std::string, CBotInstr*> CBotPreIncExpr::GetDebugLinks()
     return links;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool CBotPreIncExpr::GenerateBytecode(CBotBytecodeBuilder& builder)
+{
+    int slot = static_cast<CBotExprVar*>(m_instr)->GetBytecodeSlot(builder);
+    if (slot < 0) return false;
+
+    builder.Load(slot, &m_token);
+    builder.PushInt(1);
+    if (!builder.Binary(GetTokenType() == ID_INC ? ID_ADD : ID_SUB, nullptr, builder.GetSlotType(slot))) return false;
+    builder.Dup();
+    return builder.Store(slot);
+}
+
 } // namespace CBot
@@ -23,6 +23,7 @@
 
 #include "CBot/CBotInstr/CBotExpression.h"
 
+#include "CBot/CBotBytecode.h"
 #include "CBot/CBotStack.h"
 #include "CBot/CBotCStack.h"
 
@@ -123,4 +124,18 @@ std::map<std::string, CBotInstr*> CBotReturn::GetDebugLinks()
     return links;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool CBotReturn::GenerateBytecode(CBotBytecodeBuilder& builder)
+{
+    if (m_instr == nullptr)
+    {
+        builder.ReturnVoid();
+        return true;
+    }
+
+    if (!m_instr->GenerateBytecode(builder)) return false;
+    builder.Return();
+    return true;
+}
+
 } // namespace CBot
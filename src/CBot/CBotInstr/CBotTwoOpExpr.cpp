@@ -25,6 +25,7 @@
 #include "CBot/CBotInstr/CBotLogicExpr.h"
 #include "CBot/CBotInstr/CBotExpression.h"
 
+#include "CBot/CBotBytecode.h"
 #include "CBot/CBotStack.h"
 #include "CBot/CBotCStack.h"
 
@@ -564,4 +565,38 @@ std::map<std::string, CBotInstr*> CBotTwoOpExpr::GetDebugLinks()
     return links;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool CBotTwoOpExpr::GenerateBytecode(CBotBytecodeBuilder& builder)
+{
+    int op = GetTokenType();
+    bool isAnd = (op == ID_LOG_AND || op == ID_TXT_AND);
+    bool isOr = (op == ID_LOG_OR || op == ID_TXT_OR);
+
+    if (!m_leftop->GenerateBytecode(builder)) return false;
+
+    if (isAnd || isOr)
+    {
+        if (builder.GetType() != CBotTypBoolean) return false;
+
+        // the second operand is not evaluated if not necessary
+        int labelShortcut = builder.NewLabel();
+        int labelEnd = builder.NewLabel();
+        if (isAnd) builder.JumpIfFalse(labelShortcut);
+        else       builder.JumpIfTrue(labelShortcut);
+
+        if (!m_rightop->GenerateBytecode(builder)) return false;
+        if (builder.GetType() != CBotTypBoolean) return false;
+        builder.Jump(labelEnd);
+
+        builder.Forget();
+        builder.SetLabel(labelShortcut);
+        builder.PushBool(isOr);
+        builder.SetLabel(labelEnd);
+        return true;
+    }
+
+    if (!m_rightop->GenerateBytecode(builder)) return false;
+    return builder.Binary(op, &m_token);
+}
+
 } // namespace CBot
@@ -21,6 +21,7 @@
 #include "CBot/CBotInstr/CBotBlock.h"
 #include "CBot/CBotInstr/CBotCondition.h"
 
+#include "CBot/CBotBytecode.h"
 #include "CBot/CBotStack.h"
 #include "CBot/CBotCStack.h"
 
@@ -161,4 +162,24 @@ std::map<std::string, CBotInstr*> CBotWhile::GetDebugLinks()
     return links;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool CBotWhile::GenerateBytecode(CBotBytecodeBuilder& builder)
+{
+    int labelTest = builder.NewLabel();
+    int labelEnd = builder.NewLabel();
+
+    builder.SetLabel(labelTest);
+    builder.Tick(this, 0);          // each pass may be interrupted
+    if (!m_condition->GenerateBytecode(builder)) return false;
+    builder.JumpIfFalse(labelEnd);
+
+    builder.BeginLoop(m_label, labelEnd, labelTest);
+    if (m_block != nullptr && !builder.Statement(m_block, false)) return false;
+    builder.EndLoop();
+
+    builder.Jump(labelTest);
+    builder.SetLabel(labelEnd);
+    return true;
+}
+
 } // namespace CBot
@@ -0,0 +1,164 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2023, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+#include "CBot/CBotMemoryPool.h"
+
+#include <atomic>
+#include <new>
+
+namespace CBot
+{
+
+namespace
+{
+
+//! Granularity of pooled block sizes
+const std::size_t POOL_ALIGN = 16;
+//! Number of size classes, blocks bigger than POOL_ALIGN * POOL_BUCKETS are not pooled
+const std::size_t POOL_BUCKETS = 16;
+//! Maximum number of blocks kept in one free list
+const long POOL_MAX_FREE = 4096;
+
+struct FreeBlock
+{
+    FreeBlock* next;
+};
+
+struct FreeLists
+{
+    FreeBlock* head[POOL_BUCKETS] = {};
+    long count[POOL_BUCKETS] = {};
+
+    ~FreeLists();
+};
+
+//! Statistics of all threads, blocks may be freed on another thread than they were allocated on
+struct Counters
+{
+    std::atomic<long> allocations{0};
+    std::atomic<long> reused{0};
+    std::atomic<long> live{0};
+    std::atomic<long> pooled{0};
+};
+
+Counters g_counters;
+
+thread_local FreeLists t_lists;
+//! Set once t_lists is destroyed at thread exit, blocks freed after that go straight to the system
+thread_local bool t_destroyed = false;
+
+FreeLists::~FreeLists()
+{
+    for (std::size_t i = 0; i < POOL_BUCKETS; i++)
+    {
+        while (head[i] != nullptr)
+        {
+            FreeBlock* block = head[i];
+            head[i] = block->next;
+            ::operator delete(block);
+        }
+        g_counters.pooled.fetch_sub(count[i], std::memory_order_relaxed);
+        count[i] = 0;
+    }
+    t_destroyed = true;
+}
+
+std::size_t GetBucket(std::size_t size)
+{
+    return (size + POOL_ALIGN - 1) / POOL_ALIGN - 1;
+}
+
+} // namespace
+
+void* CBotMemoryPool::Allocate(std::size_t size)
+{
+    std::size_t bucket = GetBucket(size);
+    if (size == 0 || bucket >= POOL_BUCKETS)
+        return ::operator new(size);
+
+    g_counters.allocations.fetch_add(1, std::memory_order_relaxed);
+    g_counters.live.fetch_add(1, std::memory_order_relaxed);
+
+    if (t_destroyed)
+        return ::operator new((bucket + 1) * POOL_ALIGN);
+
+    FreeLists& lists = t_lists;
+    FreeBlock* block = lists.head[bucket];
+    if (block != nullptr)
+    {
+        lists.head[bucket] = block->next;
+        lists.count[bucket]--;
+        g_counters.reused.fetch_add(1, std::memory_order_relaxed);
+        g_counters.pooled.fetch_sub(1, std::memory_order_relaxed);
+        return block;
+    }
+
+    return ::operator new((bucket + 1) * POOL_ALIGN);
+}
+
+void CBotMemoryPool::Free(void* ptr, std::size_t size)
+{
+    if (ptr == nullptr) return;
+
+    std::size_t bucket = GetBucket(size);
+    if (size == 0 || bucket >= POOL_BUCKETS)
+    {
+        ::operator delete(ptr);
+        return;
+    }
+
+    g_counters.live.fetch_sub(1, std::memory_order_relaxed);
+
+    if (t_destroyed)
+    {
+        ::operator delete(ptr);
+        return;
+    }
+
+    FreeLists& lists = t_lists;
+    if (lists.count[bucket] >= POOL_MAX_FREE)
+    {
+        ::operator delete(ptr);
+        return;
+    }
+
+    FreeBlock* block = static_cast<FreeBlock*>(ptr);
+    block->next = lists.head[bucket];
+    lists.head[bucket] = block;
+    lists.count[bucket]++;
+    g_counters.pooled.fetch_add(1, std::memory_order_relaxed);
+}
+
+CBotMemoryPool::Stats CBotMemoryPool::GetStats()
+{
+    Stats stats;
+    stats.allocations = g_counters.allocations.load(std::memory_order_relaxed);
+    stats.reused = g_counters.reused.load(std::memory_order_relaxed);
+    stats.live = g_counters.live.load(std::memory_order_relaxed);
+    stats.pooled = g_counters.pooled.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void CBotMemoryPool::ResetStats()
+{
+    g_counters.allocations.store(0, std::memory_order_relaxed);
+    g_counters.reused.store(0, std::memory_order_relaxed);
+}
+
+} // namespace CBot
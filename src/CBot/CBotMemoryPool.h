@@ -0,0 +1,77 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2023, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace CBot
+{
+
+/**
+ * \brief Free list allocator for small, short-lived CBot objects
+ *
+ * Executing a program creates and destroys a lot of CBotVar objects for
+ * intermediate results, each with its own CBotToken. Instead of returning
+ * them to the system allocator, freed blocks are kept in free lists sorted
+ * by size and handed out again on the next allocation of the same size.
+ *
+ * Classes opt in by overriding operator new/delete, see CBotVarValue and
+ * CBotToken. Free lists are per thread, so no locking is needed; a block
+ * freed on another thread than the one it was allocated on simply moves to
+ * that thread's free list. Statistics are counted for all threads together.
+ */
+class CBotMemoryPool
+{
+public:
+    //! Allocation statistics, see GetStats()
+    struct Stats
+    {
+        //! Total number of allocations
+        long allocations = 0;
+        //! Number of allocations served from a free list
+        long reused = 0;
+        //! Number of blocks currently in use
+        long live = 0;
+        //! Number of blocks waiting in free lists
+        long pooled = 0;
+    };
+
+    /**
+     * \brief Allocate a block of given size
+     *
+     * Blocks too big to be pooled are passed directly to ::operator new
+     */
+    static void* Allocate(std::size_t size);
+
+    /**
+     * \brief Release a block allocated with Allocate()
+     * \param ptr Block to release
+     * \param size Size given to Allocate() for this block
+     */
+    static void Free(void* ptr, std::size_t size);
+
+    //! Return allocation statistics of all threads
+    static Stats GetStats();
+
+    //! Reset allocation counters, blocks stay in free lists
+    static void ResetStats();
+};
+
+} // namespace CBot
@@ -18,7 +18,9 @@
  */
 
 #include "CBot/CBotVar/CBotVar.h"
+#include "CBot/CBotVar/CBotVarClass.h"
 
+#include "CBot/CBotContext.h"
 #include "CBot/CBotExternalCall.h"
 #include "CBot/CBotStack.h"
 #include "CBot/CBotCStack.h"
@@ -34,14 +36,35 @@
 namespace CBot
 {
 
-std::unique_ptr<CBotExternalCallList> CBotProgram::m_externalCalls;
+namespace
+{
+//! State of RunConcurrent() on the calling thread
+struct ConcurrentRun
+{
+    bool running = false;
+    bool deferred = false;
+};
+thread_local ConcurrentRun t_concurrentRun;
+} // namespace
+
+CBotProgram::CompiledCode::~CompiledCode()
+{
+    functionIndex.Clear();
+    for (CBotFunction* f : functions) delete f;
+}
 
 CBotProgram::CBotProgram()
+: m_context(&CBotContext::GetCurrent())
 {
 }
 
 CBotProgram::CBotProgram(CBotVar* thisVar)
-: m_thisVar(thisVar)
+: m_context(&CBotContext::GetCurrent()), m_thisVar(thisVar)
+{
+}
+
+CBotProgram::CBotProgram(CBotVar* thisVar, CBotContext& context)
+: m_context(&context), m_thisVar(thisVar)
 {
 }
 
@@ -54,12 +77,13 @@ CBotProgram::~CBotProgram()
 
     CBotClass::FreeLock(this);
 
-    for (CBotFunction* f : m_functions) delete f;
-    m_functions.clear();
+    ReleaseFunctions();
 }
 
 bool CBotProgram::Compile(const std::string& program, std::vector<std::string>& externFunctions, void* pUser)
 {
+    CBotContext::Scope scope(*m_context);
+
     // Cleanup the previously compiled program
     Stop();
 
@@ -68,8 +92,7 @@ bool CBotProgram::Compile(const std::string& program, std::vector<std::string>&
                          // but without destroying the object
 
     m_classes.clear();
-    for (CBotFunction* f : m_functions) delete f;
-    m_functions.clear();
+    ReleaseFunctions();
 
     externFunctions.clear();
     m_error = CBotNoErr;
@@ -82,7 +105,7 @@ bool CBotProgram::Compile(const std::string& program, std::vector<std::string>&
     CBotToken* p = tokens.get()->GetNext();                 // skips the first token (separator)
 
     pStack->SetProgram(this);                               // defined used routines
-    m_externalCalls->SetUserPtr(pUser);
+    m_context->m_externalCalls->SetUserPtr(pUser);
 
     // Step 2. Find all function and class definitions
     while ( pStack->IsOk() && p != nullptr && p->GetType() != 0)
@@ -100,7 +123,10 @@ bool CBotProgram::Compile(const std::string& program, std::vector<std::string>&
         {
             CBotFunction* newfunc  = CBotFunction::Compile1(p, pStack.get(), nullptr);
             if (newfunc != nullptr)
+            {
                 m_functions.push_back(newfunc);
+                m_functionIndex.Add(newfunc);
+            }
         }
     }
 
@@ -110,8 +136,7 @@ bool CBotProgram::Compile(const std::string& program, std::vector<std::string>&
     if ( !pStack->IsOk() )
     {
         m_error = pStack->GetError(m_errorStart, m_errorEnd);
-        for (CBotFunction* f : m_functions) delete f;
-        m_functions.clear();
+        ReleaseFunctions();
         return false;
     }
 
@@ -140,13 +165,84 @@ bool CBotProgram::Compile(const std::string& program, std::vector<std::string>&
     if ( !pStack->IsOk() )
     {
         m_error = pStack->GetError(m_errorStart, m_errorEnd);
-        for (CBotFunction* f : m_functions) delete f;
-        m_functions.clear();
+        ReleaseFunctions();
     }
 
     return !m_functions.empty();
 }
 
+bool CBotProgram::Compile(const std::string& program, std::vector<std::string>& externFunctions, void* pUser, const std::string& cacheKey)
+{
+    std::string key = cacheKey + '\n' + program;
+    auto& compileCache = m_context->m_compileCache;
+
+    std::shared_ptr<CompiledCode> code;
+    auto it = compileCache.find(key);
+    if (it != compileCache.end())
+    {
+        if (it->second.generation == m_context->m_compileGeneration) code = it->second.code.lock();
+        if (code == nullptr) compileCache.erase(it);
+    }
+
+    if (code != nullptr)
+    {
+        // Same code as an existing program, only reset the state of this one
+        Stop();
+
+        for (CBotClass* c : m_classes)
+            c->Purge();
+        m_classes.clear();
+        ReleaseFunctions();
+
+        m_code = code;
+        m_functions = code->functions;
+        m_functionIndex = code->functionIndex;
+        externFunctions = code->externFunctions;
+        m_error = CBotNoErr;
+        return true;
+    }
+
+    if (!Compile(program, externFunctions, pUser)) return false;
+
+    // Classes and public functions are registered globally with this program as owner
+    if (!m_classes.empty()) return true;
+    for (CBotFunction* f : m_functions)
+    {
+        if (f->IsPublic()) return true;
+    }
+
+    code = std::make_shared<CompiledCode>();
+    code->functions = m_functions;
+    code->functionIndex = m_functionIndex;
+    code->externFunctions = externFunctions;
+    for (CBotFunction* f : m_functions) f->m_pProg = nullptr;   // runs in whichever program calls it
+    m_code = code;
+
+    for (auto entry = compileCache.begin(); entry != compileCache.end(); )
+    {
+        if (entry->second.code.expired()) entry = compileCache.erase(entry);
+        else ++entry;
+    }
+    compileCache[key] = CompileCacheEntry{ code, m_context->m_compileGeneration };
+    return true;
+}
+
+void CBotProgram::InvalidateCompileCache()
+{
+    CBotContext::GetCurrent().InvalidateCompileCache();
+}
+
+void CBotProgram::ReleaseFunctions()
+{
+    m_functionIndex.Clear();
+    if (m_code == nullptr)
+    {
+        for (CBotFunction* f : m_functions) delete f;
+    }
+    m_functions.clear();
+    m_code.reset();
+}
+
 bool CBotProgram::Start(const std::string& name)
 {
     Stop();
@@ -184,6 +280,8 @@ bool CBotProgram::Run(void* pUser, int timer)
 
     m_error = CBotNoErr;
 
+    CBotContext::Scope scope(*m_context);
+
     m_stack->SetUserPtr(pUser);
     if ( timer >= 0 ) m_stack->SetTimer(timer); // TODO: Check if changing order here fixed ipf()
     m_stack->Reset();                         // reset the possible previous error, and resets the timer
@@ -212,6 +310,42 @@ bool CBotProgram::Run(void* pUser, int timer)
     return ok;
 }
 
+bool CBotProgram::RunConcurrent(void* pUser, int timer)
+{
+    t_concurrentRun.running = true;
+    t_concurrentRun.deferred = false;
+
+    bool finished = Run(pUser, timer);
+
+    m_deferred = !finished && t_concurrentRun.deferred;
+    m_timerLeft = finished ? 0 : m_stack->GetTimerLeft();
+    t_concurrentRun.running = false;
+    return finished;
+}
+
+bool CBotProgram::IsDeferred()
+{
+    return m_deferred;
+}
+
+int CBotProgram::GetTimerLeft()
+{
+    return m_timerLeft;
+}
+
+bool CBotProgram::IsRunningConcurrently()
+{
+    return t_concurrentRun.running;
+}
+
+bool CBotProgram::DeferIfConcurrent()
+{
+    if (!t_concurrentRun.running) return false;
+
+    t_concurrentRun.deferred = true;
+    return true;
+}
+
 void CBotProgram::Stop()
 {
     if (m_stack != nullptr)
@@ -223,6 +357,17 @@ void CBotProgram::Stop()
     CBotClass::FreeLock(this);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void CBotProgram::SetEngine(Engine engine)
+{
+    m_engine = engine;
+}
+
+CBotProgram::Engine CBotProgram::GetEngine()
+{
+    return m_engine;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 bool CBotProgram::GetRunPos(std::string& functionName, int& start, int& end)
 {
@@ -296,29 +441,26 @@ static bool rSizeOf( CBotVar* pVar, CBotVar* pResult, int& ex, void* pUser )
 {
     if ( pVar == nullptr ) { ex = CBotErrLowParam; return true; }
 
-    int i = 0;
-    pVar = pVar->GetItemList();
-
-    while ( pVar != nullptr )
-    {
-        i++;
-        pVar = pVar->GetNext();
-    }
-
-    pResult->SetValInt(i);
+    CBotVarClass* array = pVar->GetPointer();
+    pResult->SetValInt(array != nullptr ? array->GetItemCount() : 0);
     return true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 bool CBotProgram::AddFunction(const std::string& name,
                               bool rExec(CBotVar* pVar, CBotVar* pResult, int& Exception, void* pUser),
-                              CBotTypResult rCompile(CBotVar*& pVar, void* pUser))
+                              CBotTypResult rCompile(CBotVar*& pVar, void* pUser),
+                              bool threadSafe)
 {
-    return m_externalCalls->AddFunction(name, std::unique_ptr<CBotExternalCall>(new CBotExternalCallDefault(rExec, rCompile)));
+    InvalidateCompileCache();
+    std::unique_ptr<CBotExternalCall> call(new CBotExternalCallDefault(rExec, rCompile));
+    call->SetThreadSafe(threadSafe);
+    return CBotContext::GetCurrent().m_externalCalls->AddFunction(name, std::move(call));
 }
 
 bool CBotProgram::DefineNum(const std::string& name, long val)
 {
+    InvalidateCompileCache();
     CBotToken::DefineNum(name, val);
     return true;
 }
@@ -347,6 +489,8 @@ bool CBotProgram::RestoreState(std::istream &istr)
     unsigned short  w;
     std::string      s;
 
+    CBotContext::Scope scope(*m_context);
+
     Stop();
 
     long version;
@@ -388,7 +532,7 @@ int CBotProgram::GetVersion()
 
 void CBotProgram::Init()
 {
-    m_externalCalls.reset(new CBotExternalCallList);
+    CBotContext::GetCurrent().m_externalCalls.reset(new CBotExternalCallList);
 
     CBotProgram::DefineNum("CBotErrZeroDiv",    CBotErrZeroDiv);     // division by zero
     CBotProgram::DefineNum("CBotErrNotInit",    CBotErrNotInit);     // uninitialized variable
@@ -403,7 +547,7 @@ void CBotProgram::Init()
     CBotProgram::DefineNum("CBotErrStackOver",  CBotErrStackOver);   // Stack overflow
     CBotProgram::DefineNum("CBotErrDeletedPtr", CBotErrDeletedPtr);  // Attempted to use deleted object
 
-    CBotProgram::AddFunction("sizeof", rSizeOf, cSizeOf);
+    CBotProgram::AddFunction("sizeof", rSizeOf, cSizeOf, true);
 
     InitStringFunctions();
     InitMathFunctions();
@@ -412,15 +556,22 @@ void CBotProgram::Init()
 
 void CBotProgram::Free()
 {
+    CBotContext& context = CBotContext::GetCurrent();
+    context.InvalidateCompileCache();
+    context.m_compileCache.clear();
     CBotToken::ClearDefineNum();
-    m_externalCalls->Clear();
+    context.m_externalCalls->Clear();
     CBotClass::ClearPublic();
-    m_externalCalls.reset();
 }
 
 const std::unique_ptr<CBotExternalCallList>& CBotProgram::GetExternalCalls()
 {
-    return m_externalCalls;
+    return m_context->m_externalCalls;
+}
+
+CBotContext& CBotProgram::GetContext()
+{
+    return *m_context;
 }
 
 } // namespace CBot
@@ -20,10 +20,12 @@
 #pragma once
 
 #include "CBot/CBotEnums.h"
+#include "CBot/CBotFunctionIndex.h"
 
 #include <list>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace CBot
@@ -35,6 +37,7 @@ class CBotStack;
 class CBotTypResult;
 class CBotVar;
 class CBotExternalCallList;
+class CBotContext;
 
 /**
  * \brief Class that manages a CBot program. This is the main entry point into the CBot engine.
@@ -55,6 +58,10 @@ class CBotExternalCallList;
  *
  * After you are finished, free the memory used by the CBot engine by calling CBotProgram::Free().
  *
+ * All of this happens in a CBotContext. Everything is in the default context
+ * unless you select another one with CBotContext::Scope, which gives a
+ * separate engine with its own functions, constants and classes.
+ *
  * \section Example Example usage
  * \code
  * // Initialize the engine
@@ -86,6 +93,15 @@ class CBotExternalCallList;
 class CBotProgram
 {
 public:
+    /**
+     * \brief Engines executing the functions of a program
+     */
+    enum class Engine
+    {
+        TREE,       //!< walk the tree of CBotInstr, supports everything
+        BYTECODE,   //!< run simple functions as bytecode (see CBotBytecode), others on the tree
+    };
+
     /**
      * \brief Constructor
      */
@@ -97,6 +113,16 @@ public:
      */
     CBotProgram(CBotVar* thisVar);
 
+    /**
+     * \brief Constructor for a program in given context
+     *
+     * The other constructors use CBotContext::GetCurrent().
+     *
+     * \param thisVar Variable to pass to the program as "this"
+     * \param context Context the program is compiled and run in, must outlive the program
+     */
+    CBotProgram(CBotVar* thisVar, CBotContext& context);
+
     /**
      * \brief Destructor
      */
@@ -104,11 +130,13 @@ public:
 
     /**
      * \brief Initializes the module, should be done once (and only once) at the beginning
+     *
+     * Adds the standard functions and constants to the current context (see CBotContext::GetCurrent()).
      */
     static void Init();
 
     /**
-     * \brief Frees the static memory areas
+     * \brief Frees everything added to the current context
      */
     static void Free();
 
@@ -134,6 +162,36 @@ public:
      */
     bool Compile(const std::string& program, std::vector<std::string>& externFunctions, void* pUser = nullptr);
 
+    /**
+     * \brief Compile the program, sharing the code with identical programs compiled before
+     *
+     * Works like Compile(const std::string&, std::vector<std::string>&, void*),
+     * but the code of programs which define no classes and no public functions
+     * is remembered by its source text and \a cacheKey. Compiling the same text
+     * with the same key again, e.g. in another robot of the same type or when
+     * restarting a program, reuses the existing instruction tree instead of
+     * building a new one. Only the execution state is kept per program.
+     *
+     * The code is forgotten once no program uses it anymore, or when external
+     * functions, public functions or classes change (see InvalidateCompileCache()).
+     *
+     * \param program Code to compile
+     * \param[out] externFunctions Returns the names of functions declared as extern
+     * \param pUser Optional pointer to be passed to compile function (see AddFunction())
+     * \param cacheKey Anything else the compile functions depend on, e.g. the kind of object \a pUser refers to
+     * \return true if compilation is successful, false if an compilation error occurs
+     */
+    bool Compile(const std::string& program, std::vector<std::string>& externFunctions, void* pUser, const std::string& cacheKey);
+
+    /**
+     * \brief Forget all code remembered for sharing between programs
+     *
+     * Called whenever something a program could depend on changes: external
+     * functions, constants, public functions or classes.
+     * Only affects the current context (see CBotContext::GetCurrent()).
+     */
+    static void InvalidateCompileCache();
+
     /**
      * \brief Returns the last error
      * \return Error code
@@ -180,6 +238,71 @@ public:
      */
     bool Run(void* pUser = nullptr, int timer = -1);
 
+    /**
+     * \brief Executes the program concurrently with other programs
+     *
+     * Works like Run(), but can be called for several programs at once from
+     * different threads. Anything which would make the result depend on the
+     * order the programs run in is not executed; the program is suspended just
+     * before it instead (see DeferIfConcurrent()). This includes external
+     * functions not registered as thread safe (see AddFunction()),
+     * "synchronized" methods and static class fields.
+     *
+     * Class instances are not updated (see CBotClass::SetUpdateFunc()) while
+     * running concurrently, so the caller has to update the ones the programs
+     * may read before.
+     *
+     * If IsDeferred() returns true afterwards, call Run() from the main thread
+     * with GetTimerLeft() as the timer to execute the deferred operation and
+     * the rest of the time slice.
+     *
+     * \param pUser Custom pointer to be passed to execute function (see AddFunction())
+     * \param timer Maximum number of "timer ticks" to execute, see Run()
+     * \return true if the program execution finished, false if the program is suspended
+     */
+    bool RunConcurrent(void* pUser, int timer);
+
+    /**
+     * \brief Check if the last RunConcurrent() stopped before an operation that has to be executed by Run()
+     */
+    bool IsDeferred();
+
+    /**
+     * \brief Get the number of "timer ticks" left when the last RunConcurrent() stopped
+     */
+    int GetTimerLeft();
+
+    /**
+     * \brief Check if the calling thread is executing RunConcurrent()
+     */
+    static bool IsRunningConcurrently();
+
+    /**
+     * \brief Stop RunConcurrent() before an operation that must not run concurrently with other programs
+     *
+     * The caller has to interrupt the execution (return false) if this returns
+     * true; the operation is then executed again by the next Run().
+     *
+     * \return true in RunConcurrent(), false otherwise
+     */
+    static bool DeferIfConcurrent();
+
+    /**
+     * \brief Select the engine used to execute the functions of this program
+     *
+     * Both engines give the same results; the bytecode engine is faster for
+     * functions doing simple computations on local variables. The engine can
+     * be changed at any time, it is used by the functions started afterwards.
+     *
+     * \param engine Engine to use, Engine::TREE by default
+     */
+    void SetEngine(Engine engine);
+
+    /**
+     * \brief Returns the engine selected with SetEngine()
+     */
+    Engine GetEngine();
+
     /**
      * \brief Gives the current position in the executing program
      * \param[out] functionName Name of the currently executed function
@@ -262,11 +385,14 @@ public:
      * \param name Name of the function
      * \param rExec Execution function
      * \param rCompile Compilation function
+     * \param threadSafe true if the function only uses its arguments and result, so programs can call it
+     *                   while running concurrently (see RunConcurrent())
      * \return true
      */
     static bool AddFunction(const std::string& name,
                             bool rExec(CBotVar* pVar, CBotVar* pResult, int& Exception, void* pUser),
-                            CBotTypResult rCompile(CBotVar*& pVar, void* pUser));
+                            CBotTypResult rCompile(CBotVar*& pVar, void* pUser),
+                            bool threadSafe = false);
 
     /**
      * \copydoc CBotToken::DefineNum()
@@ -327,15 +453,47 @@ public:
     bool ClassExists(std::string name);
 
     /**
-     * \brief Returns static list of all registered external calls
+     * \brief Returns the list of all external calls registered in the context of this program
+     */
+    const std::unique_ptr<CBotExternalCallList>& GetExternalCalls();
+
+    /**
+     * \brief Returns the context this program was constructed in
      */
-    static const std::unique_ptr<CBotExternalCallList>& GetExternalCalls();
+    CBotContext& GetContext();
 
 private:
-    //! All external calls
-    static std::unique_ptr<CBotExternalCallList> m_externalCalls;
+    /**
+     * \brief Functions compiled from one source text, shared by the programs using them
+     */
+    struct CompiledCode
+    {
+        std::list<CBotFunction*> functions;
+        CBotFunctionIndex functionIndex;
+        std::vector<std::string> externFunctions;
+
+        ~CompiledCode();
+    };
+
+    //! Entry of the compile cache, see Compile(const std::string&, std::vector<std::string>&, void*, const std::string&)
+    struct CompileCacheEntry
+    {
+        std::weak_ptr<CompiledCode> code;
+        //! Value of CBotContext::m_compileGeneration the code was compiled in
+        long generation;
+    };
+
+    //! Release the functions of this program, deleting them unless they are shared
+    void ReleaseFunctions();
+
+    //! Context with the external calls, classes and public functions this program uses
+    CBotContext* m_context;
     //! All user-defined functions
     std::list<CBotFunction*> m_functions{};
+    //! Owner of m_functions if they are shared, nullptr if this program owns them
+    std::shared_ptr<CompiledCode> m_code{};
+    //! Same functions, indexed for resolving calls
+    CBotFunctionIndex m_functionIndex{};
     //! The entry point function
     CBotFunction* m_entryPoint = nullptr;
     //! Classes defined in this program
@@ -345,11 +503,20 @@ private:
     //! "this" variable
     CBotVar* m_thisVar = nullptr;
     friend class CBotFunction;
+    friend class CBotCStack;
     friend class CBotDebug;
+    friend class CBotContext;
 
     CBotError m_error = CBotNoErr;
     int m_errorStart = 0;
     int m_errorEnd = 0;
+    //! Last RunConcurrent() stopped in DeferIfConcurrent()
+    bool m_deferred = false;
+    //! Ticks left when the last RunConcurrent() stopped
+    int m_timerLeft = 0;
+
+    //! Engine used to execute the functions
+    Engine m_engine = Engine::TREE;
 };
 
 } // namespace CBot
@@ -20,6 +20,7 @@
 #include "CBot/CBotStack.h"
 
 #include "CBot/CBotClass.h"
+#include "CBot/CBotProgram.h"
 
 #include "CBot/CBotInstr/CBotFunction.h"
 
@@ -104,6 +105,7 @@ void CBotStack::Delete()
 
     delete m_var;
     delete m_listVar;
+    free(m_varIndex);
 
     CBotStack*    p = m_prev;
     bool        bOver = m_bOver;
@@ -412,6 +414,59 @@ CBotVar* CBotStack::FindVar(long ident, bool bUpdate)
     return nullptr;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+CBotVar* CBotStack::FindVar(long ident, bool bUpdate, int& level, int& slot)
+{
+    if (level >= 0)
+    {
+        // never leave the current function, a recursive call could have the same variable further down
+        CBotStack*    p = this;
+        for (int i = 0; i < level && p != nullptr; i++)
+            p = (p->m_block == BlockVisibilityType::FUNCTION) ? nullptr : p->m_prev;
+
+        if (p != nullptr && slot < p->m_varCount)
+        {
+            CBotVar*    pp = p->m_varIndex[slot];
+
+            if (pp->GetUniqNum() == ident)
+            {
+                if ( bUpdate )
+                    pp->Update(m_data->pUser);
+
+                return pp;
+            }
+        }
+    }
+
+    // not where it was last time, search the whole stack and remember the position,
+    // unless the instruction may be shared by programs running concurrently
+    bool    bRemember = !CBotProgram::IsRunningConcurrently();
+    if ( bRemember ) level = -1;
+    bool    bLocal = true;
+    int     n = 0;
+    for (CBotStack* p = this; p != nullptr; p = p->m_prev, n++)
+    {
+        int    i = 0;
+        for (CBotVar* pp = p->m_listVar; pp != nullptr; pp = pp->m_next, i++)
+        {
+            if (pp->GetUniqNum() == ident)
+            {
+                if ( bLocal && bRemember )
+                {
+                    level = n;
+                    slot = i;
+                }
+                if ( bUpdate )
+                    pp->Update(m_data->pUser);
+
+                return pp;
+            }
+        }
+        if (p->m_block == BlockVisibilityType::FUNCTION) bLocal = false;    // anything further belongs to the caller
+    }
+    return nullptr;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 CBotVar* CBotStack::FindVar(CBotToken& pToken, bool bUpdate)
 {
@@ -449,6 +504,13 @@ bool CBotStack::IncState(int limite)
     return (m_data->timer > limite);                // interrupted if timer pass
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool CBotStack::CountTicks(int ticks, int limite)
+{
+    m_data->timer -= ticks;                       // decrement the timer
+    return (m_data->timer > limite);                // interrupted if timer pass
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void CBotStack::SetError(CBotError n, CBotToken* token)
 {
@@ -487,6 +549,11 @@ int CBotStack::GetTimer()
     return m_data->initimer;
 }
 
+int CBotStack::GetTimerLeft()
+{
+    return m_data->timer;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 bool CBotStack::Execute()
 {
@@ -508,6 +575,8 @@ bool CBotStack::Execute()
 
     if ( instr == nullptr ) return true;                // normal execution request
 
+    if (!instr->IsThreadSafe() && CBotProgram::DeferIfConcurrent()) return false;
+
     if (!instr->Run(nullptr, pile)) return false;            // resume interrupted execution
 
     if (pile->m_next != nullptr) pile->m_next->Delete();
@@ -561,6 +630,18 @@ void CBotStack::AddVar(CBotVar* pVar)
     while ( *pp != nullptr ) pp = &(*pp)->m_next;
 
     *pp = pVar;                    // added after
+    p->IndexVar(pVar);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CBotStack::IndexVar(CBotVar* pVar)
+{
+    if (m_varCount == m_varCapacity)
+    {
+        m_varCapacity = m_varCapacity == 0 ? 8 : m_varCapacity * 2;
+        m_varIndex = static_cast<CBotVar**>(realloc(m_varIndex, m_varCapacity * sizeof(CBotVar*)));
+    }
+    m_varIndex[m_varCount++] = pVar;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -590,25 +671,28 @@ void CBotStack::SetUserPtr(void* user)
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-bool CBotStack::ExecuteCall(long& nIdent, CBotToken* token, CBotVar** ppVar, const CBotTypResult& rettype)
+bool CBotStack::ExecuteCall(long& nIdent, CBotToken* token, CBotVar** ppVar, const CBotTypResult& rettype,
+                            CBotCallCache* cache)
 {
     int res;
+    // the identifier is kept in the calling instruction, which may be shared by programs running concurrently
+    long ident = nIdent;
 
     // first looks by the identifier
 
     res = m_prog->GetExternalCalls()->DoCall(nullptr, nullptr, ppVar, this, rettype);
-    if (res >= 0) return res;
-
-    res = CBotFunction::DoCall(m_prog, m_prog->GetFunctions(), nIdent, "", ppVar, this, token);
-    if (res >= 0) return res;
+    if (res < 0) res = CBotFunction::DoCall(m_prog, ident, "", ppVar, this, token, cache);
 
     // if not found (recompile?) seeks by name
 
-    nIdent = 0;
-    res = m_prog->GetExternalCalls()->DoCall(token, nullptr, ppVar, this, rettype);
-    if (res >= 0) return res;
+    if (res < 0)
+    {
+        ident = 0;
+        res = m_prog->GetExternalCalls()->DoCall(token, nullptr, ppVar, this, rettype);
+        if (res < 0) res = CBotFunction::DoCall(m_prog, ident, token->GetString(), ppVar, this, token, cache);
+    }
 
-    res = CBotFunction::DoCall(m_prog, m_prog->GetFunctions(), nIdent, token->GetString(), ppVar, this, token);
+    if (ident != nIdent && !CBotProgram::IsRunningConcurrently()) nIdent = ident;
     if (res >= 0) return res;
 
     SetError(CBotErrUndefFunc, token);
@@ -616,14 +700,14 @@ bool CBotStack::ExecuteCall(long& nIdent, CBotToken* token, CBotVar** ppVar, con
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-void CBotStack::RestoreCall(long& nIdent, CBotToken* token, CBotVar** ppVar)
+void CBotStack::RestoreCall(long& nIdent, CBotToken* token, CBotVar** ppVar, CBotCallCache* cache)
 {
     if (m_next == nullptr) return;
 
     if (m_prog->GetExternalCalls()->RestoreCall(token, nullptr, ppVar, this))
         return;
 
-    CBotFunction::RestoreCall(m_prog->GetFunctions(), nIdent, token->GetString(), ppVar, this);
+    CBotFunction::RestoreCall(m_prog, nIdent, token->GetString(), ppVar, this, cache);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -782,6 +866,8 @@ bool CBotStack::RestoreState(std::istream &istr, CBotStack* &pStack)
 
     if (!CBotVar::RestoreState(istr, pStack->m_var)) return false;     // temp variable
     if (!CBotVar::RestoreState(istr, pStack->m_listVar)) return false; // local variables
+    for (CBotVar* pVar = pStack->m_listVar; pVar != nullptr; pVar = pVar->m_next)
+        pStack->IndexVar(pVar);
 
     return pStack->RestoreState(istr, pStack->m_next);
 }
@@ -929,6 +1015,8 @@ bool CBotVar::RestoreState(std::istream &istr, CBotVar* &pVar)
                     pNew = new CBotVarClass(token, r);                // directly creates an instance
                                                                     // attention cptuse = 0
                     if (!RestoreState(istr, (static_cast<CBotVarClass*>(pNew))->m_pVar)) return false;
+                    (static_cast<CBotVarClass*>(pNew))->m_items.clear();     // index the restored list
+                    (static_cast<CBotVarClass*>(pNew))->IndexItems();
                     pNew->SetIdent(id);
 
                     if (isClass && p == nullptr) // set id for each item in this instance
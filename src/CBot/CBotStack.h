@@ -35,6 +35,7 @@ class CBotExternalCall;
 class CBotVar;
 class CBotProgram;
 class CBotToken;
+class CBotCallCache;
 
 /**
  * \brief The execution stack
@@ -153,6 +154,12 @@ public:
      */
     void AddVar(CBotVar* var);
 
+    /**
+     * \brief Get the variables declared at this level
+     * \return First variable of the list, use CBotVar::GetNext() to go through it
+     */
+    CBotVar* GetListVar() { return m_listVar; }
+
     /**
      * \brief Fetch a variable by its token
      * \param pToken Token upon which search is performed
@@ -184,6 +191,26 @@ public:
      */
     CBotVar* FindVar(long ident, bool bUpdate);
 
+    /**
+     * \brief Fetch a variable on the stack according to its unique identifier, using a cached position
+     *
+     * \a level and \a slot describe where the variable was found last time: how many stack levels
+     * above this one and at which position in that level's variable list. If the variable is still
+     * there it is read from the level's index of variables without walking the list, otherwise the
+     * full search of FindVar(long, bool) is done and the position is updated. Instructions keep one
+     * such pair each; since an instruction always runs at the same depth relative to the block that
+     * declares its variable, the cached position stays valid across loop iterations and calls.
+     * Variables found outside of the current function (globals) are never cached, \a level is set
+     * to -1 for them.
+     *
+     * \param ident Unique identifier of a variable
+     * \param bUpdate true to automatically call update function for classes, see CBotClass::SetUpdateFunc()
+     * \param[in, out] level Number of stack levels to go up, -1 if unknown
+     * \param[in, out] slot Index of the variable in the level's variable list
+     * \return Found variable, nullptr if not found
+     */
+    CBotVar* FindVar(long ident, bool bUpdate, int& level, int& slot);
+
     /**
      * \brief Find variable by its token and returns a copy of it
      *
@@ -313,6 +340,17 @@ public:
      */
     bool            IncState(int lim = -10);
 
+    /**
+     * \brief Count several ticks on the execution timer without changing the state
+     *
+     * Used by the bytecode engine, which accounts for a whole statement at once (see CBotBytecode)
+     *
+     * \param ticks Number of ticks to count
+     * \param lim Required amount of "ticks" on the timer required to allow to continue execution
+     * \return false if timer requests interruption (timer <= limit)
+     */
+    bool            CountTicks(int ticks, int lim = -10);
+
     /**
      * \brief Check if we are in step by step execution mode
      * \return true if step by step, false otherwise
@@ -412,15 +450,18 @@ public:
      * \param token Function name token
      * \param ppVar Array of function arguments
      * \param rettype Expected return type
+     * \param cache Inline cache of the call site, can be null
      */
-    bool            ExecuteCall(long& nIdent, CBotToken* token, CBotVar** ppVar, const CBotTypResult& rettype);
+    bool            ExecuteCall(long& nIdent, CBotToken* token, CBotVar** ppVar, const CBotTypResult& rettype,
+                                CBotCallCache* cache = nullptr);
     /**
      * \brief Restore a function call after the program state has been restored from a file
      * \param[in, out] nIdent Unique function identifier, if not found will be updated
      * \param token Function name token
      * \param ppVar Array of function arguments
+     * \param cache Inline cache of the call site, can be null
      */
-    void            RestoreCall(long& nIdent, CBotToken* token, CBotVar** ppVar);
+    void            RestoreCall(long& nIdent, CBotToken* token, CBotVar** ppVar, CBotCallCache* cache = nullptr);
 
     //@}
 
@@ -445,6 +486,10 @@ public:
      * \brief Get the current configured maximum number of "timer ticks" (parts of instructions) to execute
      */
     int             GetTimer();
+    /**
+     * \brief Get the number of "timer ticks" left since the last Reset()
+     */
+    int             GetTimerLeft();
 
     /**
      * \brief Get current position in the program
@@ -464,6 +509,9 @@ public:
     bool            IsCallFinished();
 
 private:
+    //! Append a variable of m_listVar to m_varIndex
+    void            IndexVar(CBotVar* pVar);
+
     CBotStack*        m_next;
     CBotStack*        m_next2;
     CBotStack*        m_prev;
@@ -477,6 +525,10 @@ private:
 
     CBotVar*        m_var;                        // result of the operations
     CBotVar*        m_listVar;                    // variables declared at this level
+    //! m_listVar by position, for FindVar(long, bool, int&, int&); malloc'ed like the stack itself
+    CBotVar**       m_varIndex;
+    int             m_varCount;
+    int             m_varCapacity;
 
     BlockVisibilityType m_block;                    // is part of a block (variables are local to this block)
     bool            m_bOver;                    // stack limits?
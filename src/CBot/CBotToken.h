@@ -110,6 +110,10 @@ public:
      */
     ~CBotToken();
 
+    //! Tokens are allocated from CBotMemoryPool, every CBotVar owns one
+    static void* operator new(std::size_t size);
+    static void operator delete(void* ptr, std::size_t size);
+
     /**
      * \brief Return the token type or the keyword id
      * \return A value from ::TokenType. For ::TokenTypKeyWord, returns the keyword ID instead.
@@ -164,7 +168,7 @@ public:
     static std::unique_ptr<CBotToken> CompileTokens(const std::string& prog);
 
     /**
-     * \brief Define a new constant
+     * \brief Define a new constant in the current context (see CBotContext::GetCurrent())
      * \param name Name of the constant
      * \param val Value of the constant
      * \return true on success, false if already defined
@@ -172,7 +176,7 @@ public:
     static bool DefineNum(const std::string& name, long val);
 
     /**
-     * \brief Clear the list of defined constants
+     * \brief Clear the list of constants defined in the current context
      * \see DefineNum()
      */
     static void ClearDefineNum();
@@ -205,9 +209,6 @@ private:
     //! The end position of the token in the CBotProgram
     int m_end = 0;
 
-    //! Map of all defined constants (see DefineNum())
-    static std::map<std::string, long> m_defineNum;
-
     /**
      * \brief Check if the word is a keyword
      * \param w The word to check
@@ -51,7 +51,7 @@ namespace CBot
 {
 
 ////////////////////////////////////////////////////////////////////////////////
-long CBotVar::m_identcpt = 0;
+std::atomic<long> CBotVar::m_identcpt{9999};   // numbers below 10000 are slots of class fields
 
 ////////////////////////////////////////////////////////////////////////////////
 CBotVar::CBotVar( ) : m_token(nullptr)
@@ -122,8 +122,7 @@ void CBotVar::SetUniqNum(long n)
 ////////////////////////////////////////////////////////////////////////////////
 long CBotVar::NextUniqNum()
 {
-    if (++m_identcpt < 10000) m_identcpt = 10000;
-    return m_identcpt;
+    return ++m_identcpt;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
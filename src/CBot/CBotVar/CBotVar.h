@@ -24,6 +24,7 @@
 #include "CBot/CBotEnums.h"
 #include "CBot/CBotUtils.h"
 
+#include <atomic>
 #include <cstdint>
 #include <string>
 
@@ -703,8 +704,8 @@ protected:
      */
     long m_ident;
 
-    //! TODO: ?
-    static long m_identcpt;
+    //! Last number given by NextUniqNum(), atomic as programs can run concurrently
+    static std::atomic<long> m_identcpt;
 
     friend class CBotStack;
     friend class CBotCStack;
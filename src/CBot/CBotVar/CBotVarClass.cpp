@@ -20,6 +20,8 @@
 #include "CBot/CBotVar/CBotVarClass.h"
 
 #include "CBot/CBotClass.h"
+#include "CBot/CBotContext.h"
+#include "CBot/CBotProgram.h"
 #include "CBot/CBotStack.h"
 #include "CBot/CBotDefines.h"
 
@@ -30,9 +32,6 @@
 namespace CBot
 {
 
-////////////////////////////////////////////////////////////////////////////////
-std::set<CBotVarClass*> CBotVarClass::m_instances{};
-
 ////////////////////////////////////////////////////////////////////////////////
 CBotVarClass::CBotVarClass(const CBotToken& name, const CBotTypResult& type) : CBotVar(name)
 {
@@ -60,9 +59,11 @@ CBotVarClass::CBotVarClass(const CBotToken& name, const CBotTypResult& type) : C
     m_bConstructor = false;
     m_CptUse    = 0;
     m_ItemIdent = type.Eq(CBotTypIntrinsic) ? 0 : CBotVar::NextUniqNum();
+    m_context   = &CBotContext::GetCurrent();
 
     // add to the list
-    if (m_ItemIdent != 0) m_instances.insert(this);
+    m_listed    = m_ItemIdent != 0;
+    if (m_listed) AddInstance();
 
     CBotClass* pClass = type.GetClass();
 
@@ -77,7 +78,7 @@ CBotVarClass::~CBotVarClass( )
         assert(0);
 
     // removes the class list
-    if (m_ItemIdent != 0) m_instances.erase(this);
+    if (m_listed) RemoveInstance();
 
     delete    m_pVar;
 }
@@ -108,13 +109,14 @@ void CBotVarClass::Copy(CBotVar* pSrc, bool bName)
 //    m_next        = nullptr;
     m_pUserPtr    = p->m_pUserPtr;
     m_pMyThis    = nullptr;//p->m_pMyThis;
-    m_ItemIdent = p->m_ItemIdent;
+    SetIdent(p->m_ItemIdent);
 
     // keeps indentificator the same (by default)
     if (m_ident == 0 ) m_ident     = p->m_ident;
 
     delete        m_pVar;
     m_pVar        = nullptr;
+    m_items.clear();
 
     CBotVar*    pv = p->m_pVar;
     while( pv != nullptr )
@@ -126,12 +128,42 @@ void CBotVarClass::Copy(CBotVar* pSrc, bool bName)
 
         pv = pv->GetNext();
     }
+    IndexItems();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 void CBotVarClass::SetIdent(long n)
 {
+    if (m_ItemIdent == n) return;
+
+    if (m_listed) RemoveInstance();
     m_ItemIdent = n;
+    if (m_listed) AddInstance();
+
+    // identifiers restored from a saved state must not be given to new instances
+    if (n > m_identcpt) m_identcpt = n;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CBotVarClass::AddInstance()
+{
+    std::lock_guard<std::mutex> lock(m_context->m_instancesMutex);
+    m_context->m_instances.emplace(m_ItemIdent, this);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CBotVarClass::RemoveInstance()
+{
+    std::lock_guard<std::mutex> lock(m_context->m_instancesMutex);
+    auto range = m_context->m_instances.equal_range(m_ItemIdent);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (it->second == this)
+        {
+            m_context->m_instances.erase(it);
+            return;
+        }
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -146,6 +178,7 @@ void CBotVarClass::SetClass(CBotClass* pClass)//, int &nIdent)
     // initializes the variables associated with this class
     delete m_pVar;
     m_pVar = nullptr;
+    m_items.clear();
 
     if (pClass == nullptr) return;
 
@@ -205,6 +238,7 @@ void CBotVarClass::SetClass(CBotClass* pClass)//, int &nIdent)
         pv = pv->GetNext();
         if ( pv == nullptr ) pClass = pClass->GetParent();
     }
+    IndexItems();       // now, the instance can be shared by programs running concurrently
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -222,6 +256,10 @@ void CBotVarClass::Update(void* pUser)
     if ( m_pUserPtr != nullptr) pUser = m_pUserPtr;
     if ( pUser == OBJECTDELETED ||
          pUser == OBJECTCREATED ) return;
+
+    // the caller of CBotProgram::RunConcurrent() updates the instances before
+    if ( CBotProgram::IsRunningConcurrently() ) return;
+
     m_pClass->Update(this, pUser);
 }
 
@@ -242,6 +280,13 @@ CBotVar* CBotVarClass::GetItem(const std::string& name)
 ////////////////////////////////////////////////////////////////////////////////
 CBotVar* CBotVarClass::GetItemRef(int nIdent)
 {
+    IndexItems();
+    if ( m_pClass != nullptr && nIdent > 0 && nIdent < static_cast<int>(m_items.size()) )
+    {
+        CBotVar* item = m_items[nIdent];
+        if ( item != nullptr && item->GetUniqNum() == nIdent ) return item;
+    }
+
     CBotVar*    p = m_pVar;
 
     while ( p != nullptr )
@@ -256,32 +301,51 @@ CBotVar* CBotVarClass::GetItemRef(int nIdent)
 ////////////////////////////////////////////////////////////////////////////////
 CBotVar* CBotVarClass::GetItem(int n, bool bExtend)
 {
-    CBotVar*    p = m_pVar;
-
     if ( n < 0 ) return nullptr;
     if ( n > MAXARRAYSIZE ) return nullptr;
 
     if ( m_type.GetLimite() >= 0 && n >= m_type.GetLimite() ) return nullptr;
 
-    if ( p == nullptr && bExtend )
+    IndexItems();
+
+    if ( n < static_cast<int>(m_items.size()) ) return m_items[n];
+    if ( !bExtend ) return nullptr;
+
+    while ( static_cast<int>(m_items.size()) <= n )
     {
-        p = CBotVar::Create("", m_type.GetTypElem());
-        m_pVar = p;
+        CBotVar* p = CBotVar::Create("", m_type.GetTypElem());
+        if ( m_items.empty() ) m_pVar = p;
+        else m_items.back()->m_next = p;
+        m_items.push_back(p);
     }
 
-    if ( n == 0 ) return p;
+    return m_items[n];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int CBotVarClass::GetItemCount()
+{
+    IndexItems();
+    return static_cast<int>(m_items.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CBotVarClass::IndexItems()
+{
+    if ( !m_items.empty() ) return;
 
-    while ( n-- > 0 )
+    if ( m_pClass == nullptr )                          // array, elements by position
     {
-        if ( p->m_next == nullptr )
-        {
-            if ( bExtend ) p->m_next = CBotVar::Create("", m_type.GetTypElem());
-            if ( p->m_next == nullptr ) return nullptr;
-        }
-        p = p->m_next;
+        for ( CBotVar* p = m_pVar; p != nullptr; p = p->m_next ) m_items.push_back(p);
+        return;
     }
 
-    return p;
+    m_items.resize(m_pClass->GetFieldCount() + 1, nullptr);   // fields by slot
+    for ( CBotVar* p = m_pVar; p != nullptr; p = p->m_next )
+    {
+        long slot = p->GetUniqNum();
+        if ( slot > 0 && slot < static_cast<long>(m_items.size()) ) m_items[slot] = p;
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -371,8 +435,7 @@ void CBotVarClass::IncrementUse()
 ////////////////////////////////////////////////////////////////////////////////
 void CBotVarClass::DecrementUse()
 {
-    m_CptUse--;
-    if ( m_CptUse == 0 )
+    if ( --m_CptUse == 0 )
     {
         // if there is one, call the destructor
         // but only if a constructor had been called.
@@ -412,12 +475,25 @@ CBotVarClass* CBotVarClass::GetPointer()
 ////////////////////////////////////////////////////////////////////////////////
 CBotVarClass* CBotVarClass::Find(long id)
 {
-    for (CBotVarClass* p : m_instances)
+    CBotContext& context = CBotContext::GetCurrent();
+    std::lock_guard<std::mutex> lock(context.m_instancesMutex);
+    auto it = context.m_instances.find(id);
+    if (it == context.m_instances.end()) return nullptr;
+    return it->second;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::map<std::string, int> CBotVarClass::GetInstanceCounts()
+{
+    std::map<std::string, int> counts;
+    CBotContext& context = CBotContext::GetCurrent();
+    std::lock_guard<std::mutex> lock(context.m_instancesMutex);
+    for (const auto& instance : context.m_instances)
     {
-        if (p->m_ItemIdent == id) return p;
+        CBotClass* pClass = instance.second->m_pClass;
+        if (pClass != nullptr) counts[pClass->GetName()]++;
     }
-
-    return nullptr;
+    return counts;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
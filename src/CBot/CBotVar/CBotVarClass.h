@@ -21,11 +21,16 @@
 
 #include "CBot/CBotVar/CBotVar.h"
 
-#include <set>
+#include <atomic>
+#include <map>
+#include <string>
+#include <vector>
 
 namespace CBot
 {
 
+class CBotContext;
+
 /**
  * \brief CBotVar subclass for managing classes (::CBotTypClass, ::CBotTypIntrinsic)
  *
@@ -54,6 +59,12 @@ public:
     CBotVar* GetItemList() override;
     std::string GetValString() const override;
 
+    /**
+     * \brief Get the number of elements of an array
+     * \return Number of elements, without walking the list of items
+     */
+    int GetItemCount();
+
     bool Save1State(std::ostream &ostr) override;
 
     void Update(void* pUser) override;
@@ -81,12 +92,18 @@ public:
     void SetIdent(long n) override;
 
     /*!
-     * \brief Finds a class instance by unique identifier
+     * \brief Finds a class instance of the current context (see CBotContext::GetCurrent()) by unique identifier
      * \param id Identifier to find
-     * \return Found class instance
+     * \return Found class instance, nullptr if no live instance has this identifier
      */
     static CBotVarClass* Find(long id);
 
+    /*!
+     * \brief Count live class instances of the current context, to find objects leaked by programs
+     * \return Number of instances by class name; arrays and intrinsic values are not counted
+     */
+    static std::map<std::string, int> GetInstanceCounts();
+
     //@}
 
     bool Eq(CBotVar* left, CBotVar* right) override;
@@ -95,14 +112,32 @@ public:
     void ConstructorSet() override;
 
 private:
-    //! List of all class instances - first
-    static std::set<CBotVarClass*> m_instances;
+    //! Fill m_items from m_pVar if it is empty
+    void IndexItems();
+
+    //! Add to the instances of m_context under the current identifier
+    void AddInstance();
+    //! Remove from the instances of m_context
+    void RemoveInstance();
+
+    //! Context the instance was created in
+    CBotContext* m_context;
+    //! True if the instance is listed in the instances of m_context
+    bool m_listed;
     //! Class definition
     CBotClass* m_pClass;
     //! Class members
     CBotVar* m_pVar;
+    /**
+     * \brief Index of m_pVar, built with the fields and rebuilt from the list when empty
+     *
+     * For arrays, the elements by position. For class instances, the fields by
+     * unique number, which is their slot in the layout of the class (see
+     * CBotClass::AddItem()); unused slots are nullptr.
+     */
+    std::vector<CBotVar*> m_items;
     //! Reference counter
-    int m_CptUse;
+    std::atomic<int> m_CptUse;
     //! Identifier (unique) of an instance
     long m_ItemIdent;
     //! Set after constructor is called, allows destructor to be called
@@ -22,6 +22,7 @@
 #include "CBot/CBotVar/CBotVar.h"
 
 #include "CBot/CBotEnums.h"
+#include "CBot/CBotMemoryPool.h"
 #include "CBot/CBotToken.h"
 
 #include <sstream>
@@ -46,6 +47,17 @@ public:
         m_type = type;
     }
 
+    //! Simple values are created and destroyed all the time during execution, keep them in a pool
+    static void* operator new(std::size_t size)
+    {
+        return CBotMemoryPool::Allocate(size);
+    }
+
+    static void operator delete(void* ptr, std::size_t size)
+    {
+        CBotMemoryPool::Free(ptr, size);
+    }
+
     void Copy(CBotVar* pSrc, bool bName = true) override
     {
         CBotVar::Copy(pSrc, bName);
@@ -289,16 +289,16 @@ bool rStrLower( CBotVar* pVar, CBotVar* pResult, int& ex, void* pUser )
 ////////////////////////////////////////////////////////////////////////////////
 void InitStringFunctions()
 {
-    CBotProgram::AddFunction("strlen",   rStrLen,   cIntStr );
-    CBotProgram::AddFunction("strleft",  rStrLeft,  cStrStrInt );
-    CBotProgram::AddFunction("strright", rStrRight, cStrStrInt );
-    CBotProgram::AddFunction("strmid",   rStrMid,   cStrStrIntInt );
+    CBotProgram::AddFunction("strlen",   rStrLen,   cIntStr, true);
+    CBotProgram::AddFunction("strleft",  rStrLeft,  cStrStrInt, true);
+    CBotProgram::AddFunction("strright", rStrRight, cStrStrInt, true);
+    CBotProgram::AddFunction("strmid",   rStrMid,   cStrStrIntInt, true);
 
-    CBotProgram::AddFunction("strval",   rStrVal,   cFloatStr );
-    CBotProgram::AddFunction("strfind",  rStrFind,  cIntStrStr );
+    CBotProgram::AddFunction("strval",   rStrVal,   cFloatStr, true);
+    CBotProgram::AddFunction("strfind",  rStrFind,  cIntStrStr, true);
 
-    CBotProgram::AddFunction("strupper", rStrUpper, cStrStr );
-    CBotProgram::AddFunction("strlower", rStrLower, cStrStr );
+    CBotProgram::AddFunction("strupper", rStrUpper, cStrStr, true);
+    CBotProgram::AddFunction("strlower", rStrLower, cStrStr, true);
 }
 
 } // namespace CBot
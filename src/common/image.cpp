@@ -181,6 +181,15 @@ CImage::~CImage()
     Free();
 }
 
+void CImage::Create(Math::IntPoint size)
+{
+    Free();
+
+    m_data = MakeUnique<ImageData>();
+    m_data->surface = SDL_CreateRGBSurface(0, size.x, size.y, 32,
+                                           0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
+}
+
 bool CImage::IsEmpty() const
 {
     return m_data == nullptr;
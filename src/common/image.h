@@ -67,6 +67,9 @@ public:
     //! Frees the allocated image data
     void Free();
 
+    //! Replaces the image data with a new RGBA image of given size
+    void Create(Math::IntPoint size);
+
     //! Returns whether the image is empty (has null data)
     bool IsEmpty() const;
 
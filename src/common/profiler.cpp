@@ -30,6 +30,7 @@ long long CProfiler::m_performanceCounters[PCNT_MAX] = {0};
 long long CProfiler::m_prevPerformanceCounters[PCNT_MAX] = {0};
 std::stack<TimeStamp> CProfiler::m_runningPerformanceCounters;
 std::stack<PerformanceCounter> CProfiler::m_runningPerformanceCountersType;
+long long CProfiler::m_performanceValues[PVAL_MAX] = {0};
 
 void CProfiler::SetSystemUtils(CSystemUtils* systemUtils)
 {
@@ -69,6 +70,16 @@ float CProfiler::GetPerformanceCounterFraction(PerformanceCounter counter)
     return static_cast<float>(m_prevPerformanceCounters[counter]) / static_cast<float>(m_prevPerformanceCounters[PCNT_ALL]);
 }
 
+void CProfiler::SetPerformanceValue(PerformanceValue value, long long amount)
+{
+    m_performanceValues[value] = amount;
+}
+
+long long CProfiler::GetPerformanceValue(PerformanceValue value)
+{
+    return m_performanceValues[value];
+}
+
 void CProfiler::ResetPerformanceCounters()
 {
     for (int i = 0; i < PCNT_MAX; ++i)
@@ -37,6 +37,7 @@ enum PerformanceCounter
     PCNT_UPDATE_PARTICLE,       //! < frame update in CParticle
     PCNT_UPDATE_GAME,           //! < frame update in CRobotMain
     PCNT_UPDATE_CBOT,           //! < running CBot code (part of CRobotMain update)
+    PCNT_UPDATE_COLLISION,      //! < collision broad phase (part of CRobotMain update)
 
     PCNT_RENDER_ALL,            //! < the whole rendering process
     PCNT_RENDER_PARTICLE_WORLD, //! < rendering the particles in 3D
@@ -54,6 +55,19 @@ enum PerformanceCounter
     PCNT_MAX
 };
 
+/**
+ * \enum PerformanceValue
+ * \brief Type of value reported for performance testing, as of last frame
+ */
+enum PerformanceValue
+{
+    PVAL_PARTICLE_LIVE,         //! < particles alive
+    PVAL_PARTICLE_PEAK,         //! < highest number of particles alive since level start
+    PVAL_PARTICLE_DROPPED,      //! < particles not created because of the budget since level start
+
+    PVAL_MAX
+};
+
 class CProfiler
 {
 public:
@@ -64,6 +78,9 @@ public:
     static long long GetPerformanceCounterTime(PerformanceCounter counter);
     static float GetPerformanceCounterFraction(PerformanceCounter counter);
 
+    static void SetPerformanceValue(PerformanceValue value, long long amount);
+    static long long GetPerformanceValue(PerformanceValue value);
+
 private:
     static void ResetPerformanceCounters();
     static void SavePerformanceCounters();
@@ -75,6 +92,8 @@ private:
     static long long m_prevPerformanceCounters[PCNT_MAX];
     static std::stack<TimeUtils::TimeStamp> m_runningPerformanceCounters;
     static std::stack<PerformanceCounter> m_runningPerformanceCountersType;
+
+    static long long m_performanceValues[PVAL_MAX];
 };
 
 
@@ -27,6 +27,7 @@
 
 #include "graphics/engine/camera.h"
 #include "graphics/engine/engine.h"
+#include "graphics/engine/particle.h"
 
 #include "level/robotmain.h"
 
@@ -92,6 +93,7 @@ void CSettings::SaveSettings()
     GetConfigFile().SetBoolProperty("Setup", "LightMode", engine->GetLightMode());
     GetConfigFile().SetIntProperty("Setup", "JoystickIndex", app->GetJoystickEnabled() ? app->GetJoystick().index : -1);
     GetConfigFile().SetFloatProperty("Setup", "ParticleDensity", engine->GetParticleDensity());
+    GetConfigFile().SetIntProperty("Setup", "ParticleBudget", engine->GetParticle()->GetBudget());
     GetConfigFile().SetFloatProperty("Setup", "ClippingDistance", engine->GetClippingDistance());
     GetConfigFile().SetBoolProperty("Setup", "EditIndentMode", engine->GetEditIndentMode());
     GetConfigFile().SetIntProperty("Setup", "EditIndentValue", engine->GetEditIndentValue());
@@ -105,6 +107,8 @@ void CSettings::SaveSettings()
     GetConfigFile().SetIntProperty("Setup", "FilterMode", engine->GetTextureFilterMode());
     GetConfigFile().SetBoolProperty("Setup", "ShadowMapping", engine->GetShadowMapping());
     GetConfigFile().SetBoolProperty("Setup", "ShadowMappingQuality", engine->GetShadowMappingQuality());
+    GetConfigFile().SetBoolProperty("Setup", "ShadowMappingCache", engine->GetShadowMappingCache());
+    GetConfigFile().SetBoolProperty("Setup", "TextureCache", engine->GetTextureCache());
     GetConfigFile().SetIntProperty("Setup", "ShadowMappingResolution",
         engine->GetShadowMappingOffscreen() ? engine->GetShadowMappingOffscreenResolution() : 0);
 
@@ -113,6 +117,7 @@ void CSettings::SaveSettings()
 
     // Experimental settings
     GetConfigFile().SetBoolProperty("Experimental", "TerrainShadows", engine->GetTerrainShadows());
+    GetConfigFile().SetBoolProperty("Experimental", "ConcurrentPrograms", main->GetConcurrentPrograms());
     GetConfigFile().SetIntProperty("Setup", "VSync", engine->GetVSync());
 
     CInput::GetInstancePointer()->SaveKeyBindings();
@@ -229,6 +234,9 @@ void CSettings::LoadSettings()
     if (GetConfigFile().GetFloatProperty("Setup", "ParticleDensity", fValue))
         engine->SetParticleDensity(fValue);
 
+    if (GetConfigFile().GetIntProperty("Setup", "ParticleBudget", iValue))
+        engine->GetParticle()->SetBudget(iValue);
+
     if (GetConfigFile().GetFloatProperty("Setup", "ClippingDistance", fValue))
         engine->SetClippingDistance(fValue);
 
@@ -272,6 +280,12 @@ void CSettings::LoadSettings()
     if (GetConfigFile().GetBoolProperty("Setup", "ShadowMappingQuality", bValue))
         engine->SetShadowMappingQuality(bValue);
 
+    if (GetConfigFile().GetBoolProperty("Setup", "ShadowMappingCache", bValue))
+        engine->SetShadowMappingCache(bValue);
+
+    if (GetConfigFile().GetBoolProperty("Setup", "TextureCache", bValue))
+        engine->SetTextureCache(bValue);
+
     if (GetConfigFile().GetIntProperty("Setup", "ShadowMappingResolution", iValue))
     {
         if (iValue == 0)
@@ -287,6 +301,8 @@ void CSettings::LoadSettings()
 
     if (GetConfigFile().GetBoolProperty("Experimental", "TerrainShadows", bValue))
         engine->SetTerrainShadows(bValue);
+    if (GetConfigFile().GetBoolProperty("Experimental", "ConcurrentPrograms", bValue))
+        main->SetConcurrentPrograms(bValue);
     if (GetConfigFile().GetIntProperty("Setup", "VSync", iValue))
     {
         engine->SetVSync(iValue);
@@ -0,0 +1,118 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2023, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/**
+ * \class CWorkerPool
+ * \brief Set of threads that run queued functions concurrently
+ *
+ * Functions are started in the order they were queued. Functions still
+ * waiting in the queue when the pool is destroyed are discarded; the ones
+ * already running are finished first.
+ */
+class CWorkerPool
+{
+public:
+    using ThreadFunctionPtr = std::function<void()>;
+
+public:
+    //! Creates the pool; \a threadCount of 0 uses one thread less than there are cores
+    explicit CWorkerPool(int threadCount = 0)
+    {
+        if (threadCount <= 0)
+            threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+
+        for (int i = 0; i < threadCount; ++i)
+            m_threads.emplace_back(&CWorkerPool::Run, this);
+    }
+
+    ~CWorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_running = false;
+            m_cond.notify_all();
+        }
+        for (auto& thread : m_threads)
+            thread.join();
+    }
+
+    void Start(ThreadFunctionPtr&& func)
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_queue.push(std::move(func));
+        m_cond.notify_one();
+    }
+
+    //! Waits until all queued functions have finished
+    void Wait()
+    {
+        auto lock = std::unique_lock<std::mutex>(m_mutex);
+        m_idleCond.wait(lock, [&]() { return m_queue.empty() && m_busyThreads == 0; });
+    }
+
+    int GetThreadCount() const
+    {
+        return static_cast<int>(m_threads.size());
+    }
+
+    CWorkerPool(const CWorkerPool&) = delete;
+    CWorkerPool& operator=(const CWorkerPool&) = delete;
+
+private:
+    void Run()
+    {
+        auto lock = std::unique_lock<std::mutex>(m_mutex);
+        while (true)
+        {
+            m_cond.wait(lock, [&]() { return !m_running || !m_queue.empty(); });
+            if (!m_running) break;
+
+            ThreadFunctionPtr func = std::move(m_queue.front());
+            m_queue.pop();
+            m_busyThreads++;
+
+            lock.unlock();
+            func();
+            lock.lock();
+
+            m_busyThreads--;
+            if (m_queue.empty() && m_busyThreads == 0)
+                m_idleCond.notify_all();
+        }
+    }
+
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::condition_variable m_idleCond;
+    bool m_running = true;
+    int m_busyThreads = 0;
+    std::queue<ThreadFunctionPtr> m_queue;
+};
@@ -458,6 +458,16 @@ public:
     //! Draws a static buffer
     virtual void DrawStaticBuffer(unsigned int bufferId) = 0;
 
+    /**
+     * \brief Draws a static buffer several times in one call
+     *
+     * Each instance is drawn with its own world transform and color, replacing
+     * the current world transform. \a colors may be null, meaning white for all instances.
+     * Devices without instancing support draw the instances one by one.
+     */
+    virtual void DrawStaticBufferInstanced(unsigned int bufferId, const Math::Matrix* transforms,
+                                           const Color* colors, int instanceCount) = 0;
+
     //! Deletes a static buffer
     virtual void DestroyStaticBuffer(unsigned int bufferId) = 0;
 
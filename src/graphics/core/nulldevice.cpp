@@ -214,6 +214,11 @@ void CNullDevice::DrawStaticBuffer(unsigned int bufferId)
 {
 }
 
+void CNullDevice::DrawStaticBufferInstanced(unsigned int bufferId, const Math::Matrix* transforms,
+                                            const Color* colors, int instanceCount)
+{
+}
+
 void CNullDevice::DestroyStaticBuffer(unsigned int bufferId)
 {
 }
@@ -0,0 +1,326 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2023, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+
+#include "graphics/engine/culling.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define CULLING_SSE
+#include <xmmintrin.h>
+#endif
+
+
+// Graphics module namespace
+namespace Gfx
+{
+
+void CullingFrustum::Set(const Math::Matrix& combined)
+{
+    Math::Matrix m = combined;
+
+    // Rows of the combined matrix added to or subtracted from the last one:
+    // left, right, bottom, top, front, back
+    for (int i = 0; i < 6; i++)
+    {
+        int row = i / 2 + 1;
+        float sign = (i % 2 == 0) ? 1.0f : -1.0f;
+
+        Math::Vector normal(m.Get(4, 1) + sign * m.Get(row, 1),
+                            m.Get(4, 2) + sign * m.Get(row, 2),
+                            m.Get(4, 3) + sign * m.Get(row, 3));
+        float w = m.Get(4, 4) + sign * m.Get(row, 4);
+
+        float length = normal.Length();
+        if (length > 0.0f)
+        {
+            normal /= length;
+            w /= length;
+        }
+
+        nx[i] = normal.x;
+        ny[i] = normal.y;
+        nz[i] = normal.z;
+        d[i] = w;
+    }
+}
+
+bool CullingFrustum::ContainsSphere(const Math::Vector& center, float radius) const
+{
+    for (int i = 0; i < 6; i++)
+    {
+        if (nx[i] * center.x + ny[i] * center.y + nz[i] * center.z + d[i] < -radius)
+            return false;
+    }
+
+    return true;
+}
+
+
+CCullingGrid::CCullingGrid(float cellSize)
+    : m_cellSize(cellSize)
+{
+    assert(cellSize > 0.0f);
+}
+
+void CCullingGrid::Clear()
+{
+    m_cells.clear();
+    m_cellIndex.clear();
+    m_locations.clear();
+}
+
+uint64_t CCullingGrid::GetCellKey(const Math::Vector& pos) const
+{
+    int32_t x = static_cast<int32_t>(floorf(pos.x / m_cellSize));
+    int32_t z = static_cast<int32_t>(floorf(pos.z / m_cellSize));
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(z);
+}
+
+int CCullingGrid::GetCell(uint64_t key)
+{
+    auto it = m_cellIndex.find(key);
+    if (it != m_cellIndex.end())
+        return it->second;
+
+    int index = m_cells.size();
+    m_cells.push_back(Cell());
+    m_cellIndex[key] = index;
+    return index;
+}
+
+void CCullingGrid::Update(int id, const Math::Sphere& sphere)
+{
+    assert(id >= 0);
+
+    if (id >= static_cast<int>(m_locations.size()))
+        m_locations.resize(id + 1);
+
+    int cellIndex = GetCell(GetCellKey(sphere.pos));
+
+    // Moving within the same cell only updates the sphere
+    if (m_locations[id].cell != cellIndex)
+    {
+        Remove(id);
+
+        Cell& cell = m_cells[cellIndex];
+        m_locations[id].cell = cellIndex;
+        m_locations[id].slot = cell.ids.size();
+
+        cell.ids.push_back(id);
+        cell.x.push_back(0.0f);
+        cell.y.push_back(0.0f);
+        cell.z.push_back(0.0f);
+        cell.radius.push_back(0.0f);
+    }
+
+    Cell& cell = m_cells[cellIndex];
+    int slot = m_locations[id].slot;
+
+    // A shrinking sphere may leave the bounds too large
+    if (cell.x[slot] - cell.radius[slot] <= cell.min.x || cell.x[slot] + cell.radius[slot] >= cell.max.x ||
+        cell.y[slot] - cell.radius[slot] <= cell.min.y || cell.y[slot] + cell.radius[slot] >= cell.max.y ||
+        cell.z[slot] - cell.radius[slot] <= cell.min.z || cell.z[slot] + cell.radius[slot] >= cell.max.z)
+    {
+        cell.boundsOutdated = true;
+    }
+
+    cell.x[slot] = sphere.pos.x;
+    cell.y[slot] = sphere.pos.y;
+    cell.z[slot] = sphere.pos.z;
+    cell.radius[slot] = sphere.radius;
+
+    if (cell.ids.size() == 1)
+    {
+        cell.boundsOutdated = true;
+    }
+    else if (! cell.boundsOutdated)
+    {
+        Math::Vector extent(sphere.radius, sphere.radius, sphere.radius);
+        Math::Vector min = sphere.pos - extent;
+        Math::Vector max = sphere.pos + extent;
+        cell.min = Math::Vector(std::min(cell.min.x, min.x), std::min(cell.min.y, min.y), std::min(cell.min.z, min.z));
+        cell.max = Math::Vector(std::max(cell.max.x, max.x), std::max(cell.max.y, max.y), std::max(cell.max.z, max.z));
+    }
+}
+
+void CCullingGrid::Remove(int id)
+{
+    if (! Contains(id))
+        return;
+
+    Cell& cell = m_cells[m_locations[id].cell];
+    int slot = m_locations[id].slot;
+    int last = cell.ids.size() - 1;
+
+    // The last sphere of the cell takes the free slot
+    if (slot != last)
+    {
+        cell.ids[slot] = cell.ids[last];
+        cell.x[slot] = cell.x[last];
+        cell.y[slot] = cell.y[last];
+        cell.z[slot] = cell.z[last];
+        cell.radius[slot] = cell.radius[last];
+        m_locations[cell.ids[slot]].slot = slot;
+    }
+
+    cell.ids.pop_back();
+    cell.x.pop_back();
+    cell.y.pop_back();
+    cell.z.pop_back();
+    cell.radius.pop_back();
+    cell.boundsOutdated = true;
+
+    m_locations[id] = Location();
+}
+
+bool CCullingGrid::Contains(int id) const
+{
+    return id >= 0 && id < static_cast<int>(m_locations.size()) && m_locations[id].cell != -1;
+}
+
+void CCullingGrid::UpdateBounds(Cell& cell)
+{
+    cell.boundsOutdated = false;
+
+    if (cell.ids.empty())
+        return;
+
+    cell.min = Math::Vector( 1e30f,  1e30f,  1e30f);
+    cell.max = Math::Vector(-1e30f, -1e30f, -1e30f);
+
+    for (int i = 0; i < static_cast<int>(cell.ids.size()); i++)
+    {
+        float r = cell.radius[i];
+        cell.min.x = std::min(cell.min.x, cell.x[i] - r);
+        cell.min.y = std::min(cell.min.y, cell.y[i] - r);
+        cell.min.z = std::min(cell.min.z, cell.z[i] - r);
+        cell.max.x = std::max(cell.max.x, cell.x[i] + r);
+        cell.max.y = std::max(cell.max.y, cell.y[i] + r);
+        cell.max.z = std::max(cell.max.z, cell.z[i] + r);
+    }
+}
+
+CullingResult CCullingGrid::TestBox(const CullingFrustum& frustum, const Math::Vector& min, const Math::Vector& max)
+{
+    Math::Vector center = (min + max) * 0.5f;
+    Math::Vector extent = (max - min) * 0.5f;
+
+    CullingResult result = CULLING_INSIDE;
+
+    for (int i = 0; i < 6; i++)
+    {
+        float distance = frustum.nx[i] * center.x + frustum.ny[i] * center.y + frustum.nz[i] * center.z + frustum.d[i];
+        float radius = fabs(frustum.nx[i]) * extent.x + fabs(frustum.ny[i]) * extent.y + fabs(frustum.nz[i]) * extent.z;
+
+        if (distance < -radius)
+            return CULLING_OUTSIDE;
+
+        if (distance < radius)
+            result = CULLING_INTERSECT;
+    }
+
+    return result;
+}
+
+void CCullingGrid::Cull(const CullingFrustum& frustum, std::vector<int>& result)
+{
+    m_sphereTests = 0;
+    m_cellTests = 0;
+
+    for (Cell& cell : m_cells)
+    {
+        if (cell.ids.empty())
+            continue;
+
+        if (cell.boundsOutdated)
+            UpdateBounds(cell);
+
+        m_cellTests++;
+
+        CullingResult test = TestBox(frustum, cell.min, cell.max);
+        if (test == CULLING_OUTSIDE)
+            continue;
+
+        if (test == CULLING_INSIDE)
+        {
+            result.insert(result.end(), cell.ids.begin(), cell.ids.end());
+            continue;
+        }
+
+        CullCell(frustum, cell, result);
+    }
+}
+
+void CCullingGrid::CullCell(const CullingFrustum& frustum, const Cell& cell, std::vector<int>& result)
+{
+    int count = cell.ids.size();
+    int i = 0;
+
+    m_sphereTests += count;
+
+#ifdef CULLING_SSE
+    // Four spheres against one plane at a time
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(&cell.x[i]);
+        __m128 y = _mm_loadu_ps(&cell.y[i]);
+        __m128 z = _mm_loadu_ps(&cell.z[i]);
+        __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&cell.radius[i]));
+
+        __m128 inside = _mm_cmpeq_ps(x, x);  // all set, unless NaN
+        for (int p = 0; p < 6; p++)
+        {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(frustum.nx[p])),
+                                                    _mm_mul_ps(y, _mm_set1_ps(frustum.ny[p]))),
+                                         _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(frustum.nz[p])),
+                                                    _mm_set1_ps(frustum.d[p])));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negRadius));
+        }
+
+        int mask = _mm_movemask_ps(inside);
+        for (int j = 0; j < 4; j++)
+        {
+            if (mask & (1 << j))
+                result.push_back(cell.ids[i + j]);
+        }
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        if (frustum.ContainsSphere(Math::Vector(cell.x[i], cell.y[i], cell.z[i]), cell.radius[i]))
+            result.push_back(cell.ids[i]);
+    }
+}
+
+int CCullingGrid::GetSphereTestCount() const
+{
+    return m_sphereTests;
+}
+
+int CCullingGrid::GetCellTestCount() const
+{
+    return m_cellTests;
+}
+
+} // namespace Gfx
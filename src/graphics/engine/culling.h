@@ -0,0 +1,145 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2023, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+
+/**
+ * \file graphics/engine/culling.h
+ * \brief Frustum culling of world objects - CCullingGrid class
+ */
+
+#pragma once
+
+#include "math/matrix.h"
+#include "math/sphere.h"
+#include "math/vector.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+
+// Graphics module namespace
+namespace Gfx
+{
+
+/**
+ * \struct CullingFrustum
+ * \brief Six normalized planes of a view frustum, stored component-wise
+ *
+ * A point p is on the inner side of plane i if nx[i]*p.x + ny[i]*p.y + nz[i]*p.z + d[i] >= 0.
+ */
+struct CullingFrustum
+{
+    float nx[6] = {};
+    float ny[6] = {};
+    float nz[6] = {};
+    float d[6] = {};
+
+    //! Extracts the planes from combined projection * view matrix
+    void Set(const Math::Matrix& combined);
+    //! Tests whether a sphere is (partially) within the frustum
+    bool ContainsSphere(const Math::Vector& center, float radius) const;
+};
+
+//! Result of testing a box against a frustum
+enum CullingResult
+{
+    CULLING_OUTSIDE,
+    CULLING_INTERSECT,
+    CULLING_INSIDE
+};
+
+//! Default size of a grid cell in world units
+const float CULLING_CELL_SIZE = 80.0f;
+
+/**
+ * \class CCullingGrid
+ * \brief Uniform grid of bounding spheres on the horizontal plane
+ *
+ * Spheres are identified by an integer (the object rank in CEngine) and are
+ * filed by their center into square cells. Each cell keeps a bounding box of
+ * its spheres, so cells outside the frustum are skipped and cells inside it
+ * are accepted as a whole. Only spheres in cells crossing the frustum are
+ * tested one by one, four at a time with SSE when available.
+ *
+ * Moving a sphere only touches its old and new cell, so the grid is kept
+ * up to date incrementally rather than rebuilt every frame.
+ */
+class CCullingGrid
+{
+public:
+    explicit CCullingGrid(float cellSize = CULLING_CELL_SIZE);
+
+    //! Removes all spheres
+    void        Clear();
+
+    //! Adds the sphere or moves it if it is already in the grid
+    void        Update(int id, const Math::Sphere& sphere);
+    //! Removes the sphere, if present
+    void        Remove(int id);
+    //! Returns whether the sphere is in the grid
+    bool        Contains(int id) const;
+
+    //! Appends identifiers of spheres (partially) within the frustum to \a result
+    void        Cull(const CullingFrustum& frustum, std::vector<int>& result);
+
+    //! Returns the number of spheres tested one by one by the last Cull()
+    int         GetSphereTestCount() const;
+    //! Returns the number of cells tested by the last Cull()
+    int         GetCellTestCount() const;
+
+    //! Classifies a box against the frustum
+    static CullingResult TestBox(const CullingFrustum& frustum, const Math::Vector& min, const Math::Vector& max);
+
+protected:
+    struct Cell
+    {
+        //! Sphere centers and radii, component-wise
+        std::vector<float> x, y, z, radius;
+        //! Sphere identifiers
+        std::vector<int> ids;
+        //! Bounds of all spheres in the cell
+        Math::Vector min, max;
+        //! true if the bounds must be recomputed after a removal
+        bool boundsOutdated = false;
+    };
+
+    struct Location
+    {
+        int cell = -1;
+        int slot = -1;
+    };
+
+    uint64_t    GetCellKey(const Math::Vector& pos) const;
+    int         GetCell(uint64_t key);
+    void        UpdateBounds(Cell& cell);
+    void        CullCell(const CullingFrustum& frustum, const Cell& cell, std::vector<int>& result);
+
+protected:
+    float m_cellSize;
+    std::vector<Cell> m_cells;
+    std::unordered_map<uint64_t, int> m_cellIndex;
+    //! Location of each sphere, indexed by identifier
+    std::vector<Location> m_locations;
+
+    int m_sphereTests = 0;
+    int m_cellTests = 0;
+};
+
+} // namespace Gfx
@@ -45,6 +45,8 @@
 #include "graphics/engine/pyro_manager.h"
 #include "graphics/engine/terrain.h"
 #include "graphics/engine/text.h"
+#include "graphics/engine/texture_cache.h"
+#include "graphics/engine/texture_loader.h"
 #include "graphics/engine/water.h"
 
 #include "graphics/model/model_mesh.h"
@@ -58,6 +60,8 @@
 
 #include "ui/controls/interface.h"
 
+#include <algorithm>
+#include <functional>
 #include <iomanip>
 #include <SDL_surface.h>
 #include <SDL_thread.h>
@@ -69,6 +73,11 @@ using TimeUtils::TimeUnit;
 namespace Gfx
 {
 
+//! Shadow map frames an object must stay still before it is drawn in the static shadow layer
+const int SHADOW_STATIC_FRAMES = 60;
+//! Steps of the shadow map position with cached static shadows, relative to the shadow range
+const float SHADOW_CACHE_STEP = 0.25f;
+
 /**
  * \struct EngineMouse
  * \brief Information about mouse cursor
@@ -196,6 +205,7 @@ CEngine::CEngine(CApplication *app, CSystemUtils* systemUtils)
     m_offscreenShadowRenderingResolution = 1024;
     m_qualityShadows = true;
     m_terrainShadows = false;
+    m_shadowCache = true;
     m_shadowRange = 0.0f;
     m_multisample = 2;
     m_vsync = 0;
@@ -228,6 +238,8 @@ CEngine::CEngine(CApplication *app, CSystemUtils* systemUtils)
     m_terrainTexParams.format = TEX_IMG_AUTO;
     m_terrainTexParams.filter = TEX_FILTER_BILINEAR;
 
+    m_textureCache = MakeUnique<CTextureCache>();
+
     // Compute bias matrix for shadow mapping
     Math::Matrix temp1, temp2;
     Math::LoadScaleMatrix(temp1, Math::Vector(0.5f, 0.5f, 0.5f));
@@ -236,6 +248,8 @@ CEngine::CEngine(CApplication *app, CSystemUtils* systemUtils)
 
     m_lastState = -1;
     m_statisticTriangle = 0;
+    m_statisticDrawCalls = 0;
+    m_statisticStateChanges = 0;
     m_fps = 0.0f;
     m_firstGroundSpot = false;
 }
@@ -359,6 +373,9 @@ bool CEngine::Create()
     params.mipmap = false;
     m_miceTexture = LoadTexture("textures/interface/mouse.png", params);
 
+    m_textureCache->SetEnabled(true);
+    m_textureLoader = MakeUnique<CTextureLoader>(m_textureCache.get());
+
     m_currentFrameTime = m_systemUtils->GetCurrentTimeStamp();
     m_lastFrameTime = m_systemUtils->GetCurrentTimeStamp();
 
@@ -367,14 +384,21 @@ bool CEngine::Create()
 
 void CEngine::Destroy()
 {
+    m_textureLoader.reset();
+
     m_text->Destroy();
 
     if (m_shadowMap.id != 0)
     {
         if (m_offscreenShadowRendering)
+        {
             m_device->DeleteFramebuffer("shadow");
+            m_device->DeleteFramebuffer("shadow_static");
+        }
         else
+        {
             m_device->DestroyTexture(m_shadowMap);
+        }
 
         m_shadowMap = Texture();
     }
@@ -660,6 +684,8 @@ int CEngine::CreateBaseObject()
 
     m_baseObjects[baseObjRank].used = true;
 
+    MarkBaseObjectChanged(baseObjRank);
+
     return baseObjRank;
 }
 
@@ -687,6 +713,8 @@ void CEngine::DeleteBaseObject(int baseObjRank)
     p1.next.clear();
 
     p1.used = false;
+
+    MarkBaseObjectChanged(baseObjRank);
 }
 
 void CEngine::DeleteAllBaseObjects()
@@ -710,6 +738,9 @@ void CEngine::DeleteAllBaseObjects()
         }
     }
 
+    for (int baseObjRank = 0; baseObjRank < static_cast<int>( m_baseObjectUsers.size() ); baseObjRank++)
+        MarkBaseObjectChanged(baseObjRank);
+
     m_baseObjects.clear();
 }
 
@@ -720,6 +751,8 @@ void CEngine::CopyBaseObject(int sourceBaseObjRank, int destBaseObjRank)
 
     m_baseObjects[destBaseObjRank] = m_baseObjects[sourceBaseObjRank];
 
+    MarkBaseObjectChanged(destBaseObjRank);
+
     EngineBaseObject& p1 = m_baseObjects[destBaseObjRank];
 
     if (! p1.used)
@@ -763,6 +796,7 @@ void CEngine::AddBaseObjTriangles(int baseObjRank, const std::vector<VertexTex2>
     }
 
     p1.boundingSphere = Math::BoundingSphereForBox(p1.bboxMin, p1.bboxMax);
+    MarkBaseObjectChanged(baseObjRank);
 
     p1.totalTriangles += vertices.size() / 3;
 }
@@ -799,6 +833,7 @@ void CEngine::AddBaseObjQuick(int baseObjRank, const EngineBaseObjDataTier& buff
         }
 
         p1.boundingSphere = Math::BoundingSphereForBox(p1.bboxMin, p1.bboxMax);
+        MarkBaseObjectChanged(baseObjRank);
     }
 
     if (p3.type == ENG_TRIANGLE_TYPE_TRIANGLES)
@@ -909,6 +944,14 @@ int CEngine::CreateObject()
 void CEngine::DeleteAllObjects()
 {
     m_objects.clear();
+    for (std::vector<int>& users : m_baseObjectUsers)
+        users.clear();
+    m_cullingGrid.Clear();
+    m_cullingOutdated.clear();
+    m_visibleObjects.clear();
+    m_shadowCasters.clear();
+    m_shadowStaticObjects.clear();
+    m_shadowStaticOutdated = true;
     m_shadowSpots.clear();
 
     DeleteAllGroundSpots();
@@ -920,6 +963,9 @@ void CEngine::DeleteObject(int objRank)
 
     // Mark object as deleted
     m_objects[objRank].used = false;
+    SetBaseObjectUser(objRank, -1);
+    m_cullingGrid.Remove(objRank);
+    MarkShadowCasterChanged(objRank);
 
     // Delete associated shadows
     DeleteShadowSpot(objRank);
@@ -929,7 +975,17 @@ void CEngine::SetObjectBaseRank(int objRank, int baseObjRank)
 {
     assert(objRank == -1 || (objRank >= 0 && objRank < static_cast<int>( m_objects.size() )));
 
-    m_objects[objRank].baseObjRank = baseObjRank;
+    SetBaseObjectUser(objRank, baseObjRank);
+    MarkCullingOutdated(objRank);
+    MarkShadowCasterChanged(objRank);
+}
+
+void CEngine::SetObjectLodBaseRank(int objRank, int baseObjRank)
+{
+    assert(objRank >= 0 && objRank < static_cast<int>( m_objects.size() ));
+
+    SetBaseObjectUser(objRank, baseObjRank);
+    MarkCullingOutdated(objRank);
 }
 
 int CEngine::GetObjectBaseRank(int objRank)
@@ -944,6 +1000,7 @@ void CEngine::SetObjectType(int objRank, EngineObjectType type)
     assert(objRank >= 0 && objRank < static_cast<int>( m_objects.size() ));
 
     m_objects[objRank].type = type;
+    MarkShadowCasterChanged(objRank);
 }
 
 EngineObjectType CEngine::GetObjectType(int objRank)
@@ -959,6 +1016,8 @@ void CEngine::SetObjectTransform(int objRank, const Math::Matrix& transform)
     assert(objRank >= 0 && objRank < static_cast<int>( m_objects.size() ));
 
     m_objects[objRank].transform = transform;
+    MarkCullingOutdated(objRank);
+    MarkShadowCasterChanged(objRank);
 }
 
 void CEngine::GetObjectTransform(int objRank, Math::Matrix& transform)
@@ -1678,6 +1737,7 @@ void CEngine::UpdateGeometry()
         }
 
         p1.boundingSphere = Math::BoundingSphereForBox(p1.bboxMin, p1.bboxMax);
+        MarkBaseObjectChanged(baseObjRank);
     }
 
     m_updateGeometry = false;
@@ -1932,6 +1992,127 @@ bool CEngine::IsVisible(int objRank)
     return false;
 }
 
+Math::Sphere CEngine::GetObjectWorldSphere(int objRank)
+{
+    assert(objRank >= 0 && objRank < static_cast<int>(m_objects.size()));
+
+    int baseObjRank = m_objects[objRank].baseObjRank;
+    assert(baseObjRank >= 0 && baseObjRank < static_cast<int>(m_baseObjects.size()));
+
+    // The sphere is moved to world coordinates, and grown by the largest scale of the transform
+    Math::Matrix transform = m_objects[objRank].transform;
+    const auto& sphere = m_baseObjects[baseObjRank].boundingSphere;
+    Math::Vector center = Math::Transform(transform, sphere.pos);
+
+    float scale = 0.0f;
+    for (int i = 1; i <= 3; i++)
+    {
+        Math::Vector row(transform.Get(i, 1), transform.Get(i, 2), transform.Get(i, 3));
+        Math::Vector col(transform.Get(1, i), transform.Get(2, i), transform.Get(3, i));
+        scale = Math::Max(scale, row.Length(), col.Length());
+    }
+
+    return Math::Sphere(center, sphere.radius * scale);
+}
+
+void CEngine::MarkCullingOutdated(int objRank)
+{
+    if (m_objects[objRank].cullingOutdated)
+        return;
+
+    m_objects[objRank].cullingOutdated = true;
+    m_cullingOutdated.push_back(objRank);
+}
+
+void CEngine::MarkBaseObjectChanged(int baseObjRank)
+{
+    if (baseObjRank >= static_cast<int>(m_baseObjectUsers.size()))
+        return;
+
+    // The static shadow layer is only redrawn if one of these objects is in it
+    for (int objRank : m_baseObjectUsers[baseObjRank])
+    {
+        MarkCullingOutdated(objRank);
+        MarkShadowCasterChanged(objRank);
+    }
+}
+
+void CEngine::SetBaseObjectUser(int objRank, int baseObjRank)
+{
+    int oldBaseObjRank = m_objects[objRank].baseObjRank;
+    if (oldBaseObjRank == baseObjRank)
+        return;
+
+    if (oldBaseObjRank >= 0 && oldBaseObjRank < static_cast<int>(m_baseObjectUsers.size()))
+    {
+        std::vector<int>& users = m_baseObjectUsers[oldBaseObjRank];
+        users.erase(std::remove(users.begin(), users.end(), objRank), users.end());
+    }
+
+    if (baseObjRank >= 0)
+    {
+        if (baseObjRank >= static_cast<int>(m_baseObjectUsers.size()))
+            m_baseObjectUsers.resize(baseObjRank + 1);
+
+        m_baseObjectUsers[baseObjRank].push_back(objRank);
+    }
+
+    m_objects[objRank].baseObjRank = baseObjRank;
+}
+
+void CEngine::UpdateCullingGrid()
+{
+    for (int objRank : m_cullingOutdated)
+    {
+        if (objRank >= static_cast<int>(m_objects.size()))
+            continue;
+
+        EngineObject& object = m_objects[objRank];
+        object.cullingOutdated = false;
+
+        int baseObjRank = object.baseObjRank;
+        if (! object.used || baseObjRank < 0 || baseObjRank >= static_cast<int>(m_baseObjects.size()) ||
+            ! m_baseObjects[baseObjRank].used)
+        {
+            m_cullingGrid.Remove(objRank);
+            continue;
+        }
+
+        m_cullingGrid.Update(objRank, GetObjectWorldSphere(objRank));
+    }
+
+    m_cullingOutdated.clear();
+}
+
+void CEngine::CullObjects(const Math::Matrix& proj, const Math::Matrix& view, std::vector<int>& result)
+{
+    // Same flip of the z axis as done by the device for the view transform
+    Math::Matrix scale;
+    scale.Set(3, 3, -1.0f);
+
+    CullingFrustum frustum;
+    frustum.Set(Math::MultiplyMatrices(proj, Math::MultiplyMatrices(scale, view)));
+
+    m_cullingGrid.Cull(frustum, result);
+}
+
+void CEngine::CullWorldObjects()
+{
+    for (int objRank : m_visibleObjects)
+    {
+        if (objRank < static_cast<int>(m_objects.size()))
+            m_objects[objRank].visible = false;
+    }
+
+    m_visibleObjects.clear();
+
+    UpdateCullingGrid();
+    CullObjects(m_matProj, m_matView, m_visibleObjects);
+
+    for (int objRank : m_visibleObjects)
+        m_objects[objRank].visible = true;
+}
+
 bool CEngine::TransformPoint(Math::Vector& p2D, int objRank, Math::Vector p3D)
 {
     assert(objRank >= 0 && objRank < static_cast<int>(m_objects.size()));
@@ -2247,18 +2428,31 @@ Texture CEngine::CreateTexture(const std::string& texName, const TextureCreatePa
 
     Texture tex;
     CImage img;
+    std::unique_ptr<CImage> decoded;
+
+    // Loaded before the background decoding finished, so TakeFinished() won't report it
+    if (m_texDeferredParams.erase(texName) > 0)
+        m_placeholderRefresh = true;
 
     if (image == nullptr)
     {
-        if (!img.Load(texName))
+        // Use the image if it is already being decoded in the background
+        std::string error;
+        if (m_textureLoader != nullptr && m_textureLoader->Take(texName, decoded, error))
+        {
+            image = decoded.get();
+        }
+        else if (m_textureCache->Load(texName, img, error))
+        {
+            image = &img;
+        }
+
+        if (image == nullptr)
         {
-            std::string error = img.GetError();
             GetLogger()->Error("Couldn't load texture '%s': %s, blacklisting\n", texName.c_str(), error.c_str());
             m_texBlacklist.insert(texName);
             return Texture(); // invalid texture
         }
-
-        image = &img;
     }
 
     tex = m_device->CreateTexture(image, params);
@@ -2327,7 +2521,14 @@ bool CEngine::LoadAllTextures()
 
     m_planet->LoadTexture();
 
+    return LoadBaseObjectTextures();
+}
+
+bool CEngine::LoadBaseObjectTextures()
+{
     bool ok = true;
+    m_placeholderUsed = false;
+    m_placeholderRefresh = false;
 
     for (int objRank = 0; objRank < static_cast<int>( m_objects.size() ); objRank++)
     {
@@ -2355,9 +2556,9 @@ bool CEngine::LoadAllTextures()
             if (! p2.tex1Name.empty())
             {
                 if (terrain)
-                    p2.tex1 = LoadTexture("textures/"+p2.tex1Name, m_terrainTexParams);
+                    p2.tex1 = LoadTextureDeferred("textures/"+p2.tex1Name, m_terrainTexParams);
                 else
-                    p2.tex1 = LoadTexture("textures/"+p2.tex1Name);
+                    p2.tex1 = LoadTextureDeferred("textures/"+p2.tex1Name, m_defaultTexParams);
 
                 if (! p2.tex1.Valid())
                     ok = false;
@@ -2366,9 +2567,9 @@ bool CEngine::LoadAllTextures()
             if (! p2.tex2Name.empty())
             {
                 if (terrain)
-                    p2.tex2 = LoadTexture("textures/"+p2.tex2Name, m_terrainTexParams);
+                    p2.tex2 = LoadTextureDeferred("textures/"+p2.tex2Name, m_terrainTexParams);
                 else
-                    p2.tex2 = LoadTexture("textures/"+p2.tex2Name);
+                    p2.tex2 = LoadTextureDeferred("textures/"+p2.tex2Name, m_defaultTexParams);
 
                 if (! p2.tex2.Valid())
                     ok = false;
@@ -2379,6 +2580,152 @@ bool CEngine::LoadAllTextures()
     return ok;
 }
 
+Texture CEngine::LoadTextureDeferred(const std::string& name, const TextureCreateParams& params)
+{
+    if (m_texBlacklist.find(name) != m_texBlacklist.end())
+        return Texture();
+
+    auto it = m_texNameMap.find(name);
+    if (it != m_texNameMap.end())
+        return it->second;
+
+    if (m_textureLoader == nullptr)
+        return CreateTexture(name, params);
+
+    if (!m_placeholderTexture.Valid())
+    {
+        CImage img(Math::IntPoint(1, 1));
+        img.SetPixel(Math::IntPoint(0, 0), Color(0.5f, 0.5f, 0.5f, 1.0f));
+
+        TextureCreateParams placeholderParams;
+        placeholderParams.format = TEX_IMG_AUTO;
+        placeholderParams.filter = TEX_FILTER_NEAREST;
+        placeholderParams.mipmap = false;
+        m_placeholderTexture = m_device->CreateTexture(&img, placeholderParams);
+    }
+
+    m_texDeferredParams[name] = params;
+    m_textureLoader->Request(name);
+
+    m_placeholderUsed = true;
+    return m_placeholderTexture;
+}
+
+void CEngine::PreloadTextures(const std::vector<std::string>& names)
+{
+    if (m_textureLoader == nullptr)
+        return;
+
+    for (const std::string& name : names)
+    {
+        if (m_texNameMap.find(name) != m_texNameMap.end())
+            continue;
+
+        if (m_texBlacklist.find(name) != m_texBlacklist.end())
+            continue;
+
+        if (m_texDeferredParams.find(name) == m_texDeferredParams.end())
+            m_texDeferredParams[name] = m_defaultTexParams;
+
+        m_textureLoader->Request(name);
+    }
+}
+
+std::vector<std::string> CEngine::GetObjectTextureNames()
+{
+    std::set<std::string> names;
+    for (const EngineBaseObject& p1 : m_baseObjects)
+    {
+        if (! p1.used)
+            continue;
+
+        for (const EngineBaseObjTexTier& p2 : p1.next)
+        {
+            if (! p2.tex1Name.empty())
+                names.insert("textures/"+p2.tex1Name);
+
+            if (! p2.tex2Name.empty())
+                names.insert("textures/"+p2.tex2Name);
+        }
+    }
+    return std::vector<std::string>(names.begin(), names.end());
+}
+
+int CEngine::GetPendingTextureCount()
+{
+    if (m_textureLoader == nullptr)
+        return 0;
+
+    return m_textureLoader->GetRequestCount();
+}
+
+void CEngine::SetTextureCache(bool value)
+{
+    m_textureCache->SetEnabled(value);
+}
+
+bool CEngine::GetTextureCache()
+{
+    return m_textureCache->GetEnabled();
+}
+
+void CEngine::SetTextureUploadBudget(float budget)
+{
+    m_textureUploadBudget = budget;
+}
+
+float CEngine::GetTextureUploadBudget()
+{
+    return m_textureUploadBudget;
+}
+
+void CEngine::UploadDecodedTextures()
+{
+    if (m_textureLoader == nullptr)
+        return;
+
+    TimeUtils::TimeStamp start = m_systemUtils->GetCurrentTimeStamp();
+
+    bool uploaded = false;
+    std::string name;
+    std::unique_ptr<CImage> image;
+    std::string error;
+    while (m_textureLoader->TakeFinished(name, image, error))
+    {
+        TextureCreateParams params = m_defaultTexParams;
+        auto it = m_texDeferredParams.find(name);
+        if (it != m_texDeferredParams.end())
+        {
+            params = it->second;
+            m_texDeferredParams.erase(it);
+        }
+
+        // Already loaded synchronously in the meantime
+        if (m_texNameMap.find(name) != m_texNameMap.end())
+            continue;
+
+        if (image == nullptr)
+        {
+            GetLogger()->Error("Couldn't load texture '%s': %s, blacklisting\n", name.c_str(), error.c_str());
+            m_texBlacklist.insert(name);
+        }
+        else
+        {
+            CreateTexture(name, params, image.get());
+        }
+
+        uploaded = true;
+
+        TimeUtils::TimeStamp now = m_systemUtils->GetCurrentTimeStamp();
+        if (TimeUtils::Diff(start, now, TimeUnit::MILLISECONDS) > m_textureUploadBudget)
+            break;
+    }
+
+    // Replace placeholders with the uploaded textures
+    if (m_placeholderUsed && (uploaded || m_placeholderRefresh || m_textureLoader->GetRequestCount() == 0))
+        LoadBaseObjectTextures();
+}
+
 static bool IsExcludeColor(Math::Point *exclude, int x, int y)
 {
     int i = 0;
@@ -2581,6 +2928,13 @@ void CEngine::FlushTextureCache()
     m_revTexNameMap.clear();
     m_texBlacklist.clear();
 
+    if (m_textureLoader != nullptr)
+        m_textureLoader->Clear();
+    m_texDeferredParams.clear();
+    m_placeholderTexture.SetInvalid();
+    m_placeholderUsed = false;
+    m_placeholderRefresh = false;
+
     m_firstGroundSpot = true;
 }
 
@@ -2949,6 +3303,7 @@ void CEngine::SetShadowMapping(bool value)
     if(!value)
     {
         m_device->DeleteFramebuffer("shadow");
+        m_device->DeleteFramebuffer("shadow_static");
         m_device->DestroyTexture(m_shadowMap);
         m_shadowMap.id = 0;
     }
@@ -2972,6 +3327,7 @@ void CEngine::SetShadowMappingOffscreen(bool value)
     else
     {
         m_device->DeleteFramebuffer("shadow");
+        m_device->DeleteFramebuffer("shadow_static");
         m_shadowMap.id = 0;
     }
 }
@@ -2987,6 +3343,7 @@ void CEngine::SetShadowMappingOffscreenResolution(int resolution)
     if(resolution == m_offscreenShadowRenderingResolution) return;
     m_offscreenShadowRenderingResolution = resolution;
     m_device->DeleteFramebuffer("shadow");
+    m_device->DeleteFramebuffer("shadow_static");
     m_shadowMap.id = 0;
 }
 
@@ -3014,6 +3371,7 @@ bool CEngine::GetShadowMappingQuality()
 void CEngine::SetTerrainShadows(bool value)
 {
     m_terrainShadows = value;
+    m_shadowStaticOutdated = true;
 }
 
 bool CEngine::GetTerrainShadows()
@@ -3021,6 +3379,17 @@ bool CEngine::GetTerrainShadows()
     return m_terrainShadows;
 }
 
+void CEngine::SetShadowMappingCache(bool value)
+{
+    m_shadowCache = value;
+    m_shadowStaticOutdated = true;
+}
+
+bool CEngine::GetShadowMappingCache()
+{
+    return m_shadowCache;
+}
+
 void CEngine::SetVSync(int value)
 {
     if (value < -1) value = -1;
@@ -3182,7 +3551,11 @@ void CEngine::Render()
     if (! m_render)
         return;
 
+    UploadDecodedTextures();
+
     m_statisticTriangle = 0;
+    m_statisticDrawCalls = 0;
+    m_statisticStateChanges = 0;
     m_lastState = -1;
     m_lastColor = Color(-1.0f);
     m_lastMaterial = Material();
@@ -3209,6 +3582,10 @@ void CEngine::Render()
     }
     else
     {
+        // Select resolution of terrain mosaics for both shadow map and scene
+        if (m_drawWorld && m_terrain != nullptr)
+            m_terrain->UpdateLevelOfDetail(m_eyePt);
+
         // Render shadow map
         if (m_drawWorld && m_shadowMapping)
             RenderShadowMap();
@@ -3282,82 +3659,114 @@ void CEngine::Draw3DScene()
 
     UseShadowMapping(true);
 
-    for (int objRank = 0; objRank < static_cast<int>(m_objects.size()); objRank++)
-    {
-        if (! m_objects[objRank].used)
-            continue;
+    CullWorldObjects();
 
-        if (m_objects[objRank].type != ENG_OBJTYPE_TERRAIN)
-            continue;
+    QueueWorldObjects(true);
+    DrawRenderQueue(false);
 
-        if (! m_objects[objRank].drawWorld)
-            continue;
+    if (!m_qualityShadows)
+        UseShadowMapping(false);
 
-        m_device->SetTransform(TRANSFORM_WORLD, m_objects[objRank].transform);
+    // Draws the old-style shadow spots, if shadow mapping disabled
+    if (!m_shadowMapping)
+        DrawShadowSpots();
 
-        if (! IsVisible(objRank))
-            continue;
+    CProfiler::StopPerformanceCounter(PCNT_RENDER_TERRAIN);
 
-        int baseObjRank = m_objects[objRank].baseObjRank;
-        if (baseObjRank == -1)
-            continue;
+    // Draw other objects
 
-        assert(baseObjRank >= 0 && baseObjRank < static_cast<int>( m_baseObjects.size() ));
+    CProfiler::StartPerformanceCounter(PCNT_RENDER_OBJECTS);
 
-        EngineBaseObject& p1 = m_baseObjects[baseObjRank];
-        if (! p1.used)
-            continue;
+    QueueWorldObjects(false);
+    DrawRenderQueue(false);
 
-        for (int l2 = 0; l2 < static_cast<int>( p1.next.size() ); l2++)
-        {
-            EngineBaseObjTexTier& p2 = p1.next[l2];
+    UseShadowMapping(false);
 
-            SetTexture(p2.tex1, 0);
-            SetTexture(p2.tex2, 1);
+    // Draw transparent objects
 
-            for (int l3 = 0; l3 < static_cast<int>( p2.next.size() ); l3++)
-            {
-                EngineBaseObjDataTier& p3 = p2.next[l3];
+    DrawRenderQueue(true);
 
-                SetMaterial(p3.material);
-                SetState(p3.state);
+    CProfiler::StopPerformanceCounter(PCNT_RENDER_OBJECTS);
 
-                DrawObject(p3);
-            }
+    m_lightMan->UpdateDeviceLights(ENG_OBJTYPE_TERRAIN);
+
+    if (m_debugLights)
+        m_device->DebugLights();
+
+    if (m_debugDumpLights)
+    {
+        m_debugDumpLights = false;
+        m_lightMan->DebugDumpLights();
+    }
+
+    CProfiler::StartPerformanceCounter(PCNT_RENDER_WATER);
+    m_water->DrawSurf(); // draws water surface
+    CProfiler::StopPerformanceCounter(PCNT_RENDER_WATER);
+
+    m_device->SetRenderState(RENDER_STATE_LIGHTING, false);
+
+    RenderPendingDebugDraws();
+
+    if (m_debugGoto)
+    {
+        Math::Matrix worldMatrix;
+        worldMatrix.LoadIdentity();
+        m_device->SetTransform(TRANSFORM_WORLD, worldMatrix);
+
+        SetState(ENG_RSTATE_OPAQUE_COLOR);
+
+        for (const auto& line : m_displayGoto)
+        {
+            m_device->DrawPrimitive(PRIMITIVE_LINE_STRIP, line.data(), line.size());
         }
     }
+    m_displayGoto.clear();
 
-    if (!m_qualityShadows)
-        UseShadowMapping(false);
+    CProfiler::StartPerformanceCounter(PCNT_RENDER_PARTICLE_WORLD);
+    m_particle->DrawParticle(SH_WORLD); // draws the particles of the 3D world
+    CProfiler::StopPerformanceCounter(PCNT_RENDER_PARTICLE_WORLD);
 
-    // Draws the old-style shadow spots, if shadow mapping disabled
-    if (!m_shadowMapping)
-        DrawShadowSpots();
+    m_device->SetRenderState(RENDER_STATE_LIGHTING, true);
 
-    CProfiler::StopPerformanceCounter(PCNT_RENDER_TERRAIN);
+    m_lightning->Draw();                     // draws lightning
 
-    // Draw other objects
+    DrawForegroundImage();   // draws the foreground
 
-    CProfiler::StartPerformanceCounter(PCNT_RENDER_OBJECTS);
+    if (! m_overFront) DrawOverColor();      // draws the foreground color
+}
 
-    bool transparent = false;
+uint64_t CEngine::GetRenderKey(int objRank, const EngineBaseObjTexTier& texTier,
+                               const EngineBaseObjDataTier& dataTier)
+{
+    // From the most significant bits: transparency (1), object type (3),
+    // render state (23), first texture (16) and second texture (16).
+    // Object types come before state, as lights are updated for each type.
+    uint64_t transparent = m_objects[objRank].type != ENG_OBJTYPE_TERRAIN &&
+                           m_objects[objRank].transparency != 0.0f;
 
-    for (int objRank = 0; objRank < static_cast<int>(m_objects.size()); objRank++)
+    uint64_t key = transparent << 63;
+    key |= static_cast<uint64_t>(m_objects[objRank].type & 0x7) << 60;
+    key |= static_cast<uint64_t>(dataTier.state & 0x7fffff) << 37;
+    key |= static_cast<uint64_t>(texTier.tex1.id & 0xffff) << 21;
+    key |= static_cast<uint64_t>(texTier.tex2.id & 0xffff) << 5;
+    return key;
+}
+
+void CEngine::QueueWorldObjects(bool terrain)
+{
+    m_renderQueue.clear();
+
+    for (int objRank : m_visibleObjects)
     {
         if (! m_objects[objRank].used)
             continue;
 
-        if (m_objects[objRank].type == ENG_OBJTYPE_TERRAIN)
+        if ((m_objects[objRank].type == ENG_OBJTYPE_TERRAIN) != terrain)
             continue;
 
         if (! m_objects[objRank].drawWorld)
             continue;
 
-        m_device->SetTransform(TRANSFORM_WORLD, m_objects[objRank].transform);
-
-        if (! IsVisible(objRank))
-            continue;
-
         int baseObjRank = m_objects[objRank].baseObjRank;
         if (baseObjRank == -1)
             continue;
@@ -3368,140 +3777,129 @@ void CEngine::Draw3DScene()
         if (! p1.used)
             continue;
 
-        m_lightMan->UpdateDeviceLights(m_objects[objRank].type);
-
         for (int l2 = 0; l2 < static_cast<int>( p1.next.size() ); l2++)
         {
             EngineBaseObjTexTier& p2 = p1.next[l2];
 
-            SetTexture(p2.tex1, 0);
-            SetTexture(p2.tex2, 1);
-
             for (int l3 = 0; l3 < static_cast<int>( p2.next.size() ); l3++)
             {
                 EngineBaseObjDataTier& p3 = p2.next[l3];
 
-                if (m_objects[objRank].transparency != 0.0f)  // transparent ?
-                {
-                    transparent = true;
-                    continue;
-                }
-
-                SetMaterial(p3.material);
-                SetState(p3.state);
-
-                DrawObject(p3);
+                EngineRenderItem item;
+                item.key = GetRenderKey(objRank, p2, p3);
+                item.objRank = objRank;
+                item.texTier = &p2;
+                item.dataTier = &p3;
+                m_renderQueue.push_back(item);
             }
         }
     }
 
-    UseShadowMapping(false);
-
-    // Draw transparent objects
-
-    if (transparent)
+    // Items with the same state are grouped by the tier of a static buffer, so that
+    // all instances of a base object end up next to each other and can be drawn at once.
+    // Stable, so that the others stay grouped by object.
+    auto batch = [](const EngineRenderItem& item)
     {
-        int tState = ENG_RSTATE_TTEXTURE_BLACK | ENG_RSTATE_2FACE;
-        Color tColor = Color(68.0f / 255.0f, 68.0f / 255.0f, 68.0f / 255.0f, 68.0f / 255.0f);
-
-        for (int objRank = 0; objRank < static_cast<int>(m_objects.size()); objRank++)
-        {
-            if (! m_objects[objRank].used)
-                continue;
-
-            if (m_objects[objRank].type == ENG_OBJTYPE_TERRAIN)
-                continue;
-
-            if (! m_objects[objRank].drawWorld)
-                continue;
-
-            m_device->SetTransform(TRANSFORM_WORLD, m_objects[objRank].transform);
+        return item.dataTier->staticBufferId != 0 ? item.dataTier : nullptr;
+    };
+    std::stable_sort(m_renderQueue.begin(), m_renderQueue.end(),
+                     [&batch](const EngineRenderItem& a, const EngineRenderItem& b)
+                     {
+                         if (a.key != b.key)
+                             return a.key < b.key;
+                         return std::less<const EngineBaseObjDataTier*>()(batch(a), batch(b));
+                     });
+}
 
-            if (! IsVisible(objRank))
-                continue;
+void CEngine::DrawRenderQueue(bool transparent)
+{
+    int tState = ENG_RSTATE_TTEXTURE_BLACK | ENG_RSTATE_2FACE;
+    Color tColor = Color(68.0f / 255.0f, 68.0f / 255.0f, 68.0f / 255.0f, 68.0f / 255.0f);
 
-            int baseObjRank = m_objects[objRank].baseObjRank;
-            if (baseObjRank == -1)
-                continue;
+    int lastObjRank = -1;
+    EngineObjectType lastType = ENG_OBJTYPE_NULL;
+    Texture lastTex1, lastTex2;
+    bool first = true;
 
-            assert(baseObjRank >= 0 && baseObjRank < static_cast<int>( m_baseObjects.size() ));
+    for (int i = 0; i < static_cast<int>( m_renderQueue.size() ); i++)
+    {
+        const EngineRenderItem& item = m_renderQueue[i];
 
-            EngineBaseObject& p1 = m_baseObjects[baseObjRank];
-            if (! p1.used)
-                continue;
+        if ((item.key >> 63 != 0) != transparent)
+            continue;
 
-            m_lightMan->UpdateDeviceLights(m_objects[objRank].type);
+        const EngineObject& object = m_objects[item.objRank];
 
-            for (int l2 = 0; l2 < static_cast<int>( p1.next.size() ); l2++)
+        // Following items drawing the same static buffer with the same state
+        int instanceCount = 1;
+        if (item.dataTier->staticBufferId != 0)
+        {
+            while (i + instanceCount < static_cast<int>( m_renderQueue.size() ) &&
+                   m_renderQueue[i + instanceCount].dataTier == item.dataTier &&
+                   m_renderQueue[i + instanceCount].key == item.key)
             {
-                EngineBaseObjTexTier& p2 = p1.next[l2];
-
-                SetTexture(p2.tex1, 0);
-                SetTexture(p2.tex2, 1);
-
-                for (int l3 = 0; l3 < static_cast<int>( p2.next.size() ); l3++)
-                {
-                    EngineBaseObjDataTier& p3 = p2.next[l3];
-
-                    if (m_objects[objRank].transparency == 0.0f)
-                        continue;
-
-                    SetMaterial(p3.material);
-                    SetState(tState, tColor);
-
-                    DrawObject(p3);
-                }
+                instanceCount++;
             }
         }
-    }
-
-    CProfiler::StopPerformanceCounter(PCNT_RENDER_OBJECTS);
-
-    m_lightMan->UpdateDeviceLights(ENG_OBJTYPE_TERRAIN);
 
-    if (m_debugLights)
-        m_device->DebugLights();
+        if (first || object.type != lastType)
+        {
+            m_lightMan->UpdateDeviceLights(object.type);
+            lastType = object.type;
+            m_statisticStateChanges++;
+        }
 
-    if (m_debugDumpLights)
-    {
-        m_debugDumpLights = false;
-        m_lightMan->DebugDumpLights();
-    }
+        if (instanceCount == 1 && item.objRank != lastObjRank)
+        {
+            m_device->SetTransform(TRANSFORM_WORLD, object.transform);
+            lastObjRank = item.objRank;
+            m_statisticStateChanges++;
+        }
 
-    CProfiler::StartPerformanceCounter(PCNT_RENDER_WATER);
-    m_water->DrawSurf(); // draws water surface
-    CProfiler::StopPerformanceCounter(PCNT_RENDER_WATER);
+        if (first || !(item.texTier->tex1 == lastTex1))
+        {
+            SetTexture(item.texTier->tex1, 0);
+            lastTex1 = item.texTier->tex1;
+            m_statisticStateChanges++;
+        }
 
-    m_device->SetRenderState(RENDER_STATE_LIGHTING, false);
+        if (first || !(item.texTier->tex2 == lastTex2))
+        {
+            SetTexture(item.texTier->tex2, 1);
+            lastTex2 = item.texTier->tex2;
+            m_statisticStateChanges++;
+        }
 
-    RenderPendingDebugDraws();
+        if (first || item.dataTier->material != m_lastMaterial)
+        {
+            SetMaterial(item.dataTier->material);
+            m_statisticStateChanges++;
+        }
 
-    if (m_debugGoto)
-    {
-        Math::Matrix worldMatrix;
-        worldMatrix.LoadIdentity();
-        m_device->SetTransform(TRANSFORM_WORLD, worldMatrix);
+        int state = transparent ? tState : item.dataTier->state;
+        Color color = transparent ? tColor : Color(1.0f, 1.0f, 1.0f, 1.0f);
+        if (state != m_lastState || color != m_lastColor)
+            m_statisticStateChanges++;
+        SetState(state, color);
 
-        SetState(ENG_RSTATE_OPAQUE_COLOR);
+        first = false;
 
-        for (const auto& line : m_displayGoto)
+        if (instanceCount == 1)
         {
-            m_device->DrawPrimitive(PRIMITIVE_LINE_STRIP, line.data(), line.size());
+            DrawObject(*item.dataTier);
+            continue;
         }
-    }
-    m_displayGoto.clear();
 
-    CProfiler::StartPerformanceCounter(PCNT_RENDER_PARTICLE_WORLD);
-    m_particle->DrawParticle(SH_WORLD); // draws the particles of the 3D world
-    CProfiler::StopPerformanceCounter(PCNT_RENDER_PARTICLE_WORLD);
+        m_instanceTransforms.clear();
+        for (int j = 0; j < instanceCount; j++)
+            m_instanceTransforms.push_back(m_objects[m_renderQueue[i + j].objRank].transform);
 
-    m_device->SetRenderState(RENDER_STATE_LIGHTING, true);
+        DrawObjectInstances(*item.dataTier, m_instanceTransforms);
 
-    m_lightning->Draw();                     // draws lightning
-
-    DrawForegroundImage();   // draws the foreground
-
-    if (! m_overFront) DrawOverColor();      // draws the foreground color
+        // The device has replaced the world transform
+        lastObjRank = -1;
+        i += instanceCount - 1;
+    }
 }
 
 void CEngine::Capture3DScene()
@@ -3834,13 +4232,32 @@ void CEngine::RenderShadowMap()
         GetLogger()->Info("Created shadow map texture: %dx%d, depth %d\n", width, height, depth);
     }
 
-    if (m_offscreenShadowRendering)
+    // Layer of static shadow casters, kept between frames
+    CFramebuffer* staticLayer = nullptr;
+    if (m_offscreenShadowRendering && m_shadowCache)
     {
-        m_device->GetFramebuffer("shadow")->Bind();
+        staticLayer = m_device->GetFramebuffer("shadow_static");
+        if (staticLayer == nullptr)
+        {
+            FramebufferParams params;
+            params.width = m_shadowMap.size.x;
+            params.height = m_shadowMap.size.y;
+            params.depth = 32;
+            params.colorAttachment = FramebufferParams::AttachmentType::None;
+            params.depthAttachment = FramebufferParams::AttachmentType::Texture;
+
+            staticLayer = m_device->CreateFramebuffer("shadow_static", params);
+            if (staticLayer == nullptr)
+            {
+                GetLogger()->Error("Could not create framebuffer for static shadows, disabling shadow caching\n");
+                m_shadowCache = false;
+            }
+
+            m_shadowStaticOutdated = true;
+        }
     }
 
     m_device->SetRenderMode(RENDER_MODE_SHADOW);
-    m_device->Clear();
 
     // change state to rendering shadow maps
     m_device->SetColorMask(false, false, false, false);
@@ -3883,15 +4300,21 @@ void CEngine::RenderShadowMap()
         pos = Math::MatrixVectorMultiply(lightRotation, pos);
         // ...then we round to the nearest worldUnitsPerTexel:
         const float worldUnitsPerTexel = (dist * 2.0f) / m_shadowMap.size.x;
-        pos /= worldUnitsPerTexel;
+        // With cached static shadows, the map moves in larger steps, so that the static layer
+        // stays valid while the camera moves a little; the depth range is extended accordingly
+        const float worldUnitsPerStep = (staticLayer != nullptr) ? dist * SHADOW_CACHE_STEP : worldUnitsPerTexel;
+        pos /= worldUnitsPerStep;
         pos.x = round(pos.x);
         pos.y = round(pos.y);
         pos.z = round(pos.z);
-        pos *= worldUnitsPerTexel;
+        pos *= worldUnitsPerStep;
         // ...and convert back to world space.
         pos = Math::MatrixVectorMultiply(lightRotation.Inverse(), pos);
     }
 
+    if (staticLayer != nullptr)
+        depth += dist * SHADOW_CACHE_STEP;
+
     Math::Vector lookAt = pos - lightDir;
 
     Math::LoadOrthoProjectionMatrix(m_shadowProjMat, -dist, dist, -dist, dist, -depth, depth);
@@ -3914,58 +4337,76 @@ void CEngine::RenderShadowMap()
     m_device->SetTexture(2, 0);
 
     // render objects into shadow map
-    for (int objRank = 0; objRank < static_cast<int>(m_objects.size()); objRank++)
-    {
-        if (!m_objects[objRank].used)
-            continue;
-
-        bool terrain = (m_objects[objRank].type == ENG_OBJTYPE_TERRAIN);
+    m_shadowFrame++;
+    m_shadowCasters.clear();
+    UpdateCullingGrid();
+    CullObjects(m_shadowProjMat, m_shadowViewMat, m_shadowCasters);
 
-        if (terrain)
+    if (staticLayer != nullptr)
+    {
+        // Objects which stopped moving are added to the static layer from time to time
+        bool newStatic = false;
+        for (int objRank : m_shadowCasters)
         {
-            if (m_terrainShadows)
+            if (!m_objects[objRank].shadowStatic && IsStaticShadowCaster(objRank))
             {
-                m_device->SetRenderState(RENDER_STATE_ALPHA_TEST, false);
-                m_device->SetRenderState(RENDER_STATE_CULLING, true);
-                m_device->SetCullMode(CULL_CCW);
+                newStatic = true;
+                break;
             }
-            else
-                continue;
         }
-        else
+
+        if (m_shadowStaticOutdated || !Math::MatricesEqual(m_shadowStaticViewMat, m_shadowViewMat) ||
+            (newStatic && m_shadowFrame - m_shadowStaticFrame > SHADOW_STATIC_FRAMES))
         {
-            m_device->SetRenderState(RENDER_STATE_ALPHA_TEST, true);
-            m_device->SetRenderState(RENDER_STATE_CULLING, false);
-        }
+            for (int objRank : m_shadowStaticObjects)
+            {
+                if (objRank < static_cast<int>(m_objects.size()))
+                    m_objects[objRank].shadowStatic = false;
+            }
+            m_shadowStaticObjects.clear();
 
-        m_device->SetTransform(TRANSFORM_WORLD, m_objects[objRank].transform);
+            staticLayer->Bind();
+            m_device->Clear();
 
-        if (!IsVisible(objRank))
-            continue;
+            for (int objRank : m_shadowCasters)
+            {
+                if (!m_objects[objRank].used || !IsStaticShadowCaster(objRank))
+                    continue;
 
-        int baseObjRank = m_objects[objRank].baseObjRank;
-        if (baseObjRank == -1)
-            continue;
+                DrawShadowCaster(objRank);
+                m_objects[objRank].shadowStatic = true;
+                m_shadowStaticObjects.push_back(objRank);
+            }
 
-        assert(baseObjRank >= 0 && baseObjRank < static_cast<int>(m_baseObjects.size()));
+            m_shadowStaticOutdated = false;
+            m_shadowStaticFrame = m_shadowFrame;
+            m_shadowStaticViewMat = m_shadowViewMat;
+        }
 
-        EngineBaseObject& p1 = m_baseObjects[baseObjRank];
-        if (!p1.used)
-            continue;
+        // Dynamic casters are drawn over a copy of the static layer
+        CFramebuffer* framebuffer = m_device->GetFramebuffer("shadow");
+        framebuffer->Bind();
+        staticLayer->CopyDepthTo(framebuffer);
+    }
+    else
+    {
+        if (m_offscreenShadowRendering)
+            m_device->GetFramebuffer("shadow")->Bind();
 
-        for (int l2 = 0; l2 < static_cast<int>(p1.next.size()); l2++)
-        {
-            EngineBaseObjTexTier& p2 = p1.next[l2];
+        m_device->Clear();
 
-            SetTexture(p2.tex1, 0);
+        m_shadowStaticOutdated = true;
+    }
 
-            for (int l3 = 0; l3 < static_cast<int>(p2.next.size()); l3++)
-            {
-                EngineBaseObjDataTier& p3 = p2.next[l3];
+    for (int objRank : m_shadowCasters)
+    {
+        if (!m_objects[objRank].used)
+            continue;
 
-                DrawObject(p3);
-            }
-        }
+        if (staticLayer != nullptr && m_objects[objRank].shadowStatic)
+            continue;
+
+        DrawShadowCaster(objRank);
     }
 
     m_device->SetRenderState(RENDER_STATE_DEPTH_BIAS, false);
@@ -3995,6 +4436,72 @@ void CEngine::RenderShadowMap()
     m_device->SetRenderState(RENDER_STATE_DEPTH_TEST, false);
 }
 
+void CEngine::DrawShadowCaster(int objRank)
+{
+    bool terrain = (m_objects[objRank].type == ENG_OBJTYPE_TERRAIN);
+
+    if (terrain)
+    {
+        if (m_terrainShadows)
+        {
+            m_device->SetRenderState(RENDER_STATE_ALPHA_TEST, false);
+            m_device->SetRenderState(RENDER_STATE_CULLING, true);
+            m_device->SetCullMode(CULL_CCW);
+        }
+        else
+            return;
+    }
+    else
+    {
+        m_device->SetRenderState(RENDER_STATE_ALPHA_TEST, true);
+        m_device->SetRenderState(RENDER_STATE_CULLING, false);
+    }
+
+    m_device->SetTransform(TRANSFORM_WORLD, m_objects[objRank].transform);
+
+    int baseObjRank = m_objects[objRank].baseObjRank;
+    if (baseObjRank == -1)
+        return;
+
+    assert(baseObjRank >= 0 && baseObjRank < static_cast<int>(m_baseObjects.size()));
+
+    EngineBaseObject& p1 = m_baseObjects[baseObjRank];
+    if (!p1.used)
+        return;
+
+    for (int l2 = 0; l2 < static_cast<int>(p1.next.size()); l2++)
+    {
+        EngineBaseObjTexTier& p2 = p1.next[l2];
+
+        SetTexture(p2.tex1, 0);
+
+        for (int l3 = 0; l3 < static_cast<int>(p2.next.size()); l3++)
+        {
+            EngineBaseObjDataTier& p3 = p2.next[l3];
+
+            DrawObject(p3);
+        }
+    }
+}
+
+bool CEngine::IsStaticShadowCaster(int objRank)
+{
+    const EngineObject& object = m_objects[objRank];
+
+    if (object.type != ENG_OBJTYPE_TERRAIN && object.type != ENG_OBJTYPE_FIX)
+        return false;
+
+    return m_shadowFrame - object.lastMoveFrame > SHADOW_STATIC_FRAMES;
+}
+
+void CEngine::MarkShadowCasterChanged(int objRank)
+{
+    m_objects[objRank].lastMoveFrame = m_shadowFrame;
+
+    if (m_objects[objRank].shadowStatic)
+        m_shadowStaticOutdated = true;
+}
+
 void CEngine::UseShadowMapping(bool enable)
 {
     if (!m_shadowMapping) return;
@@ -4073,8 +4580,25 @@ void CEngine::UseMSAA(bool enable)
     }
 }
 
+void CEngine::DrawObjectInstances(const EngineBaseObjDataTier& p4, const std::vector<Math::Matrix>& transforms)
+{
+    assert(p4.staticBufferId != 0);
+
+    m_statisticDrawCalls++;
+
+    int count = transforms.size();
+    m_device->DrawStaticBufferInstanced(p4.staticBufferId, transforms.data(), nullptr, count);
+
+    if (p4.type == ENG_TRIANGLE_TYPE_TRIANGLES)
+        m_statisticTriangle += count * (p4.vertices.size() / 3);
+    else
+        m_statisticTriangle += count * (p4.vertices.size() - 2);
+}
+
 void CEngine::DrawObject(const EngineBaseObjDataTier& p4)
 {
+    m_statisticDrawCalls++;
+
     if (p4.staticBufferId != 0)
     {
         m_device->DrawStaticBuffer(p4.staticBufferId);
@@ -5135,7 +5659,7 @@ void CEngine::DrawStats()
 
     float height = m_text->GetAscent(FONT_COMMON, 13.0f);
     float width = 0.4f;
-    const int TOTAL_LINES = 22;
+    const int TOTAL_LINES = 27;
 
     Math::Point pos(0.05f * m_size.x/m_size.y, 0.05f + TOTAL_LINES * height);
 
@@ -5188,7 +5712,8 @@ void CEngine::DrawStats()
                              CProfiler::GetPerformanceCounterTime(PCNT_UPDATE_PARTICLE);
 
     long long gameUpdate = CProfiler::GetPerformanceCounterTime(PCNT_UPDATE_GAME) -
-                           CProfiler::GetPerformanceCounterTime(PCNT_UPDATE_CBOT);
+                           CProfiler::GetPerformanceCounterTime(PCNT_UPDATE_CBOT) -
+                           CProfiler::GetPerformanceCounterTime(PCNT_UPDATE_COLLISION);
 
     long long otherUpdate = CProfiler::GetPerformanceCounterTime(PCNT_UPDATE_ALL) -
                             CProfiler::GetPerformanceCounterTime(PCNT_UPDATE_ENGINE) -
@@ -5209,6 +5734,7 @@ void CEngine::DrawStats()
     drawStatsCounter("    Particle update",   PCNT_UPDATE_PARTICLE);
     drawStatsValue  ("    Game update",       gameUpdate);
     drawStatsCounter("    CBot programs",     PCNT_UPDATE_CBOT);
+    drawStatsCounter("    Collisions",        PCNT_UPDATE_COLLISION);
     drawStatsValue(  "    Other update",      otherUpdate);
     drawStatsLine(   "", "", "");
     drawStatsCounter("Frame render",      PCNT_RENDER_ALL);
@@ -5223,6 +5749,11 @@ void CEngine::DrawStats()
     drawStatsCounter("Swap buffers & VSync",  PCNT_SWAP_BUFFERS);
     drawStatsLine(   "", "", "");
     drawStatsLine(   "Triangles",         StrUtils::ToString<int>(m_statisticTriangle), "");
+    drawStatsLine(   "Draw calls",        StrUtils::ToString<int>(m_statisticDrawCalls), "");
+    drawStatsLine(   "State changes",     StrUtils::ToString<int>(m_statisticStateChanges), "");
+    drawStatsLine(   "Particles",         StrUtils::Format("%lld / %lld", CProfiler::GetPerformanceValue(PVAL_PARTICLE_LIVE),
+                                                                          CProfiler::GetPerformanceValue(PVAL_PARTICLE_PEAK)), "");
+    drawStatsLine(   "    dropped",       StrUtils::ToString<long long>(CProfiler::GetPerformanceValue(PVAL_PARTICLE_DROPPED)), "");
     drawStatsLine(   "FPS",               StrUtils::Format("%.3f", m_fps), "");
     drawStatsLine(   "", "", "");
     std::stringstream str;
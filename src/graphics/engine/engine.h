@@ -32,6 +32,8 @@
 #include "graphics/core/texture.h"
 #include "graphics/core/vertex.h"
 
+#include "graphics/engine/culling.h"
+
 #include "math/intpoint.h"
 #include "math/matrix.h"
 #include "math/point.h"
@@ -39,6 +41,7 @@
 #include "math/vector.h"
 
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <map>
@@ -70,6 +73,8 @@ class CLightning;
 class CPlanet;
 class CTerrain;
 class CPyroManager;
+class CTextureCache;
+class CTextureLoader;
 class CModelMesh;
 struct ModelShadowSpot;
 struct ModelTriangle;
@@ -283,6 +288,12 @@ struct EngineObject
     int                    shadowRank = -1;
     //! Transparency of the object [0, 1]
     float                  transparency = 0.0f;
+    //! true if the object must be refitted in the culling grid
+    bool                   cullingOutdated = false;
+    //! true if the object is drawn in the cached layer of static shadow casters
+    bool                   shadowStatic = false;
+    //! Shadow map frame in which the object was last moved or changed
+    int                    lastMoveFrame = 0;
 
     //! Loads default values
     inline void LoadDefault()
@@ -291,6 +302,25 @@ struct EngineObject
     }
 };
 
+/**
+ * \struct EngineRenderItem
+ * \brief Draw call of an object tier collected by the render queue
+ *
+ * Items are drawn in order of their key, which packs transparency, object type,
+ * render state and textures, so that consecutive items share most of the state.
+ */
+struct EngineRenderItem
+{
+    //! Packed state, see CEngine::GetRenderKey()
+    uint64_t                     key = 0;
+    //! Rank of the object, gives the transform and the type
+    int                          objRank = -1;
+    //! Tier with the textures
+    const EngineBaseObjTexTier*  texTier = nullptr;
+    //! Tier with the material, render state and geometry or static buffer
+    const EngineBaseObjDataTier* dataTier = nullptr;
+};
+
 /**
  * \struct EngineShadowType
  * \brief Type of shadow drawn by the graphics engine
@@ -604,7 +634,7 @@ public:
     //! Returns the terrain manager
     CTerrain*       GetTerrain();
     //! Returns the water manager
-    CWater*         GetWater();
+    TEST_VIRTUAL CWater* GetWater();
     //! Returns the lighting manager
     CLightning*     GetLightning();
     //! Returns the planet manager
@@ -640,7 +670,7 @@ public:
     //@{
     //! Management of animation pause mode
     void            SetPause(bool pause);
-    bool            GetPause();
+    TEST_VIRTUAL bool GetPause();
     //@}
 
     //@{
@@ -756,6 +786,13 @@ public:
     int             GetObjectBaseRank(int objRank);
     //@}
 
+    //! Switches the object to another level of detail of the same mesh
+    /**
+     * Unlike SetObjectBaseRank(), this is not a change of the shadow caster,
+     * so the object stays in the cached layer of static shadows.
+     */
+    void            SetObjectLodBaseRank(int objRank, int baseObjRank);
+
     //@{
     //! Management of engine object type
     void            SetObjectType(int objRank, EngineObjectType type);
@@ -879,8 +916,28 @@ public:
     //! Loads texture, creating it with given params if not already present
     Texture         LoadTexture(const std::string& name, const TextureCreateParams& params);
     //! Loads all necessary textures
+    /** Textures of objects not loaded yet are decoded in the background and drawn with a placeholder meanwhile. */
     bool            LoadAllTextures();
 
+    //! Starts decoding the given textures in the background, to be uploaded in the next frames
+    void            PreloadTextures(const std::vector<std::string>& names);
+    //! Returns names of all textures used by base objects
+    std::vector<std::string> GetObjectTextureNames();
+    //! Returns the number of textures being decoded in the background
+    int             GetPendingTextureCount();
+
+    //! Management of the cache of decoded textures on disk
+    //@{
+    void            SetTextureCache(bool value);
+    bool            GetTextureCache();
+    //@}
+
+    //! Management of the time per frame spent uploading textures decoded in the background, in ms
+    //@{
+    void            SetTextureUploadBudget(float budget);
+    float           GetTextureUploadBudget();
+    //@}
+
     //! Changes colors in a texture
     //@{
     bool            ChangeTextureColor(const std::string& texName,
@@ -1070,6 +1127,8 @@ public:
     bool            GetShadowMappingQuality();
     void            SetTerrainShadows(bool value);
     bool            GetTerrainShadows();
+    void            SetShadowMappingCache(bool value);
+    bool            GetShadowMappingCache();
     //@}
 
     //@{
@@ -1206,12 +1265,20 @@ protected:
     void        DrawCaptured3DScene();
     //! Renders shadow map
     void        RenderShadowMap();
+    //! Draws one object into the shadow map
+    void        DrawShadowCaster(int objRank);
+    //! Tests whether the object can be drawn in the cached layer of static shadow casters
+    bool        IsStaticShadowCaster(int objRank);
+    //! Marks the object as moved or changed, for the cache of static shadow casters
+    void        MarkShadowCasterChanged(int objRank);
     //! Enables or disables shadow mapping
     void        UseShadowMapping(bool enable);
     //! Enables or disables MSAA
     void        UseMSAA(bool enable);
     //! Draw 3D object
     void        DrawObject(const EngineBaseObjDataTier& p4);
+    //! Draws a 3D object tier once for each of the given transforms
+    void        DrawObjectInstances(const EngineBaseObjDataTier& p4, const std::vector<Math::Matrix>& transforms);
     //! Draws the user interface over the scene
     void        DrawInterface();
 
@@ -1250,9 +1317,39 @@ protected:
     //! Create texture and add it to cache
     Texture CreateTexture(const std::string &texName, const TextureCreateParams &params, CImage* image = nullptr);
 
+    //! Returns the texture if already loaded, otherwise requests it in the background and returns a placeholder
+    Texture LoadTextureDeferred(const std::string& name, const TextureCreateParams& params);
+    //! Uploads textures decoded in the background, within the per-frame budget
+    void UploadDecodedTextures();
+    //! Loads textures of all base objects, deferring the ones not loaded yet
+    bool LoadBaseObjectTextures();
+
     //! Tests whether the given object is visible
     bool        IsVisible(int objRank);
 
+    //! Returns the bounding sphere of the given object in world coordinates
+    Math::Sphere GetObjectWorldSphere(int objRank);
+    //! Marks the given object to be refitted in the culling grid
+    void        MarkCullingOutdated(int objRank);
+    //! Marks the objects using the given base object to be refitted after it changed
+    void        MarkBaseObjectChanged(int baseObjRank);
+    //! Changes the base object of given object, keeping \ref m_baseObjectUsers up to date
+    void        SetBaseObjectUser(int objRank, int baseObjRank);
+    //! Refits the culling grid for objects that have moved or changed
+    void        UpdateCullingGrid();
+    //! Appends objects within the frustum of given projection and view to \a result
+    void        CullObjects(const Math::Matrix& proj, const Math::Matrix& view, std::vector<int>& result);
+    //! Finds the objects visible in the 3D scene and updates their visibility flag
+    void        CullWorldObjects();
+
+    //! Returns the sort key of a draw call, see EngineRenderItem
+    uint64_t    GetRenderKey(int objRank, const EngineBaseObjTexTier& texTier,
+                             const EngineBaseObjDataTier& dataTier);
+    //! Fills the render queue with parts of terrain or of other objects found by CullWorldObjects(), sorted by key
+    void        QueueWorldObjects(bool terrain);
+    //! Draws the opaque or the transparent items of the render queue
+    void        DrawRenderQueue(bool transparent);
+
     //! Detects whether an object is affected by the mouse
     bool        DetectBBox(int objRank, Math::Point mouse);
 
@@ -1381,6 +1478,8 @@ protected:
     float           m_fogStart[2];
     Color           m_waterAddColor;
     int             m_statisticTriangle;
+    int             m_statisticDrawCalls;
+    int             m_statisticStateChanges;
     Math::Vector    m_statisticPos;
     bool            m_updateGeometry;
     bool            m_updateStaticBuffers;
@@ -1454,6 +1553,18 @@ protected:
     bool m_qualityShadows;
     //! true enables casting shadows by terrain
     bool m_terrainShadows;
+    //! true enables caching of static shadow casters in offscreen shadow rendering
+    bool m_shadowCache;
+    //! true if the cached layer of static shadow casters must be drawn again
+    bool m_shadowStaticOutdated = true;
+    //! Number of shadow maps rendered so far
+    int m_shadowFrame = 0;
+    //! Shadow map frame in which the static layer was last drawn
+    int m_shadowStaticFrame = 0;
+    //! Shadow view matrix used for the static layer
+    Math::Matrix m_shadowStaticViewMat;
+    //! Objects drawn in the static layer
+    std::vector<int> m_shadowStaticObjects;
     //! Shadow color
     float m_shadowColor;
     //! Shadow range
@@ -1469,6 +1580,20 @@ protected:
     /** Textures on this list were not successful in first loading,
      *  so are disabled for subsequent load calls. */
     std::set<std::string> m_texBlacklist;
+    //! Cache of decoded textures on disk
+    std::unique_ptr<CTextureCache> m_textureCache;
+    //! Background decoding of textures
+    std::unique_ptr<CTextureLoader> m_textureLoader;
+    //! Creation params of textures being decoded in the background
+    std::map<std::string, TextureCreateParams> m_texDeferredParams;
+    //! Texture drawn instead of the ones being decoded
+    Texture         m_placeholderTexture;
+    //! Base objects use the placeholder texture
+    bool            m_placeholderUsed = false;
+    //! A deferred texture was loaded synchronously, placeholders have to be replaced
+    bool            m_placeholderRefresh = false;
+    //! Time per frame for uploading decoded textures, in ms
+    float           m_textureUploadBudget = 4.0f;
 
     //! Texture with mouse cursors
     Texture         m_miceTexture;
@@ -1497,6 +1622,22 @@ protected:
 
     std::unordered_map<std::string, int> m_staticMeshBaseObjects;
 
+    //! Grid of object bounding spheres for frustum culling
+    CCullingGrid    m_cullingGrid;
+    //! Objects to refit in the culling grid
+    std::vector<int> m_cullingOutdated;
+    //! Objects using each base object, by base object rank
+    std::vector<std::vector<int>> m_baseObjectUsers;
+    //! Objects visible in the 3D scene in current frame
+    std::vector<int> m_visibleObjects;
+    //! Objects within the frustum of the shadow map in current frame
+    std::vector<int> m_shadowCasters;
+
+    //! Draw calls of world objects in current frame
+    std::vector<EngineRenderItem> m_renderQueue;
+    //! Transforms of the instances drawn by the current batch of the render queue
+    std::vector<Math::Matrix> m_instanceTransforms;
+
     std::vector<std::vector<VertexCol>> m_displayGoto;
     std::unique_ptr<CImage> m_displayGotoImage;
 
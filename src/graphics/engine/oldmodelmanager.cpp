@@ -24,13 +24,14 @@
 #include "common/logger.h"
 #include "common/stringutils.h"
 
-#include "common/resources/inputstream.h"
+#include "common/thread/worker_pool.h"
 
 #include "graphics/engine/engine.h"
 
-#include "graphics/model/model_input.h"
+#include "graphics/model/model_cache.h"
 #include "graphics/model/model_io_exception.h"
 
+#include <algorithm>
 #include <cstdio>
 
 namespace Gfx
@@ -52,23 +53,7 @@ bool COldModelManager::LoadModel(const std::string& fileName, bool mirrored, int
     CModel model;
     try
     {
-        CInputStream stream;
-        stream.open("models/" + fileName);
-        if (!stream.is_open())
-            throw CModelIOException(std::string("Could not open file '") + fileName + "'");
-
-        std::string::size_type extension_index = fileName.find_last_of('.');
-        if (extension_index == std::string::npos)
-            throw CModelIOException(std::string("Filename '") + fileName + "' has no extension");
-
-        std::string extension = fileName.substr(extension_index + 1);
-
-        if (extension == "mod")
-            model = ModelInput::Read(stream, ModelFormat::Old);
-        else if (extension == "txt")
-            model = ModelInput::Read(stream, ModelFormat::Text);
-        else
-            throw CModelIOException(std::string("Filename '") + fileName + "' has unknown extension");
+        model = ReadModel(fileName);
     }
     catch (const CModelIOException& e)
     {
@@ -76,25 +61,101 @@ bool COldModelManager::LoadModel(const std::string& fileName, bool mirrored, int
         return false;
     }
 
-    CModelMesh* mesh = model.GetMesh("main");
+    CreateModel(FileInfo(fileName, mirrored, variant), model);
+
+    return true;
+}
+
+void COldModelManager::PreloadModels(const std::vector<FileInfo>& models)
+{
+    // Each file is read once, even if used with several variants
+    std::vector<std::string> fileNames;
+    for (const FileInfo& fileInfo : models)
+    {
+        if (m_models.count(fileInfo) > 0)
+            continue;
+
+        if (std::find(fileNames.begin(), fileNames.end(), fileInfo.fileName) == fileNames.end())
+            fileNames.push_back(fileInfo.fileName);
+    }
+
+    if (fileNames.empty())
+        return;
+
+    GetLogger()->Debug("Preloading %d models\n", static_cast<int>(fileNames.size()));
+
+    std::vector<CModel> readModels(fileNames.size());
+    std::vector<std::string> errors(fileNames.size());
+    {
+        CWorkerPool pool;
+        for (int i = 0; i < static_cast<int>(fileNames.size()); ++i)
+        {
+            pool.Start([&, i]()
+            {
+                try
+                {
+                    readModels[i] = ReadModel(fileNames[i]);
+                }
+                catch (const CModelIOException& e)
+                {
+                    errors[i] = e.what();
+                }
+            });
+        }
+        pool.Wait();
+    }
+
+    // Engine objects can be created only on the main thread
+    for (const FileInfo& fileInfo : models)
+    {
+        if (m_models.count(fileInfo) > 0)
+            continue;
+
+        int index = std::find(fileNames.begin(), fileNames.end(), fileInfo.fileName) - fileNames.begin();
+        if (!errors[index].empty())
+        {
+            GetLogger()->Error("Loading model '%s' failed: %s\n", fileInfo.fileName.c_str(), errors[index].c_str());
+            continue;
+        }
+
+        CreateModel(fileInfo, readModels[index]);
+    }
+}
+
+CModel COldModelManager::ReadModel(const std::string& fileName)
+{
+    std::string::size_type extension_index = fileName.find_last_of('.');
+    if (extension_index == std::string::npos)
+        throw CModelIOException(std::string("Filename '") + fileName + "' has no extension");
+
+    std::string extension = fileName.substr(extension_index + 1);
+
+    if (extension == "mod")
+        return ModelCache::Read("models/" + fileName, ModelFormat::Old);
+    else if (extension == "txt")
+        return ModelCache::Read("models/" + fileName, ModelFormat::Text);
+    else
+        throw CModelIOException(std::string("Filename '") + fileName + "' has unknown extension");
+}
+
+void COldModelManager::CreateModel(const FileInfo& fileInfo, const CModel& model)
+{
+    const CModelMesh* mesh = model.GetMesh("main");
     assert(mesh != nullptr);
 
     ModelInfo modelInfo;
     modelInfo.baseObjRank = m_engine->CreateBaseObject();
     modelInfo.triangles = mesh->GetTriangles();
 
-    if (mirrored)
+    if (fileInfo.mirrored)
         Mirror(modelInfo.triangles);
 
-    if (variant != 0)
-        ChangeVariant(modelInfo.triangles, variant);
+    if (fileInfo.variant != 0)
+        ChangeVariant(modelInfo.triangles, fileInfo.variant);
 
-    FileInfo fileInfo(fileName, mirrored, variant);
     m_models[fileInfo] = modelInfo;
 
     m_engine->AddBaseObjTriangles(modelInfo.baseObjRank, modelInfo.triangles);
-
-    return true;
 }
 
 bool COldModelManager::AddModelReference(const std::string& fileName, bool mirrored, int objRank, int variant)
@@ -109,6 +170,7 @@ bool COldModelManager::AddModelReference(const std::string& fileName, bool mirro
     }
 
     m_engine->SetObjectBaseRank(objRank, (*it).second.baseObjRank);
+    m_usedModels.insert((*it).first);
 
     return true;
 }
@@ -129,6 +191,7 @@ bool COldModelManager::AddModelCopy(const std::string& fileName, bool mirrored,
     m_engine->SetObjectBaseRank(objRank, copyBaseObjRank);
 
     m_copiesBaseRanks.push_back(copyBaseObjRank);
+    m_usedModels.insert((*it).first);
 
     return true;
 }
@@ -176,6 +239,16 @@ void COldModelManager::UnloadAllModels()
     m_models.clear();
 }
 
+std::vector<COldModelManager::FileInfo> COldModelManager::GetUsedModels()
+{
+    return std::vector<FileInfo>(m_usedModels.begin(), m_usedModels.end());
+}
+
+void COldModelManager::ClearUsedModels()
+{
+    m_usedModels.clear();
+}
+
 void COldModelManager::Mirror(std::vector<ModelTriangle>& triangles)
 {
     for (int i = 0; i < static_cast<int>( triangles.size() ); i++)
@@ -21,11 +21,13 @@
 
 #include "common/singleton.h"
 
+#include "graphics/model/model.h"
 #include "graphics/model/model_triangle.h"
 
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
 
 namespace Gfx
 {
@@ -53,12 +55,45 @@ class CEngine;
  */
 class COldModelManager
 {
+public:
+    //! Model file with its mirroring and variant
+    struct FileInfo
+    {
+        std::string fileName;
+        bool mirrored;
+        int variant;
+
+        inline FileInfo(const std::string& _fileName, bool _mirrored, int _variant = 0)
+         : fileName(_fileName)
+         , mirrored(_mirrored)
+         , variant(_variant)
+        {}
+
+        inline bool operator<(const FileInfo& other) const
+        {
+            int compare = fileName.compare(other.fileName);
+            if (compare < 0)
+                return true;
+            if (compare > 0)
+                return false;
+
+            if (variant < other.variant)
+                return true;
+            if (variant > other.variant)
+                return false;
+
+            return !mirrored && mirrored != other.mirrored;
+        }
+    };
+
 public:
     COldModelManager(CEngine* engine);
     ~COldModelManager();
 
     //! Loads a model from given file
     bool LoadModel(const std::string& fileName, bool mirrored, int variant = 0);
+    //! Loads the given models which are not loaded yet, reading the files on worker threads
+    void PreloadModels(const std::vector<FileInfo>& models);
 
     //! Adds an instance of model to the given object rank as a reference to base object
     bool AddModelReference(const std::string& fileName, bool mirrored, int objRank, int variant = 0);
@@ -80,7 +115,18 @@ public:
     //! Unloads all models
     void UnloadAllModels();
 
+    //! Returns the models added to objects since the last call to ClearUsedModels()
+    std::vector<FileInfo> GetUsedModels();
+    //! Clears the list of used models
+    void ClearUsedModels();
+
 protected:
+    //! Reads the model file; can be called from any thread
+    /** @throws CModelIOException on read error */
+    static CModel ReadModel(const std::string& fileName);
+    //! Creates the base engine object of a model read from file
+    void CreateModel(const FileInfo& fileInfo, const CModel& model);
+
     //! Mirrors the model along the Z axis
     void Mirror(std::vector<ModelTriangle>& triangles);
     //! Changes variant
@@ -92,35 +138,9 @@ private:
         std::vector<ModelTriangle> triangles;
         int baseObjRank = -1;
     };
-    struct FileInfo
-    {
-        std::string fileName;
-        bool mirrored;
-        int variant;
 
-        inline FileInfo(const std::string& _fileName, bool _mirrored, int _variant = 0)
-         : fileName(_fileName)
-         , mirrored(_mirrored)
-         , variant(_variant)
-        {}
-
-        inline bool operator<(const FileInfo& other) const
-        {
-            int compare = fileName.compare(other.fileName);
-            if (compare < 0)
-                return true;
-            if (compare > 0)
-                return false;
-
-            if (variant < other.variant)
-                return true;
-            if (variant > other.variant)
-                return false;
-
-            return !mirrored && mirrored != other.mirrored;
-        }
-    };
     std::map<FileInfo, ModelInfo> m_models;
+    std::set<FileInfo> m_usedModels;
     std::vector<int> m_copiesBaseRanks;
     CEngine* m_engine;
 };
@@ -23,6 +23,7 @@
 #include "app/app.h"
 
 #include "common/logger.h"
+#include "common/profiler.h"
 
 #include "graphics/core/device.h"
 
@@ -44,8 +45,14 @@
 
 #include "sound/sound.h"
 
+#include <algorithm>
 #include <cstring>
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define PARTICLE_SSE
+#include <xmmintrin.h>
+#endif
+
 
 // Graphics module namespace
 namespace Gfx
@@ -55,6 +62,11 @@ namespace Gfx
 const float FOG_HSUP    = 10.0f;
 const float FOG_HINF    = 100.0f;
 
+//! Number of removable particles compared before removing one to make room
+const int   EVICT_CANDIDATES = 32;
+//! Distance at which a particle counts as much as one at the end of its life
+const float EVICT_DISTANCE   = 200.0f;
+
 
 //! Check if an object is a destroyable enemy
 static bool IsAlien(ObjectType type)
@@ -88,8 +100,8 @@ void CParticle::SetDevice(CDevice* device)
 
 void CParticle::FlushParticle()
 {
-    for (int i = 0; i < MAXPARTICULE*MAXPARTITYPE; i++)
-        m_particle[i].used = false;
+    for (int i = 0; i < static_cast<int>(m_particle.size()); i++)
+        SetUsed(i, false);
 
     for (int i = 0; i < MAXPARTITYPE; i++)
     {
@@ -99,8 +111,12 @@ void CParticle::FlushParticle()
         }
     }
 
-    for (int i = 0; i < MAXTRACK; i++)
+    m_freeTracks.clear();
+    for (int i = static_cast<int>(m_track.size())-1; i >= 0; i--)
+    {
         m_track[i].used = false;
+        m_freeTracks.push_back(i);
+    }
 
     m_wheelTraceTotal = 0;
     m_wheelTraceIndex = 0;
@@ -110,23 +126,30 @@ void CParticle::FlushParticle()
 
     m_fogTotal = 0;
     m_exploGunCounter = 0;
+
+    m_peakCount = 0;
+    m_droppedCount = 0;
 }
 
 void CParticle::FlushParticle(int sheet)
 {
-    for (int i = 0; i < MAXPARTICULE*MAXPARTITYPE; i++)
+    for (int i = 0; i < static_cast<int>(m_particle.size()); i++)
     {
         if (!m_particle[i].used) continue;
         if (m_particle[i].sheet != sheet) continue;
 
-        m_particle[i].used = false;
+        SetUsed(i, false);
     }
 
     for (int i = 0; i < MAXPARTITYPE; i++)
         m_totalInterface[i][sheet] = 0;
 
-    for (int i = 0; i < MAXTRACK; i++)
+    m_freeTracks.clear();
+    for (int i = static_cast<int>(m_track.size())-1; i >= 0; i--)
+    {
         m_track[i].used = false;
+        m_freeTracks.push_back(i);
+    }
 
     if (sheet == SH_WORLD)
     {
@@ -174,15 +197,9 @@ static char RandomLetter()
     return chars[rand()%chars.size()];
 }
 
-/** Returns the channel of the particle created or -1 on error. */
-int CParticle::CreateParticle(Math::Vector pos, Math::Vector speed, Math::Point dim,
-                              ParticleType type,
-                              float duration, float mass,
-                              float windSensitivity, int sheet)
+/** Returns the texture type, -1 if the particle can't be created by CreateParticle(). */
+int CParticle::GetParticleFamily(ParticleType type)
 {
-    if (m_main == nullptr)
-        m_main = CRobotMain::GetInstancePointer();
-
     int t = -1;
     if ( type == PARTIEXPLOT   ||
          type == PARTIEXPLOO   ||
@@ -284,74 +301,79 @@ int CParticle::CreateParticle(Math::Vector pos, Math::Vector speed, Math::Point
     {
         t = 5; // text render
     }
-    if (t >= MAXPARTITYPE) return -1;
-    if (t == -1) return -1;
-
-    for (int j = 0; j < MAXPARTICULE; j++)
-    {
-        int i = MAXPARTICULE*t+j;
-
-        if (! m_particle[i].used)
-        {
-            m_particle[i] = Particle();
-            m_particle[i].used      = true;
-            m_particle[i].ray       = false;
-            m_particle[i].uniqueStamp = m_uniqueStamp++;
-            m_particle[i].sheet     = sheet;
-            m_particle[i].mass      = mass;
-            m_particle[i].duration  = duration;
-            m_particle[i].pos       = pos;
-            m_particle[i].goal      = pos;
-            m_particle[i].speed     = speed;
-            m_particle[i].windSensitivity = windSensitivity;
-            m_particle[i].dim       = dim;
-            m_particle[i].zoom      = 1.0f;
-            m_particle[i].angle     = 0.0f;
-            m_particle[i].intensity = 1.0f;
-            m_particle[i].type      = type;
-            m_particle[i].phase     = PARPHSTART;
-            m_particle[i].texSup.x  = 0.0f;
-            m_particle[i].texSup.y  = 0.0f;
-            m_particle[i].texInf.x  = 0.0f;
-            m_particle[i].texInf.y  = 0.0f;
-            m_particle[i].time      = 0.0f;
-            m_particle[i].phaseTime = 0.0f;
-            m_particle[i].testTime  = 0.0f;
-            m_particle[i].objLink   = nullptr;
-            m_particle[i].objFather = nullptr;
-            m_particle[i].trackRank = -1;
+    return t;
+}
 
-            m_totalInterface[t][sheet] ++;
+/** Returns the channel of the particle created or -1 on error. */
+int CParticle::CreateParticle(Math::Vector pos, Math::Vector speed, Math::Point dim,
+                              ParticleType type,
+                              float duration, float mass,
+                              float windSensitivity, int sheet)
+{
+    if (m_main == nullptr && CRobotMain::IsCreated())
+        m_main = CRobotMain::GetInstancePointer();
 
-            if ( type == PARTIEXPLOT ||
-                 type == PARTIEXPLOO )
-            {
-                m_particle[i].angle = Math::Rand()*Math::PI*2.0f;
-            }
+    int t = GetParticleFamily(type);
+    if (t == -1) return -1;
 
-            if ( type == PARTIGUN1 ||
-                 type == PARTIGUN4 )
-            {
-                m_particle[i].testTime = 1.0f;  // impact immediately
-            }
+    int i = AllocateRank(t, type, sheet);
+    if (i == -1) return -1;
+
+    m_particle[i] = Particle();
+    SetUsed(i, true);
+    m_particle[i].ray       = false;
+    m_particle[i].uniqueStamp = m_uniqueStamp++;
+    m_particle[i].sheet     = sheet;
+    m_particle[i].mass      = mass;
+    m_motion.duration[i]  = duration;
+    m_motion.pos[i]       = pos;
+    m_particle[i].goal      = pos;
+    m_motion.speed[i]     = speed;
+    m_particle[i].windSensitivity = windSensitivity;
+    m_particle[i].dim       = dim;
+    m_motion.zoom[i]      = 1.0f;
+    m_particle[i].angle     = 0.0f;
+    m_particle[i].intensity = 1.0f;
+    m_particle[i].type      = type;
+    m_particle[i].phase     = PARPHSTART;
+    m_particle[i].texSup.x  = 0.0f;
+    m_particle[i].texSup.y  = 0.0f;
+    m_particle[i].texInf.x  = 0.0f;
+    m_particle[i].texInf.y  = 0.0f;
+    m_motion.time[i]      = 0.0f;
+    m_motion.phaseTime[i] = 0.0f;
+    m_motion.testTime[i]  = 0.0f;
+    m_particle[i].objLink   = nullptr;
+    m_particle[i].objFather = nullptr;
+    m_particle[i].trackRank = -1;
+
+    m_totalInterface[t][sheet] ++;
+
+    if ( type == PARTIEXPLOT ||
+         type == PARTIEXPLOO )
+    {
+        m_particle[i].angle = Math::Rand()*Math::PI*2.0f;
+    }
 
-            if ( type == PARTIVIRUS )
-            {
-                m_particle[i].text = RandomLetter();
-            }
+    if ( type == PARTIGUN1 ||
+         type == PARTIGUN4 )
+    {
+        m_motion.testTime[i] = 1.0f;  // impact immediately
+    }
 
-            if ( type >= PARTIFOG0 &&
-                 type <= PARTIFOG7 )
-            {
-                if (m_fogTotal < MAXPARTIFOG)
-                m_fog[m_fogTotal++] = i;
-            }
+    if ( type == PARTIVIRUS )
+    {
+        m_particle[i].text = RandomLetter();
+    }
 
-            return i | ((m_particle[i].uniqueStamp&0xffff)<<16);
-        }
+    if ( type >= PARTIFOG0 &&
+         type <= PARTIFOG7 )
+    {
+        if (m_fogTotal < MAXPARTIFOG)
+        m_fog[m_fogTotal++] = i;
     }
 
-    return -1;
+    return i | ((m_particle[i].uniqueStamp&0xffff)<<16);
 }
 
 /** Returns the channel of the particle created or -1 on error */
@@ -362,100 +384,93 @@ int CParticle::CreateFrag(Math::Vector pos, Math::Vector speed,
                           float windSensitivity, int sheet)
 {
     int t = 0;
-    for (int j = 0; j < MAXPARTICULE; j++)
-    {
-        int i = MAXPARTICULE*t+j;
-
-        if (!m_particle[i].used)
-        {
-            m_particle[i] = Particle();
-            m_particle[i].used      = true;
-            m_particle[i].ray       = false;
-            m_particle[i].uniqueStamp = m_uniqueStamp++;
-            m_particle[i].sheet     = sheet;
-            m_particle[i].mass      = mass;
-            m_particle[i].duration  = duration;
-            m_particle[i].pos       = pos;
-            m_particle[i].goal      = pos;
-            m_particle[i].speed     = speed;
-            m_particle[i].windSensitivity = windSensitivity;
-            m_particle[i].zoom      = 1.0f;
-            m_particle[i].angle     = 0.0f;
-            m_particle[i].intensity = 1.0f;
-            m_particle[i].type      = type;
-            m_particle[i].phase     = PARPHSTART;
-            m_particle[i].texSup.x  = 0.0f;
-            m_particle[i].texSup.y  = 0.0f;
-            m_particle[i].texInf.x  = 0.0f;
-            m_particle[i].texInf.y  = 0.0f;
-            m_particle[i].time      = 0.0f;
-            m_particle[i].phaseTime = 0.0f;
-            m_particle[i].testTime  = 0.0f;
-            m_particle[i].objLink   = nullptr;
-            m_particle[i].objFather = nullptr;
-            m_particle[i].trackRank = -1;
-            m_triangle[i] = *triangle;
-
-            m_totalInterface[t][sheet] ++;
-
-            Math::Vector    p1;
-            p1.x = m_triangle[i].triangle[0].coord.x;
-            p1.y = m_triangle[i].triangle[0].coord.y;
-            p1.z = m_triangle[i].triangle[0].coord.z;
-
-            Math::Vector p2;
-            p2.x = m_triangle[i].triangle[1].coord.x;
-            p2.y = m_triangle[i].triangle[1].coord.y;
-            p2.z = m_triangle[i].triangle[1].coord.z;
-
-            Math::Vector p3;
-            p3.x = m_triangle[i].triangle[2].coord.x;
-            p3.y = m_triangle[i].triangle[2].coord.y;
-            p3.z = m_triangle[i].triangle[2].coord.z;
-
-            float l1 = Math::Distance(p1, p2);
-            float l2 = Math::Distance(p2, p3);
-            float l3 = Math::Distance(p3, p1);
-            float dx = fabs(Math::Min(l1, l2, l3))*0.5f;
-            float dy = fabs(Math::Max(l1, l2, l3))*0.5f;
-            p1 = Math::Vector(-dx,  dy, 0.0f);
-            p2 = Math::Vector( dx,  dy, 0.0f);
-            p3 = Math::Vector(-dx, -dy, 0.0f);
-
-            m_triangle[i].triangle[0].coord.x = p1.x;
-            m_triangle[i].triangle[0].coord.y = p1.y;
-            m_triangle[i].triangle[0].coord.z = p1.z;
+    int i = AllocateRank(t, type, sheet);
+    if (i == -1) return -1;
+
+    m_particle[i] = Particle();
+    SetUsed(i, true);
+    m_particle[i].ray       = false;
+    m_particle[i].uniqueStamp = m_uniqueStamp++;
+    m_particle[i].sheet     = sheet;
+    m_particle[i].mass      = mass;
+    m_motion.duration[i]  = duration;
+    m_motion.pos[i]       = pos;
+    m_particle[i].goal      = pos;
+    m_motion.speed[i]     = speed;
+    m_particle[i].windSensitivity = windSensitivity;
+    m_motion.zoom[i]      = 1.0f;
+    m_particle[i].angle     = 0.0f;
+    m_particle[i].intensity = 1.0f;
+    m_particle[i].type      = type;
+    m_particle[i].phase     = PARPHSTART;
+    m_particle[i].texSup.x  = 0.0f;
+    m_particle[i].texSup.y  = 0.0f;
+    m_particle[i].texInf.x  = 0.0f;
+    m_particle[i].texInf.y  = 0.0f;
+    m_motion.time[i]      = 0.0f;
+    m_motion.phaseTime[i] = 0.0f;
+    m_motion.testTime[i]  = 0.0f;
+    m_particle[i].objLink   = nullptr;
+    m_particle[i].objFather = nullptr;
+    m_particle[i].trackRank = -1;
+    m_triangle[i] = *triangle;
+
+    m_totalInterface[t][sheet] ++;
+
+    Math::Vector    p1;
+    p1.x = m_triangle[i].triangle[0].coord.x;
+    p1.y = m_triangle[i].triangle[0].coord.y;
+    p1.z = m_triangle[i].triangle[0].coord.z;
+
+    Math::Vector p2;
+    p2.x = m_triangle[i].triangle[1].coord.x;
+    p2.y = m_triangle[i].triangle[1].coord.y;
+    p2.z = m_triangle[i].triangle[1].coord.z;
+
+    Math::Vector p3;
+    p3.x = m_triangle[i].triangle[2].coord.x;
+    p3.y = m_triangle[i].triangle[2].coord.y;
+    p3.z = m_triangle[i].triangle[2].coord.z;
+
+    float l1 = Math::Distance(p1, p2);
+    float l2 = Math::Distance(p2, p3);
+    float l3 = Math::Distance(p3, p1);
+    float dx = fabs(Math::Min(l1, l2, l3))*0.5f;
+    float dy = fabs(Math::Max(l1, l2, l3))*0.5f;
+    p1 = Math::Vector(-dx,  dy, 0.0f);
+    p2 = Math::Vector( dx,  dy, 0.0f);
+    p3 = Math::Vector(-dx, -dy, 0.0f);
+
+    m_triangle[i].triangle[0].coord.x = p1.x;
+    m_triangle[i].triangle[0].coord.y = p1.y;
+    m_triangle[i].triangle[0].coord.z = p1.z;
+
+    m_triangle[i].triangle[1].coord.x = p2.x;
+    m_triangle[i].triangle[1].coord.y = p2.y;
+    m_triangle[i].triangle[1].coord.z = p2.z;
+
+    m_triangle[i].triangle[2].coord.x = p3.x;
+    m_triangle[i].triangle[2].coord.y = p3.y;
+    m_triangle[i].triangle[2].coord.z = p3.z;
 
-            m_triangle[i].triangle[1].coord.x = p2.x;
-            m_triangle[i].triangle[1].coord.y = p2.y;
-            m_triangle[i].triangle[1].coord.z = p2.z;
-
-            m_triangle[i].triangle[2].coord.x = p3.x;
-            m_triangle[i].triangle[2].coord.y = p3.y;
-            m_triangle[i].triangle[2].coord.z = p3.z;
-
-            Math::Vector n(0.0f, 0.0f, -1.0f);
+    Math::Vector n(0.0f, 0.0f, -1.0f);
 
-            m_triangle[i].triangle[0].normal.x = n.x;
-            m_triangle[i].triangle[0].normal.y = n.y;
-            m_triangle[i].triangle[0].normal.z = n.z;
+    m_triangle[i].triangle[0].normal.x = n.x;
+    m_triangle[i].triangle[0].normal.y = n.y;
+    m_triangle[i].triangle[0].normal.z = n.z;
 
-            m_triangle[i].triangle[1].normal.x = n.x;
-            m_triangle[i].triangle[1].normal.y = n.y;
-            m_triangle[i].triangle[1].normal.z = n.z;
+    m_triangle[i].triangle[1].normal.x = n.x;
+    m_triangle[i].triangle[1].normal.y = n.y;
+    m_triangle[i].triangle[1].normal.z = n.z;
 
-            m_triangle[i].triangle[2].normal.x = n.x;
-            m_triangle[i].triangle[2].normal.y = n.y;
-            m_triangle[i].triangle[2].normal.z = n.z;
+    m_triangle[i].triangle[2].normal.x = n.x;
+    m_triangle[i].triangle[2].normal.y = n.y;
+    m_triangle[i].triangle[2].normal.z = n.z;
 
-            if (type == PARTIFRAG)
-                m_particle[i].angle = Math::Rand()*Math::PI*2.0f;
+    if (type == PARTIFRAG)
+        m_particle[i].angle = Math::Rand()*Math::PI*2.0f;
 
-            return i | ((m_particle[i].uniqueStamp&0xffff)<<16);
-        }
-    }
-
-    return -1;
+    return i | ((m_particle[i].uniqueStamp&0xffff)<<16);
 }
 
 
@@ -466,45 +481,38 @@ int CParticle::CreatePart(Math::Vector pos, Math::Vector speed,
                           float windSensitivity, int sheet)
 {
     int t = 0;
-    for (int j = 0; j < MAXPARTICULE; j++)
-    {
-        int i = MAXPARTICULE*t+j;
-
-        if (!m_particle[i].used)
-        {
-            m_particle[i] = Particle();
-            m_particle[i].used      = true;
-            m_particle[i].ray       = false;
-            m_particle[i].uniqueStamp = m_uniqueStamp++;
-            m_particle[i].sheet     = sheet;
-            m_particle[i].mass      = mass;
-            m_particle[i].weight    = weight;
-            m_particle[i].duration  = duration;
-            m_particle[i].pos       = pos;
-            m_particle[i].goal      = pos;
-            m_particle[i].speed     = speed;
-            m_particle[i].windSensitivity = windSensitivity;
-            m_particle[i].zoom      = 1.0f;
-            m_particle[i].angle     = 0.0f;
-            m_particle[i].intensity = 1.0f;
-            m_particle[i].type      = type;
-            m_particle[i].phase     = PARPHSTART;
-            m_particle[i].texSup.x  = 0.0f;
-            m_particle[i].texSup.y  = 0.0f;
-            m_particle[i].texInf.x  = 0.0f;
-            m_particle[i].texInf.y  = 0.0f;
-            m_particle[i].time      = 0.0f;
-            m_particle[i].phaseTime = 0.0f;
-            m_particle[i].testTime  = 0.0f;
-            m_particle[i].trackRank = -1;
-
-            m_totalInterface[t][sheet] ++;
-
-            return i | ((m_particle[i].uniqueStamp&0xffff)<<16);
-        }
-    }
-
-    return -1;
+    int i = AllocateRank(t, type, sheet);
+    if (i == -1) return -1;
+
+    m_particle[i] = Particle();
+    SetUsed(i, true);
+    m_particle[i].ray       = false;
+    m_particle[i].uniqueStamp = m_uniqueStamp++;
+    m_particle[i].sheet     = sheet;
+    m_particle[i].mass      = mass;
+    m_particle[i].weight    = weight;
+    m_motion.duration[i]  = duration;
+    m_motion.pos[i]       = pos;
+    m_particle[i].goal      = pos;
+    m_motion.speed[i]     = speed;
+    m_particle[i].windSensitivity = windSensitivity;
+    m_motion.zoom[i]      = 1.0f;
+    m_particle[i].angle     = 0.0f;
+    m_particle[i].intensity = 1.0f;
+    m_particle[i].type      = type;
+    m_particle[i].phase     = PARPHSTART;
+    m_particle[i].texSup.x  = 0.0f;
+    m_particle[i].texSup.y  = 0.0f;
+    m_particle[i].texInf.x  = 0.0f;
+    m_particle[i].texInf.y  = 0.0f;
+    m_motion.time[i]      = 0.0f;
+    m_motion.phaseTime[i] = 0.0f;
+    m_motion.testTime[i]  = 0.0f;
+    m_particle[i].trackRank = -1;
+
+    m_totalInterface[t][sheet] ++;
+
+    return i | ((m_particle[i].uniqueStamp&0xffff)<<16);
 }
 
 /** Returns the channel of the particle created or -1 on error */
@@ -519,50 +527,42 @@ int CParticle::CreateRay(Math::Vector pos, Math::Vector goal,
     {
         t = 3;  // effect02
     }
-    if (t >= MAXPARTITYPE) return -1;
     if (t == -1) return -1;
 
-    for (int j = 0; j < MAXPARTICULE; j++)
-    {
-        int i = MAXPARTICULE*t+j;
-
-        if (!m_particle[i].used)
-        {
-            m_particle[i] = Particle();
-            m_particle[i].used      = true;
-            m_particle[i].ray       = true;
-            m_particle[i].uniqueStamp = m_uniqueStamp++;
-            m_particle[i].sheet     = sheet;
-            m_particle[i].mass      = 0.0f;
-            m_particle[i].duration  = duration;
-            m_particle[i].pos       = pos;
-            m_particle[i].goal      = goal;
-            m_particle[i].speed     = Math::Vector(0.0f, 0.0f, 0.0f);
-            m_particle[i].windSensitivity = 0.0f;
-            m_particle[i].dim       = dim;
-            m_particle[i].zoom      = 1.0f;
-            m_particle[i].angle     = 0.0f;
-            m_particle[i].intensity = 1.0f;
-            m_particle[i].type      = type;
-            m_particle[i].phase     = PARPHSTART;
-            m_particle[i].texSup.x  = 0.0f;
-            m_particle[i].texSup.y  = 0.0f;
-            m_particle[i].texInf.x  = 0.0f;
-            m_particle[i].texInf.y  = 0.0f;
-            m_particle[i].time      = 0.0f;
-            m_particle[i].phaseTime = 0.0f;
-            m_particle[i].testTime  = 0.0f;
-            m_particle[i].objLink   = nullptr;
-            m_particle[i].objFather = nullptr;
-            m_particle[i].trackRank = -1;
-
-            m_totalInterface[t][sheet] ++;
-
-            return i | ((m_particle[i].uniqueStamp&0xffff)<<16);
-        }
-    }
-
-    return -1;
+    int i = AllocateRank(t, type, sheet);
+    if (i == -1) return -1;
+
+    m_particle[i] = Particle();
+    SetUsed(i, true);
+    m_particle[i].ray       = true;
+    m_particle[i].uniqueStamp = m_uniqueStamp++;
+    m_particle[i].sheet     = sheet;
+    m_particle[i].mass      = 0.0f;
+    m_motion.duration[i]  = duration;
+    m_motion.pos[i]       = pos;
+    m_particle[i].goal      = goal;
+    m_motion.speed[i]     = Math::Vector(0.0f, 0.0f, 0.0f);
+    m_particle[i].windSensitivity = 0.0f;
+    m_particle[i].dim       = dim;
+    m_motion.zoom[i]      = 1.0f;
+    m_particle[i].angle     = 0.0f;
+    m_particle[i].intensity = 1.0f;
+    m_particle[i].type      = type;
+    m_particle[i].phase     = PARPHSTART;
+    m_particle[i].texSup.x  = 0.0f;
+    m_particle[i].texSup.y  = 0.0f;
+    m_particle[i].texInf.x  = 0.0f;
+    m_particle[i].texInf.y  = 0.0f;
+    m_motion.time[i]      = 0.0f;
+    m_motion.phaseTime[i] = 0.0f;
+    m_motion.testTime[i]  = 0.0f;
+    m_particle[i].objLink   = nullptr;
+    m_particle[i].objFather = nullptr;
+    m_particle[i].trackRank = -1;
+
+    m_totalInterface[t][sheet] ++;
+
+    return i | ((m_particle[i].uniqueStamp&0xffff)<<16);
 }
 
 /** "length" is the length of the tail of drag (in seconds)! */
@@ -574,26 +574,28 @@ int CParticle::CreateTrack(Math::Vector pos, Math::Vector speed, Math::Point dim
     int channel = CreateParticle(pos, speed, dim, type, duration, mass, 0.0f, 0);
     if (channel == -1) return -1;
 
-    // Seeks a streak free.
-    for (int i = 0; i < MAXTRACK; i++)
-    {
-        if (!m_track[i].used)  // free?
-        {
-            int rank = channel;
-            if (!CheckChannel(rank)) return -1;
-            m_particle[rank].trackRank = i;
+    int rank = channel;
+    if (!CheckChannel(rank)) return -1;
 
-            m_track[i].used = true;
-            m_track[i].step = (length/duration) / MAXTRACKLEN;
-            m_track[i].last = 0.0f;
-            m_track[i].intensity = 1.0f;
-            m_track[i].width = width;
-            m_track[i].posUsed = 1;
-            m_track[i].head = 0;
-            m_track[i].pos[0] = pos;
-            break;
-        }
+    // Takes a free streak.
+    if (m_freeTracks.empty())
+    {
+        m_freeTracks.push_back(m_track.size());
+        m_track.push_back(Track());
     }
+    int i = m_freeTracks.back();
+    m_freeTracks.pop_back();
+
+    m_particle[rank].trackRank = i;
+
+    m_track[i].used = true;
+    m_track[i].step = (length/duration) / MAXTRACKLEN;
+    m_track[i].last = 0.0f;
+    m_track[i].intensity = 1.0f;
+    m_track[i].width = width;
+    m_track[i].posUsed = 1;
+    m_track[i].head = 0;
+    m_track[i].pos[0] = pos;
 
     return channel;
 }
@@ -602,9 +604,13 @@ void CParticle::CreateWheelTrace(const Math::Vector &p1, const Math::Vector &p2,
                                  const Math::Vector &p3, const Math::Vector &p4,
                                  TraceColor color)
 {
-    int max = MAXWHEELTRACE;
+    int max = m_wheelTraceBudget;
+    if (max <= 0) return;
+    if (static_cast<int>(m_wheelTrace.size()) < max)
+        m_wheelTrace.resize(max);
+
+    if (m_wheelTraceIndex >= max)  m_wheelTraceIndex = 0;
     int i = m_wheelTraceIndex++;
-    if (m_wheelTraceIndex > max)  m_wheelTraceIndex = 0;
 
     m_wheelTrace[i].color = color;
     m_wheelTrace[i].pos[0] = p1;  // ul
@@ -612,7 +618,7 @@ void CParticle::CreateWheelTrace(const Math::Vector &p1, const Math::Vector &p2,
     m_wheelTrace[i].pos[2] = p3;  // ur
     m_wheelTrace[i].pos[3] = p4;  // dr
 
-    if (m_terrain == nullptr)
+    if (m_terrain == nullptr && m_main != nullptr)
         m_terrain = m_main->GetTerrain();
 
     m_terrain->AdjustToFloor(m_wheelTrace[i].pos[0]);
@@ -642,7 +648,7 @@ bool CParticle::CheckChannel(int &channel)
     channel &= 0xffff;
 
     if (channel < 0)  return false;
-    if (channel >= MAXPARTICULE*MAXPARTITYPE) return false;
+    if (channel >= static_cast<int>(m_particle.size())) return false;
 
     if (!m_particle[channel].used)
     {
@@ -659,21 +665,188 @@ bool CParticle::CheckChannel(int &channel)
     return true;
 }
 
+int CParticle::AllocateRank(int t, ParticleType type, int sheet)
+{
+    bool overBudget = m_liveCount >= m_budget ||
+                      (m_typeBudget[t] > 0 && m_typeLive[t] >= m_typeBudget[t]);
+
+    if (!overBudget && m_freeRanks[t].empty())
+        overBudget = !AddPage(t);
+
+    if (overBudget && !EvictRank(t, type, sheet))
+    {
+        m_droppedCount++;
+        return -1;
+    }
+
+    int rank = m_freeRanks[t].back();
+    m_freeRanks[t].pop_back();
+    return rank;
+}
+
+bool CParticle::AddPage(int t)
+{
+    int page = m_pageFamily.size();
+    int total = (page+1)*PARTIPAGE;
+    if (total > MAXPARTIRANK) return false;
+
+    m_pageFamily.push_back(t);
+    m_pages[t].push_back(page);
+    m_used.push_back(0);
+    m_frameActive.push_back(0);
+
+    m_particle.resize(total);
+    m_motion.pos.resize(total);
+    m_motion.speed.resize(total);
+    m_motion.duration.resize(total, 0.0f);
+    m_motion.zoom.resize(total, 0.0f);
+    m_motion.time.resize(total, 0.0f);
+    m_motion.phaseTime.resize(total, 0.0f);
+    m_motion.testTime.resize(total, 0.0f);
+    m_frameMove.resize(total, 0.0f);
+    m_frameTime.resize(total, 0.0f);
+    if (t == 0)
+        m_triangle.resize(total);
+
+    // Lowest ranks are taken first
+    for (int i = total-1; i >= page*PARTIPAGE; i--)
+        m_freeRanks[t].push_back(i);
+
+    return true;
+}
+
+/**
+ * Compares a few removable particles, starting where the last search stopped.
+ * The one closest to its end of life and farthest from the camera goes.
+ * Only pure visual effects can be removed, and only for another effect.
+ */
+bool CParticle::EvictRank(int t, ParticleType type, int sheet)
+{
+    if (sheet != SH_WORLD) return false;
+
+    int pageTotal = m_pages[t].size();
+    if (pageTotal == 0) return false;
+
+    int victim = -1;
+    float victimScore = 0.0f;
+    int candidates = 0;
+
+    int first = m_evictCursor[t] % pageTotal;
+    for (int n = 0; n < pageTotal && candidates < EVICT_CANDIDATES; n++)
+    {
+        int p = (first+n) % pageTotal;
+        int page = m_pages[t][p];
+        m_evictCursor[t] = p+1;
+
+        uint64_t used = m_used[page];
+        for (int b = 0; used != 0; b++, used >>= 1)
+        {
+            if ((used & 1) == 0) continue;
+
+            int i = page*PARTIPAGE + b;
+            if (!IsEvictable(i)) continue;
+
+            float score = 0.0f;
+            if (m_motion.duration[i] > 0.0f)
+                score += m_motion.time[i]/m_motion.duration[i];
+            score += Math::Distance(m_motion.pos[i], m_eyePt)/EVICT_DISTANCE;
+
+            if (victim == -1 || score > victimScore)
+            {
+                victim = i;
+                victimScore = score;
+            }
+            candidates++;
+        }
+    }
+
+    if (victim == -1) return false;
+
+    DeleteRank(victim);
+    return true;
+}
+
+bool CParticle::IsEvictable(int rank)
+{
+    if (rank == m_frameRank) return false;  // being updated
+
+    const Particle& p = m_particle[rank];
+    if (p.sheet != SH_WORLD) return false;
+    if (p.objLink != nullptr) return false;
+    if (p.trackRank != -1) return false;
+    if (p.ray) return false;
+
+    // Particles with a meaning in the game or kept by their creator
+    if ( p.type == PARTIGUN1    ||
+         p.type == PARTIGUN2    ||
+         p.type == PARTIGUN3    ||
+         p.type == PARTIGUN4    ||
+         p.type == PARTIQUARTZ  ||
+         p.type == PARTISELY    ||
+         p.type == PARTISELR    ||
+         p.type == PARTITOTO    ||
+         p.type == PARTICONTROL ||
+         p.type == PARTISHOW    ||
+         p.type == PARTIGFLAT   ||
+         p.type == PARTIERROR   ||
+         p.type == PARTIWARNING ||
+         p.type == PARTIINFO    )
+        return false;
+
+    if (p.type >= PARTISPHERE0 && p.type <= PARTISPHERE6) return false;
+    if (p.type >= PARTIFOG0 && p.type <= PARTIFOG7) return false;
+    if (p.type >= PARTILIMIT1 && p.type <= PARTILIMIT3) return false;
+
+    return true;
+}
+
+void CParticle::SetUsed(int rank, bool used)
+{
+    if (m_particle[rank].used == used) return;
+
+    int page = rank/PARTIPAGE;
+    int t = m_pageFamily[page];
+    uint64_t bit = static_cast<uint64_t>(1) << (rank%PARTIPAGE);
+
+    m_particle[rank].used = used;
+    if (used)
+    {
+        m_used[page] |= bit;
+        m_typeLive[t]++;
+        m_liveCount++;
+        m_peakCount = std::max(m_peakCount, m_liveCount);
+    }
+    else
+    {
+        m_used[page] &= ~bit;
+        m_frameActive[page] &= ~bit;  // no longer updated in current frame
+        m_frameMove[rank] = 0.0f;
+        m_frameTime[rank] = 0.0f;
+        m_typeLive[t]--;
+        m_liveCount--;
+        m_freeRanks[t].push_back(rank);
+    }
+}
+
 void CParticle::DeleteRank(int rank)
 {
-    if (m_totalInterface[rank/MAXPARTICULE][m_particle[rank].sheet] > 0)
-        m_totalInterface[rank/MAXPARTICULE][m_particle[rank].sheet]--;
+    int t = m_pageFamily[rank/PARTIPAGE];
+    if (m_totalInterface[t][m_particle[rank].sheet] > 0)
+        m_totalInterface[t][m_particle[rank].sheet]--;
 
     int i = m_particle[rank].trackRank;
     if (i != -1)  // drag associated?
+    {
         m_track[i].used = false;  // frees the drag
+        m_freeTracks.push_back(i);
+    }
 
-    m_particle[rank].used = false;
+    SetUsed(rank, false);
 }
 
 void CParticle::DeleteParticle(ParticleType type)
 {
-    for (int i = 0; i < MAXPARTICULE*MAXPARTITYPE; i++)
+    for (int i = 0; i < static_cast<int>(m_particle.size()); i++)
     {
         if (!m_particle[i].used) continue;
         if (m_particle[i].type != type) continue;
@@ -686,14 +859,7 @@ void CParticle::DeleteParticle(int channel)
 {
     if (!CheckChannel(channel)) return;
 
-    if (m_totalInterface[channel/MAXPARTICULE][m_particle[channel].sheet] > 0 )
-        m_totalInterface[channel/MAXPARTICULE][m_particle[channel].sheet]--;
-
-    int i = m_particle[channel].trackRank;
-    if (i != -1)  // drag associated?
-        m_track[i].used = false;  // frees the drag
-
-    m_particle[channel].used = false;
+    DeleteRank(channel);
 }
 
 void CParticle::SetObjectLink(int channel, CObject *object)
@@ -711,7 +877,7 @@ void CParticle::SetObjectFather(int channel, CObject *object)
 void CParticle::SetPosition(int channel, Math::Vector pos)
 {
     if (!CheckChannel(channel))  return;
-    m_particle[channel].pos = pos;
+    m_motion.pos[channel] = pos;
 }
 
 void CParticle::SetDimension(int channel, Math::Point dim)
@@ -723,7 +889,7 @@ void CParticle::SetDimension(int channel, Math::Point dim)
 void CParticle::SetZoom(int channel, float zoom)
 {
     if (!CheckChannel(channel))  return;
-    m_particle[channel].zoom = zoom;
+    m_motion.zoom[channel] = zoom;
 }
 
 void CParticle::SetAngle(int channel, float angle)
@@ -742,9 +908,9 @@ void CParticle::SetParam(int channel, Math::Vector pos, Math::Point dim, float z
                           float angle, float intensity)
 {
     if (!CheckChannel(channel))  return;
-    m_particle[channel].pos       = pos;
+    m_motion.pos[channel]       = pos;
     m_particle[channel].dim       = dim;
-    m_particle[channel].zoom      = zoom;
+    m_motion.zoom[channel]      = zoom;
     m_particle[channel].angle     = angle;
     m_particle[channel].intensity = intensity;
 }
@@ -753,14 +919,14 @@ void CParticle::SetPhase(int channel, ParticlePhase phase, float duration)
 {
     if (!CheckChannel(channel))  return;
     m_particle[channel].phase = phase;
-    m_particle[channel].duration = duration;
-    m_particle[channel].phaseTime = m_particle[channel].time;
+    m_motion.duration[channel] = duration;
+    m_motion.phaseTime[channel] = m_motion.time[channel];
 }
 
 bool CParticle::GetPosition(int channel, Math::Vector &pos)
 {
     if (!CheckChannel(channel))  return false;
-    pos = m_particle[channel].pos;
+    pos = m_motion.pos[channel];
     return true;
 }
 
@@ -771,12 +937,12 @@ void CParticle::SetFrameUpdate(int sheet, bool update)
 
 void CParticle::FrameParticle(float rTime)
 {
-    if (m_main == nullptr)
+    if (m_main == nullptr && CRobotMain::IsCreated())
         m_main = CRobotMain::GetInstancePointer();
 
-    bool pause = (m_engine->GetPause() && !m_main->GetInfoLock());
+    bool pause = (m_engine->GetPause() && (m_main == nullptr || !m_main->GetInfoLock()));
 
-    if (m_terrain == nullptr)
+    if (m_terrain == nullptr && m_main != nullptr)
         m_terrain = m_main->GetTerrain();
 
     if (m_water == nullptr)
@@ -790,45 +956,87 @@ void CParticle::FrameParticle(float rTime)
 
     Math::Vector wind = m_terrain->GetWind();
     Math::Vector eye = m_engine->GetEyePt();
+    m_eyePt = eye;
+
+    // Selects the particles to update, going through used ones only.
+    m_framePages.clear();
+    for (int t = 0; t < MAXPARTITYPE; t++)
+    {
+        for (int page : m_pages[t])
+        {
+            m_framePages.push_back(page);
+            m_frameActive[page] = 0;
+
+            uint64_t used = m_used[page];
+            for (int b = 0; used != 0; b++, used >>= 1)
+            {
+                if ((used & 1) == 0) continue;
+
+                int i = page*PARTIPAGE + b;
+                m_frameTime[i] = 0.0f;
+                m_frameMove[i] = 0.0f;
+
+                if (!m_frameUpdate[m_particle[i].sheet]) continue;
+
+                if (m_particle[i].type != PARTISHOW)
+                {
+                    if (pause && m_particle[i].sheet != SH_INTERFACE) continue;
+                }
+
+                m_frameActive[page] |= static_cast<uint64_t>(1) << b;
+                m_frameTime[i] = rTime;
+                if (m_particle[i].type != PARTIQUARTZ)
+                    m_frameMove[i] = rTime;
+            }
+
+            if (m_frameActive[page] != 0)
+                MoveParticles(page*PARTIPAGE, PARTIPAGE);
+        }
+    }
 
     Math::Point ts, ti;
     Math::Vector pos;
 
-    for (int i = 0; i < MAXPARTICULE*MAXPARTITYPE; i++)
+    // Then the behaviour of each type, one particle at a time.
+    // Particles created meanwhile are updated from next frame on.
+    int frameTotal = m_framePages.size()*PARTIPAGE;
+    for (int k = 0; k < frameTotal; k++)
     {
-        if (!m_particle[i].used) continue;
-        if (!m_frameUpdate[m_particle[i].sheet]) continue;
-
-        if (m_particle[i].type != PARTISHOW)
+        // The set is read again for each particle, as updating a particle can delete other ones.
+        int page = m_framePages[k/PARTIPAGE];
+        uint64_t active = m_frameActive[page] >> (k%PARTIPAGE);
+        if (active == 0)  // nothing left in this page?
         {
-            if (pause && m_particle[i].sheet != SH_INTERFACE) continue;
+            k += PARTIPAGE - k%PARTIPAGE - 1;
+            continue;
         }
+        if ((active & 1) == 0) continue;
 
-        if (m_particle[i].type != PARTIQUARTZ)
-            m_particle[i].pos += m_particle[i].speed*rTime;
+        int i = page*PARTIPAGE + k%PARTIPAGE;
+        m_frameRank = i;
 
         if (m_particle[i].sheet == SH_WORLD)
         {
             float h = rTime*m_particle[i].windSensitivity*Math::Rand()*2.0f;
-            m_particle[i].pos += wind*h;
+            m_motion.pos[i] += wind*h;
         }
 
-        float progress = (m_particle[i].time-m_particle[i].phaseTime)/m_particle[i].duration;
+        float progress = (m_motion.time[i]-m_motion.phaseTime[i])/m_motion.duration[i];
 
         // Manages the particles with mass that bounce.
         if ( m_particle[i].mass != 0.0f        &&
              m_particle[i].type != PARTIQUARTZ )
         {
-            m_particle[i].speed.y -= m_particle[i].mass*rTime;
+            m_motion.speed[i].y -= m_particle[i].mass*rTime;
 
             float h;
             if (m_particle[i].sheet == SH_INTERFACE)
                 h = 0.0f;
             else
-                h = m_terrain->GetFloorLevel(m_particle[i].pos, true);
+                h = m_terrain->GetFloorLevel(m_motion.pos[i], true);
 
             h += m_particle[i].dim.y*0.75f;
-            if (m_particle[i].pos.y < h)  // impact with the ground?
+            if (m_motion.pos[i].y < h)  // impact with the ground?
             {
                 if ( m_particle[i].type == PARTIPART &&
                      m_particle[i].weight > 3.0f &&  // heavy enough?
@@ -839,22 +1047,22 @@ void CParticle::FrameParticle(float rTime)
                     if (amplitude > 1.0f)  amplitude = 1.0f;
                     if (amplitude > 0.0f)
                     {
-                        Play(SOUND_BOUM, m_particle[i].pos, amplitude);
+                        Play(SOUND_BOUM, m_motion.pos[i], amplitude);
                     }
                 }
 
                 if (m_particle[i].bounce < 3)
                 {
-                    m_particle[i].pos.y = h;
-                    m_particle[i].speed.y *= -0.4f;
-                    m_particle[i].speed.x *=  0.4f;
-                    m_particle[i].speed.z *=  0.4f;
+                    m_motion.pos[i].y = h;
+                    m_motion.speed[i].y *= -0.4f;
+                    m_motion.speed[i].x *=  0.4f;
+                    m_motion.speed[i].z *=  0.4f;
                     m_particle[i].bounce ++;  // more impact
                 }
                 else    // disappears after 3 bounces?
                 {
-                    if ( m_particle[i].pos.y < h-10.0f ||
-                         m_particle[i].time >= 20.0f   )
+                    if ( m_motion.pos[i].y < h-10.0f ||
+                         m_motion.time[i] >= 20.0f   )
                     {
                         DeleteRank(i);
                         continue;
@@ -867,7 +1075,7 @@ void CParticle::FrameParticle(float rTime)
         int r = m_particle[i].trackRank;
         if (r != -1)  // drag exists?
         {
-            if (TrackMove(r, m_particle[i].pos, progress))
+            if (TrackMove(r, m_motion.pos[i], progress))
             {
                 DeleteRank(i);
                 continue;
@@ -878,7 +1086,7 @@ void CParticle::FrameParticle(float rTime)
 
         if (m_particle[i].type == PARTITRACK1)  // technical explosion?
         {
-            m_particle[i].zoom = 1.0f-(m_particle[i].time-m_particle[i].duration);
+            m_motion.zoom[i] = 1.0f-(m_motion.time[i]-m_motion.duration[i]);
 
             ts.x = 0.375f;
             ts.y = 0.000f;
@@ -888,7 +1096,7 @@ void CParticle::FrameParticle(float rTime)
 
         if (m_particle[i].type == PARTITRACK2)  // spray blue?
         {
-            m_particle[i].zoom = 1.0f-(m_particle[i].time-m_particle[i].duration);
+            m_motion.zoom[i] = 1.0f-(m_motion.time[i]-m_motion.duration[i]);
 
             ts.x = 0.500f;
             ts.y = 0.000f;
@@ -898,7 +1106,7 @@ void CParticle::FrameParticle(float rTime)
 
         if (m_particle[i].type == PARTITRACK3)  // spider?
         {
-            m_particle[i].zoom = 1.0f-(m_particle[i].time-m_particle[i].duration);
+            m_motion.zoom[i] = 1.0f-(m_motion.time[i]-m_motion.duration[i]);
 
             ts.x = 0.500f;
             ts.y = 0.750f;
@@ -908,7 +1116,7 @@ void CParticle::FrameParticle(float rTime)
 
         if (m_particle[i].type == PARTITRACK4)  // insect explosion?
         {
-            m_particle[i].zoom = 1.0f-(m_particle[i].time-m_particle[i].duration);
+            m_motion.zoom[i] = 1.0f-(m_motion.time[i]-m_motion.duration[i]);
 
             ts.x = 0.625f;
             ts.y = 0.000f;
@@ -918,7 +1126,7 @@ void CParticle::FrameParticle(float rTime)
 
         if (m_particle[i].type == PARTITRACK5)  // derrick?
         {
-            m_particle[i].zoom = 1.0f-(m_particle[i].time-m_particle[i].duration);
+            m_motion.zoom[i] = 1.0f-(m_motion.time[i]-m_motion.duration[i]);
 
             ts.x = 0.750f;
             ts.y = 0.000f;
@@ -939,7 +1147,7 @@ void CParticle::FrameParticle(float rTime)
              m_particle[i].type == PARTITRACK9  ||  // win-3 ?
              m_particle[i].type == PARTITRACK10 )   // win-4 ?
         {
-            m_particle[i].zoom = 1.0f-(m_particle[i].time-m_particle[i].duration);
+            m_motion.zoom[i] = 1.0f-(m_motion.time[i]-m_motion.duration[i]);
 
             ts.x = 0.25f*(m_particle[i].type-PARTITRACK7);
             ts.y = 0.25f;
@@ -949,14 +1157,14 @@ void CParticle::FrameParticle(float rTime)
 
         if (m_particle[i].type == PARTITRACK11)  // phazer shot?
         {
-            CObject* object = SearchObjectGun(m_particle[i].goal, m_particle[i].pos, m_particle[i].type, m_particle[i].objFather);
-            m_particle[i].goal = m_particle[i].pos;
+            CObject* object = SearchObjectGun(m_particle[i].goal, m_motion.pos[i], m_particle[i].type, m_particle[i].objFather);
+            m_particle[i].goal = m_motion.pos[i];
             if (object != nullptr && object->Implements(ObjectInterfaceType::Damageable))
             {
                 dynamic_cast<CDamageableObject&>(*object).DamageObject(DamageType::Phazer, 0.002f, m_particle[i].objFather);
             }
 
-            m_particle[i].zoom = 1.0f-(m_particle[i].time-m_particle[i].duration);
+            m_motion.zoom[i] = 1.0f-(m_motion.time[i]-m_motion.duration[i]);
 
             ts.x = 0.375f;
             ts.y = 0.000f;
@@ -966,7 +1174,7 @@ void CParticle::FrameParticle(float rTime)
 
         if (m_particle[i].type == PARTITRACK12)  // drag reactor?
         {
-            m_particle[i].zoom = 1.0f;
+            m_motion.zoom[i] = 1.0f;
 
             ts.x = 0.375f;
             ts.y = 0.000f;
@@ -982,7 +1190,7 @@ void CParticle::FrameParticle(float rTime)
                 continue;
             }
 
-            m_particle[i].zoom = 1.0f-progress;
+            m_motion.zoom[i] = 1.0f-progress;
             m_particle[i].intensity = 1.0f-progress;
 
             ts.x = 0.000f;
@@ -999,7 +1207,7 @@ void CParticle::FrameParticle(float rTime)
                 continue;
             }
 
-            m_particle[i].zoom = 1.0f-progress;
+            m_motion.zoom[i] = 1.0f-progress;
             m_particle[i].angle = Math::Rand()*Math::PI*2.0f;
 
             ts.x = 0.125f;
@@ -1017,7 +1225,7 @@ void CParticle::FrameParticle(float rTime)
             }
 
             if (progress < 0.25f)
-                m_particle[i].zoom = progress/0.25f;
+                m_motion.zoom[i] = progress/0.25f;
             else
                 m_particle[i].intensity = 1.0f-(progress-0.25f)/0.75f;
 
@@ -1036,7 +1244,7 @@ void CParticle::FrameParticle(float rTime)
             }
 
             m_particle[i].intensity = 1.0f-progress;
-            m_particle[i].zoom = 1.0f+progress*3.0f;
+            m_motion.zoom[i] = 1.0f+progress*3.0f;
 
             ts.x = 0.000f;
             ts.y = 0.750f;
@@ -1052,7 +1260,7 @@ void CParticle::FrameParticle(float rTime)
                 continue;
             }
 
-            m_particle[i].zoom = 1.0f-progress;
+            m_motion.zoom[i] = 1.0f-progress;
 
             ts.x = 0.375f;
             ts.y = 0.750f;
@@ -1068,7 +1276,7 @@ void CParticle::FrameParticle(float rTime)
                 continue;
             }
 
-            m_particle[i].zoom = 1.0f+progress*7.0f;
+            m_motion.zoom[i] = 1.0f+progress*7.0f;
             m_particle[i].intensity = powf(1.0f-progress, 3.0f);
 
             ts.x = 0.375f;
@@ -1087,9 +1295,9 @@ void CParticle::FrameParticle(float rTime)
             }
 
             if (m_particle[i].type == PARTIFIRE)
-                m_particle[i].zoom = 1.0f-progress;
+                m_motion.zoom[i] = 1.0f-progress;
             else
-                m_particle[i].zoom = progress;
+                m_motion.zoom[i] = progress;
 
             ts.x = 0.500f;
             ts.y = 0.750f;
@@ -1105,11 +1313,11 @@ void CParticle::FrameParticle(float rTime)
                 continue;
             }
 
-            if (m_particle[i].testTime >= 0.05f)
+            if (m_motion.testTime[i] >= 0.05f)
             {
-                m_particle[i].testTime = 0.0f;
+                m_motion.testTime[i] = 0.0f;
 
-                if (m_terrain->GetHeightToFloor(m_particle[i].pos, true) < -2.0f)
+                if (m_terrain->GetHeightToFloor(m_motion.pos[i], true) < -2.0f)
                 {
                     m_exploGunCounter++;
 
@@ -1150,8 +1358,8 @@ void CParticle::FrameParticle(float rTime)
                     continue;
                 }
 
-                CObject* object = SearchObjectGun(m_particle[i].goal, m_particle[i].pos, m_particle[i].type, m_particle[i].objFather);
-                m_particle[i].goal = m_particle[i].pos;
+                CObject* object = SearchObjectGun(m_particle[i].goal, m_motion.pos[i], m_particle[i].type, m_particle[i].objFather);
+                m_particle[i].goal = m_motion.pos[i];
                 if (object != nullptr)
                 {
                     if (object->Implements(ObjectInterfaceType::Damageable))
@@ -1163,7 +1371,7 @@ void CParticle::FrameParticle(float rTime)
 
                     if (m_exploGunCounter % 2 == 0)
                     {
-                        pos = m_particle[i].pos;
+                        pos = m_motion.pos[i];
                         Math::Vector speed;
                         speed.x = 0.0f;
                         speed.z = 0.0f;
@@ -1199,7 +1407,7 @@ void CParticle::FrameParticle(float rTime)
             }
 
             m_particle[i].angle -= rTime*Math::PI*8.0f;
-            m_particle[i].zoom = 1.0f-progress;
+            m_motion.zoom[i] = 1.0f-progress;
 
             ts.x = 0.00f;
             ts.y = 0.50f;
@@ -1215,20 +1423,20 @@ void CParticle::FrameParticle(float rTime)
                 continue;
             }
 
-            if (m_particle[i].testTime >= 0.1f)
+            if (m_motion.testTime[i] >= 0.1f)
             {
-                m_particle[i].testTime = 0.0f;
-                CObject* object = SearchObjectGun(m_particle[i].goal, m_particle[i].pos, m_particle[i].type, m_particle[i].objFather);
-                m_particle[i].goal = m_particle[i].pos;
+                m_motion.testTime[i] = 0.0f;
+                CObject* object = SearchObjectGun(m_particle[i].goal, m_motion.pos[i], m_particle[i].type, m_particle[i].objFather);
+                m_particle[i].goal = m_motion.pos[i];
                 if (object != nullptr)
                 {
                     if (object->GetType() == OBJECT_MOBILErs && dynamic_cast<CShielder&>(*object).GetActiveShieldRadius() > 0.0f)  // protected by shield?
                     {
-                        CreateParticle(m_particle[i].pos, Math::Vector(0.0f, 0.0f, 0.0f), Math::Point(6.0f, 6.0f), PARTIGUNDEL, 2.0f);
+                        CreateParticle(m_motion.pos[i], Math::Vector(0.0f, 0.0f, 0.0f), Math::Point(6.0f, 6.0f), PARTIGUNDEL, 2.0f);
                         if (m_lastTimeGunDel > 0.2f)
                         {
                             m_lastTimeGunDel = 0.0f;
-                            Play(SOUND_GUNDEL, m_particle[i].pos, 1.0f);
+                            Play(SOUND_GUNDEL, m_motion.pos[i], 1.0f);
                         }
                         DeleteRank(i);
                         continue;
@@ -1236,7 +1444,7 @@ void CParticle::FrameParticle(float rTime)
                     else
                     {
                         if (object->GetType() != OBJECT_HUMAN)
-                            Play(SOUND_TOUCH, m_particle[i].pos, 1.0f);
+                            Play(SOUND_TOUCH, m_motion.pos[i], 1.0f);
 
                         if (object->Implements(ObjectInterfaceType::Damageable))
                         {
@@ -1247,7 +1455,7 @@ void CParticle::FrameParticle(float rTime)
             }
 
             m_particle[i].angle = Math::Rand()*Math::PI*2.0f;
-            m_particle[i].zoom = 1.0f-progress;
+            m_motion.zoom[i] = 1.0f-progress;
 
             ts.x = 0.125f;
             ts.y = 0.875f;
@@ -1263,20 +1471,20 @@ void CParticle::FrameParticle(float rTime)
                 continue;
             }
 
-            if (m_particle[i].testTime >= 0.1f)
+            if (m_motion.testTime[i] >= 0.1f)
             {
-                m_particle[i].testTime = 0.0f;
-                CObject* object = SearchObjectGun(m_particle[i].goal, m_particle[i].pos, m_particle[i].type, m_particle[i].objFather);
-                m_particle[i].goal = m_particle[i].pos;
+                m_motion.testTime[i] = 0.0f;
+                CObject* object = SearchObjectGun(m_particle[i].goal, m_motion.pos[i], m_particle[i].type, m_particle[i].objFather);
+                m_particle[i].goal = m_motion.pos[i];
                 if (object != nullptr)
                 {
                     if (object->GetType() == OBJECT_MOBILErs && dynamic_cast<CShielder&>(*object).GetActiveShieldRadius() > 0.0f)
                     {
-                        CreateParticle(m_particle[i].pos, Math::Vector(0.0f, 0.0f, 0.0f), Math::Point(6.0f, 6.0f), PARTIGUNDEL, 2.0f);
+                        CreateParticle(m_motion.pos[i], Math::Vector(0.0f, 0.0f, 0.0f), Math::Point(6.0f, 6.0f), PARTIGUNDEL, 2.0f);
                         if (m_lastTimeGunDel > 0.2f)
                         {
                             m_lastTimeGunDel = 0.0f;
-                            Play(SOUND_GUNDEL, m_particle[i].pos, 1.0f);
+                            Play(SOUND_GUNDEL, m_motion.pos[i], 1.0f);
                         }
                         DeleteRank(i);
                         continue;
@@ -1305,11 +1513,11 @@ void CParticle::FrameParticle(float rTime)
                 continue;
             }
 
-            if (m_particle[i].testTime >= 0.05f)
+            if (m_motion.testTime[i] >= 0.05f)
             {
-                m_particle[i].testTime = 0.0f;
+                m_motion.testTime[i] = 0.0f;
 
-                if (m_terrain->GetHeightToFloor(m_particle[i].pos, true) < -2.0f)
+                if (m_terrain->GetHeightToFloor(m_motion.pos[i], true) < -2.0f)
                 {
                     m_exploGunCounter ++;
 
@@ -1338,8 +1546,8 @@ void CParticle::FrameParticle(float rTime)
                     continue;
                 }
 
-                CObject* object = SearchObjectGun(m_particle[i].goal, m_particle[i].pos, m_particle[i].type, m_particle[i].objFather);
-                m_particle[i].goal = m_particle[i].pos;
+                CObject* object = SearchObjectGun(m_particle[i].goal, m_motion.pos[i], m_particle[i].type, m_particle[i].objFather);
+                m_particle[i].goal = m_motion.pos[i];
                 if (object != nullptr)
                 {
                     if (object->Implements(ObjectInterfaceType::Damageable))
@@ -1351,7 +1559,7 @@ void CParticle::FrameParticle(float rTime)
 
                     if (m_exploGunCounter % 2 == 0)
                     {
-                        pos = m_particle[i].pos;
+                        pos = m_motion.pos[i];
                         Math::Vector speed;
                         speed.x = 0.0f;
                         speed.z = 0.0f;
@@ -1373,7 +1581,7 @@ void CParticle::FrameParticle(float rTime)
             }
 
             m_particle[i].angle = Math::Rand()*Math::PI*2.0f;
-            m_particle[i].zoom = 1.0f-progress;
+            m_motion.zoom[i] = 1.0f-progress;
 
             ts.x = 0.125f;
             ts.y = 0.875f;
@@ -1389,7 +1597,7 @@ void CParticle::FrameParticle(float rTime)
                 continue;
             }
 
-            m_particle[i].zoom = 0.1f+progress;
+            m_motion.zoom[i] = 0.1f+progress;
             m_particle[i].intensity = 1.0f-progress;
 
             ts.x = 0.00f;
@@ -1408,7 +1616,7 @@ void CParticle::FrameParticle(float rTime)
 
             if (progress < 0.5f) m_particle[i].intensity = progress/0.5f;
             else                 m_particle[i].intensity = 2.0f-progress/0.5f;
-            m_particle[i].zoom = 1.0f-progress*0.8f;
+            m_motion.zoom[i] = 1.0f-progress*0.8f;
             m_particle[i].angle -= rTime*Math::PI*0.5f;
 
             ts.x = 0.50f;
@@ -1425,7 +1633,7 @@ void CParticle::FrameParticle(float rTime)
                 continue;
             }
 
-            m_particle[i].zoom = 0.1f+progress;
+            m_motion.zoom[i] = 0.1f+progress;
             m_particle[i].intensity = 1.0f-progress;
 
             ts.x = 0.50f;
@@ -1442,7 +1650,7 @@ void CParticle::FrameParticle(float rTime)
                 continue;
             }
 
-            m_particle[i].zoom = 0.1f+progress;
+            m_motion.zoom[i] = 0.1f+progress;
             m_particle[i].intensity = 1.0f-progress;
             m_particle[i].angle -= rTime*Math::PI*2.0f;
 
@@ -1460,7 +1668,7 @@ void CParticle::FrameParticle(float rTime)
                 continue;
             }
 
-            m_particle[i].zoom = 1.0f;
+            m_motion.zoom[i] = 1.0f;
             m_particle[i].intensity = 1.0f;
 
             ts.x = 0.000f;
@@ -1476,7 +1684,7 @@ void CParticle::FrameParticle(float rTime)
                 continue;
             }
 
-            m_particle[i].zoom = 1.0f;
+            m_motion.zoom[i] = 1.0f;
             m_particle[i].intensity = 1.0f;
 
             ts.x = 0.375f;
@@ -1492,7 +1700,7 @@ void CParticle::FrameParticle(float rTime)
                 continue;
             }
 
-            m_particle[i].zoom = 1.0f;
+            m_motion.zoom[i] = 1.0f;
             m_particle[i].intensity = 1.0f;
 
             ts.x = 0.500f;
@@ -1503,7 +1711,7 @@ void CParticle::FrameParticle(float rTime)
 
         if (m_particle[i].type == PARTIFOG0)
         {
-            m_particle[i].zoom = progress;
+            m_motion.zoom[i] = progress;
             m_particle[i].intensity = 0.3f+sinf(progress)*0.15f;
             m_particle[i].angle += rTime*0.05f;
 
@@ -1514,7 +1722,7 @@ void CParticle::FrameParticle(float rTime)
         }
         if (m_particle[i].type == PARTIFOG1)
         {
-            m_particle[i].zoom = progress;
+            m_motion.zoom[i] = progress;
             m_particle[i].intensity = 0.3f+sinf(progress)*0.15f;
             m_particle[i].angle -= rTime*0.07f;
 
@@ -1526,7 +1734,7 @@ void CParticle::FrameParticle(float rTime)
 
         if (m_particle[i].type == PARTIFOG2)
         {
-            m_particle[i].zoom = progress;
+            m_motion.zoom[i] = progress;
             m_particle[i].intensity = 0.6f+sinf(progress)*0.15f;
             m_particle[i].angle += rTime*0.05f;
 
@@ -1537,7 +1745,7 @@ void CParticle::FrameParticle(float rTime)
         }
         if (m_particle[i].type == PARTIFOG3)
         {
-            m_particle[i].zoom = progress;
+            m_motion.zoom[i] = progress;
             m_particle[i].intensity = 0.6f+sinf(progress)*0.15f;
             m_particle[i].angle -= rTime*0.07f;
 
@@ -1549,7 +1757,7 @@ void CParticle::FrameParticle(float rTime)
 
         if (m_particle[i].type == PARTIFOG4)
         {
-            m_particle[i].zoom = progress;
+            m_motion.zoom[i] = progress;
             m_particle[i].intensity = 0.5f+sinf(progress)*0.2f;
             m_particle[i].angle += rTime*0.05f;
 
@@ -1560,7 +1768,7 @@ void CParticle::FrameParticle(float rTime)
         }
         if (m_particle[i].type == PARTIFOG5)
         {
-            m_particle[i].zoom = progress;
+            m_motion.zoom[i] = progress;
             m_particle[i].intensity = 0.5f+sinf(progress)*0.2f;
             m_particle[i].angle -= rTime*0.07f;
 
@@ -1572,7 +1780,7 @@ void CParticle::FrameParticle(float rTime)
 
         if (m_particle[i].type == PARTIFOG6)
         {
-            m_particle[i].zoom = progress;
+            m_motion.zoom[i] = progress;
             m_particle[i].intensity = 0.5f+sinf(progress)*0.2f;
             m_particle[i].angle += rTime*0.05f;
 
@@ -1583,7 +1791,7 @@ void CParticle::FrameParticle(float rTime)
         }
         if (m_particle[i].type == PARTIFOG7)
         {
-            m_particle[i].zoom = progress;
+            m_motion.zoom[i] = progress;
             m_particle[i].intensity = 0.5f+sinf(progress)*0.2f;
             m_particle[i].angle -= rTime*0.07f;
 
@@ -1600,15 +1808,15 @@ void CParticle::FrameParticle(float rTime)
         {
             float h = 10.0f;
 
-            if ( m_particle[i].pos.y >= eye.y   &&
-                 m_particle[i].pos.y <  eye.y+h )
+            if ( m_motion.pos[i].y >= eye.y   &&
+                 m_motion.pos[i].y <  eye.y+h )
             {
-                m_particle[i].intensity *= (m_particle[i].pos.y-eye.y)/h;
+                m_particle[i].intensity *= (m_motion.pos[i].y-eye.y)/h;
             }
-            if ( m_particle[i].pos.y >  eye.y-h &&
-                 m_particle[i].pos.y <  eye.y   )
+            if ( m_motion.pos[i].y >  eye.y-h &&
+                 m_motion.pos[i].y <  eye.y   )
             {
-                m_particle[i].intensity *= (eye.y-m_particle[i].pos.y)/h;
+                m_particle[i].intensity *= (eye.y-m_motion.pos[i].y)/h;
             }
         }
 
@@ -1621,7 +1829,7 @@ void CParticle::FrameParticle(float rTime)
                 continue;
             }
 
-            m_particle[i].zoom = 1.0f-progress/2.0f;
+            m_motion.zoom[i] = 1.0f-progress/2.0f;
             m_particle[i].intensity = 1.0f-progress;
 
             if (m_particle[i].type == PARTIEXPLOT)  ts.x = 0.750f;
@@ -1670,7 +1878,7 @@ void CParticle::FrameParticle(float rTime)
                 continue;
             }
 
-            m_particle[i].zoom = 1.0f-progress/2.0f;
+            m_motion.zoom[i] = 1.0f-progress/2.0f;
             if (progress < 0.5f)
             {
                 m_particle[i].intensity = progress/0.5f;
@@ -1689,13 +1897,13 @@ void CParticle::FrameParticle(float rTime)
         if (m_particle[i].type == PARTIBUBBLE)
         {
             if ( progress >= 1.0f ||
-                 m_particle[i].pos.y >= m_water->GetLevel() )
+                 (m_water != nullptr && m_motion.pos[i].y >= m_water->GetLevel()) )
             {
                 DeleteRank(i);
                 continue;
             }
 
-            m_particle[i].zoom = 1.0f-progress/2.0f;
+            m_motion.zoom[i] = 1.0f-progress/2.0f;
             m_particle[i].intensity = 1.0f-progress;
 
             ts.x = 0.250f;
@@ -1716,7 +1924,7 @@ void CParticle::FrameParticle(float rTime)
 
             if (progress < 0.25f)
             {
-                m_particle[i].zoom = progress/0.25f;
+                m_motion.zoom[i] = progress/0.25f;
             }
             else
             {
@@ -1770,7 +1978,7 @@ void CParticle::FrameParticle(float rTime)
             }
 
             if (progress < 0.25f)
-                m_particle[i].zoom = progress/0.25f;
+                m_motion.zoom[i] = progress/0.25f;
             else
                 m_particle[i].intensity = 1.0f-(progress-0.25f)/0.75f;
 
@@ -1785,7 +1993,7 @@ void CParticle::FrameParticle(float rTime)
                 continue;
             }
 
-            m_particle[i].zoom = 1.0f-progress;
+            m_motion.zoom[i] = 1.0f-progress;
 
             ts.x = 0.625f;
             ts.y = 0.750f;
@@ -1803,7 +2011,7 @@ void CParticle::FrameParticle(float rTime)
 
             if (progress < 0.25f)
             {
-                m_particle[i].zoom = progress/0.25f;
+                m_motion.zoom[i] = progress/0.25f;
             }
             else
             {
@@ -1826,7 +2034,7 @@ void CParticle::FrameParticle(float rTime)
 
             if (progress < 0.25f)
             {
-                m_particle[i].zoom = progress/0.25f;
+                m_motion.zoom[i] = progress/0.25f;
             }
             else
             {
@@ -1847,7 +2055,7 @@ void CParticle::FrameParticle(float rTime)
                 continue;
             }
 
-            m_particle[i].zoom = 1.0f+powf(progress, 2.0f)*5.0f;
+            m_motion.zoom[i] = 1.0f+powf(progress, 2.0f)*5.0f;
             m_particle[i].intensity = 1.0f-progress;
 
             ts.x = 0.625f;
@@ -1864,7 +2072,7 @@ void CParticle::FrameParticle(float rTime)
                 continue;
             }
 
-            m_particle[i].zoom = 1.0f-progress;
+            m_motion.zoom[i] = 1.0f-progress;
 
             ts.x = 0.625f;
             ts.y = 0.875f;
@@ -1892,11 +2100,11 @@ void CParticle::FrameParticle(float rTime)
 
         if (m_particle[i].type == PARTIQUEUE)
         {
-            if (m_particle[i].testTime >= 0.05f)
+            if (m_motion.testTime[i] >= 0.05f)
             {
-                m_particle[i].testTime = 0.0f;
+                m_motion.testTime[i] = 0.0f;
 
-                pos = m_particle[i].pos;
+                pos = m_motion.pos[i];
                 Math::Vector speed = Math::Vector(0.0f, 0.0f, 0.0f);
                 Math::Point dim;
                 dim.x = 1.0f*(Math::Rand()*0.8f+0.6f);
@@ -1916,11 +2124,11 @@ void CParticle::FrameParticle(float rTime)
             {
                 DeleteRank(i);
 
-                pos = m_particle[i].pos;
+                pos = m_motion.pos[i];
                 Math::Point dim;
                 dim.x    = m_particle[i].dim.x/4.0f;
                 dim.y    = dim.x;
-                float duration = m_particle[i].duration;
+                float duration = m_motion.duration[i];
                 float mass     = m_particle[i].mass;
                 int total = static_cast<int>((10.0f*m_engine->GetParticleDensity()));
                 for (int j = 0; j < total; j++)
@@ -1944,7 +2152,7 @@ void CParticle::FrameParticle(float rTime)
                 continue;
             }
 
-            m_particle[i].zoom = (m_particle[i].time-m_particle[i].duration);
+            m_motion.zoom[i] = (m_motion.time[i]-m_motion.duration[i]);
 
             ts.x = 0.125f;
             ts.y = 0.875f;
@@ -1960,7 +2168,7 @@ void CParticle::FrameParticle(float rTime)
                 continue;
             }
 
-            m_particle[i].zoom = 1.0f-(m_particle[i].time-m_particle[i].duration);
+            m_motion.zoom[i] = 1.0f-(m_motion.time[i]-m_motion.duration[i]);
 
             ts.x = 0.125f;
             ts.y = 0.875f;
@@ -1977,9 +2185,9 @@ void CParticle::FrameParticle(float rTime)
             }
 
             if (progress > 0.5f)
-                m_particle[i].zoom = 1.0f-(progress-0.5f)*2.0f;
+                m_motion.zoom[i] = 1.0f-(progress-0.5f)*2.0f;
 
-            m_particle[i].angle = m_particle[i].time*Math::PI;
+            m_particle[i].angle = m_motion.time[i]*Math::PI;
 
             ts.x = 0.75f;
             ts.y = 0.25f;
@@ -1996,9 +2204,9 @@ void CParticle::FrameParticle(float rTime)
             }
 
             if (progress > 0.5f)
-                m_particle[i].zoom = 1.0f-(progress-0.5f)*2.0f;
+                m_motion.zoom[i] = 1.0f-(progress-0.5f)*2.0f;
 
-            m_particle[i].angle = m_particle[i].time*Math::PI;
+            m_particle[i].angle = m_motion.time[i]*Math::PI;
 
             ts.x = 0.75f;
             ts.y = 0.50f;
@@ -2015,9 +2223,9 @@ void CParticle::FrameParticle(float rTime)
             }
 
             if (progress > 0.5f)
-                m_particle[i].zoom = 1.0f-(progress-0.5f)*2.0f;
+                m_motion.zoom[i] = 1.0f-(progress-0.5f)*2.0f;
 
-            m_particle[i].angle = m_particle[i].time*Math::PI;
+            m_particle[i].angle = m_motion.time[i]*Math::PI;
 
             ts.x = 0.75f;
             ts.y = 0.00f;
@@ -2035,7 +2243,7 @@ void CParticle::FrameParticle(float rTime)
             }
 
             if (progress < 0.5f)
-                m_particle[i].zoom = progress*2.0f;
+                m_motion.zoom[i] = progress*2.0f;
             else
                 m_particle[i].intensity = 1.0f-(progress-0.5f)*2.0f;
 
@@ -2055,11 +2263,11 @@ void CParticle::FrameParticle(float rTime)
 
             if (progress < 0.3f)
             {
-                m_particle[i].zoom = progress/0.3f;
+                m_motion.zoom[i] = progress/0.3f;
             }
             else
             {
-                m_particle[i].zoom = 1.0f;
+                m_motion.zoom[i] = 1.0f;
                 m_particle[i].intensity = 1.0f-(progress-0.3f)/0.7f;
             }
 
@@ -2078,9 +2286,9 @@ void CParticle::FrameParticle(float rTime)
             }
 
             if (progress > 0.5f)
-                m_particle[i].zoom = 1.0f-(m_particle[i].time-m_particle[i].duration/2.0f);
+                m_motion.zoom[i] = 1.0f-(m_motion.time[i]-m_motion.duration[i]/2.0f);
 
-            m_particle[i].angle = m_particle[i].time*Math::PI;
+            m_particle[i].angle = m_motion.time[i]*Math::PI;
 
             ts.x = 0.75f;
             ts.y = 0.50f;
@@ -2092,11 +2300,11 @@ void CParticle::FrameParticle(float rTime)
         {
             if (progress >= 1.0f)
             {
-                m_particle[i].time = 0.0f;
-                m_particle[i].duration = 0.5f+Math::Rand()*2.0f;
-                m_particle[i].pos.x = m_particle[i].speed.x + (Math::Rand()-0.5f)*m_particle[i].mass;
-                m_particle[i].pos.y = m_particle[i].speed.y + (Math::Rand()-0.5f)*m_particle[i].mass;
-                m_particle[i].pos.z = m_particle[i].speed.z + (Math::Rand()-0.5f)*m_particle[i].mass;
+                m_motion.time[i] = 0.0f;
+                m_motion.duration[i] = 0.5f+Math::Rand()*2.0f;
+                m_motion.pos[i].x = m_motion.speed[i].x + (Math::Rand()-0.5f)*m_particle[i].mass;
+                m_motion.pos[i].y = m_motion.speed[i].y + (Math::Rand()-0.5f)*m_particle[i].mass;
+                m_motion.pos[i].z = m_motion.speed[i].z + (Math::Rand()-0.5f)*m_particle[i].mass;
                 m_particle[i].dim.x = 0.5f+Math::Rand()*1.5f;
                 m_particle[i].dim.y = m_particle[i].dim.x;
                 progress = 0.0f;
@@ -2104,12 +2312,12 @@ void CParticle::FrameParticle(float rTime)
 
             if (progress < 0.2f)
             {
-                m_particle[i].zoom = progress/0.2f;
+                m_motion.zoom[i] = progress/0.2f;
                 m_particle[i].intensity = 1.0f;
             }
             else
             {
-                m_particle[i].zoom = 1.0f;
+                m_motion.zoom[i] = 1.0f;
                 m_particle[i].intensity = 1.0f-(progress-0.2f)/0.8f;
             }
 
@@ -2127,7 +2335,7 @@ void CParticle::FrameParticle(float rTime)
                 continue;
             }
 
-            m_particle[i].zoom = 1.0f-progress;
+            m_motion.zoom[i] = 1.0f-progress;
             if (progress < 0.15f)
                 m_particle[i].intensity = progress/0.15f;
             else
@@ -2149,7 +2357,7 @@ void CParticle::FrameParticle(float rTime)
                 continue;
             }
 
-            m_particle[i].zoom = progress*1.0f;
+            m_motion.zoom[i] = progress*1.0f;
             m_particle[i].intensity = 1.0f-progress;
 
             ts.x = 0.500f;
@@ -2166,7 +2374,7 @@ void CParticle::FrameParticle(float rTime)
                 continue;
             }
 
-            m_particle[i].zoom = progress*1.0f;
+            m_motion.zoom[i] = progress*1.0f;
             m_particle[i].intensity = 1.0f-progress;
 
             ts.x = 0.875f;
@@ -2183,7 +2391,7 @@ void CParticle::FrameParticle(float rTime)
                 continue;
             }
 
-            m_particle[i].zoom = progress*1.0f;
+            m_motion.zoom[i] = progress*1.0f;
             m_particle[i].intensity = 1.0f-progress;
 
             ts.x = 0.750f;
@@ -2215,7 +2423,7 @@ void CParticle::FrameParticle(float rTime)
                 continue;
             }
 
-            m_particle[i].zoom = progress*m_particle[i].dim.x;
+            m_motion.zoom[i] = progress*m_particle[i].dim.x;
 
             if (progress < 0.65f)
                 m_particle[i].intensity = progress/0.65f;
@@ -2243,8 +2451,8 @@ void CParticle::FrameParticle(float rTime)
             else
                 m_particle[i].intensity = 1.0f-(progress-0.30f)/0.70f;
 
-            m_particle[i].zoom = progress*m_particle[i].dim.x;
-            m_particle[i].angle = m_particle[i].time*Math::PI*2.0f;
+            m_motion.zoom[i] = progress*m_particle[i].dim.x;
+            m_particle[i].angle = m_motion.time[i]*Math::PI*2.0f;
 
             ts.x = 0.000f;
             ts.y = 0.000f;
@@ -2265,8 +2473,8 @@ void CParticle::FrameParticle(float rTime)
             else
                 m_particle[i].intensity = 1.0f-(progress-0.20f)/0.80f;
 
-            m_particle[i].zoom = progress*m_particle[i].dim.x;
-            m_particle[i].angle = m_particle[i].time*Math::PI*2.0f;
+            m_motion.zoom[i] = progress*m_particle[i].dim.x;
+            m_particle[i].angle = m_motion.time[i]*Math::PI*2.0f;
 
             ts.x = 0.125f;
             ts.y = 0.000f;
@@ -2293,8 +2501,8 @@ void CParticle::FrameParticle(float rTime)
             if (m_particle[i].phase == PARPHEND)
                 m_particle[i].intensity = 1.0f-progress;
 
-            m_particle[i].zoom = m_particle[i].dim.x;
-            m_particle[i].angle = m_particle[i].time*Math::PI*0.2f;
+            m_motion.zoom[i] = m_particle[i].dim.x;
+            m_particle[i].angle = m_motion.time[i]*Math::PI*0.2f;
 
             ts.x = 0.25f;
             ts.y = 0.75f;
@@ -2310,7 +2518,7 @@ void CParticle::FrameParticle(float rTime)
                 continue;
             }
 
-            m_particle[i].zoom = progress*m_particle[i].dim.x;
+            m_motion.zoom[i] = progress*m_particle[i].dim.x;
 
             if (progress < 0.65 )
                 m_particle[i].intensity = progress/0.65f;
@@ -2328,8 +2536,8 @@ void CParticle::FrameParticle(float rTime)
         if (m_particle[i].type == PARTISPHERE5)
         {
             m_particle[i].intensity = 0.7f+sinf(progress)*0.3f;
-            m_particle[i].zoom = m_particle[i].dim.x*(1.0f+sinf(progress*0.7f)*0.01f);
-            m_particle[i].angle = m_particle[i].time*Math::PI*0.2f;
+            m_motion.zoom[i] = m_particle[i].dim.x*(1.0f+sinf(progress*0.7f)*0.01f);
+            m_particle[i].angle = m_motion.time[i]*Math::PI*0.2f;
 
             ts.x = 0.25f;
             ts.y = 0.50f;
@@ -2345,7 +2553,7 @@ void CParticle::FrameParticle(float rTime)
                 continue;
             }
 
-            m_particle[i].zoom = (1.0f-progress)*m_particle[i].dim.x;
+            m_motion.zoom[i] = (1.0f-progress)*m_particle[i].dim.x;
             m_particle[i].intensity = progress*0.5f;
 
             ts.x = 0.125f;
@@ -2362,7 +2570,7 @@ void CParticle::FrameParticle(float rTime)
                 continue;
             }
 
-            m_particle[i].zoom = progress;
+            m_motion.zoom[i] = progress;
             m_particle[i].intensity = 1.0f-progress;
 
             ts.x = 0.50f;
@@ -2374,13 +2582,13 @@ void CParticle::FrameParticle(float rTime)
         if (m_particle[i].type == PARTIDROP)
         {
             if (progress >= 1.0f ||
-                m_particle[i].pos.y < m_water->GetLevel())
+                (m_water != nullptr && m_motion.pos[i].y < m_water->GetLevel()))
             {
                 DeleteRank(i);
                 continue;
             }
 
-            m_particle[i].zoom = 1.0f-progress;
+            m_motion.zoom[i] = 1.0f-progress;
             m_particle[i].intensity = 1.0f-progress;
 
             ts.x = 0.750f;
@@ -2392,7 +2600,7 @@ void CParticle::FrameParticle(float rTime)
         if (m_particle[i].type == PARTIWATER)
         {
             if (progress >= 1.0f ||
-                m_particle[i].pos.y < m_water->GetLevel())
+                (m_water != nullptr && m_motion.pos[i].y < m_water->GetLevel()))
             {
                 DeleteRank(i);
                 continue;
@@ -2414,10 +2622,10 @@ void CParticle::FrameParticle(float rTime)
                 continue;
             }
 
-            if (m_particle[i].testTime >= 0.2f)
+            if (m_motion.testTime[i] >= 0.2f)
             {
-                m_particle[i].testTime = 0.0f;
-                CObject* object = SearchObjectRay(m_particle[i].pos, m_particle[i].goal,
+                m_motion.testTime[i] = 0.0f;
+                CObject* object = SearchObjectRay(m_motion.pos[i], m_particle[i].goal,
                                          m_particle[i].type, m_particle[i].objFather);
                 if (object != nullptr)
                 {
@@ -2452,14 +2660,76 @@ void CParticle::FrameParticle(float rTime)
         m_particle[i].texSup.y = ts.y+dp;
         m_particle[i].texInf.x = ti.x-dp;
         m_particle[i].texInf.y = ti.y-dp;
-        m_particle[i].time     += rTime;
-        m_particle[i].testTime += rTime;
+    }
+
+    m_frameRank = -1;
+
+    // Finally the particles still updated get older.
+    for (int page : m_framePages)
+    {
+        if (m_frameActive[page] != 0)
+            AgeParticles(page*PARTIPAGE, PARTIPAGE);
+    }
+
+    CProfiler::SetPerformanceValue(PVAL_PARTICLE_LIVE, m_liveCount);
+    CProfiler::SetPerformanceValue(PVAL_PARTICLE_PEAK, m_peakCount);
+    CProfiler::SetPerformanceValue(PVAL_PARTICLE_DROPPED, m_droppedCount);
+}
+
+void CParticle::MoveParticles(int first, int count)
+{
+    static_assert(sizeof(Math::Vector) == 3*sizeof(float), "positions must be packed floats");
+
+    const int end = first+count;
+    int i = first;
+
+#ifdef PARTICLE_SSE
+    // Four particles are twelve floats, each step is repeated for x, y and z.
+    float* pos = &m_motion.pos[0].x;
+    const float* speed = &m_motion.speed[0].x;
+    for (; i+4 <= end; i += 4)
+    {
+        __m128 s = _mm_loadu_ps(&m_frameMove[i]);
+        __m128 s0 = _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 0, 0, 0));
+        __m128 s1 = _mm_shuffle_ps(s, s, _MM_SHUFFLE(2, 2, 1, 1));
+        __m128 s2 = _mm_shuffle_ps(s, s, _MM_SHUFFLE(3, 3, 3, 2));
+
+        float* p = pos + 3*i;
+        const float* v = speed + 3*i;
+        _mm_storeu_ps(p,   _mm_add_ps(_mm_loadu_ps(p),   _mm_mul_ps(_mm_loadu_ps(v),   s0)));
+        _mm_storeu_ps(p+4, _mm_add_ps(_mm_loadu_ps(p+4), _mm_mul_ps(_mm_loadu_ps(v+4), s1)));
+        _mm_storeu_ps(p+8, _mm_add_ps(_mm_loadu_ps(p+8), _mm_mul_ps(_mm_loadu_ps(v+8), s2)));
+    }
+#endif
+
+    for (; i < end; i++)
+        m_motion.pos[i] += m_motion.speed[i]*m_frameMove[i];
+}
+
+void CParticle::AgeParticles(int first, int count)
+{
+    const int end = first+count;
+    int i = first;
+
+#ifdef PARTICLE_SSE
+    for (; i+4 <= end; i += 4)
+    {
+        __m128 s = _mm_loadu_ps(&m_frameTime[i]);
+        _mm_storeu_ps(&m_motion.time[i],     _mm_add_ps(_mm_loadu_ps(&m_motion.time[i]),     s));
+        _mm_storeu_ps(&m_motion.testTime[i], _mm_add_ps(_mm_loadu_ps(&m_motion.testTime[i]), s));
+    }
+#endif
+
+    for (; i < end; i++)
+    {
+        m_motion.time[i]     += m_frameTime[i];
+        m_motion.testTime[i] += m_frameTime[i];
     }
 }
 
 bool CParticle::TrackMove(int i, Math::Vector pos, float progress)
 {
-    if (i < 0 || i >= MAXTRACK)  return true;
+    if (i < 0 || i >= static_cast<int>(m_track.size()))  return true;
     if (! m_track[i].used) return true;
 
     if (progress < 1.0f)  // particle exists?
@@ -2674,10 +2944,10 @@ void CParticle::TrackDraw(int i, ParticleType type)
 
 void CParticle::DrawParticleTriangle(int i)
 {
-    if (m_particle[i].zoom == 0.0f)  return;
+    if (m_motion.zoom[i] == 0.0f)  return;
 
     Math::Vector eye = m_engine->GetEyePt();
-    Math::Vector pos = m_particle[i].pos;
+    Math::Vector pos = m_motion.pos[i];
 
     CObject* object = m_particle[i].objLink;
     if (object != nullptr)
@@ -2701,7 +2971,7 @@ void CParticle::DrawParticleTriangle(int i)
 
 void CParticle::DrawParticleNorm(int i)
 {
-    float zoom = m_particle[i].zoom;
+    float zoom = m_motion.zoom[i];
 
     if (zoom == 0.0f) return;
     if (m_particle[i].intensity == 0.0f) return;
@@ -2712,7 +2982,7 @@ void CParticle::DrawParticleNorm(int i)
 
     if (m_particle[i].sheet == SH_INTERFACE)
     {
-        Math::Vector pos = m_particle[i].pos;
+        Math::Vector pos = m_motion.pos[i];
 
         Math::Vector n(0.0f, 0.0f, -1.0f);
 
@@ -2747,7 +3017,7 @@ void CParticle::DrawParticleNorm(int i)
     else
     {
         Math::Vector eye = m_engine->GetEyePt();
-        Math::Vector pos = m_particle[i].pos;
+        Math::Vector pos = m_motion.pos[i];
 
         CObject* object = m_particle[i].objLink;
         if (object != nullptr)
@@ -2799,10 +3069,10 @@ void CParticle::DrawParticleNorm(int i)
 
 void CParticle::DrawParticleFlat(int i)
 {
-    if (m_particle[i].zoom == 0.0f) return;
+    if (m_motion.zoom[i] == 0.0f) return;
     if (m_particle[i].intensity == 0.0f) return;
 
-    Math::Vector pos = m_particle[i].pos;
+    Math::Vector pos = m_motion.pos[i];
 
     CObject* object = m_particle[i].objLink;
     if (object != nullptr)
@@ -2830,8 +3100,8 @@ void CParticle::DrawParticleFlat(int i)
     Math::Vector n(0.0f, 0.0f, -1.0f);
 
     Math::Point dim;
-    dim.x = m_particle[i].dim.x * m_particle[i].zoom;
-    dim.y = m_particle[i].dim.y * m_particle[i].zoom;
+    dim.x = m_particle[i].dim.x * m_motion.zoom[i];
+    dim.y = m_particle[i].dim.y * m_motion.zoom[i];
 
     Math::Vector corner[4];
     corner[0].x =  dim.x;
@@ -2865,7 +3135,7 @@ void CParticle::DrawParticleFog(int i)
     if (!m_engine->GetFog()) return;
     if (m_particle[i].intensity == 0.0f) return;
 
-    Math::Vector pos = m_particle[i].pos;
+    Math::Vector pos = m_motion.pos[i];
 
     Math::Point dim;
     dim.x = m_particle[i].dim.x;
@@ -2878,16 +3148,16 @@ void CParticle::DrawParticleFog(int i)
          m_particle[i].type == PARTIFOG4 ||
          m_particle[i].type == PARTIFOG6 )
     {
-        zoom.x = 1.0f+sinf(m_particle[i].zoom*2.0f)/6.0f;
-        zoom.y = 1.0f+cosf(m_particle[i].zoom*2.7f)/6.0f;
+        zoom.x = 1.0f+sinf(m_motion.zoom[i]*2.0f)/6.0f;
+        zoom.y = 1.0f+cosf(m_motion.zoom[i]*2.7f)/6.0f;
     }
     if ( m_particle[i].type == PARTIFOG1 ||
          m_particle[i].type == PARTIFOG3 ||
          m_particle[i].type == PARTIFOG5 ||
          m_particle[i].type == PARTIFOG7 )
     {
-        zoom.x = 1.0f+sinf(m_particle[i].zoom*3.0f)/6.0f;
-        zoom.y = 1.0f+cosf(m_particle[i].zoom*3.7f)/6.0f;
+        zoom.x = 1.0f+sinf(m_motion.zoom[i]*3.0f)/6.0f;
+        zoom.y = 1.0f+cosf(m_motion.zoom[i]*3.7f)/6.0f;
     }
 
     dim.x *= zoom.x;
@@ -2949,11 +3219,11 @@ void CParticle::DrawParticleFog(int i)
 
 void CParticle::DrawParticleRay(int i)
 {
-    if (m_particle[i].zoom == 0.0f)  return;
+    if (m_motion.zoom[i] == 0.0f)  return;
     if (m_particle[i].intensity == 0.0f)  return;
 
     Math::Vector eye = m_engine->GetEyePt();
-    Math::Vector pos = m_particle[i].pos;
+    Math::Vector pos = m_motion.pos[i];
     Math::Vector goal = m_particle[i].goal;
 
     CObject* object = m_particle[i].objLink;
@@ -2980,8 +3250,8 @@ void CParticle::DrawParticleRay(int i)
     Math::Vector n(0.0f, 0.0f, left ? 1.0f : -1.0f);
 
     Math::Point dim;
-    dim.x = m_particle[i].dim.x * m_particle[i].zoom;
-    dim.y = m_particle[i].dim.y * m_particle[i].zoom;
+    dim.x = m_particle[i].dim.x * m_motion.zoom[i];
+    dim.y = m_particle[i].dim.y * m_motion.zoom[i];
 
     if (left) dim.y = -dim.y;
 
@@ -3014,40 +3284,40 @@ void CParticle::DrawParticleRay(int i)
     }
     else if (m_particle[i].type == PARTIRAY3)
     {
-        if (m_particle[i].time < m_particle[i].duration*0.40f)
+        if (m_motion.time[i] < m_motion.duration[i]*0.40f)
         {
-            float prop = m_particle[i].time / (m_particle[i].duration*0.40f);
+            float prop = m_motion.time[i] / (m_motion.duration[i]*0.40f);
             first = 0;
             last  = static_cast<int>(prop*step);
         }
-        else if (m_particle[i].time < m_particle[i].duration*0.60f)
+        else if (m_motion.time[i] < m_motion.duration[i]*0.60f)
         {
             first = 0;
             last  = step;
         }
         else
         {
-            float prop = (m_particle[i].time-m_particle[i].duration*0.60f) / (m_particle[i].duration*0.40f);
+            float prop = (m_motion.time[i]-m_motion.duration[i]*0.60f) / (m_motion.duration[i]*0.40f);
             first = static_cast<int>(prop*step);
             last  = step;
         }
     }
     else
     {
-        if (m_particle[i].time < m_particle[i].duration*0.50f)
+        if (m_motion.time[i] < m_motion.duration[i]*0.50f)
         {
-            float prop = m_particle[i].time / (m_particle[i].duration*0.50f);
+            float prop = m_motion.time[i] / (m_motion.duration[i]*0.50f);
             first = 0;
             last  = static_cast<int>(prop*step);
         }
-        else if (m_particle[i].time < m_particle[i].duration*0.75f)
+        else if (m_motion.time[i] < m_motion.duration[i]*0.75f)
         {
             first = 0;
             last  = step;
         }
         else
         {
-            float prop = (m_particle[i].time-m_particle[i].duration*0.75f) / (m_particle[i].duration*0.25f);
+            float prop = (m_motion.time[i]-m_motion.duration[i]*0.75f) / (m_motion.duration[i]*0.25f);
             first = static_cast<int>(prop*step);
             last  = step;
         }
@@ -3106,7 +3376,7 @@ void CParticle::DrawParticleRay(int i)
 
 void CParticle::DrawParticleSphere(int i)
 {
-    float zoom = m_particle[i].zoom;
+    float zoom = m_motion.zoom[i];
 
     if (zoom == 0.0f) return;
 
@@ -3118,9 +3388,9 @@ void CParticle::DrawParticleSphere(int i)
     mat.Set(1, 1, zoom);
     mat.Set(2, 2, zoom);
     mat.Set(3, 3, zoom);
-    mat.Set(1, 4, m_particle[i].pos.x);
-    mat.Set(2, 4, m_particle[i].pos.y);
-    mat.Set(3, 4, m_particle[i].pos.z);
+    mat.Set(1, 4, m_motion.pos[i].x);
+    mat.Set(2, 4, m_motion.pos[i].y);
+    mat.Set(3, 4, m_motion.pos[i].z);
 
     if (m_particle[i].angle != 0.0f)
     {
@@ -3214,7 +3484,7 @@ static float ProgressCylinder(float progress)
 
 void CParticle::DrawParticleCylinder(int i)
 {
-    float progress = m_particle[i].zoom;
+    float progress = m_motion.zoom[i];
     float zoom = m_particle[i].dim.x;
     float diam = m_particle[i].dim.y;
     if (progress >= 1.0f || zoom == 0.0f)  return;
@@ -3227,9 +3497,9 @@ void CParticle::DrawParticleCylinder(int i)
     mat.Set(1, 1, zoom);
     mat.Set(2, 2, zoom);
     mat.Set(3, 3, zoom);
-    mat.Set(1, 4, m_particle[i].pos.x);
-    mat.Set(2, 4, m_particle[i].pos.y);
-    mat.Set(3, 4, m_particle[i].pos.z);
+    mat.Set(1, 4, m_motion.pos[i].x);
+    mat.Set(2, 4, m_motion.pos[i].y);
+    mat.Set(3, 4, m_motion.pos[i].z);
     m_device->SetTransform(TRANSFORM_WORLD, mat);
 
     Math::Point ts, ti;
@@ -3380,8 +3650,10 @@ void CParticle::DrawParticle(int sheet)
     // Draw the basic particles of triangles.
     if (m_totalInterface[0][sheet] > 0)
     {
-        for (int i = 0; i < MAXPARTICULE; i++)
+        int total = m_pages[0].size()*PARTIPAGE;
+        for (int j = 0; j < total; j++)
         {
+            int i = m_pages[0][j/PARTIPAGE]*PARTIPAGE + j%PARTIPAGE;
             if (!m_particle[i].used)  continue;
             if (m_particle[i].sheet != sheet)  continue;
             if (m_particle[i].type == PARTIPART)  continue;
@@ -3425,9 +3697,10 @@ void CParticle::DrawParticle(int sheet)
         else        state = ENG_RSTATE_TTEXTURE_BLACK;  // effect[00..02].png
         m_engine->SetState(state);
 
-        for (int j = 0; j < MAXPARTICULE; j++)
+        int total = m_pages[t].size()*PARTIPAGE;
+        for (int j = 0; j < total; j++)
         {
-            int i = MAXPARTICULE*t+j;
+            int i = m_pages[t][j/PARTIPAGE]*PARTIPAGE + j%PARTIPAGE;
             if (!m_particle[i].used)  continue;
             if (m_particle[i].sheet != sheet)  continue;
 
@@ -3489,7 +3762,7 @@ void CParticle::DrawParticle(int sheet)
 CObject* CParticle::SearchObjectGun(Math::Vector old, Math::Vector pos,
                                     ParticleType type, CObject *father)
 {
-    if (m_main->GetMovieLock()) return nullptr;  // current movie?
+    if (m_main != nullptr && m_main->GetMovieLock()) return nullptr;  // current movie?
 
     float min = 5.0f;
     if (type == PARTIGUN2) min = 2.0f;  // shooting insect?
@@ -3604,7 +3877,7 @@ CObject* CParticle::SearchObjectGun(Math::Vector old, Math::Vector pos,
 CObject* CParticle::SearchObjectRay(Math::Vector pos, Math::Vector goal,
                                     ParticleType type, CObject *father)
 {
-    if (m_main->GetMovieLock()) return nullptr;  // current movie?
+    if (m_main != nullptr && m_main->GetMovieLock()) return nullptr;  // current movie?
 
     float min = 10.0f;
 
@@ -3674,20 +3947,20 @@ Color CParticle::GetFogColor(Math::Vector pos)
     {
         int i = m_fog[fog];  // i = rank of the particle
 
-        if (pos.y >= m_particle[i].pos.y+FOG_HSUP)  continue;
-        if (pos.y <= m_particle[i].pos.y-FOG_HINF)  continue;
+        if (pos.y >= m_motion.pos[i].y+FOG_HSUP)  continue;
+        if (pos.y <= m_motion.pos[i].y-FOG_HINF)  continue;
 
-        float dist = Math::DistanceProjected(pos, m_particle[i].pos);
+        float dist = Math::DistanceProjected(pos, m_motion.pos[i]);
         if (dist >= m_particle[i].dim.x*1.5f)  continue;
 
         // Calculates the horizontal distance.
         float factor = 1.0f-powf(dist/(m_particle[i].dim.x*1.5f), 4.0f);
 
         // Calculates the vertical distance.
-        if (pos.y > m_particle[i].pos.y)
-            factor *= 1.0f-(pos.y-m_particle[i].pos.y)/FOG_HSUP;
+        if (pos.y > m_motion.pos[i].y)
+            factor *= 1.0f-(pos.y-m_motion.pos[i].y)/FOG_HSUP;
         else
-            factor *= 1.0f-(m_particle[i].pos.y-pos.y)/FOG_HINF;
+            factor *= 1.0f-(m_motion.pos[i].y-pos.y)/FOG_HINF;
 
         factor *= 0.3f;
 
@@ -3740,9 +4013,64 @@ Color CParticle::GetFogColor(Math::Vector pos)
     return result;
 }
 
+void CParticle::SetBudget(int budget)
+{
+    m_budget = Math::Clamp(budget, 0, MAXPARTIRANK);
+}
+
+int CParticle::GetBudget()
+{
+    return m_budget;
+}
+
+void CParticle::SetTypeBudget(int type, int budget)
+{
+    if (type < 0 || type >= MAXPARTITYPE) return;
+    m_typeBudget[type] = std::max(budget, 0);
+}
+
+int CParticle::GetTypeBudget(int type)
+{
+    if (type < 0 || type >= MAXPARTITYPE) return 0;
+    return m_typeBudget[type];
+}
+
+void CParticle::SetWheelTraceBudget(int budget)
+{
+    m_wheelTraceBudget = std::max(budget, 0);
+    m_wheelTrace.resize(m_wheelTraceBudget);
+    m_wheelTraceTotal = std::min(m_wheelTraceTotal, m_wheelTraceBudget);
+    m_wheelTraceIndex = 0;
+}
+
+int CParticle::GetWheelTraceBudget()
+{
+    return m_wheelTraceBudget;
+}
+
+int CParticle::GetLiveCount()
+{
+    return m_liveCount;
+}
+
+int CParticle::GetPeakCount()
+{
+    return m_peakCount;
+}
+
+int CParticle::GetDroppedCount()
+{
+    return m_droppedCount;
+}
+
+int CParticle::GetCapacity()
+{
+    return m_particle.size();
+}
+
 void CParticle::CutObjectLink(CObject* obj)
 {
-    for (int i = 0; i < MAXPARTICULE*MAXPARTITYPE; i++)
+    for (int i = 0; i < static_cast<int>(m_particle.size()); i++)
     {
         if (!m_particle[i].used) continue;
 
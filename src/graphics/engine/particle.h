@@ -31,6 +31,9 @@
 
 #include "sound/sound_type.h"
 
+#include <cstdint>
+#include <vector>
+
 
 class CRobotMain;
 class CObject;
@@ -41,12 +44,17 @@ class CSoundInterface;
 namespace Gfx
 {
 
-const short MAXPARTICULE = 500;
 const short MAXPARTITYPE = 6;
-const short MAXTRACK = 100;
 const short MAXTRACKLEN = 10;
 const short MAXPARTIFOG = 100;
-const short MAXWHEELTRACE = 1000;
+//! Number of particles in a page, pools grow by whole pages
+const short PARTIPAGE = 64;
+//! Limit of particle ranks, these have to fit in the lower half of a channel
+const int MAXPARTIRANK = 0x10000;
+//! Default maximum number of particles alive at once
+const int DEFAULT_PARTIBUDGET = 8192;
+//! Default number of tire marks kept before the oldest ones are reused
+const int DEFAULT_WHEELTRACE = 1000;
 
 const short SH_WORLD = 0;       // particle in the world in the interface
 const short SH_FRONT = 1;       // particle in the world on the interface
@@ -170,21 +178,14 @@ struct Particle
     ParticlePhase   phase = {};      // phase PARPH*
     float           mass = 0.0f;       // mass of the particle (in rebounding)
     float           weight = 0.0f;     // weight of the particle (for noise)
-    float           duration = 0.0f;   // length of life
-    Math::Vector    pos;        // absolute position (relative if object links)
     Math::Vector    goal;       // goal position (if ray)
-    Math::Vector    speed;      // speed of displacement
     float           windSensitivity = 0.0f;
     short           bounce = 0;     // number of rebounds
     Math::Point     dim;        // dimensions of the rectangle
-    float           zoom = 0.0f;       // zoom (0..1)
     float           angle = 0.0f;      // angle of rotation
     float           intensity = 0.0f;  // intensity
     Math::Point     texSup;     // coordinated upper texture
     Math::Point     texInf;     // coordinated lower texture
-    float           time = 0.0f;       // age of the particle (0..n)
-    float           phaseTime = 0.0f;  // age at the beginning of phase
-    float           testTime = 0.0f;   // time since last test
     CObject*        objLink = nullptr;    // father object (for example reactor)
     CObject*        objFather = nullptr;  // father object (for example reactor)
     short           objRank = 0;    // rank of the object, or -1
@@ -193,6 +194,24 @@ struct Particle
     Color           color = Color(1.0f, 1.0f, 1.0f, 1.0f);
 };
 
+/**
+ * \struct ParticleMotion
+ * \brief Fields of particles updated every frame, one array for each field
+ *
+ * Indexes are the same as in CParticle::m_particle. Keeping these apart from
+ * Particle lets FrameParticle() integrate all particles with SIMD instructions.
+ */
+struct ParticleMotion
+{
+    std::vector<Math::Vector> pos;        // absolute position (relative if object links)
+    std::vector<Math::Vector> speed;      // speed of displacement
+    std::vector<float>        duration;   // length of life
+    std::vector<float>        zoom;       // zoom (0..1)
+    std::vector<float>        time;       // age of the particle (0..n)
+    std::vector<float>        phaseTime;  // age at the beginning of phase
+    std::vector<float>        testTime;   // time since last test
+};
+
 struct Track
 {
     char            used = 0;      // TRUE -> drag used
@@ -218,7 +237,10 @@ struct WheelTrace
  * \class CParticle
  * \brief Particle engine
  *
- * TODO: documentation
+ * Particles are kept in pools, one for each texture type, which grow by pages
+ * of PARTIPAGE particles. Free particles of each pool are kept in a free list.
+ * When the budget is reached, a new particle replaces an old or far away effect
+ * particle of the same pool, or is dropped if there is none.
  */
 class CParticle
 {
@@ -294,7 +316,50 @@ public:
     //! Indicates that the object binds to the particle no longer exists, without deleting it
     void        CutObjectLink(CObject* obj);
 
+    //! Management of the maximum number of particles alive at once
+    //@{
+    void        SetBudget(int budget);
+    int         GetBudget();
+    //@}
+
+    //! Management of the maximum number of particles of one texture type, 0 for no own limit
+    //@{
+    void        SetTypeBudget(int type, int budget);
+    int         GetTypeBudget(int type);
+    //@}
+
+    //! Management of the number of tire marks
+    //@{
+    void        SetWheelTraceBudget(int budget);
+    int         GetWheelTraceBudget();
+    //@}
+
+    //! Returns the number of particles alive
+    int         GetLiveCount();
+    //! Returns the highest number of particles alive since last flush
+    int         GetPeakCount();
+    //! Returns the number of particles not created since last flush, because of the budget
+    int         GetDroppedCount();
+    //! Returns the number of particles the pools can hold without growing
+    int         GetCapacity();
+
 protected:
+    //! Returns the texture type of particles, -1 if unknown
+    int         GetParticleFamily(ParticleType type);
+    //! Takes a free particle of given texture type, returns its rank or -1 if over budget
+    int         AllocateRank(int t, ParticleType type, int sheet);
+    //! Adds a page of free particles to the pool of given texture type
+    bool        AddPage(int t);
+    //! Removes the least useful particle of given texture type, returns false if none can go
+    bool        EvictRank(int t, ParticleType type, int sheet);
+    //! Indicates whether a particle is only a visual effect that can be removed early
+    bool        IsEvictable(int rank);
+    //! Marks a particle of given rank as used or free
+    void        SetUsed(int rank, bool used);
+    //! Moves a range of particles by their speed, times their step of the frame
+    void        MoveParticles(int first, int count);
+    //! Makes a range of particles older by their step of the frame
+    void        AgeParticles(int first, int count);
     //! Removes a particle of given rank
     void        DeleteRank(int rank);
     /**
@@ -340,12 +405,41 @@ protected:
     CRobotMain*       m_main = nullptr;
     CSoundInterface*  m_sound = nullptr;
 
-    Particle       m_particle[MAXPARTICULE*MAXPARTITYPE];
-    EngineTriangle m_triangle[MAXPARTICULE];  // triangle if PartiType == 0
-    Track          m_track[MAXTRACK];
+    std::vector<Particle> m_particle;
+    ParticleMotion m_motion;
+    //! Texture type of each page
+    std::vector<int> m_pageFamily;
+    //! Pages of each texture type, in order of update and drawing
+    std::vector<int> m_pages[MAXPARTITYPE];
+    //! Free ranks of each texture type
+    std::vector<int> m_freeRanks[MAXPARTITYPE];
+    //! Set of used particles of each page, one bit per particle
+    std::vector<uint64_t> m_used;
+    //! Set of particles FrameParticle() is updating in current frame, one word per page
+    std::vector<uint64_t> m_frameActive;
+    //! Time steps of current frame for position and age of each particle, 0 if not updated
+    std::vector<float> m_frameMove;
+    std::vector<float> m_frameTime;
+    std::vector<EngineTriangle> m_triangle;  // triangle if PartiType == 0
+    std::vector<Track> m_track;
+    std::vector<int> m_freeTracks;
     int           m_wheelTraceTotal = 0;
     int           m_wheelTraceIndex = 0;
-    WheelTrace    m_wheelTrace[MAXWHEELTRACE];
+    std::vector<WheelTrace> m_wheelTrace;
+    int           m_wheelTraceBudget = DEFAULT_WHEELTRACE;
+    int           m_budget = DEFAULT_PARTIBUDGET;
+    int           m_typeBudget[MAXPARTITYPE] = {};
+    int           m_typeLive[MAXPARTITYPE] = {};
+    int           m_evictCursor[MAXPARTITYPE] = {};
+    int           m_liveCount = 0;
+    int           m_peakCount = 0;
+    int           m_droppedCount = 0;
+    //! Camera position in last frame, to find far away particles
+    Math::Vector  m_eyePt;
+    //! Pages updated by FrameParticle() in current frame
+    std::vector<int> m_framePages;
+    //! Particle FrameParticle() is updating, -1 if none
+    int           m_frameRank = -1;
     int           m_totalInterface[MAXPARTITYPE][SH_MAX] = {};
     bool          m_frameUpdate[SH_MAX] = {};
     int           m_fogTotal = 0;
@@ -63,6 +63,10 @@ CTerrain::CTerrain()
     m_materialAutoID = 0;
     m_materialPointCount = 0;
 
+    m_lodFrame = 0;
+    m_lodCacheSize = 0;
+    m_lodCacheBudget = TERRAIN_LOD_CACHE_BUDGET;
+
     FlushBuildingLevel();
     FlushFlyingLimit();
     FlushMaterials();
@@ -93,12 +97,14 @@ bool CTerrain::Generate(int mosaicCount, int brickCountPow2, float brickSize,
 
     dim = (m_mosaicCount*m_brickCount+1)*(m_mosaicCount*m_brickCount+1);
     std::vector<float>(dim).swap(m_relief);
+    m_reliefVersion++;
 
     dim = m_mosaicCount*m_textureSubdivCount*m_mosaicCount*m_textureSubdivCount;
     std::vector<int>(dim).swap(m_textures);
 
     dim = m_mosaicCount*m_mosaicCount;
     std::vector<int>(dim, -1).swap(m_objRanks);
+    std::vector<MosaicLod>(dim).swap(m_mosaicLods);
 
     return true;
 }
@@ -221,6 +227,11 @@ bool CTerrain::LoadResources(const std::string& fileName)
         return false;
     }
 
+    return LoadResources(img);
+}
+
+bool CTerrain::LoadResources(CImage& img)
+{
     ImageData *data = img.GetData();
 
     int size = (m_mosaicCount*m_brickCount)+1;
@@ -273,23 +284,21 @@ TerrainRes CTerrain::GetResource(const Math::Vector &pos)
 void CTerrain::FlushRelief()
 {
     m_relief.clear();
+    m_reliefVersion++;
     m_resources.clear();
     m_textures.clear();
 
-    for (int objRank : m_objRanks)
+    for (int y = 0; y < m_mosaicCount; y++)
     {
-        if (objRank == -1)
-            continue;
-
-        int baseObjRank = m_engine->GetObjectBaseRank(objRank);
-
-        if (baseObjRank != -1)
-            m_engine->DeleteBaseObject(baseObjRank);
-
-        m_engine->DeleteObject(objRank);
+        for (int x = 0; x < m_mosaicCount; x++)
+        {
+            if (x+y*m_mosaicCount < static_cast<int>( m_objRanks.size() ))
+                DeleteSquare(x, y);
+        }
     }
 
     m_objRanks.clear();
+    m_mosaicLods.clear();
 }
 
 /**
@@ -298,8 +307,6 @@ void CTerrain::FlushRelief()
 bool CTerrain::LoadRelief(const std::string &fileName, float scaleRelief,
                           bool adjustBorder)
 {
-    m_scaleRelief = scaleRelief;
-
     CImage img;
 
     if (! img.Load(fileName))
@@ -308,6 +315,13 @@ bool CTerrain::LoadRelief(const std::string &fileName, float scaleRelief,
         return false;
     }
 
+    return LoadRelief(img, scaleRelief, adjustBorder);
+}
+
+bool CTerrain::LoadRelief(CImage& img, float scaleRelief, bool adjustBorder)
+{
+    m_scaleRelief = scaleRelief;
+
     ImageData *data = img.GetData();
 
     int size = (m_mosaicCount*m_brickCount)+1;
@@ -343,6 +357,7 @@ bool CTerrain::LoadRelief(const std::string &fileName, float scaleRelief,
             m_relief[x+y*size] = level;
         }
     }
+    m_reliefVersion++;
 
     return true;
 }
@@ -398,6 +413,8 @@ bool CTerrain::RandomizeRelief()
             m_relief[x2+y2*size] = value * 255.0f;
         }
     }
+    m_reliefVersion++;
+
     return true;
 }
 
@@ -416,13 +433,18 @@ bool CTerrain::AddReliefPoint(Math::Vector pos, float scaleRelief)
          y < 0 || y >= size )  return false;
 
     if (m_relief[x+y*size] < pos.y*scaleRelief)
+    {
         m_relief[x+y*size] = pos.y*scaleRelief;
+        m_reliefVersion++;
+    }
 
     return true;
 }
 
 void CTerrain::AdjustRelief()
 {
+    m_reliefVersion++;
+
     if (m_depth == 1) return;
 
     int ii = m_mosaicCount*m_brickCount+1;
@@ -572,20 +594,13 @@ VertexTex2 CTerrain::GetVertex(int x, int y, int step)
   |
   +-------------------> x
 \endverbatim */
-bool CTerrain::CreateMosaic(int ox, int oy, int step, int objRank,
+bool CTerrain::CreateMosaic(int ox, int oy, int step, int baseObjRank,
                             const Material &mat)
 {
-    int baseObjRank = m_engine->GetObjectBaseRank(objRank);
-    if (baseObjRank == -1)
-    {
-        baseObjRank = m_engine->CreateBaseObject();
-        m_engine->SetObjectBaseRank(objRank, baseObjRank);
-    }
-
     std::string texName1;
     std::string texName2;
 
-    if ( step == 1 )
+    // All levels of detail keep the shadow texture, so that they look the same
     {
         int i = (ox/5) + (oy/5)*(m_mosaicCount/5);
         std::stringstream s;
@@ -640,8 +655,7 @@ bool CTerrain::CreateMosaic(int ox, int oy, int step, int objRank,
                 buffer.state = ENG_RSTATE_WRAP;
 
                 buffer.state |= ENG_RSTATE_SECOND;
-                if (step == 1)
-                    buffer.state |= ENG_RSTATE_DUAL_BLACK;
+                buffer.state |= ENG_RSTATE_DUAL_BLACK;
 
                 for (int x = 0; x <= brick; x += step)
                 {
@@ -734,12 +748,6 @@ bool CTerrain::CreateMosaic(int ox, int oy, int step, int objRank,
         }
     }
 
-    Math::Matrix transform;
-    transform.LoadIdentity();
-    transform.Set(1, 4, o.coord.x);
-    transform.Set(3, 4, o.coord.z);
-    m_engine->SetObjectTransform(objRank, transform);
-
     return true;
 }
 
@@ -1250,21 +1258,178 @@ void CTerrain::FlushMaterialPoints()
 
 bool CTerrain::CreateSquare(int x, int y)
 {
-    Material mat;
-    mat.diffuse = Color(1.0f, 1.0f, 1.0f);
-    mat.ambient = Color(0.0f, 0.0f, 0.0f);
-
     int objRank = m_engine->CreateObject();
     m_engine->SetObjectType(objRank, ENG_OBJTYPE_TERRAIN);
 
     m_objRanks[x+y*m_mosaicCount] = objRank;
 
-    for (int step = 0; step < m_depth; step++)
+    // The origin of mosaic is its center
+    Math::Vector center = GetVector(x*m_brickCount+m_brickCount/2, y*m_brickCount+m_brickCount/2);
+    Math::Matrix transform;
+    transform.LoadIdentity();
+    transform.Set(1, 4, center.x);
+    transform.Set(3, 4, center.z);
+    m_engine->SetObjectTransform(objRank, transform);
+
+    MosaicLod& lod = m_mosaicLods[x+y*m_mosaicCount];
+    lod.baseObjRanks.assign(m_depth, -1);
+    lod.lastUsed.assign(m_depth, m_lodFrame);
+    lod.level = 0;
+
+    // All levels are prepared in advance, as far as the budget allows
+    for (int level = m_depth-1; level >= 0; level--)
+        GetMosaicLevel(x, y, level);
+
+    m_engine->SetObjectBaseRank(objRank, lod.baseObjRanks[0]);
+
+    TrimLodCache();
+
+    return true;
+}
+
+void CTerrain::DeleteSquare(int x, int y)
+{
+    int objRank = m_objRanks[x+y*m_mosaicCount];
+    if (objRank == -1)
+        return;
+
+    MosaicLod& lod = m_mosaicLods[x+y*m_mosaicCount];
+    for (int level = 0; level < static_cast<int>( lod.baseObjRanks.size() ); level++)
     {
-        CreateMosaic(x, y, 1 << step, objRank, mat);
+        if (lod.baseObjRanks[level] == -1)
+            continue;
+
+        m_engine->DeleteBaseObject(lod.baseObjRanks[level]);
+        m_lodCacheSize -= GetMosaicLevelSize(level);
     }
+    lod = MosaicLod();
 
-    return true;
+    m_engine->DeleteObject(objRank);
+    m_objRanks[x+y*m_mosaicCount] = -1;
+}
+
+int CTerrain::GetMosaicLevel(int x, int y, int level)
+{
+    MosaicLod& lod = m_mosaicLods[x+y*m_mosaicCount];
+
+    if (lod.baseObjRanks[level] == -1)
+    {
+        Material mat;
+        mat.diffuse = Color(1.0f, 1.0f, 1.0f);
+        mat.ambient = Color(0.0f, 0.0f, 0.0f);
+
+        int baseObjRank = m_engine->CreateBaseObject();
+        CreateMosaic(x, y, 1 << level, baseObjRank, mat);
+
+        lod.baseObjRanks[level] = baseObjRank;
+        m_lodCacheSize += GetMosaicLevelSize(level);
+    }
+
+    return lod.baseObjRanks[level];
+}
+
+int CTerrain::GetMosaicLevelSize(int level)
+{
+    int brick = m_brickCount/m_textureSubdivCount;
+    int steps = Math::Max(brick >> level, 1);
+
+    // One strip of (steps+1)*2 vertices for each row, in each texture subdivision
+    return m_textureSubdivCount*m_textureSubdivCount * steps * (steps+1)*2 * sizeof(VertexTex2);
+}
+
+void CTerrain::TrimLodCache()
+{
+    while (m_lodCacheSize > m_lodCacheBudget)
+    {
+        // Least recently used level that is not drawn now
+        int oldestSquare = -1;
+        int oldestLevel = -1;
+        for (int i = 0; i < static_cast<int>( m_mosaicLods.size() ); i++)
+        {
+            const MosaicLod& lod = m_mosaicLods[i];
+            for (int level = 0; level < static_cast<int>( lod.baseObjRanks.size() ); level++)
+            {
+                if (lod.baseObjRanks[level] == -1 || level == lod.level)
+                    continue;
+
+                if (oldestSquare == -1 || lod.lastUsed[level] < m_mosaicLods[oldestSquare].lastUsed[oldestLevel])
+                {
+                    oldestSquare = i;
+                    oldestLevel = level;
+                }
+            }
+        }
+
+        if (oldestSquare == -1)
+            break;
+
+        MosaicLod& lod = m_mosaicLods[oldestSquare];
+        m_engine->DeleteBaseObject(lod.baseObjRanks[oldestLevel]);
+        lod.baseObjRanks[oldestLevel] = -1;
+        m_lodCacheSize -= GetMosaicLevelSize(oldestLevel);
+    }
+}
+
+void CTerrain::UpdateLevelOfDetail(const Math::Vector& eye)
+{
+    if (m_depth <= 1 || m_vision <= 0.0f)
+        return;
+
+    m_lodFrame++;
+
+    float mosaicSize = m_brickCount*m_brickSize;
+    bool created = false;
+
+    for (int y = 0; y < m_mosaicCount; y++)
+    {
+        for (int x = 0; x < m_mosaicCount; x++)
+        {
+            int objRank = m_objRanks[x+y*m_mosaicCount];
+            if (objRank == -1)
+                continue;
+
+            MosaicLod& lod = m_mosaicLods[x+y*m_mosaicCount];
+
+            // Horizontal distance to the nearest point of the mosaic
+            Math::Vector center = GetVector(x*m_brickCount+m_brickCount/2, y*m_brickCount+m_brickCount/2);
+            float dx = Math::Max(fabs(eye.x - center.x) - mosaicSize/2.0f, 0.0f);
+            float dz = Math::Max(fabs(eye.z - center.z) - mosaicSize/2.0f, 0.0f);
+            float distance = sqrtf(dx*dx + dz*dz);
+
+            // A new level every m_vision, with some margin before going back to finer ones
+            int level = Math::Min(static_cast<int>(distance / m_vision), m_depth-1);
+            if (level < lod.level && distance > lod.level*m_vision - m_vision*0.1f)
+                level = lod.level;
+
+            if (level != lod.level || lod.baseObjRanks[level] == -1)
+            {
+                created = created || lod.baseObjRanks[level] == -1;
+                m_engine->SetObjectLodBaseRank(objRank, GetMosaicLevel(x, y, level));
+                lod.level = level;
+            }
+
+            lod.lastUsed[level] = m_lodFrame;
+        }
+    }
+
+    if (created)
+        TrimLodCache();
+}
+
+void CTerrain::SetLodCacheBudget(int budget)
+{
+    m_lodCacheBudget = budget;
+    TrimLodCache();
+}
+
+int CTerrain::GetLodCacheBudget()
+{
+    return m_lodCacheBudget;
+}
+
+int CTerrain::GetLodCacheSize()
+{
+    return m_lodCacheSize;
 }
 
 bool CTerrain::CreateObjects()
@@ -1357,10 +1522,7 @@ bool CTerrain::Terraform(const Math::Vector &p1, const Math::Vector &p2, float h
     {
         for (int x = pp1.x; x <= pp2.x; x++)
         {
-            int objRank = m_objRanks[x+y*m_mosaicCount];
-            int baseObjRank = m_engine->GetObjectBaseRank(objRank);
-            m_engine->DeleteBaseObject(baseObjRank);
-            m_engine->DeleteObject(objRank);
+            DeleteSquare(x, y);
             CreateSquare(x, y);  // recreates the square
         }
     }
@@ -1369,6 +1531,11 @@ bool CTerrain::Terraform(const Math::Vector &p1, const Math::Vector &p2, float h
     return true;
 }
 
+int CTerrain::GetReliefVersion()
+{
+    return m_reliefVersion;
+}
+
 void CTerrain::SetWind(Math::Vector speed)
 {
     m_wind = speed;
@@ -34,6 +34,8 @@
 #include <vector>
 
 
+class CImage;
+
 // Graphics module namespace
 namespace Gfx
 {
@@ -46,6 +48,9 @@ struct Material;
 //! Limit of slope considered a flat piece of land
 const float TERRAIN_FLATLIMIT = (5.0f*Math::PI/180.0f);
 
+//! Default memory budget for the geometry of all levels of detail of mosaics, in bytes
+const int TERRAIN_LOD_CACHE_BUDGET = 32 * 1024 * 1024;
+
 
 /**
  * \enum TerrainRes
@@ -170,22 +175,38 @@ public:
     void        FlushRelief();
     //! Load relief from image
     bool        LoadRelief(const std::string& fileName, float scaleRelief, bool adjustBorder);
+    //! Load relief from image already decoded
+    bool        LoadRelief(CImage& img, float scaleRelief, bool adjustBorder);
     //! Load ramdomized relief
     bool        RandomizeRelief();
 
     //! Load resources from image
     bool        LoadResources(const std::string& fileName);
+    //! Load resources from image already decoded
+    bool        LoadResources(CImage& img);
 
     //! Creates all objects of the terrain within the 3D engine
     bool        CreateObjects();
 
+    //! Selects the resolution of each mosaic according to its distance from the eye
+    void        UpdateLevelOfDetail(const Math::Vector& eye);
+    //@{
+    //! Management of the memory budget for geometry of mosaics, in bytes
+    void        SetLodCacheBudget(int budget);
+    int         GetLodCacheBudget();
+    //@}
+    //! Returns the memory used by geometry of mosaics, in bytes
+    int         GetLodCacheSize();
+
     //! Modifies the terrain's relief
     bool        Terraform(const Math::Vector& p1, const Math::Vector& p2, float height);
+    //! Returns a number that changes each time the relief is modified
+    int         GetReliefVersion();
 
     //@{
     //! Management of the wind
     void         SetWind(Math::Vector speed);
-    Math::Vector GetWind();
+    TEST_VIRTUAL Math::Vector GetWind();
     //@}
 
     //! Gives the exact slope of the terrain at 2D (XZ) position
@@ -195,7 +216,7 @@ public:
     //! Gives the normal vector at 2D (XZ) position
     bool        GetNormal(Math::Vector& n, const Math::Vector &p);
     //! Returns the height of the ground level at 2D (XZ) position
-    float       GetFloorLevel(const Math::Vector& pos, bool brut=false, bool water=false);
+    TEST_VIRTUAL float GetFloorLevel(const Math::Vector& pos, bool brut=false, bool water=false);
     //! Returns the distance to the ground level from 3D position
     float       GetHeightToFloor(const Math::Vector& pos, bool brut=false, bool water=false);
     //! Modifies the Y coordinate of 3D position to rest on the ground floor
@@ -255,10 +276,18 @@ protected:
     Math::Vector GetVector(int x, int y);
     //! Calculates a vertex of the terrain
     VertexTex2  GetVertex(int x, int y, int step);
-    //! Creates all objects of a mosaic
-    bool        CreateMosaic(int ox, int oy, int step, int objRank, const Material& mat);
+    //! Creates the geometry of a mosaic at given resolution in a base object
+    bool        CreateMosaic(int ox, int oy, int step, int baseObjRank, const Material& mat);
     //! Creates all objects in a mesh square ground
     bool        CreateSquare(int x, int y);
+    //! Removes all objects of a mesh square ground
+    void        DeleteSquare(int x, int y);
+    //! Returns the base object of a mosaic at given level of detail, creating it if needed
+    int         GetMosaicLevel(int x, int y, int level);
+    //! Returns the memory used by geometry of a mosaic at given level of detail
+    int         GetMosaicLevelSize(int level);
+    //! Removes least recently used levels of detail until the cache fits in the budget
+    void        TrimLodCache();
 
     struct TerrainMaterial;
     //! Seeks a material based on its ID
@@ -298,6 +327,32 @@ protected:
     //! Object ranks for mosaic objects
     std::vector<int> m_objRanks;
 
+    /**
+     * \struct MosaicLod
+     * \brief Cached levels of detail of a mosaic
+     *
+     * Level n is drawn with a step of 2^n bricks. As AdjustRelief() makes the edges of
+     * mosaics linear between points of the coarsest level, neighbors of different levels
+     * share the same edges and no cracks appear between them.
+     */
+    struct MosaicLod
+    {
+        //! Base object for each level, -1 if not generated
+        std::vector<int> baseObjRanks;
+        //! Frame in which each level was last drawn
+        std::vector<int> lastUsed;
+        //! Level currently drawn
+        int level = 0;
+    };
+    //! Levels of detail for mosaic objects
+    std::vector<MosaicLod> m_mosaicLods;
+    //! Counter of calls to UpdateLevelOfDetail()
+    int             m_lodFrame;
+    //! Memory used by generated levels of detail
+    int             m_lodCacheSize;
+    //! Memory budget for generated levels of detail
+    int             m_lodCacheBudget;
+
     //! Number of mosaics (along one dimension)
     int             m_mosaicCount;
     //! Number of bricks per mosaic (along one dimension)
@@ -388,6 +443,9 @@ protected:
     //! Wind speed
     Math::Vector    m_wind;
 
+    //! Incremented on every change of m_relief
+    int             m_reliefVersion = 0;
+
     //! Global flying height limit
     float           m_flyingMaxHeight;
 
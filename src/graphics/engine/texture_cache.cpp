@@ -0,0 +1,221 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2023, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+
+#include "graphics/engine/texture_cache.h"
+
+#include "common/image.h"
+#include "common/logger.h"
+
+#include "common/resources/inputstream.h"
+#include "common/resources/outputstream.h"
+#include "common/resources/resourcemanager.h"
+
+#include <SDL_surface.h>
+
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+
+// Graphics module namespace
+namespace Gfx
+{
+
+namespace
+{
+
+const char CACHE_MAGIC[4] = { 'C', 'T', 'X', 'C' };
+const uint32_t CACHE_VERSION = 1;
+
+//! Header of a cache entry, followed by the source file name and the pixels
+struct CacheHeader
+{
+    char     magic[4];
+    uint32_t version;
+    int64_t  sourceTime;
+    int64_t  sourceSize;
+    int32_t  width;
+    int32_t  height;
+    uint32_t nameLength;
+};
+
+//! FNV-1a hash of a string
+uint64_t HashName(const std::string& name)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : name)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+} // anonymous namespace
+
+
+CTextureCache::CTextureCache(const std::string& directory)
+    : m_directory(directory)
+    , m_enabled(false)
+{
+}
+
+void CTextureCache::SetEnabled(bool enabled)
+{
+    if (enabled && !CResourceManager::DirectoryExists(m_directory))
+    {
+        if (!CResourceManager::CreateNewDirectory(m_directory))
+        {
+            GetLogger()->Warn("Unable to create texture cache directory %s\n", m_directory.c_str());
+            enabled = false;
+        }
+    }
+
+    m_enabled = enabled;
+}
+
+bool CTextureCache::GetEnabled() const
+{
+    return m_enabled;
+}
+
+std::string CTextureCache::GetEntryPath(const std::string& name) const
+{
+    std::stringstream str;
+    str << m_directory << "/" << std::hex << std::setw(16) << std::setfill('0') << HashName(name) << ".tex";
+    return str.str();
+}
+
+bool CTextureCache::Load(const std::string& name, CImage& image, std::string& error)
+{
+    int64_t sourceTime = -1;
+    int64_t sourceSize = -1;
+    std::string path;
+
+    if (m_enabled)
+    {
+        sourceTime = CResourceManager::GetLastModificationTime(name);
+        sourceSize = CResourceManager::GetFileSize(name);
+        path = GetEntryPath(name);
+
+        if (sourceSize >= 0 && Read(path, name, sourceTime, sourceSize, image))
+            return true;
+    }
+
+    if (!image.Load(name))
+    {
+        error = image.GetError();
+        return false;
+    }
+
+    if (m_enabled && sourceSize >= 0)
+        Write(path, name, sourceTime, sourceSize, image);
+
+    return true;
+}
+
+void CTextureCache::Clear()
+{
+    for (const std::string& file : CResourceManager::ListFiles(m_directory, true))
+        CResourceManager::Remove(m_directory + "/" + file);
+}
+
+bool CTextureCache::Read(const std::string& path, const std::string& name,
+                         int64_t sourceTime, int64_t sourceSize, CImage& image) const
+{
+    if (!CResourceManager::Exists(path))
+        return false;
+
+    CInputStream file(path);
+    if (!file.is_open())
+        return false;
+
+    CacheHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+        return false;
+
+    if (memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != CACHE_VERSION)
+        return false;
+
+    if (header.sourceTime != sourceTime || header.sourceSize != sourceSize)
+        return false;
+
+    if (header.width <= 0 || header.height <= 0 || header.nameLength != name.size())
+        return false;
+
+    // Guards against collisions of the hashed file names
+    std::string entryName(header.nameLength, '\0');
+    if (!file.read(&entryName[0], header.nameLength) || entryName != name)
+        return false;
+
+    image.Create(Math::IntPoint(header.width, header.height));
+    SDL_Surface* surface = image.GetData()->surface;
+    if (surface == nullptr || surface->pitch != header.width * 4)
+    {
+        image.Free();
+        return false;
+    }
+
+    std::size_t pixelSize = static_cast<std::size_t>(surface->pitch) * header.height;
+    if (!file.read(static_cast<char*>(surface->pixels), pixelSize))
+    {
+        image.Free();
+        return false;
+    }
+
+    return true;
+}
+
+void CTextureCache::Write(const std::string& path, const std::string& name,
+                          int64_t sourceTime, int64_t sourceSize, CImage& image) const
+{
+    SDL_Surface* surface = image.GetData()->surface;
+    if (surface->format->BytesPerPixel != 4 || surface->format->Rmask != 0x00FF0000 ||
+        surface->format->Amask != 0xFF000000)
+    {
+        image.ConvertToRGBA();
+        surface = image.GetData()->surface;
+    }
+
+    COutputStream file(path, std::ios_base::out | std::ios_base::binary);
+    if (!file.is_open())
+    {
+        GetLogger()->Debug("Unable to write texture cache entry %s\n", path.c_str());
+        return;
+    }
+
+    CacheHeader header;
+    memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.sourceTime = sourceTime;
+    header.sourceSize = sourceSize;
+    header.width = surface->w;
+    header.height = surface->h;
+    header.nameLength = name.size();
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(name.c_str(), name.size());
+
+    const char* pixels = static_cast<const char*>(surface->pixels);
+    for (int y = 0; y < surface->h; ++y)
+        file.write(pixels + y * surface->pitch, surface->w * 4);
+}
+
+} // namespace Gfx
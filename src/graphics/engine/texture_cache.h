@@ -0,0 +1,83 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2023, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+
+/**
+ * \file graphics/engine/texture_cache.h
+ * \brief Cache of decoded texture images on disk - CTextureCache class
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+
+class CImage;
+
+// Graphics module namespace
+namespace Gfx
+{
+
+/**
+ * \class CTextureCache
+ * \brief Stores decoded texture images in the user directory
+ *
+ * Each texture file is cached as raw RGBA pixels in a file named by the hash
+ * of its path, so that later loads need a single read instead of decoding
+ * the PNG or JPG file. An entry is valid only while the modification time and
+ * size of the source file match the ones stored with it.
+ *
+ * Load() may be called from several threads at once, for different files.
+ */
+class CTextureCache
+{
+public:
+    explicit CTextureCache(const std::string& directory = "cache/textures");
+
+    //! Management of enabled state
+    //@{
+    void            SetEnabled(bool enabled);
+    bool            GetEnabled() const;
+    //@}
+
+    //! Loads the image of given file, from the cache if valid, otherwise decoding and caching it
+    bool            Load(const std::string& name, CImage& image, std::string& error);
+
+    //! Removes all cached images
+    void            Clear();
+
+    //! Returns the path of the cache entry for given file
+    std::string     GetEntryPath(const std::string& name) const;
+
+private:
+    //! Reads the cache entry if it matches the source file
+    bool            Read(const std::string& path, const std::string& name,
+                         int64_t sourceTime, int64_t sourceSize, CImage& image) const;
+    //! Writes the cache entry
+    void            Write(const std::string& path, const std::string& name,
+                          int64_t sourceTime, int64_t sourceSize, CImage& image) const;
+
+private:
+    std::string     m_directory;
+    std::atomic<bool> m_enabled;
+};
+
+} // namespace Gfx
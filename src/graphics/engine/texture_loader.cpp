@@ -0,0 +1,155 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2023, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+
+#include "graphics/engine/texture_loader.h"
+
+#include "common/image.h"
+#include "common/make_unique.h"
+#include "common/thread/worker_pool.h"
+
+#include "graphics/engine/texture_cache.h"
+
+
+// Graphics module namespace
+namespace Gfx
+{
+
+CTextureLoader::CTextureLoader(CTextureCache* cache, int threadCount)
+    : m_cache(cache)
+{
+    m_pool = MakeUnique<CWorkerPool>(threadCount);
+}
+
+CTextureLoader::~CTextureLoader()
+{
+    m_pool.reset();
+}
+
+void CTextureLoader::Request(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    if (m_jobs.find(name) != m_jobs.end())
+        return;
+
+    m_jobs[name] = Job();
+
+    int generation = m_generation;
+    m_pool->Start([this, name, generation]() { Decode(name, generation); });
+}
+
+bool CTextureLoader::IsRequested(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    return m_jobs.find(name) != m_jobs.end();
+}
+
+int CTextureLoader::GetRequestCount()
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    return static_cast<int>(m_jobs.size());
+}
+
+bool CTextureLoader::Take(const std::string& name, std::unique_ptr<CImage>& image, std::string& error)
+{
+    std::unique_lock<std::mutex> lock{m_mutex};
+    auto it = m_jobs.find(name);
+    if (it == m_jobs.end())
+        return false;
+
+    if (it->second.state == JobState::Queued)
+    {
+        // Decoding it here is faster than waiting for the rest of the queue
+        m_jobs.erase(it);
+        return false;
+    }
+
+    m_finishedCond.wait(lock, [&]() { return it->second.state == JobState::Finished; });
+
+    image = std::move(it->second.image);
+    error = it->second.error;
+    m_jobs.erase(it);
+    return true;
+}
+
+bool CTextureLoader::TakeFinished(std::string& name, std::unique_ptr<CImage>& image, std::string& error)
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    while (!m_finished.empty())
+    {
+        name = m_finished.front();
+        m_finished.pop_front();
+
+        // Already taken with Take()
+        auto it = m_jobs.find(name);
+        if (it == m_jobs.end() || it->second.state != JobState::Finished)
+            continue;
+
+        image = std::move(it->second.image);
+        error = it->second.error;
+        m_jobs.erase(it);
+        return true;
+    }
+
+    return false;
+}
+
+void CTextureLoader::Clear()
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_generation++;
+    m_jobs.clear();
+    m_finished.clear();
+}
+
+void CTextureLoader::Decode(const std::string& name, int generation)
+{
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        if (generation != m_generation)
+            return;
+
+        auto it = m_jobs.find(name);
+        if (it == m_jobs.end() || it->second.state != JobState::Queued)
+            return; // taken before decoding started
+
+        it->second.state = JobState::Decoding;
+    }
+
+    auto image = MakeUnique<CImage>();
+    std::string error;
+    if (!m_cache->Load(name, *image, error))
+        image.reset();
+
+    std::lock_guard<std::mutex> lock{m_mutex};
+    if (generation != m_generation)
+        return;
+
+    auto it = m_jobs.find(name);
+    if (it == m_jobs.end())
+        return;
+
+    it->second.state = JobState::Finished;
+    it->second.image = std::move(image);
+    it->second.error = error;
+    m_finished.push_back(name);
+    m_finishedCond.notify_all();
+}
+
+} // namespace Gfx
@@ -0,0 +1,115 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2023, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+
+/**
+ * \file graphics/engine/texture_loader.h
+ * \brief Asynchronous decoding of texture images - CTextureLoader class
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+
+class CImage;
+class CWorkerPool;
+
+// Graphics module namespace
+namespace Gfx
+{
+
+class CTextureCache;
+
+/**
+ * \class CTextureLoader
+ * \brief Decodes texture image files on worker threads
+ *
+ * Images are requested by file name and decoded in the background. The engine
+ * takes finished images on the main thread, where they are uploaded to the device.
+ * An image which is needed immediately can be taken with Take(); if its decoding
+ * has not started yet, the request is dropped and the caller decodes it itself.
+ */
+class CTextureLoader
+{
+public:
+    //! Creates the loader; \a threadCount of 0 selects it from the number of cores
+    explicit CTextureLoader(CTextureCache* cache, int threadCount = 0);
+    ~CTextureLoader();
+
+    //! Queues decoding of the given file; does nothing if it is already requested
+    void Request(const std::string& name);
+    //! Returns true if the given file is requested and not yet taken
+    bool IsRequested(const std::string& name);
+    //! Returns the number of requested images not yet taken
+    int GetRequestCount();
+
+    //! Takes the decoded image of the given file, waiting if it is being decoded
+    /**
+     * Returns false if the file was not requested or its decoding did not start yet.
+     * Otherwise \a image is the decoded image, or nullptr with \a error set on failure.
+     */
+    bool Take(const std::string& name, std::unique_ptr<CImage>& image, std::string& error);
+    //! Takes any one finished image; returns false if there is none
+    bool TakeFinished(std::string& name, std::unique_ptr<CImage>& image, std::string& error);
+
+    //! Forgets all requests; images still being decoded are discarded when finished
+    void Clear();
+
+private:
+    //! Decodes the given file on a worker thread
+    void Decode(const std::string& name, int generation);
+
+private:
+    enum class JobState
+    {
+        Queued,
+        Decoding,
+        Finished
+    };
+
+    struct Job
+    {
+        JobState state = JobState::Queued;
+        std::unique_ptr<CImage> image;
+        std::string error;
+    };
+
+    //! Cache of decoded images on disk
+    CTextureCache* m_cache;
+
+    std::mutex m_mutex;
+    std::condition_variable m_finishedCond;
+    //! Requests by file name
+    std::map<std::string, Job> m_jobs;
+    //! Names of finished jobs, in order of finishing
+    std::deque<std::string> m_finished;
+    //! Incremented by Clear() to discard jobs in flight
+    int m_generation = 0;
+
+    //! Declared last, so that worker threads are joined first
+    std::unique_ptr<CWorkerPool> m_pool;
+};
+
+} // namespace Gfx
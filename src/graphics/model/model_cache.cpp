@@ -0,0 +1,132 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2023, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+
+#include "graphics/model/model_cache.h"
+
+#include "common/logger.h"
+
+#include "common/resources/inputstream.h"
+#include "common/resources/outputstream.h"
+#include "common/resources/resourcemanager.h"
+
+#include "graphics/model/model_input.h"
+#include "graphics/model/model_io_exception.h"
+#include "graphics/model/model_output.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace Gfx
+{
+
+namespace
+{
+
+const std::string CACHE_DIRECTORY = "cache/models";
+const int CACHE_VERSION = 2;
+
+//! Returns the first line of a cache entry, identifying the source file and its version
+/**
+ * The file name guards against entries of different files mapped to the same path,
+ * e.g. "a_b.txt" and "a/b.txt".
+ */
+std::string GetEntryHeader(const std::string& fileName, long long sourceTime, long long sourceSize)
+{
+    std::stringstream str;
+    str << "colobot-model-cache " << CACHE_VERSION << " " << sourceTime << " " << sourceSize << " " << fileName;
+    return str.str();
+}
+
+} // anonymous namespace
+
+std::string ModelCache::GetEntryPath(const std::string& fileName)
+{
+    std::string name = fileName;
+    std::replace(name.begin(), name.end(), '/', '_');
+    return CACHE_DIRECTORY + "/" + name + ".bin";
+}
+
+CModel ModelCache::Read(const std::string& fileName, ModelFormat format)
+{
+    long long sourceTime = CResourceManager::GetLastModificationTime(fileName);
+    long long sourceSize = CResourceManager::GetFileSize(fileName);
+    if (sourceSize < 0)
+        throw CModelIOException(std::string("Could not open file '") + fileName + "'");
+
+    std::string header = GetEntryHeader(fileName, sourceTime, sourceSize);
+    std::string entryPath = GetEntryPath(fileName);
+
+    if (format == ModelFormat::Text && CResourceManager::Exists(entryPath))
+    {
+        CInputStream entry(entryPath);
+        if (entry.is_open())
+        {
+            // The whole entry is read at once, then parsed from memory
+            std::stringstream content;
+            content << entry.rdbuf();
+
+            std::string line;
+            if (std::getline(content, line) && line == header)
+            {
+                std::stringstream data(content.str().substr(header.size() + 1));
+                try
+                {
+                    return ModelInput::Read(data, ModelFormat::Binary);
+                }
+                catch (const CModelIOException& e)
+                {
+                    GetLogger()->Warn("Invalid model cache entry '%s': %s\n", entryPath.c_str(), e.what());
+                }
+            }
+        }
+    }
+
+    CInputStream stream;
+    stream.open(fileName);
+    if (!stream.is_open())
+        throw CModelIOException(std::string("Could not open file '") + fileName + "'");
+
+    CModel model = ModelInput::Read(stream, format);
+
+    if (format != ModelFormat::Text)
+        return model;
+
+    if (!CResourceManager::DirectoryExists(CACHE_DIRECTORY))
+        CResourceManager::CreateNewDirectory(CACHE_DIRECTORY);
+
+    try
+    {
+        COutputStream entry(entryPath);
+        if (entry.is_open())
+        {
+            entry << header << "\n";
+            ModelOutput::Write(model, entry, ModelFormat::Binary);
+        }
+    }
+    catch (const CModelIOException& e)
+    {
+        GetLogger()->Warn("Could not write model cache entry '%s': %s\n", entryPath.c_str(), e.what());
+        CResourceManager::Remove(entryPath);
+    }
+
+    return model;
+}
+
+} // namespace Gfx
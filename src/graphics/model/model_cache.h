@@ -0,0 +1,53 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2023, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+
+/**
+ * \file graphics/model/model_cache.h
+ * \brief Binary copies of parsed model files in the user directory
+ */
+
+#pragma once
+
+#include "graphics/model/model.h"
+#include "graphics/model/model_format.h"
+
+#include <string>
+
+namespace Gfx
+{
+
+namespace ModelCache
+{
+    //! Reads the model from \a fileName in given \a format
+    /**
+     * Text models are read from their binary copy in the cache directory if it is up to date
+     * with the source file; otherwise the source file is parsed and the copy is written.
+     * Models in binary formats are read directly.
+     * Can be called from several threads at once, for different files.
+     *
+     * @throws CModelIOException on read error
+     */
+    CModel Read(const std::string& fileName, ModelFormat format);
+
+    //! Returns the path of the binary copy of given file
+    std::string GetEntryPath(const std::string& fileName);
+}
+
+} // namespace Gfx
@@ -49,6 +49,7 @@ namespace ModelInput
     void ReadBinaryModel(CModel &model, std::istream &stream);
     void ReadBinaryModelV1AndV2(CModel &model, std::istream &stream);
     void ReadBinaryModelV3(CModel &model, std::istream &stream);
+    CModelMesh ReadBinaryMesh(std::istream &stream, std::string& meshName);
 
     void ReadOldModel(CModel &model, std::istream &stream);
     std::vector<ModelTriangle> ReadOldModelV1(std::istream &stream, int totalTriangles);
@@ -58,6 +59,7 @@ namespace ModelInput
     Vertex ReadBinaryVertex(std::istream& stream);
     VertexTex2 ReadBinaryVertexTex2(std::istream& stream);
     Material ReadBinaryMaterial(std::istream& stream);
+    Math::Vector ReadBinaryVector(std::istream& stream);
 
     std::string ReadLineString(std::istream& stream, const std::string& expectedPrefix);
     void ReadValuePrefix(std::istream& stream, const std::string& expectedPrefix);
@@ -196,7 +198,103 @@ void ModelInput::ReadBinaryModelV1AndV2(CModel &model, std::istream &stream)
 
 void ModelInput::ReadBinaryModelV3(CModel &model, std::istream &stream)
 {
-    // TODO...
+    ModelHeaderV3 header;
+    try
+    {
+        header.version                  = ReadBinary<4, int>(stream);
+        header.totalCrashSpheres        = ReadBinary<4, int>(stream);
+        header.hasShadowSpot            = ReadBinaryBool(stream);
+        header.hasCameraCollisionSphere = ReadBinaryBool(stream);
+        header.totalMeshes              = ReadBinary<4, int>(stream);
+    }
+    catch (const std::exception& e)
+    {
+        throw CModelIOException(std::string("Error reading model file header: ") + e.what());
+    }
+
+    try
+    {
+        for (int i = 0; i < header.totalCrashSpheres; ++i)
+        {
+            ModelCrashSphere crashSphere;
+            crashSphere.position = ReadBinaryVector(stream);
+            crashSphere.radius   = ReadBinaryFloat(stream);
+            crashSphere.sound    = ReadBinaryString<1>(stream);
+            crashSphere.hardness = ReadBinaryFloat(stream);
+            model.AddCrashSphere(crashSphere);
+        }
+
+        if (header.hasShadowSpot)
+        {
+            ModelShadowSpot shadowSpot;
+            shadowSpot.radius    = ReadBinaryFloat(stream);
+            shadowSpot.intensity = ReadBinaryFloat(stream);
+            model.SetShadowSpot(shadowSpot);
+        }
+
+        if (header.hasCameraCollisionSphere)
+        {
+            Math::Sphere sphere;
+            sphere.pos    = ReadBinaryVector(stream);
+            sphere.radius = ReadBinaryFloat(stream);
+            model.SetCameraCollisionSphere(sphere);
+        }
+
+        for (int i = 0; i < header.totalMeshes; ++i)
+        {
+            std::string meshName;
+            CModelMesh mesh = ReadBinaryMesh(stream, meshName);
+            model.AddMesh(meshName, std::move(mesh));
+        }
+    }
+    catch (const std::exception& e)
+    {
+        throw CModelIOException(std::string("Error reading model data: ") + e.what());
+    }
+}
+
+CModelMesh ModelInput::ReadBinaryMesh(std::istream &stream, std::string& meshName)
+{
+    CModelMesh mesh;
+
+    meshName = ReadBinaryString<1>(stream);
+    mesh.SetPosition(ReadBinaryVector(stream));
+    mesh.SetRotation(ReadBinaryVector(stream));
+    mesh.SetScale(ReadBinaryVector(stream));
+    mesh.SetParent(ReadBinaryString<1>(stream));
+
+    int totalTriangles = ReadBinary<4, int>(stream);
+
+    std::vector<ModelTriangle> triangles;
+    triangles.reserve(totalTriangles);
+
+    for (int i = 0; i < totalTriangles; ++i)
+    {
+        ModelTriangleV3 t;
+
+        t.p1 = ReadBinaryVertexTex2(stream);
+        t.p2 = ReadBinaryVertexTex2(stream);
+        t.p3 = ReadBinaryVertexTex2(stream);
+
+        Material mat = ReadBinaryMaterial(stream);
+        t.ambient = mat.ambient;
+        t.diffuse = mat.diffuse;
+        t.specular = mat.specular;
+
+        t.tex1Name = ReadBinaryString<1>(stream);
+        t.tex2Name = ReadBinaryString<1>(stream);
+        t.variableTex2 = ReadBinaryBool(stream);
+
+        t.transparentMode = static_cast<ModelTransparentMode>(ReadBinary<1, int>(stream));
+        t.specialMark = static_cast<ModelSpecialMark>(ReadBinary<1, int>(stream));
+        t.doubleSided = ReadBinaryBool(stream);
+
+        triangles.push_back(t);
+    }
+
+    mesh.SetTriangles(std::move(triangles));
+
+    return mesh;
 }
 
 void ModelInput::ReadTextModel(CModel &model, std::istream &stream)
@@ -682,6 +780,17 @@ Material ModelInput::ReadBinaryMaterial(std::istream& stream)
 }
 
 
+Math::Vector ModelInput::ReadBinaryVector(std::istream& stream)
+{
+    Math::Vector vector;
+
+    vector.x = ReadBinaryFloat(stream);
+    vector.y = ReadBinaryFloat(stream);
+    vector.z = ReadBinaryFloat(stream);
+
+    return vector;
+}
+
 std::string ModelInput::ReadLineString(std::istream& stream, const std::string& expectedPrefix)
 {
     std::string line;
@@ -21,10 +21,7 @@
 
 #include "common/logger.h"
 
-#include "common/resources/inputstream.h"
-
-#include "graphics/model/model_input.h"
-#include "graphics/model/model_io_exception.h"
+#include "graphics/model/model_cache.h"
 
 namespace Gfx
 {
@@ -39,12 +36,7 @@ CModel& CModelManager::GetModel(const std::string& modelName)
 
     GetLogger()->Debug("Loading new model: %s\n", modelFile.c_str());
 
-    CInputStream stream;
-    stream.open(modelFile.c_str());
-    if (!stream.is_open())
-        throw CModelIOException(std::string("Could not open file '") + modelName + "'");
-
-    CModel model = ModelInput::Read(stream, ModelFormat::Text);
+    CModel model = ModelCache::Read(modelFile, ModelFormat::Text);
     m_models[modelName] = model;
 
     return m_models[modelName];
@@ -44,6 +44,7 @@ namespace ModelOutput
     std::string SpecialMarkToString(ModelSpecialMark specialMark);
 
     void WriteBinaryModel(const CModel& model, std::ostream &stream);
+    void WriteBinaryMesh(const CModelMesh* mesh, const std::string& meshName, std::ostream &stream);
 
     void WriteOldModel(const CModel& model, std::ostream &stream);
 
@@ -51,6 +52,7 @@ namespace ModelOutput
 
     void WriteBinaryVertexTex2(VertexTex2 vertex, std::ostream &stream);
     void WriteBinaryMaterial(const Material& material, std::ostream &stream);
+    void WriteBinaryVector(const Math::Vector& vector, std::ostream &stream);
 
     void WriteTextVertexTex2(const VertexTex2& vertex, std::ostream &stream);
     void WriteTextMaterial(const Material& material, std::ostream &stream);
@@ -260,41 +262,74 @@ std::string ModelOutput::SpecialMarkToString(ModelSpecialMark specialMark)
 
 void ModelOutput::WriteBinaryModel(const CModel& model, std::ostream &stream)
 {
-    const CModelMesh* mesh = model.GetMesh("main");
-    if (mesh == nullptr)
-        throw CModelIOException("No main mesh found in model");
+    ModelHeaderV3 header;
+    header.version = 3;
+    header.totalCrashSpheres = model.GetCrashSphereCount();
+    header.hasShadowSpot = model.HasShadowSpot();
+    header.hasCameraCollisionSphere = model.HasCameraCollisionSphere();
+    header.totalMeshes = model.GetMeshCount();
 
-    ModelHeaderV1AndV2 header;
+    WriteBinary<4, int>(header.version, stream);
+    WriteBinary<4, int>(header.totalCrashSpheres, stream);
+    WriteBinaryBool(header.hasShadowSpot, stream);
+    WriteBinaryBool(header.hasCameraCollisionSphere, stream);
+    WriteBinary<4, int>(header.totalMeshes, stream);
 
-    header.version = 2;
-    header.totalTriangles = mesh->GetTriangleCount();
+    for (const auto& crashSphere : model.GetCrashSpheres())
+    {
+        WriteBinaryVector(crashSphere.position, stream);
+        WriteBinaryFloat(crashSphere.radius, stream);
+        WriteBinaryString<1>(crashSphere.sound, stream);
+        WriteBinaryFloat(crashSphere.hardness, stream);
+    }
 
-    WriteBinary<4, int>(header.version, stream);
-    WriteBinary<4, int>(header.totalTriangles, stream);
+    if (model.HasShadowSpot())
+    {
+        WriteBinaryFloat(model.GetShadowSpot().radius, stream);
+        WriteBinaryFloat(model.GetShadowSpot().intensity, stream);
+    }
 
-    for (const ModelTriangle& triangle : mesh->GetTriangles())
+    if (model.HasCameraCollisionSphere())
     {
-        ModelTriangleV1AndV2 t;
+        WriteBinaryVector(model.GetCameraCollisionSphere().pos, stream);
+        WriteBinaryFloat(model.GetCameraCollisionSphere().radius, stream);
+    }
 
-        t.p1 = triangle.p1;
-        t.p2 = triangle.p2;
-        t.p3 = triangle.p3;
-        t.material.ambient = triangle.ambient;
-        t.material.diffuse = triangle.diffuse;
-        t.material.specular = triangle.specular;
-        t.tex1Name = triangle.tex1Name;
-        t.tex2Name = triangle.tex2Name;
-        t.variableTex2 = triangle.variableTex2;
-        t.state = ConvertToOldState(triangle);
+    for (const std::string& meshName : model.GetMeshNames())
+    {
+        const CModelMesh* mesh = model.GetMesh(meshName);
+        assert(mesh != nullptr);
+        WriteBinaryMesh(mesh, meshName, stream);
+    }
+}
+
+void ModelOutput::WriteBinaryMesh(const CModelMesh* mesh, const std::string& meshName, std::ostream &stream)
+{
+    WriteBinaryString<1>(meshName, stream);
+    WriteBinaryVector(mesh->GetPosition(), stream);
+    WriteBinaryVector(mesh->GetRotation(), stream);
+    WriteBinaryVector(mesh->GetScale(), stream);
+    WriteBinaryString<1>(mesh->GetParent(), stream);
+    WriteBinary<4, int>(mesh->GetTriangleCount(), stream);
 
+    for (const ModelTriangle& t : mesh->GetTriangles())
+    {
         WriteBinaryVertexTex2(t.p1, stream);
         WriteBinaryVertexTex2(t.p2, stream);
         WriteBinaryVertexTex2(t.p3, stream);
-        WriteBinaryMaterial(t.material, stream);
+
+        Material material;
+        material.ambient = t.ambient;
+        material.diffuse = t.diffuse;
+        material.specular = t.specular;
+        WriteBinaryMaterial(material, stream);
+
         WriteBinaryString<1>(t.tex1Name, stream);
         WriteBinaryString<1>(t.tex2Name, stream);
         WriteBinaryBool(t.variableTex2, stream);
-        WriteBinary<4, int>(t.state, stream);
+        WriteBinary<1, int>(static_cast<int>(t.transparentMode), stream);
+        WriteBinary<1, int>(static_cast<int>(t.specialMark), stream);
+        WriteBinaryBool(t.doubleSided, stream);
     }
 }
 
@@ -452,6 +487,13 @@ void ModelOutput::WriteBinaryMaterial(const Material& material, std::ostream &st
     /* power */       WriteBinaryFloat(0.0f, stream);
 }
 
+void ModelOutput::WriteBinaryVector(const Math::Vector& vector, std::ostream &stream)
+{
+    WriteBinaryFloat(vector.x, stream);
+    WriteBinaryFloat(vector.y, stream);
+    WriteBinaryFloat(vector.z, stream);
+}
+
 void ModelOutput::WriteTextVertexTex2(const VertexTex2& vertex, std::ostream &stream)
 {
     stream << "c " << vertex.coord.x << " " << vertex.coord.y << " " << vertex.coord.z;
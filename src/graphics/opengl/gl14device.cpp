@@ -1505,6 +1505,17 @@ void CGL14Device::DrawStaticBuffer(unsigned int bufferId)
     glDrawArrays(mode, 0, (*it).second.vertexCount);
 }
 
+void CGL14Device::DrawStaticBufferInstanced(unsigned int bufferId, const Math::Matrix* transforms,
+                                            const Color* colors, int instanceCount)
+{
+    // No instanced arrays here, so instances are drawn one by one; colors are not supported
+    for (int i = 0; i < instanceCount; i++)
+    {
+        SetTransform(TRANSFORM_WORLD, transforms[i]);
+        DrawStaticBuffer(bufferId);
+    }
+}
+
 void CGL14Device::DestroyStaticBuffer(unsigned int bufferId)
 {
     auto it = m_vboObjects.find(bufferId);
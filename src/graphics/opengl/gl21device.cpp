@@ -1326,6 +1326,17 @@ void CGL21Device::DrawStaticBuffer(unsigned int bufferId)
     glDrawArrays(mode, 0, (*it).second.vertexCount);
 }
 
+void CGL21Device::DrawStaticBufferInstanced(unsigned int bufferId, const Math::Matrix* transforms,
+                                            const Color* colors, int instanceCount)
+{
+    // No instanced arrays here, so instances are drawn one by one; colors are not supported
+    for (int i = 0; i < instanceCount; i++)
+    {
+        SetTransform(TRANSFORM_WORLD, transforms[i]);
+        DrawStaticBuffer(bufferId);
+    }
+}
+
 void CGL21Device::DestroyStaticBuffer(unsigned int bufferId)
 {
     auto it = m_vboObjects.find(bufferId);
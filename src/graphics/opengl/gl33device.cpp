@@ -38,6 +38,7 @@
 #include <SDL.h>
 #include <physfs.h>
 
+#include <algorithm>
 #include <cassert>
 
 
@@ -364,6 +365,7 @@ bool CGL33Device::Create()
         uni.normalMatrix = glGetUniformLocation(m_normalProgram, "uni_NormalMatrix");
         uni.shadowMatrix = glGetUniformLocation(m_normalProgram, "uni_ShadowMatrix");
         uni.cameraPosition = glGetUniformLocation(m_normalProgram, "uni_CameraPosition");
+        uni.instanced = glGetUniformLocation(m_normalProgram, "uni_Instanced");
 
         uni.primaryTexture = glGetUniformLocation(m_normalProgram, "uni_PrimaryTexture");
         uni.secondaryTexture = glGetUniformLocation(m_normalProgram, "uni_SecondaryTexture");
@@ -422,6 +424,7 @@ bool CGL33Device::Create()
         glUniformMatrix4fv(uni.normalMatrix, 1, GL_FALSE, matrix.Array());
         glUniformMatrix4fv(uni.shadowMatrix, 1, GL_FALSE, matrix.Array());
         glUniform3f(uni.cameraPosition, 0.0f, 0.0f, 0.0f);
+        glUniform1i(uni.instanced, 0);
 
         glUniform1i(uni.primaryTexture, 0);
         glUniform1i(uni.secondaryTexture, 1);
@@ -535,6 +538,17 @@ bool CGL33Device::Create()
 
     m_vboMemory += m_dynamicBuffer.size;
 
+    // create instance attribute buffer
+    m_instanceBuffer.size = 1024 * 1024;
+    m_instanceBuffer.offset = 0;
+
+    glGenBuffers(1, &m_instanceBuffer.vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer.vbo);
+    glBufferData(GL_ARRAY_BUFFER, m_instanceBuffer.size, nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    m_vboMemory += m_instanceBuffer.size;
+
     GetLogger()->Info("CDevice created successfully\n");
 
     return true;
@@ -564,6 +578,10 @@ void CGL33Device::Destroy()
 
     m_vboMemory -= m_dynamicBuffer.size;
 
+    glDeleteBuffers(1, &m_instanceBuffer.vbo);
+
+    m_vboMemory -= m_instanceBuffer.size;
+
     m_lights.clear();
     m_lightsEnabled.clear();
 
@@ -1487,6 +1505,99 @@ void CGL33Device::DrawStaticBuffer(unsigned int bufferId)
     glDrawArrays(mode, 0, info.vertexCount);
 }
 
+void CGL33Device::DrawStaticBufferInstanced(unsigned int bufferId, const Math::Matrix* transforms,
+                                            const Color* colors, int instanceCount)
+{
+    // Only the normal shader reads instance attributes
+    if (m_mode != 0)
+    {
+        for (int i = 0; i < instanceCount; i++)
+        {
+            SetTransform(TRANSFORM_WORLD, transforms[i]);
+            DrawStaticBuffer(bufferId);
+        }
+        return;
+    }
+
+    if (m_updateLights) UpdateLights();
+
+    auto it = m_vboObjects.find(bufferId);
+    if (it == m_vboObjects.end())
+        return;
+
+    VertexBufferInfo &info = (*it).second;
+
+    // Per instance: model matrix, normal matrix and color
+    const int floatsPerInstance = 16 + 16 + 4;
+    const int stride = floatsPerInstance * sizeof(float);
+    const int maxBatch = m_instanceBuffer.size / stride;
+
+    GLenum mode = TranslateGfxPrimitive(info.primitiveType);
+
+    BindVAO(info.vao);
+    BindVBO(m_instanceBuffer.vbo);
+
+    for (int location = 5; location < 14; location++)
+    {
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);
+    }
+
+    glUniform1i(m_uni->instanced, 1);
+
+    for (int first = 0; first < instanceCount; first += maxBatch)
+    {
+        int count = std::min(instanceCount - first, maxBatch);
+
+        m_instanceData.resize(count * floatsPerInstance);
+        float* data = m_instanceData.data();
+
+        for (int i = 0; i < count; i++)
+        {
+            const Math::Matrix& matrix = transforms[first + i];
+
+            // Same normal matrix as SetTransform(), transposed when packed
+            Math::Matrix normalMat = matrix;
+            if (fabs(normalMat.Det()) > 1e-6)
+                normalMat = normalMat.Inverse();
+            normalMat = Math::Transpose(normalMat);
+
+            memcpy(data, matrix.m, 16 * sizeof(float));
+            memcpy(data + 16, normalMat.m, 16 * sizeof(float));
+
+            Color color = colors != nullptr ? colors[first + i] : Color(1.0f, 1.0f, 1.0f, 1.0f);
+            data[32] = color.r;
+            data[33] = color.g;
+            data[34] = color.b;
+            data[35] = color.a;
+
+            data += floatsPerInstance;
+        }
+
+        unsigned int offset = UploadVertexData(m_instanceBuffer, m_instanceData.data(), count * stride);
+
+        for (int column = 0; column < 8; column++)
+        {
+            glVertexAttribPointer(5 + column, 4, GL_FLOAT, GL_FALSE, stride,
+                reinterpret_cast<void*>(offset + column * 4 * sizeof(float)));
+        }
+
+        glVertexAttribPointer(13, 4, GL_FLOAT, GL_FALSE, stride,
+            reinterpret_cast<void*>(offset + 32 * sizeof(float)));
+
+        glDrawArraysInstanced(mode, 0, info.vertexCount, count);
+    }
+
+    glUniform1i(m_uni->instanced, 0);
+
+    // Leave the buffer's VAO as it was for ordinary draws
+    for (int location = 5; location < 14; location++)
+    {
+        glVertexAttribDivisor(location, 0);
+        glDisableVertexAttribArray(location);
+    }
+}
+
 void CGL33Device::DestroyStaticBuffer(unsigned int bufferId)
 {
     auto it = m_vboObjects.find(bufferId);
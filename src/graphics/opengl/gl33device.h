@@ -155,6 +155,8 @@ public:
         UpdateStaticBufferImpl(bufferId, primitiveType, vertices, vertexCount);
     }
     void DrawStaticBuffer(unsigned int bufferId) override;
+    void DrawStaticBufferInstanced(unsigned int bufferId, const Math::Matrix* transforms,
+                                   const Color* colors, int instanceCount) override;
     void DestroyStaticBuffer(unsigned int bufferId) override;
 
     int ComputeSphereVisibility(const Math::Vector &center, float radius) override;
@@ -307,6 +309,10 @@ private:
     GLuint m_shadowProgram = 0;
 
     DynamicBuffer m_dynamicBuffer;
+    //! Streamed per-instance attributes for DrawStaticBufferInstanced (VAO unused)
+    DynamicBuffer m_instanceBuffer;
+    //! Scratch storage for packing per-instance attributes
+    std::vector<float> m_instanceData;
 
     //! Current mode
     unsigned int m_mode = 0;
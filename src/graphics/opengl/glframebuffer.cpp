@@ -297,6 +297,25 @@ void CGLFramebuffer::CopyToScreen(int fromX, int fromY, int fromWidth, int fromH
     glBindFramebuffer(GL_FRAMEBUFFER, m_currentFBO);
 }
 
+void CGLFramebuffer::CopyDepthTo(CFramebuffer* target)
+{
+    GLuint targetFBO = 0;
+    if (!target->IsDefault())
+    {
+        CGLFramebuffer* framebuffer = dynamic_cast<CGLFramebuffer*>(target);
+        if (framebuffer == nullptr) return;
+        targetFBO = framebuffer->m_fbo;
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fbo);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, targetFBO);
+
+    glBlitFramebuffer(0, 0, m_width, m_height,
+        0, 0, m_width, m_height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_currentFBO);
+}
+
 // CGLFramebufferEXT
 GLuint CGLFramebufferEXT::m_currentFBO = 0;
 
@@ -572,4 +591,23 @@ void CGLFramebufferEXT::CopyToScreen(int fromX, int fromY, int fromWidth, int fr
     glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, m_currentFBO);
 }
 
+void CGLFramebufferEXT::CopyDepthTo(CFramebuffer* target)
+{
+    GLuint targetFBO = 0;
+    if (!target->IsDefault())
+    {
+        CGLFramebufferEXT* framebuffer = dynamic_cast<CGLFramebufferEXT*>(target);
+        if (framebuffer == nullptr) return;
+        targetFBO = framebuffer->m_fbo;
+    }
+
+    glBindFramebufferEXT(GL_READ_FRAMEBUFFER_EXT, m_fbo);
+    glBindFramebufferEXT(GL_DRAW_FRAMEBUFFER_EXT, targetFBO);
+
+    glBlitFramebufferEXT(0, 0, m_width, m_height,
+            0, 0, m_width, m_height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+    glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, m_currentFBO);
+}
+
 } // end of Gfx
@@ -74,6 +74,9 @@ public:
     void Unbind() override;
 
     void CopyToScreen(int fromX, int fromY, int fromWidth, int fromHeight, int toX, int toY, int toWidth, int toHeight) override;
+
+    //! Copies content of depth buffer to another framebuffer
+    void CopyDepthTo(CFramebuffer* target) override;
 };
 
 /**
@@ -124,6 +127,9 @@ public:
     void Unbind() override;
 
     void CopyToScreen(int fromX, int fromY, int fromWidth, int fromHeight, int toX, int toY, int toWidth, int toHeight) override;
+
+    //! Copies content of depth buffer to another framebuffer
+    void CopyDepthTo(CFramebuffer* target) override;
 };
 
 } // end of Gfx
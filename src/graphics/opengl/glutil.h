@@ -169,6 +169,8 @@ struct UniformLocations
     GLint normalMatrix = -1;
     //! Camera position
     GLint cameraPosition = -1;
+    //! true takes model and normal matrices from instance attributes
+    GLint instanced = -1;
 
     //! Primary texture sampler
     GLint primaryTexture = -1;
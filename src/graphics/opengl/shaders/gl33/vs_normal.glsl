@@ -26,6 +26,7 @@ uniform mat4 uni_ModelMatrix;
 uniform mat4 uni_ShadowMatrix;
 uniform mat4 uni_NormalMatrix;
 uniform vec3 uni_CameraPosition;
+uniform bool uni_Instanced;
 
 layout(location = 0) in vec4 in_VertexCoord;
 layout(location = 1) in vec3 in_Normal;
@@ -33,6 +34,11 @@ layout(location = 2) in vec4 in_Color;
 layout(location = 3) in vec2 in_TexCoord0;
 layout(location = 4) in vec2 in_TexCoord1;
 
+// Per-instance attributes, used when uni_Instanced is true
+layout(location = 5) in mat4 in_ModelMatrix;
+layout(location = 9) in mat4 in_NormalMatrix;
+layout(location = 13) in vec4 in_InstanceColor;
+
 out VertexData
 {
     vec4 Color;
@@ -47,15 +53,26 @@ out VertexData
 
 void main()
 {
-    vec4 position = uni_ModelMatrix * in_VertexCoord;
+    mat4 modelMatrix = uni_ModelMatrix;
+    mat4 normalMatrix = uni_NormalMatrix;
+    vec4 color = in_Color;
+
+    if (uni_Instanced)
+    {
+        modelMatrix = in_ModelMatrix;
+        normalMatrix = in_NormalMatrix;
+        color = color * in_InstanceColor;
+    }
+
+    vec4 position = modelMatrix * in_VertexCoord;
     vec4 eyeSpace = uni_ViewMatrix * position;
     gl_Position = uni_ProjectionMatrix * eyeSpace;
     vec4 shadowCoord = uni_ShadowMatrix * position;
 
-    data.Color = in_Color;
+    data.Color = color;
     data.TexCoord0 = in_TexCoord0;
     data.TexCoord1 = in_TexCoord1;
-    data.Normal = normalize((uni_NormalMatrix * vec4(in_Normal, 0.0f)).xyz);
+    data.Normal = normalize((normalMatrix * vec4(in_Normal, 0.0f)).xyz);
     data.ShadowCoord = vec4(shadowCoord.xyz / shadowCoord.w, 1.0f);
     data.Distance = abs(eyeSpace.z);
     data.CameraDirection = uni_CameraPosition - position.xyz;
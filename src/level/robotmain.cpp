@@ -20,6 +20,7 @@
 #include "level/robotmain.h"
 
 #include "CBot/CBot.h"
+#include "CBot/CBotVar/CBotVarClass.h"
 
 #include "app/app.h"
 #include "app/input.h"
@@ -27,8 +28,10 @@
 
 #include "common/config_file.h"
 #include "common/event.h"
+#include "common/image.h"
 #include "common/logger.h"
 #include "common/make_unique.h"
+#include "common/profiler.h"
 #include "common/restext.h"
 #include "common/settings.h"
 #include "common/stringutils.h"
@@ -37,6 +40,8 @@
 #include "common/resources/outputstream.h"
 #include "common/resources/resourcemanager.h"
 
+#include "common/thread/worker_pool.h"
+
 #include "graphics/engine/camera.h"
 #include "graphics/engine/cloud.h"
 #include "graphics/engine/engine.h"
@@ -63,12 +68,15 @@
 #include "math/func.h"
 #include "math/geometry.h"
 
+#include "object/navigation_grid.h"
 #include "object/object.h"
 #include "object/object_create_exception.h"
 #include "object/object_manager.h"
 
 #include "object/auto/auto.h"
 
+#include "object/interface/program_storage_object.h"
+#include "object/interface/programmable_object.h"
 #include "object/interface/slotted_object.h"
 
 #include "object/motion/motion.h"
@@ -81,6 +89,7 @@
 #include "object/task/taskbuild.h"
 #include "object/task/taskmanip.h"
 
+#include "physics/broad_phase.h"
 #include "physics/physics.h"
 
 #include "script/cbottoken.h"
@@ -111,6 +120,7 @@
 
 #include <algorithm>
 #include <iomanip>
+#include <sstream>
 #include <stdexcept>
 #include <cmath>
 #include <ctime>
@@ -163,12 +173,16 @@ CRobotMain::CRobotMain()
     m_short       = MakeUnique<Ui::CMainShort>();
     m_map         = MakeUnique<Ui::CMainMap>();
 
+    m_navigationGrid = MakeUnique<CNavigationGrid>(m_terrain.get(), m_water);
+    m_broadPhase = MakeUnique<CBroadPhase>();
     m_objMan = MakeUnique<CObjectManager>(
         m_engine,
         m_terrain.get(),
         m_oldModelManager,
         m_modelManager.get(),
-        m_particle);
+        m_particle,
+        m_navigationGrid.get(),
+        m_broadPhase.get());
 
     m_debugMenu   = MakeUnique<Ui::CDebugMenu>(this, m_engine, m_objMan.get(), m_sound);
 
@@ -314,6 +328,16 @@ CPauseManager* CRobotMain::GetPauseManager()
     return m_pause.get();
 }
 
+CBroadPhase* CRobotMain::GetBroadPhase()
+{
+    return m_broadPhase.get();
+}
+
+CNavigationGrid* CRobotMain::GetNavigationGrid()
+{
+    return m_navigationGrid.get();
+}
+
 std::string PhaseToString(Phase phase)
 {
     if (phase == PHASE_WELCOME1) return "PHASE_WELCOME1";
@@ -391,6 +415,7 @@ void CRobotMain::ChangePhase(Phase phase)
         if (m_phase == PHASE_SIMUL)  // ends a simulation?
         {
             SaveAllScript();
+            SaveModelManifest();  // includes the models first used during the mission
             m_sound->StopMusic(0.0f);
             m_camera->SetControllingObject(nullptr);
 
@@ -1490,6 +1515,17 @@ void CRobotMain::ExecuteCmd(const std::string& cmd)
         return;
     }
 
+    if (cmd == "cbotinstances")
+    {
+        auto counts = CBot::CBotVarClass::GetInstanceCounts();
+        GetLogger()->Info("Live CBot class instances: %d classes\n", static_cast<int>(counts.size()));
+        for (const auto& count : counts)
+        {
+            GetLogger()->Info("  %s: %d\n", count.first.c_str(), count.second);
+        }
+        return;
+    }
+
     float speed;
     if (sscanf(cmd.c_str(), "speed %f", &speed) > 0)
     {
@@ -2366,6 +2402,11 @@ bool CRobotMain::EventFrame(const Event &event)
     CObject* toto = nullptr;
     if (!m_pause->IsPauseType(PAUSE_OBJECT_UPDATES))
     {
+        m_broadPhase->Update();
+
+        if (m_concurrentPrograms)
+            RunProgramsConcurrently();
+
         // Advances all the robots, but not toto.
         for (CObject* obj : m_objMan->GetAllObjects())
         {
@@ -2705,6 +2746,157 @@ void CRobotMain::ScenePerso()
     }
 }
 
+std::string CRobotMain::GetManifestPath(const std::string& type)
+{
+    return "cache/" + type + "_" + GetLevelCategoryDir(m_levelCategory) + "_" +
+        StrUtils::ToString<int>(m_levelChap) + "_" + StrUtils::ToString<int>(m_levelRank) + ".txt";
+}
+
+void CRobotMain::PreloadLevelTextures()
+{
+    std::string path = GetManifestPath("textures");
+    if (!CResourceManager::Exists(path))
+        return;
+
+    CInputStream file(path);
+    if (!file.is_open())
+        return;
+
+    std::vector<std::string> names;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (!line.empty())
+            names.push_back(line);
+    }
+
+    GetLogger()->Debug("Preloading %d textures from %s\n", static_cast<int>(names.size()), path.c_str());
+    m_engine->PreloadTextures(names);
+}
+
+void CRobotMain::SaveTextureManifest()
+{
+    if (!CResourceManager::DirectoryExists("cache"))
+        CResourceManager::CreateNewDirectory("cache");
+
+    std::string path = GetManifestPath("textures");
+    COutputStream file(path);
+    if (!file.is_open())
+    {
+        GetLogger()->Warn("Unable to write texture list %s\n", path.c_str());
+        return;
+    }
+
+    for (const std::string& name : m_engine->GetObjectTextureNames())
+        file << name << "\n";
+}
+
+void CRobotMain::PreloadLevelModels()
+{
+    std::string path = GetManifestPath("models");
+    if (CResourceManager::Exists(path))
+    {
+        CInputStream file(path);
+        if (file.is_open())
+        {
+            std::vector<Gfx::COldModelManager::FileInfo> models;
+            std::string line;
+            while (std::getline(file, line))
+            {
+                std::stringstream str(line);
+                std::string fileName;
+                bool mirrored = false;
+                int variant = 0;
+                if (str >> fileName >> mirrored >> variant)
+                    models.push_back(Gfx::COldModelManager::FileInfo(fileName, mirrored, variant));
+            }
+
+            m_oldModelManager->PreloadModels(models);
+        }
+    }
+
+    m_oldModelManager->ClearUsedModels();
+}
+
+void CRobotMain::SaveModelManifest()
+{
+    if (!CResourceManager::DirectoryExists("cache"))
+        CResourceManager::CreateNewDirectory("cache");
+
+    std::string path = GetManifestPath("models");
+    COutputStream file(path);
+    if (!file.is_open())
+    {
+        GetLogger()->Warn("Unable to write model list %s\n", path.c_str());
+        return;
+    }
+
+    for (const auto& model : m_oldModelManager->GetUsedModels())
+        file << model.fileName << " " << model.mirrored << " " << model.variant << "\n";
+}
+
+namespace
+{
+
+//! Sums up the time spent in each stage of scene loading, for the log
+class CLoadingStageTimer
+{
+public:
+    //! Ends the current stage, if any, and starts the given one
+    void Enter(const std::string& stage)
+    {
+        TimeUtils::TimeStamp now = std::chrono::high_resolution_clock::now();
+        if (!m_stage.empty())
+            m_durations[m_stage] += TimeUtils::Diff(m_start, now, TimeUtils::TimeUnit::MILLISECONDS);
+
+        if (!stage.empty() && m_durations.find(stage) == m_durations.end())
+        {
+            m_durations[stage] = 0.0f;
+            m_order.push_back(stage);
+        }
+
+        m_stage = stage;
+        m_start = now;
+    }
+
+    //! Ends the current stage and writes the time of all stages to the log
+    void Finish()
+    {
+        Enter("");
+
+        float total = 0.0f;
+        for (const std::string& stage : m_order)
+        {
+            GetLogger()->Info("Scene loading stage '%s': %.1f ms\n", stage.c_str(), m_durations[stage]);
+            total += m_durations[stage];
+        }
+        GetLogger()->Info("Scene loading total: %.1f ms\n", total);
+    }
+
+private:
+    std::string m_stage;
+    TimeUtils::TimeStamp m_start;
+    std::vector<std::string> m_order;
+    std::map<std::string, float> m_durations;
+};
+
+//! Returns the loading stage a level file command belongs to
+std::string GetLoadingStage(const std::string& command)
+{
+    if (command.compare(0, 7, "Terrain") == 0)
+        return "terrain";
+
+    if (command == "CreateObject" || command == "BeginObject" || command == "LevelController")
+        return "objects";
+
+    if (command == "CacheAudio" || command == "AudioChange" || command == "Audio")
+        return "audio";
+
+    return "settings";
+}
+
+} // anonymous namespace
+
 //! Creates the whole scene
 void CRobotMain::CreateScene(bool soluce, bool fixScene, bool resetObject)
 {
@@ -2801,13 +2993,59 @@ void CRobotMain::CreateScene(bool soluce, bool fixScene, bool resetObject)
         m_ui->GetDialog()->StartInformation("Level loading warning", "This level contains problems. It may stop working in future versions of the game.", message);
     };
 
+    CLoadingStageTimer stageTimer;
+
     try
     {
         m_ui->GetLoadingScreen()->SetProgress(0.05f, RT_LOADING_PROCESSING);
         GetLogger()->Info("Loading level: %s\n", m_levelFile.c_str());
+
+        stageTimer.Enter("textures");
+        if (!resetObject)
+            PreloadLevelTextures();  // decoded on worker threads while the level is loaded
+
+        stageTimer.Enter("parsing");
         CLevelParser levelParser(m_levelFile);
         levelParser.SetLevelPaths(m_levelCategory, m_levelChap, m_levelRank);
         levelParser.Load();
+
+        // Terrain images are decoded on worker threads while the models are loaded
+        std::map<std::string, std::unique_ptr<CImage>> terrainImages;
+        std::unique_ptr<CWorkerPool> terrainImagePool;  // only started if the level has terrain images
+        if (!resetObject)
+        {
+            for (auto& line : levelParser.GetLines())
+            {
+                if (line->GetCommand() != "TerrainRelief" && line->GetCommand() != "TerrainResource")
+                    continue;
+
+                std::string path = line->GetParam("image")->AsPath("textures");
+                if (terrainImages.find(path) != terrainImages.end())
+                    continue;
+
+                if (terrainImagePool == nullptr)
+                    terrainImagePool = MakeUnique<CWorkerPool>();
+
+                CImage* image = (terrainImages[path] = MakeUnique<CImage>()).get();
+                terrainImagePool->Start([image, path]() { image->Load(path); });
+            }
+        }
+
+        // Returns the decoded terrain image, or nullptr if decoding failed
+        auto GetTerrainImage = [&](const std::string& path) -> CImage*
+        {
+            if (terrainImagePool != nullptr)
+                terrainImagePool->Wait();
+            auto it = terrainImages.find(path);
+            if (it == terrainImages.end() || it->second->IsEmpty())
+                return nullptr;
+            return it->second.get();
+        };
+
+        stageTimer.Enter("models");
+        if (!resetObject)
+            PreloadLevelModels();  // read on worker threads
+
         int numObjects = levelParser.CountLines("CreateObject");
         m_ui->GetLoadingScreen()->SetProgress(0.1f, RT_LOADING_LEVEL_SETTINGS);
 
@@ -2816,6 +3054,8 @@ void CRobotMain::CreateScene(bool soluce, bool fixScene, bool resetObject)
 
         for (auto& line : levelParser.GetLines())
         {
+            stageTimer.Enter(GetLoadingStage(line->GetCommand()));
+
             if (line->GetCommand() == "Title" && !resetObject)
             {
                 //strcpy(m_title, line->GetParam("text")->AsString().c_str());
@@ -3165,10 +3405,14 @@ void CRobotMain::CreateScene(bool soluce, bool fixScene, bool resetObject)
             if (line->GetCommand() == "TerrainRelief" && !resetObject)
             {
                 m_ui->GetLoadingScreen()->SetProgress(0.2f+(1.f/5.f)*0.05f, RT_LOADING_TERRAIN, RT_LOADING_TERRAIN_RELIEF);
-                m_terrain->LoadRelief(
-                    line->GetParam("image")->AsPath("textures"),
-                    line->GetParam("factor")->AsFloat(1.0f),
-                    line->GetParam("border")->AsBool(true));
+                std::string path = line->GetParam("image")->AsPath("textures");
+                float factor = line->GetParam("factor")->AsFloat(1.0f);
+                bool border = line->GetParam("border")->AsBool(true);
+                CImage* image = GetTerrainImage(path);
+                if (image != nullptr)
+                    m_terrain->LoadRelief(*image, factor, border);
+                else
+                    m_terrain->LoadRelief(path, factor, border);
                 continue;
             }
 
@@ -3182,7 +3426,12 @@ void CRobotMain::CreateScene(bool soluce, bool fixScene, bool resetObject)
             if (line->GetCommand() == "TerrainResource" && !resetObject)
             {
                 m_ui->GetLoadingScreen()->SetProgress(0.2f+(2.f/5.f)*0.05f, RT_LOADING_TERRAIN, RT_LOADING_TERRAIN_RES);
-                m_terrain->LoadResources(line->GetParam("image")->AsPath("textures"));
+                std::string path = line->GetParam("image")->AsPath("textures");
+                CImage* image = GetTerrainImage(path);
+                if (image != nullptr)
+                    m_terrain->LoadResources(*image);
+                else
+                    m_terrain->LoadResources(path);
                 continue;
             }
 
@@ -3734,6 +3983,8 @@ void CRobotMain::CreateScene(bool soluce, bool fixScene, bool resetObject)
             throw CLevelParserException("Unknown command: '" + line->GetCommand() + "' in " + line->GetLevelFilename() + ":" + boost::lexical_cast<std::string>(line->GetLineNumber()));
         }
 
+        stageTimer.Enter("finishing");
+
         // Do this here to prevent the first frame from taking a long time to render
         m_engine->UpdateGroundSpotTextures();
 
@@ -3840,6 +4091,14 @@ void CRobotMain::CreateScene(bool soluce, bool fixScene, bool resetObject)
     }
     m_sceneReadPath = "";
 
+    if (!resetObject)
+    {
+        SaveTextureManifest();
+        SaveModelManifest();
+    }
+
+    stageTimer.Finish();
+
     if (m_app->GetSceneTestMode())
         m_eventQueue->AddEvent(Event(EVENT_QUIT));
 
@@ -5773,6 +6032,46 @@ int CRobotMain::GetAutosaveSlots()
     return m_autosaveSlots;
 }
 
+void CRobotMain::SetConcurrentPrograms(bool enable)
+{
+    m_concurrentPrograms = enable;
+    if (!m_concurrentPrograms)
+        m_programPool.reset();
+}
+
+bool CRobotMain::GetConcurrentPrograms()
+{
+    return m_concurrentPrograms;
+}
+
+void CRobotMain::RunProgramsConcurrently()
+{
+    std::vector<CScript*> scripts;
+    for (CObject* obj : m_objMan->GetAllObjects())
+    {
+        // Programs running concurrently don't update the objects they read
+        CBot::CBotVar* botVar = obj->GetBotVar();
+        if (botVar != nullptr)
+            botVar->Update(nullptr);
+
+        if (!obj->Implements(ObjectInterfaceType::Programmable))
+            continue;
+
+        CProgrammableObject* programmable = dynamic_cast<CProgrammableObject*>(obj);
+        if (programmable->GetActivity() && programmable->IsProgram())
+            scripts.push_back(programmable->GetCurrentProgram()->script.get());
+    }
+
+    if (m_programPool == nullptr)
+        m_programPool = MakeUnique<CWorkerPool>();
+
+    CProfiler::StartPerformanceCounter(PCNT_UPDATE_CBOT);
+    for (CScript* script : scripts)
+        m_programPool->Start([script]() { script->ContinueConcurrent(); });
+    m_programPool->Wait();
+    CProfiler::StopPerformanceCounter(PCNT_UPDATE_CBOT);
+}
+
 // Remove oldest saves with autosave prefix
 void CRobotMain::AutosaveRotate()
 {
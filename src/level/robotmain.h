@@ -93,6 +93,9 @@ class CPlayerProfile;
 class CSettings;
 class COldObject;
 class CPauseManager;
+class CBroadPhase;
+class CNavigationGrid;
+class CWorkerPool;
 struct ActivePause;
 
 namespace Gfx
@@ -188,6 +191,8 @@ public:
     Ui::CInterface* GetInterface();
     Ui::CDisplayText* GetDisplayText();
     CPauseManager* GetPauseManager();
+    CBroadPhase* GetBroadPhase();
+    CNavigationGrid* GetNavigationGrid();
 
     /**
      * \name Phase management
@@ -365,6 +370,19 @@ public:
     int         GetAutosaveSlots();
     //@}
 
+    /**
+     * \name Concurrent execution of programs
+     *
+     * When enabled, the computations of all programs run on worker threads at
+     * the start of each frame. Everything acting on the game still happens in
+     * the order of the objects, but programs see the objects as they were at the
+     * start of the frame.
+     */
+    //@{
+    void        SetConcurrentPrograms(bool enable);
+    bool        GetConcurrentPrograms();
+    //@}
+
     //! Enable mode where completing mission closes the game
     void        SetExitAfterMission(bool exit);
 
@@ -492,6 +510,8 @@ public:
 
 protected:
     bool        EventFrame(const Event &event);
+    //! Runs the part of the programs' time slices that doesn't act on the game, see SetConcurrentPrograms()
+    void        RunProgramsConcurrently();
     bool        EventObject(const Event &event);
     void        InitEye();
 
@@ -500,6 +520,17 @@ protected:
     void        CreateScene(bool soluce, bool fixScene, bool resetObject);
     void        ResetCreate();
 
+    //! Returns path of the list of resources of given type used by the current level
+    std::string GetManifestPath(const std::string& type);
+    //! Starts decoding the textures the current level used last time
+    void        PreloadLevelTextures();
+    //! Saves the list of textures used by the current level
+    void        SaveTextureManifest();
+    //! Loads the models the current level used last time
+    void        PreloadLevelModels();
+    //! Saves the list of models used by the current level
+    void        SaveModelManifest();
+
     void        LevelLoadingError(const std::string& error, const std::runtime_error& exception, Phase exitPhase = PHASE_LEVEL_LIST);
 
     int         CreateLight(Math::Vector direction, Gfx::Color color);
@@ -565,7 +596,9 @@ protected:
     Gfx::CLightManager* m_lightMan = nullptr;
     CSoundInterface*    m_sound = nullptr;
     CInput*             m_input = nullptr;
+    std::unique_ptr<CNavigationGrid> m_navigationGrid;
     std::unique_ptr<CObjectManager> m_objMan;
+    std::unique_ptr<CBroadPhase> m_broadPhase;
     std::unique_ptr<CMainMovie> m_movie;
     std::unique_ptr<CPauseManager> m_pause;
     std::unique_ptr<Gfx::CModelManager> m_modelManager;
@@ -730,6 +763,9 @@ protected:
     int             m_autosaveSlots = 0;
     float           m_autosaveLast = 0.0f;
 
+    bool            m_concurrentPrograms = false;
+    std::unique_ptr<CWorkerPool> m_programPool;
+
     int             m_shotSaving = 0;
 
     std::deque<CObject*> m_selectionHistory;
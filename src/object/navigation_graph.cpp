@@ -0,0 +1,430 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2023, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+
+#include "object/navigation_graph.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+
+
+namespace
+{
+
+//! Number of paths kept by each graph
+const int MAX_CACHED_PATHS = 32;
+//! Runs of free cells along a border up to this length get one entrance in the middle, longer ones get one at each end
+const int MAX_SHORT_ENTRANCE = 6;
+//! Costs of moves between cells, same as in CTaskGoto
+const int STRAIGHT_COST = 5;
+const int DIAGONAL_COST = 7;
+
+int OctileDistance(int x1, int y1, int x2, int y2)
+{
+    const int distX = std::abs(x1 - x2);
+    const int distY = std::abs(y1 - y2);
+    const int smaller = std::min(distX, distY);
+    const int bigger = std::max(distX, distY);
+    return smaller * (DIAGONAL_COST - STRAIGHT_COST) + bigger * STRAIGHT_COST;
+}
+
+} // anonymous namespace
+
+
+CNavigationGraph::CNavigationGraph(CNavigationGrid* grid, const CNavigationGrid::TerrainProfile& profile, int layer)
+    : m_grid(grid),
+      m_profile(profile),
+      m_layer(layer),
+      m_size(grid->GetSize()),
+      m_chunkCount(grid->GetChunkCount())
+{
+    m_clusters.resize(m_chunkCount * m_chunkCount);
+}
+
+CNavigationGraph::~CNavigationGraph()
+{
+}
+
+bool CNavigationGraph::IsFor(const CNavigationGrid::TerrainProfile& profile, int layer) const
+{
+    return m_layer == layer &&
+           m_profile.slopeLimit == profile.slopeLimit &&
+           m_profile.acceptWater == profile.acceptWater &&
+           m_profile.flying == profile.flying;
+}
+
+// Returns the cluster, computing it again if the grid changed around it.
+
+CNavigationGraph::Cluster& CNavigationGraph::GetCluster(int chunkX, int chunkY)
+{
+    unsigned int stamp = m_grid->GetChunkVersion(chunkX, chunkY);
+    if (chunkX > 0)                stamp += m_grid->GetChunkVersion(chunkX-1, chunkY);
+    if (chunkX < m_chunkCount-1)   stamp += m_grid->GetChunkVersion(chunkX+1, chunkY);
+    if (chunkY > 0)                stamp += m_grid->GetChunkVersion(chunkX, chunkY-1);
+    if (chunkY < m_chunkCount-1)   stamp += m_grid->GetChunkVersion(chunkX, chunkY+1);
+
+    Cluster& cluster = m_clusters[chunkY * m_chunkCount + chunkX];
+    if (!cluster.ready || cluster.stamp != stamp)
+    {
+        BuildCluster(chunkX, chunkY, cluster);
+        cluster.ready = true;
+        cluster.stamp = stamp;
+    }
+    return cluster;
+}
+
+void CNavigationGraph::BuildCluster(int chunkX, int chunkY, Cluster& cluster)
+{
+    cluster.nodes.clear();
+    AddEntrances(chunkX, chunkY, -1,  0, cluster.nodes);
+    AddEntrances(chunkX, chunkY,  1,  0, cluster.nodes);
+    AddEntrances(chunkX, chunkY,  0, -1, cluster.nodes);
+    AddEntrances(chunkX, chunkY,  0,  1, cluster.nodes);
+
+    const int n = cluster.nodes.size();
+    cluster.distances.assign(n * n, -1);
+
+    auto isFree = [this](int x, int y) { return m_grid->IsCellFree(x, y, m_profile, m_layer); };
+    std::vector<int> distances;
+    for (int i = 0; i < n; ++i)
+    {
+        SearchCluster(chunkX, chunkY, cluster.nodes[i], isFree, distances);
+        for (int j = 0; j < n; ++j)
+        {
+            int x = cluster.nodes[j] % m_size - chunkX * NAVIGATION_CHUNK_SIZE;
+            int y = cluster.nodes[j] / m_size - chunkY * NAVIGATION_CHUNK_SIZE;
+            cluster.distances[i * n + j] = distances[y * NAVIGATION_CHUNK_SIZE + x];
+        }
+    }
+}
+
+// Adds entrances on the border with the neighbouring cluster in direction dx, dy.
+// Both clusters find the same runs, so each entrance has a matching one on the other side.
+
+void CNavigationGraph::AddEntrances(int chunkX, int chunkY, int dx, int dy, std::vector<int>& nodes)
+{
+    if (chunkX + dx < 0 || chunkX + dx >= m_chunkCount ||
+        chunkY + dy < 0 || chunkY + dy >= m_chunkCount)  return;
+
+    const int minX = chunkX * NAVIGATION_CHUNK_SIZE;
+    const int minY = chunkY * NAVIGATION_CHUNK_SIZE;
+    const int maxX = std::min(m_size, minX + NAVIGATION_CHUNK_SIZE) - 1;
+    const int maxY = std::min(m_size, minY + NAVIGATION_CHUNK_SIZE) - 1;
+
+    // Cells along the border, on this side
+    int x = dx < 0 ? minX : maxX;
+    int y = dy < 0 ? minY : maxY;
+    int stepX = dx == 0 ? 1 : 0;
+    int stepY = dy == 0 ? 1 : 0;
+    if (dx == 0)  x = minX;
+    if (dy == 0)  y = minY;
+    const int length = dx == 0 ? maxX - minX + 1 : maxY - minY + 1;
+
+    auto addNode = [&](int k)
+    {
+        int cell = (y + k * stepY) * m_size + (x + k * stepX);
+        if (std::find(nodes.begin(), nodes.end(), cell) == nodes.end())
+            nodes.push_back(cell);
+    };
+
+    int runStart = -1;
+    for (int k = 0; k <= length; ++k)
+    {
+        bool free = k < length &&
+                    m_grid->IsCellFree(x + k * stepX,      y + k * stepY,      m_profile, m_layer) &&
+                    m_grid->IsCellFree(x + k * stepX + dx, y + k * stepY + dy, m_profile, m_layer);
+        if (free)
+        {
+            if (runStart < 0)  runStart = k;
+            continue;
+        }
+        if (runStart < 0)  continue;
+
+        int runEnd = k - 1;
+        if (runEnd - runStart + 1 <= MAX_SHORT_ENTRANCE)
+        {
+            addNode((runStart + runEnd) / 2);
+        }
+        else
+        {
+            addNode(runStart);
+            addNode(runEnd);
+        }
+        runStart = -1;
+    }
+}
+
+// Computes distances from a cell to all cells of its cluster.
+// Distances are stored by position inside the cluster, -1 if unreachable.
+
+template<typename F>
+void CNavigationGraph::SearchCluster(int chunkX, int chunkY, int startCell, F&& isFree, std::vector<int>& distances)
+{
+    static const int dXs[8] = {-1, 0, 1, -1, 1, -1, 0, 1};
+    static const int dYs[8] = {-1, -1, -1, 0, 0, 1, 1, 1};
+    static const int dDist[8] = {DIAGONAL_COST, STRAIGHT_COST, DIAGONAL_COST, STRAIGHT_COST,
+                                 STRAIGHT_COST, DIAGONAL_COST, STRAIGHT_COST, DIAGONAL_COST};
+
+    const int minX = chunkX * NAVIGATION_CHUNK_SIZE;
+    const int minY = chunkY * NAVIGATION_CHUNK_SIZE;
+    const int maxX = std::min(m_size, minX + NAVIGATION_CHUNK_SIZE) - 1;
+    const int maxY = std::min(m_size, minY + NAVIGATION_CHUNK_SIZE) - 1;
+
+    distances.assign(NAVIGATION_CHUNK_SIZE * NAVIGATION_CHUNK_SIZE, -1);
+
+    using Entry = std::pair<int, int>;  // distance, position inside the cluster
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+
+    int start = (startCell / m_size - minY) * NAVIGATION_CHUNK_SIZE + (startCell % m_size - minX);
+    distances[start] = 0;
+    queue.emplace(0, start);
+
+    while (!queue.empty())
+    {
+        Entry entry = queue.top();
+        queue.pop();
+        if (entry.first != distances[entry.second])  continue;  // already reached by a shorter way
+
+        const int x = minX + entry.second % NAVIGATION_CHUNK_SIZE;
+        const int y = minY + entry.second / NAVIGATION_CHUNK_SIZE;
+        for (int i = 0; i < 8; ++i)
+        {
+            const int nX = x + dXs[i];
+            const int nY = y + dYs[i];
+            if (nX < minX || nX > maxX || nY < minY || nY > maxY)  continue;
+            if (!isFree(nX, nY))  continue;
+
+            const int position = (nY - minY) * NAVIGATION_CHUNK_SIZE + (nX - minX);
+            const int distance = entry.first + dDist[i];
+            if (distances[position] >= 0 && distances[position] <= distance)  continue;
+            distances[position] = distance;
+            queue.emplace(distance, position);
+        }
+    }
+}
+
+int CNavigationGraph::GetNodeIndex(const Cluster& cluster, int cell) const
+{
+    auto it = std::find(cluster.nodes.begin(), cluster.nodes.end(), cell);
+    if (it == cluster.nodes.end())  return -1;
+    return it - cluster.nodes.begin();
+}
+
+bool CNavigationGraph::FindRoute(int startX, int startY, int goalX, int goalY,
+                                 const std::function<bool(int, int)>& isFree, std::vector<int>& chunks)
+{
+    chunks.clear();
+
+    if (startX < 0 || startX >= m_size || startY < 0 || startY >= m_size ||
+        goalX < 0 || goalX >= m_size || goalY < 0 || goalY >= m_size)  return false;
+
+    const int startChunkX = startX / NAVIGATION_CHUNK_SIZE;
+    const int startChunkY = startY / NAVIGATION_CHUNK_SIZE;
+    const int goalChunkX = goalX / NAVIGATION_CHUNK_SIZE;
+    const int goalChunkY = goalY / NAVIGATION_CHUNK_SIZE;
+    if (startChunkX == goalChunkX && startChunkY == goalChunkY)  return false;
+
+    // Start and goal are connected to entrances of their clusters
+    // with the passability of the robot, which can differ from the shared one.
+    std::vector<int> startDistances, goalDistances;
+    SearchCluster(startChunkX, startChunkY, startY * m_size + startX, isFree, startDistances);
+    SearchCluster(goalChunkX, goalChunkY, goalY * m_size + goalX, isFree, goalDistances);
+
+    auto position = [this](int cell)
+    {
+        return (cell / m_size % NAVIGATION_CHUNK_SIZE) * NAVIGATION_CHUNK_SIZE + cell % m_size % NAVIGATION_CHUNK_SIZE;
+    };
+
+    using Entry = std::pair<int, int>;  // estimated total distance, cell or -1 for the goal
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    std::unordered_map<int, int> costs;
+    std::unordered_map<int, int> parents;
+    int goalCost = -1;
+    int goalParent = -1;
+
+    auto push = [&](int cell, int cost, int parent)
+    {
+        auto it = costs.find(cell);
+        if (it != costs.end() && it->second <= cost)  return;
+        costs[cell] = cost;
+        parents[cell] = parent;
+        open.emplace(cost + OctileDistance(cell % m_size, cell / m_size, goalX, goalY), cell);
+    };
+
+    const Cluster& startCluster = GetCluster(startChunkX, startChunkY);
+    for (int node : startCluster.nodes)
+    {
+        int distance = startDistances[position(node)];
+        if (distance >= 0)  push(node, distance, -1);
+    }
+
+    while (!open.empty())
+    {
+        Entry entry = open.top();
+        open.pop();
+        if (entry.second == -1)  break;  // reached the goal
+
+        const int cell = entry.second;
+        const int x = cell % m_size;
+        const int y = cell / m_size;
+        const int cost = costs[cell];
+        if (entry.first != cost + OctileDistance(x, y, goalX, goalY))  continue;  // already reached by a shorter way
+
+        const int chunkX = x / NAVIGATION_CHUNK_SIZE;
+        const int chunkY = y / NAVIGATION_CHUNK_SIZE;
+
+        if (chunkX == goalChunkX && chunkY == goalChunkY)
+        {
+            int distance = goalDistances[position(cell)];
+            if (distance >= 0 && (goalCost < 0 || cost + distance < goalCost))
+            {
+                goalCost = cost + distance;
+                goalParent = cell;
+                open.emplace(goalCost, -1);
+            }
+        }
+
+        // Other entrances of the same cluster
+        const Cluster& cluster = GetCluster(chunkX, chunkY);
+        const int n = cluster.nodes.size();
+        const int i = GetNodeIndex(cluster, cell);
+        if (i >= 0)
+        {
+            for (int j = 0; j < n; ++j)
+            {
+                int distance = cluster.distances[i * n + j];
+                if (distance > 0)  push(cluster.nodes[j], cost + distance, cell);
+            }
+        }
+
+        // Matching entrances of neighbouring clusters
+        static const int dXs[4] = {-1, 1, 0, 0};
+        static const int dYs[4] = {0, 0, -1, 1};
+        for (int k = 0; k < 4; ++k)
+        {
+            const int nX = x + dXs[k];
+            const int nY = y + dYs[k];
+            if (nX < 0 || nX >= m_size || nY < 0 || nY >= m_size)  continue;
+            if (nX / NAVIGATION_CHUNK_SIZE == chunkX && nY / NAVIGATION_CHUNK_SIZE == chunkY)  continue;
+
+            const Cluster& other = GetCluster(nX / NAVIGATION_CHUNK_SIZE, nY / NAVIGATION_CHUNK_SIZE);
+            const int neighbor = nY * m_size + nX;
+            if (GetNodeIndex(other, neighbor) >= 0)  push(neighbor, cost + STRAIGHT_COST, cell);
+        }
+    }
+
+    if (goalCost < 0)  return false;
+
+    chunks.push_back(goalChunkY * m_chunkCount + goalChunkX);
+    for (int cell = goalParent; cell != -1; cell = parents[cell])
+    {
+        chunks.push_back((cell / m_size / NAVIGATION_CHUNK_SIZE) * m_chunkCount + cell % m_size / NAVIGATION_CHUNK_SIZE);
+    }
+    chunks.push_back(startChunkY * m_chunkCount + startChunkX);
+
+    std::sort(chunks.begin(), chunks.end());
+    chunks.erase(std::unique(chunks.begin(), chunks.end()), chunks.end());
+    return true;
+}
+
+// Appends chunks crossed by the segment, sampled every half cell.
+
+void CNavigationGraph::AddSegmentChunks(const Math::Vector& start, const Math::Vector& end, std::vector<int>& chunks) const
+{
+    const float length = std::hypot(end.x - start.x, end.z - start.z);
+    const int steps = static_cast<int>(length / (NAVIGATION_CELL_SIZE / 2.0f)) + 1;
+    for (int i = 0; i <= steps; ++i)
+    {
+        const float t = static_cast<float>(i) / steps;
+        const int x = static_cast<int>((start.x + (end.x - start.x) * t + NAVIGATION_HALF_SIZE) / NAVIGATION_CELL_SIZE);
+        const int y = static_cast<int>((start.z + (end.z - start.z) * t + NAVIGATION_HALF_SIZE) / NAVIGATION_CELL_SIZE);
+        if (x < 0 || x >= m_size || y < 0 || y >= m_size)  continue;
+
+        const int chunk = (y / NAVIGATION_CHUNK_SIZE) * m_chunkCount + x / NAVIGATION_CHUNK_SIZE;
+        if (chunks.empty() || chunks.back() != chunk)  chunks.push_back(chunk);
+    }
+}
+
+bool CNavigationGraph::FindPath(int startCell, int goalCell, float goalRadius,
+                                std::vector<Math::Vector>& points, Math::Vector& goal)
+{
+    for (auto it = m_paths.begin(); it != m_paths.end(); ++it)
+    {
+        if (it->startCell != startCell || it->goalCell != goalCell || it->goalRadius != goalRadius)  continue;
+
+        for (std::size_t i = 0; i < it->chunks.size(); ++i)
+        {
+            const int chunk = it->chunks[i];
+            if (m_grid->GetChunkVersion(chunk % m_chunkCount, chunk / m_chunkCount) != it->versions[i])
+            {
+                m_paths.erase(it);
+                return false;
+            }
+        }
+
+        m_paths.splice(m_paths.begin(), m_paths, it);
+        points = m_paths.front().points;
+        goal = m_paths.front().goal;
+        return true;
+    }
+    return false;
+}
+
+void CNavigationGraph::StorePath(int startCell, int goalCell, float goalRadius, const Math::Vector& start,
+                                 const std::vector<Math::Vector>& points, const Math::Vector& goal)
+{
+    ForgetPath(startCell, goalCell, goalRadius);
+
+    // An obstacle the path goes around is usually on the straight line
+    std::vector<int> chunks;
+    AddSegmentChunks(start, goal, chunks);
+    Math::Vector previous = start;
+    for (const Math::Vector& point : points)
+    {
+        AddSegmentChunks(previous, point, chunks);
+        previous = point;
+    }
+    std::sort(chunks.begin(), chunks.end());
+    chunks.erase(std::unique(chunks.begin(), chunks.end()), chunks.end());
+
+    std::vector<unsigned int> versions;
+    for (int chunk : chunks)
+        versions.push_back(m_grid->GetChunkVersion(chunk % m_chunkCount, chunk / m_chunkCount));
+
+    m_paths.push_front({startCell, goalCell, goalRadius, goal, points, chunks, versions});
+    if (static_cast<int>(m_paths.size()) > MAX_CACHED_PATHS)
+        m_paths.pop_back();
+}
+
+void CNavigationGraph::ForgetPath(int startCell, int goalCell, float goalRadius)
+{
+    m_paths.remove_if([&](const CachedPath& path)
+    {
+        return path.startCell == startCell && path.goalCell == goalCell && path.goalRadius == goalRadius;
+    });
+}
+
+void CNavigationGraph::ClearPaths()
+{
+    m_paths.clear();
+}
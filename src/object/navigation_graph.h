@@ -0,0 +1,130 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2023, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+
+/**
+ * \file object/navigation_graph.h
+ * \brief Coarse route graph over the navigation grid, used by goto()
+ */
+
+#pragma once
+
+#include "math/vector.h"
+
+#include "object/navigation_grid.h"
+
+#include <functional>
+#include <list>
+#include <vector>
+
+/**
+ * \class CNavigationGraph
+ * \brief Hierarchical view of the navigation grid for one kind of robot
+ *
+ * The grid is split into clusters, one for each chunk of the grid. Along
+ * the border of two clusters, each run of free cells on both sides gets
+ * one or two entrances, and the distances between entrances of a cluster
+ * are precomputed. Searching a route over entrances is much cheaper than
+ * searching all cells, and tells which clusters the detailed path has to
+ * go through (this is known as HPA*).
+ *
+ * A cluster is computed again when the version of its chunk, or of one of
+ * its neighbours, changed in the grid.
+ *
+ * The graph also keeps the last paths found between two cells, as many
+ * robots often go back and forth between the same places. A path is
+ * forgotten when a chunk along it, or along the straight line from start to
+ * goal, changed since it was found: an obstacle may now block it, or the one
+ * it went around may be gone. The robot's own exceptions are not known here,
+ * so the caller still checks the path before use.
+ */
+class CNavigationGraph
+{
+public:
+    CNavigationGraph(CNavigationGrid* grid, const CNavigationGrid::TerrainProfile& profile, int layer);
+    ~CNavigationGraph();
+
+    //! Tests if this graph was made for given profile and layer
+    bool IsFor(const CNavigationGrid::TerrainProfile& profile, int layer) const;
+
+    /**
+     * \brief Finds a coarse route between two cells
+     * \param isFree passability of cells in clusters of start and goal, in which the robot can have its own exceptions
+     * \param[out] chunks indexes of chunks the route goes through
+     * \return false if there is no route, or start and goal are in the same cluster
+     */
+    bool FindRoute(int startX, int startY, int goalX, int goalY,
+                   const std::function<bool(int, int)>& isFree, std::vector<int>& chunks);
+
+    //! Returns the points of a path found earlier, and the goal it was found for, if the grid didn't change along it
+    bool FindPath(int startCell, int goalCell, float goalRadius,
+                  std::vector<Math::Vector>& points, Math::Vector& goal);
+    //! Remembers a path from \a start, forgetting the least recently used one if there are too many
+    void StorePath(int startCell, int goalCell, float goalRadius, const Math::Vector& start,
+                   const std::vector<Math::Vector>& points, const Math::Vector& goal);
+    //! Forgets a path which is not valid anymore
+    void ForgetPath(int startCell, int goalCell, float goalRadius);
+    //! Forgets all paths
+    void ClearPaths();
+
+private:
+    struct Cluster
+    {
+        //! The cluster was computed at least once
+        bool ready = false;
+        //! Sum of versions of chunks the cluster was computed for
+        unsigned int stamp = 0;
+        //! Cells of entrances
+        std::vector<int> nodes;
+        //! Distance between each pair of nodes, -1 if unreachable
+        std::vector<int> distances;
+    };
+
+    struct CachedPath
+    {
+        int startCell;
+        int goalCell;
+        float goalRadius;
+        Math::Vector goal;
+        std::vector<Math::Vector> points;
+        //! Chunks the path and the straight line to the goal go through
+        std::vector<int> chunks;
+        //! Versions of these chunks when the path was found
+        std::vector<unsigned int> versions;
+    };
+
+    Cluster& GetCluster(int chunkX, int chunkY);
+    void BuildCluster(int chunkX, int chunkY, Cluster& cluster);
+    void AddEntrances(int chunkX, int chunkY, int dx, int dy, std::vector<int>& nodes);
+    template<typename F>
+    void SearchCluster(int chunkX, int chunkY, int startCell, F&& isFree, std::vector<int>& distances);
+    int GetNodeIndex(const Cluster& cluster, int cell) const;
+    void AddSegmentChunks(const Math::Vector& start, const Math::Vector& end, std::vector<int>& chunks) const;
+
+private:
+    CNavigationGrid* m_grid;
+    CNavigationGrid::TerrainProfile m_profile;
+    int m_layer;
+    int m_size;
+    int m_chunkCount;
+
+    std::vector<Cluster> m_clusters;
+    //! Paths found earlier, most recently used first
+    std::list<CachedPath> m_paths;
+};
@@ -0,0 +1,328 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2023, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+
+#include "object/navigation_grid.h"
+
+#include "common/make_unique.h"
+
+#include "graphics/engine/terrain.h"
+#include "graphics/engine/water.h"
+
+#include "math/point.h"
+
+#include "object/navigation_graph.h"
+#include "object/object.h"
+
+#include "object/interface/transportable_object.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace
+{
+
+bool SameSpheres(const std::vector<Math::Sphere>& a, const std::vector<Math::Sphere>& b)
+{
+    if (a.size() != b.size()) return false;
+    for (std::size_t i = 0; i < a.size(); ++i)
+    {
+        if (a[i].pos.x != b[i].pos.x || a[i].pos.y != b[i].pos.y || a[i].pos.z != b[i].pos.z ||
+            a[i].radius != b[i].radius)  return false;
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+
+CNavigationGrid::CNavigationGrid(Gfx::CTerrain* terrain, Gfx::CWater* water)
+    : m_terrain(terrain),
+      m_water(water),
+      m_size(static_cast<int>(2.0f * NAVIGATION_HALF_SIZE / NAVIGATION_CELL_SIZE)),
+      m_chunkCount((m_size + NAVIGATION_CHUNK_SIZE - 1) / NAVIGATION_CHUNK_SIZE)
+{
+    m_height.resize(m_size * m_size);
+    m_slope.resize(m_size * m_size);
+    m_chunkReady.resize(m_chunkCount * m_chunkCount, false);
+    m_chunkVersion.resize(m_chunkCount * m_chunkCount, 0u);
+}
+
+CNavigationGrid::~CNavigationGrid()
+{
+}
+
+int CNavigationGrid::GetSize() const
+{
+    return m_size;
+}
+
+int CNavigationGrid::GetChunkCount() const
+{
+    return m_chunkCount;
+}
+
+unsigned int CNavigationGrid::GetChunkVersion(int chunkX, int chunkY) const
+{
+    return m_chunkVersion[chunkY * m_chunkCount + chunkX];
+}
+
+void CNavigationGrid::InvalidateChunks()
+{
+    for (unsigned int& version : m_chunkVersion)
+        version++;
+}
+
+// Calls func for each cell inside the sphere grown by margin, same as CTaskGoto::BitmapSetCircle().
+
+template<typename F>
+void CNavigationGrid::ForEachCell(const Math::Sphere& sphere, float margin, F&& func) const
+{
+    int cx = static_cast<int>((sphere.pos.x+NAVIGATION_HALF_SIZE)/NAVIGATION_CELL_SIZE);
+    int cy = static_cast<int>((sphere.pos.z+NAVIGATION_HALF_SIZE)/NAVIGATION_CELL_SIZE);
+    float r = (sphere.radius+margin)/NAVIGATION_CELL_SIZE;
+
+    for ( int iy=cy-static_cast<int>(r) ; iy<=cy+static_cast<int>(r) ; iy++ )
+    {
+        if ( iy < 0 || iy >= m_size )  continue;
+        for ( int ix=cx-static_cast<int>(r) ; ix<=cx+static_cast<int>(r) ; ix++ )
+        {
+            if ( ix < 0 || ix >= m_size )  continue;
+            float d = Math::Point(static_cast<float>(ix-cx), static_cast<float>(iy-cy)).Length();
+            if ( d > r )  continue;
+            func(iy * m_size + ix);
+        }
+    }
+}
+
+void CNavigationGrid::Refresh()
+{
+    if (m_terrain->GetReliefVersion() != m_reliefVersion)
+    {
+        m_reliefVersion = m_terrain->GetReliefVersion();
+        std::fill(m_chunkReady.begin(), m_chunkReady.end(), false);
+        InvalidateChunks();
+
+        // Objects close to the ground are the only ones taken into account
+        for (const auto& it : m_objectSpheres)
+            m_dirtyObjects.insert(it.first);
+    }
+
+    for (CObject* object : m_dirtyObjects)
+    {
+        auto& stamped = m_objectSpheres[object];
+        std::vector<Math::Sphere> spheres = GetObstacleSpheres(object);
+        if (SameSpheres(spheres, stamped)) continue;
+
+        for (auto& layer : m_obstacleLayers)
+        {
+            StampSpheres(layer, stamped, -1);
+            StampSpheres(layer, spheres, 1);
+        }
+        stamped = std::move(spheres);
+    }
+    m_dirtyObjects.clear();
+}
+
+// Computes floor height and slope of all cells in a chunk.
+
+void CNavigationGrid::UpdateTerrainChunk(int chunkX, int chunkY)
+{
+    int maxX = std::min(m_size, (chunkX + 1) * NAVIGATION_CHUNK_SIZE);
+    int maxY = std::min(m_size, (chunkY + 1) * NAVIGATION_CHUNK_SIZE);
+    for (int y = chunkY * NAVIGATION_CHUNK_SIZE; y < maxY; y++)
+    {
+        for (int x = chunkX * NAVIGATION_CHUNK_SIZE; x < maxX; x++)
+        {
+            Math::Vector p;
+            p.x = x*NAVIGATION_CELL_SIZE-NAVIGATION_HALF_SIZE;
+            p.z = y*NAVIGATION_CELL_SIZE-NAVIGATION_HALF_SIZE;
+
+            m_height[y * m_size + x] = m_terrain->GetFloorLevel(p, true);
+            m_slope[y * m_size + x] = m_terrain->GetFineSlope(p);
+        }
+    }
+    m_chunkReady[chunkY * m_chunkCount + chunkX] = true;
+}
+
+bool CNavigationGrid::IsUnderWater(int x, int y, float level)
+{
+    if ( x < 0 || x >= m_size ||
+         y < 0 || y >= m_size )  return false;
+
+    if (!m_chunkReady[(y / NAVIGATION_CHUNK_SIZE) * m_chunkCount + x / NAVIGATION_CHUNK_SIZE])
+        UpdateTerrainChunk(x / NAVIGATION_CHUNK_SIZE, y / NAVIGATION_CHUNK_SIZE);
+
+    return m_height[y * m_size + x] < level;
+}
+
+bool CNavigationGrid::IsTerrainBlocked(int x, int y, const TerrainProfile& profile)
+{
+    if ( x < 0 || x >= m_size ||
+         y < 0 || y >= m_size )  return false;
+
+    if (!m_chunkReady[(y / NAVIGATION_CHUNK_SIZE) * m_chunkCount + x / NAVIGATION_CHUNK_SIZE])
+        UpdateTerrainChunk(x / NAVIGATION_CHUNK_SIZE, y / NAVIGATION_CHUNK_SIZE);
+
+    int cell = y * m_size + x;
+
+    if ( profile.flying )  // flying robot?
+    {
+        return m_height[cell] >= m_terrain->GetFlyingMaxHeight()-5.0f;
+    }
+
+    if ( !profile.acceptWater )  // not going underwater?
+    {
+        // Accepts that a robot is 50cm under water, for example Tropica 3!
+        // Cells next to water are blocked too.
+        float level = m_water->GetLevel()-2.0f;
+        if ( IsUnderWater(x, y, level)   ||
+             IsUnderWater(x-1, y, level) ||
+             IsUnderWater(x+1, y, level) ||
+             IsUnderWater(x, y-1, level) ||
+             IsUnderWater(x, y+1, level) )  return true;
+    }
+
+    return m_slope[cell] > profile.slopeLimit;
+}
+
+bool CNavigationGrid::IsCellFree(int x, int y, const TerrainProfile& profile, int layer)
+{
+    if ( x < 0 || x >= m_size ||
+         y < 0 || y >= m_size )  return false;
+
+    return GetObstacleCount(layer, x, y) == 0 && !IsTerrainBlocked(x, y, profile);
+}
+
+CNavigationGraph* CNavigationGrid::GetGraph(const TerrainProfile& profile, int layer)
+{
+    for (const auto& graph : m_graphs)
+    {
+        if (graph->IsFor(profile, layer)) return graph.get();
+    }
+
+    m_graphs.push_back(MakeUnique<CNavigationGraph>(this, profile, layer));
+    return m_graphs.back().get();
+}
+
+int CNavigationGrid::GetObstacleLayer(float margin)
+{
+    for (std::size_t i = 0; i < m_obstacleLayers.size(); ++i)
+    {
+        if (m_obstacleLayers[i].margin == margin) return i;
+    }
+
+    m_obstacleLayers.emplace_back();
+    ObstacleLayer& layer = m_obstacleLayers.back();
+    layer.margin = margin;
+    layer.counts.resize(m_size * m_size, 0);
+    for (const auto& it : m_objectSpheres)
+        StampSpheres(layer, it.second, 1);
+
+    return m_obstacleLayers.size() - 1;
+}
+
+int CNavigationGrid::GetObstacleCount(int layer, int x, int y) const
+{
+    if ( x < 0 || x >= m_size ||
+         y < 0 || y >= m_size )  return 0;
+
+    return m_obstacleLayers[layer].counts[y * m_size + x];
+}
+
+void CNavigationGrid::GetObjectCells(CObject* object, int layer, std::vector<int>& cells) const
+{
+    auto it = m_objectSpheres.find(object);
+    if (it == m_objectSpheres.end()) return;
+
+    for (const Math::Sphere& sphere : it->second)
+    {
+        ForEachCell(sphere, m_obstacleLayers[layer].margin, [&cells](int cell) { cells.push_back(cell); });
+    }
+}
+
+void CNavigationGrid::AddObject(CObject* object)
+{
+    m_objectSpheres[object];
+    m_dirtyObjects.insert(object);
+}
+
+void CNavigationGrid::UpdateObject(CObject* object)
+{
+    if (m_objectSpheres.count(object) == 0) return;
+    m_dirtyObjects.insert(object);
+}
+
+void CNavigationGrid::RemoveObject(CObject* object)
+{
+    auto it = m_objectSpheres.find(object);
+    if (it == m_objectSpheres.end()) return;
+
+    for (auto& layer : m_obstacleLayers)
+        StampSpheres(layer, it->second, -1);
+
+    m_objectSpheres.erase(it);
+    m_dirtyObjects.erase(object);
+}
+
+void CNavigationGrid::Clear()
+{
+    m_objectSpheres.clear();
+    m_dirtyObjects.clear();
+    for (auto& layer : m_obstacleLayers)
+        std::fill(layer.counts.begin(), layer.counts.end(), 0);
+    InvalidateChunks();
+
+    for (const auto& graph : m_graphs)
+        graph->ClearPaths();
+}
+
+// Returns the crash spheres of the object that block robots on the ground.
+
+std::vector<Math::Sphere> CNavigationGrid::GetObstacleSpheres(CObject* object)
+{
+    std::vector<Math::Sphere> spheres;
+    if (IsObjectBeingTransported(object))  return spheres;
+
+    float h = m_terrain->GetFloorLevel(object->GetPosition(), false);
+    for (const auto& crashSphere : object->GetAllCrashSpheres())
+    {
+        Math::Sphere sphere = crashSphere.sphere;
+        if ( sphere.pos.y-sphere.radius > h+8.0f )  continue;
+
+        if ( object->GetType() == OBJECT_PARA )  sphere.radius -= 2.0f;
+        spheres.push_back(sphere);
+    }
+    return spheres;
+}
+
+void CNavigationGrid::StampSpheres(ObstacleLayer& layer, const std::vector<Math::Sphere>& spheres, int delta)
+{
+    for (const Math::Sphere& sphere : spheres)
+    {
+        ForEachCell(sphere, layer.margin, [this, &layer, delta](int cell)
+        {
+            layer.counts[cell] += delta;
+            int chunkX = (cell % m_size) / NAVIGATION_CHUNK_SIZE;
+            int chunkY = (cell / m_size) / NAVIGATION_CHUNK_SIZE;
+            m_chunkVersion[chunkY * m_chunkCount + chunkX]++;
+        });
+    }
+}
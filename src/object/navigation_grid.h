@@ -0,0 +1,173 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2023, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+
+/**
+ * \file object/navigation_grid.h
+ * \brief Level-wide passability grid used by goto()
+ */
+
+#pragma once
+
+#include "math/sphere.h"
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class CObject;
+class CNavigationGraph;
+
+namespace Gfx
+{
+class CTerrain;
+class CWater;
+} // namespace Gfx
+
+//! Half of the size of the covered area (standard 3200x3200 map)
+const float NAVIGATION_HALF_SIZE = 1600.0f;
+//! Size of one cell of the navigation grid, in world units
+const float NAVIGATION_CELL_SIZE = 5.0f;
+//! Number of cells per side of a chunk, the unit in which changes are tracked
+const int NAVIGATION_CHUNK_SIZE = 16;
+
+/**
+ * \class CNavigationGrid
+ * \brief Passability of the map, shared by all CTaskGoto instances
+ *
+ * The map is covered with square cells of NAVIGATION_CELL_SIZE. Two kinds of
+ * layers are kept for the whole level:
+ *
+ * - the terrain layer, holding floor height and slope of each cell. It is
+ *   computed in chunks the first time a chunk is needed, and dropped when the
+ *   relief changes (see Gfx::CTerrain::GetReliefVersion()),
+ * - obstacle layers, counting for each cell how many crash spheres of
+ *   objects cover it. Spheres are grown by a margin depending on the size of
+ *   the robot looking for a path, so there is one layer per margin in use.
+ *
+ * Objects are stamped into the obstacle layers as they are created, and
+ * stamped again after they moved or changed shape. This is deferred until the
+ * next Refresh(), so an object moving every frame costs nothing while no
+ * robot is looking for a path.
+ *
+ * Each goto task only keeps its own exceptions on top of this, like the
+ * robot itself and its cargo.
+ *
+ * Every change of a layer increments the version of the chunks it touched,
+ * so that data derived from the grid (see CNavigationGraph) knows when it
+ * has to be computed again.
+ */
+class CNavigationGrid
+{
+public:
+    //! How a robot moves over the terrain
+    struct TerrainProfile
+    {
+        //! Steepest slope the robot can climb, in radians
+        float slopeLimit = 0.0f;
+        //! The robot can go under water
+        bool acceptWater = false;
+        //! The robot flies over the terrain
+        bool flying = false;
+    };
+
+    CNavigationGrid(Gfx::CTerrain* terrain, Gfx::CWater* water);
+    ~CNavigationGrid();
+
+    //! Returns the number of cells per side of the map
+    int GetSize() const;
+
+    //! Brings all layers up to date, to be called before using the grid
+    void Refresh();
+
+    //! Tests if the terrain makes the cell impassable for given profile
+    bool IsTerrainBlocked(int x, int y, const TerrainProfile& profile);
+    //! Tests if the cell is passable, both by terrain and by obstacles of given layer
+    bool IsCellFree(int x, int y, const TerrainProfile& profile, int layer);
+
+    //! Returns the number of chunks per side of the map
+    int GetChunkCount() const;
+    //! Returns the version of given chunk, changed each time its cells change
+    unsigned int GetChunkVersion(int chunkX, int chunkY) const;
+
+    //! Returns the route graph for given profile and obstacle layer, creating it if needed
+    CNavigationGraph* GetGraph(const TerrainProfile& profile, int layer);
+
+    //! Returns the obstacle layer for given margin, creating it if needed
+    int GetObstacleLayer(float margin);
+    //! Returns the number of crash spheres covering the cell in given layer
+    int GetObstacleCount(int layer, int x, int y) const;
+    //! Appends cells the object covers in given layer to \a cells, once for each of its crash spheres
+    void GetObjectCells(CObject* object, int layer, std::vector<int>& cells) const;
+
+    //! Adds a new object
+    void AddObject(CObject* object);
+    //! Notifies that the object moved or changed shape, does nothing for unknown objects
+    void UpdateObject(CObject* object);
+    //! Removes the object
+    void RemoveObject(CObject* object);
+    //! Removes all objects
+    void Clear();
+
+private:
+    struct ObstacleLayer
+    {
+        float margin = 0.0f;
+        std::vector<uint16_t> counts;
+    };
+
+    void InvalidateChunks();
+    void UpdateTerrainChunk(int chunkX, int chunkY);
+    bool IsUnderWater(int x, int y, float level);
+
+    std::vector<Math::Sphere> GetObstacleSpheres(CObject* object);
+    void StampSpheres(ObstacleLayer& layer, const std::vector<Math::Sphere>& spheres, int delta);
+    template<typename F>
+    void ForEachCell(const Math::Sphere& sphere, float margin, F&& func) const;
+
+private:
+    Gfx::CTerrain* m_terrain;
+    Gfx::CWater* m_water;
+    int m_size;
+    int m_chunkCount;
+
+    //! Relief version the terrain layer was computed for
+    int m_reliefVersion = -1;
+    //! Floor height of each cell, row-major
+    std::vector<float> m_height;
+    //! Slope of each cell
+    std::vector<float> m_slope;
+    //! Chunks of the terrain layer already computed
+    std::vector<bool> m_chunkReady;
+    //! Version of each chunk
+    std::vector<unsigned int> m_chunkVersion;
+
+    //! Obstacle layers, never removed so indexes stay valid
+    std::deque<ObstacleLayer> m_obstacleLayers;
+    //! Spheres currently stamped in obstacle layers for each object
+    std::unordered_map<CObject*, std::vector<Math::Sphere>> m_objectSpheres;
+    //! Objects to stamp again on next Refresh()
+    std::unordered_set<CObject*> m_dirtyObjects;
+
+    //! Route graphs, one for each profile and layer in use
+    std::vector<std::unique_ptr<CNavigationGraph>> m_graphs;
+};
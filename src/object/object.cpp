@@ -30,6 +30,8 @@
 #include "level/parser/parserline.h"
 #include "level/parser/parserparam.h"
 
+#include "object/object_manager.h"
+
 #include "script/scriptfunc.h"
 
 #include <stdexcept>
@@ -86,6 +88,9 @@ void CObject::SetCrashSpheres(const std::vector<Gfx::ModelCrashSphere>& crashSph
 void CObject::AddCrashSphere(const CrashSphere& crashSphere)
 {
     m_crashSpheres.push_back(crashSphere);
+
+    if (CObjectManager::IsCreated())
+        CObjectManager::GetInstancePointer()->UpdateObjectShape(this);
 }
 
 CrashSphere CObject::GetFirstCrashSphere()
@@ -259,6 +264,9 @@ int CObject::GetCrashSphereCount()
 void CObject::DeleteAllCrashSpheres()
 {
     m_crashSpheres.clear();
+
+    if (CObjectManager::IsCreated())
+        CObjectManager::GetInstancePointer()->UpdateObjectShape(this);
 }
 
 void CObject::SetCameraCollisionSphere(const Math::Sphere& sphere)
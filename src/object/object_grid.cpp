@@ -0,0 +1,128 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2023, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+#include "object/object_grid.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+
+namespace
+{
+
+//! Size of one cell, in world units
+const float GRID_CELL_SIZE = 40.0f;
+//! Half of the size of the covered area (standard 3200x3200 map)
+const float GRID_HALF_SIZE = 1600.0f;
+//! Number of cells per side
+const int GRID_DIM = static_cast<int>(2.0f * GRID_HALF_SIZE / GRID_CELL_SIZE);
+
+} // anonymous namespace
+
+
+CObjectGrid::CObjectGrid()
+    : m_cells(GRID_DIM * GRID_DIM)
+{
+}
+
+CObjectGrid::~CObjectGrid()
+{
+}
+
+int CObjectGrid::GetCellCoord(float coord) const
+{
+    float cell = std::floor((coord + GRID_HALF_SIZE) / GRID_CELL_SIZE);
+    if (!(cell >= 0.0f)) return 0; // also catches NaN
+    if (cell >= GRID_DIM) return GRID_DIM - 1;
+    return static_cast<int>(cell);
+}
+
+int CObjectGrid::GetCellIndex(const Math::Vector& pos) const
+{
+    return GetCellCoord(pos.z) * GRID_DIM + GetCellCoord(pos.x);
+}
+
+void CObjectGrid::Insert(CObject* object, const Math::Vector& pos)
+{
+    assert(m_objectCell.find(object) == m_objectCell.end());
+
+    int cell = GetCellIndex(pos);
+    m_cells[cell].push_back(object);
+    m_objectCell[object] = cell;
+}
+
+void CObjectGrid::Update(CObject* object, const Math::Vector& pos)
+{
+    auto it = m_objectCell.find(object);
+    if (it == m_objectCell.end()) return;
+
+    int cell = GetCellIndex(pos);
+    if (cell == it->second) return;
+
+    auto& oldCell = m_cells[it->second];
+    auto oldIt = std::find(oldCell.begin(), oldCell.end(), object);
+    assert(oldIt != oldCell.end());
+    *oldIt = oldCell.back();
+    oldCell.pop_back();
+
+    m_cells[cell].push_back(object);
+    it->second = cell;
+}
+
+void CObjectGrid::Remove(CObject* object)
+{
+    auto it = m_objectCell.find(object);
+    if (it == m_objectCell.end()) return;
+
+    auto& cell = m_cells[it->second];
+    auto cellIt = std::find(cell.begin(), cell.end(), object);
+    assert(cellIt != cell.end());
+    *cellIt = cell.back();
+    cell.pop_back();
+
+    m_objectCell.erase(it);
+}
+
+void CObjectGrid::Clear()
+{
+    for (auto& cell : m_cells)
+        cell.clear();
+    m_objectCell.clear();
+}
+
+void CObjectGrid::GetObjectsInRange(const Math::Vector& center, float radius, std::vector<CObject*>& result) const
+{
+    if (std::isnan(radius)) radius = std::numeric_limits<float>::infinity(); // no distance limit
+
+    int x1 = GetCellCoord(center.x - radius);
+    int x2 = GetCellCoord(center.x + radius);
+    int z1 = GetCellCoord(center.z - radius);
+    int z2 = GetCellCoord(center.z + radius);
+
+    for (int z = z1; z <= z2; ++z)
+    {
+        for (int x = x1; x <= x2; ++x)
+        {
+            const auto& cell = m_cells[z * GRID_DIM + x];
+            result.insert(result.end(), cell.begin(), cell.end());
+        }
+    }
+}
@@ -0,0 +1,74 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2023, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+/**
+ * \file object/object_grid.h
+ * \brief Uniform grid used to look up objects by position
+ */
+
+#pragma once
+
+#include "math/vector.h"
+
+#include <unordered_map>
+#include <vector>
+
+class CObject;
+
+/**
+ * \class CObjectGrid
+ * \brief Spatial index of objects on the XZ plane
+ *
+ * The world is divided into square cells, each holding the objects whose
+ * position falls inside it. Objects outside the covered area are kept in the
+ * nearest border cell, so a query never misses an object, it just has to
+ * look at a few more candidates.
+ *
+ * The grid must be kept up to date with Insert(), Update() and Remove();
+ * CObjectManager does this as objects are created, moved and deleted.
+ */
+class CObjectGrid
+{
+public:
+    CObjectGrid();
+    ~CObjectGrid();
+
+    //! Adds the object at given position
+    void Insert(CObject* object, const Math::Vector& pos);
+    //! Moves the object to given position, does nothing for unknown objects
+    void Update(CObject* object, const Math::Vector& pos);
+    //! Removes the object from the grid
+    void Remove(CObject* object);
+    //! Removes all objects
+    void Clear();
+
+    //! Appends all objects from cells touching the given circle to \a result
+    /** The result is a superset of objects within \a radius, callers still have to check the distance */
+    void GetObjectsInRange(const Math::Vector& center, float radius, std::vector<CObject*>& result) const;
+
+private:
+    int GetCellIndex(const Math::Vector& pos) const;
+    int GetCellCoord(float coord) const;
+
+private:
+    //! Objects in each cell, row-major
+    std::vector<std::vector<CObject*>> m_cells;
+    //! Cell in which each object is currently stored
+    std::unordered_map<CObject*, int> m_objectCell;
+};
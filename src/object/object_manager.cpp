@@ -27,11 +27,13 @@
 #include "object/object.h"
 #include "object/object_create_exception.h"
 #include "object/object_create_params.h"
+#include "object/navigation_grid.h"
 #include "object/object_factory.h"
 #include "object/old_object.h"
 
 #include "object/auto/auto.h"
 
+#include "physics/broad_phase.h"
 #include "physics/physics.h"
 
 #include <algorithm>
@@ -40,8 +42,12 @@ CObjectManager::CObjectManager(Gfx::CEngine* engine,
                                Gfx::CTerrain* terrain,
                                Gfx::COldModelManager* oldModelManager,
                                Gfx::CModelManager* modelManager,
-                               Gfx::CParticle* particle)
-  : m_objectFactory(MakeUnique<CObjectFactory>(engine,
+                               Gfx::CParticle* particle,
+                               CNavigationGrid* navigationGrid,
+                               CBroadPhase* broadPhase)
+  : m_navigationGrid(navigationGrid),
+    m_broadPhase(broadPhase),
+    m_objectFactory(MakeUnique<CObjectFactory>(engine,
                                                terrain,
                                                oldModelManager,
                                                modelManager,
@@ -65,6 +71,9 @@ bool CObjectManager::DeleteObject(CObject* instance)
     if (oldObj != nullptr)
         oldObj->DeleteObject();
 
+    m_grid.Remove(instance);
+    if (m_navigationGrid != nullptr) m_navigationGrid->RemoveObject(instance);
+
     auto it = m_objects.find(instance->GetID());
     if (it != m_objects.end())
     {
@@ -108,10 +117,25 @@ void CObjectManager::DeleteAllObjects()
     }
 
     m_objects.clear();
+    m_grid.Clear();
+    if (m_navigationGrid != nullptr) m_navigationGrid->Clear();
+    if (m_broadPhase != nullptr) m_broadPhase->Clear();
 
     m_nextId = 0;
 }
 
+void CObjectManager::UpdateObjectPosition(CObject* instance)
+{
+    m_grid.Update(instance, instance->GetPosition());
+    if (m_navigationGrid != nullptr) m_navigationGrid->UpdateObject(instance);
+    if (m_broadPhase != nullptr) m_broadPhase->UpdateObject(instance);
+}
+
+void CObjectManager::UpdateObjectShape(CObject* instance)
+{
+    if (m_navigationGrid != nullptr) m_navigationGrid->UpdateObject(instance);
+}
+
 CObject* CObjectManager::GetObjectById(unsigned int id)
 {
     if (m_objects.count(id) == 0) return nullptr;
@@ -154,6 +178,9 @@ CObject* CObjectManager::CreateObject(ObjectCreateParams params)
     CObject* objectPtr = objectUPtr.get();
 
     m_objects[params.id] = std::move(objectUPtr);
+    m_grid.Insert(objectPtr, objectPtr->GetPosition());
+    if (m_navigationGrid != nullptr) m_navigationGrid->AddObject(objectPtr);
+    if (m_broadPhase != nullptr) m_broadPhase->AddObject(objectPtr);
 
     return objectPtr;
 }
@@ -239,6 +266,31 @@ int CObjectManager::CountObjectsImplementing(ObjectInterfaceType interface)
     return count;
 }
 
+void CObjectManager::GetObjectsInRange(const Math::Vector& center, float radius, std::vector<CObject*>& result)
+{
+    m_grid.GetObjectsInRange(center, radius, result);
+}
+
+namespace
+{
+
+void GetRadarOrigin(CObject* pThis, Math::Vector& pos, float& angle)
+{
+    if (pThis != nullptr)
+    {
+        pos   = pThis->GetPosition();
+        angle = pThis->GetRotationY();
+        angle = Math::NormAngle(angle);  // 0..2*Math::PI
+    }
+    else
+    {
+        pos   = Math::Vector();
+        angle = 0.0f;
+    }
+}
+
+} // anonymous namespace
+
 std::vector<CObject*> CObjectManager::RadarAll(CObject* pThis, ObjectType type, float angle, float focus, float minDist, float maxDist, bool furthest, RadarFilter filter, bool cbotTypes)
 {
     std::vector<ObjectType> types;
@@ -251,17 +303,7 @@ std::vector<CObject*> CObjectManager::RadarAll(CObject* pThis, std::vector<Objec
 {
     Math::Vector iPos;
     float iAngle;
-    if (pThis != nullptr)
-    {
-        iPos   = pThis->GetPosition();
-        iAngle = pThis->GetRotationY();
-        iAngle = Math::NormAngle(iAngle);  // 0..2*Math::PI
-    }
-    else
-    {
-        iPos   = Math::Vector();
-        iAngle = 0.0f;
-    }
+    GetRadarOrigin(pThis, iPos, iAngle);
     return RadarAll(pThis, iPos, iAngle, type, angle, focus, minDist, maxDist, furthest, filter, cbotTypes);
 }
 
@@ -275,7 +317,11 @@ std::vector<CObject*> CObjectManager::RadarAll(CObject* pThis, Math::Vector this
 
 std::vector<CObject*> CObjectManager::RadarAll(CObject* pThis, Math::Vector thisPosition, float thisAngle, std::vector<ObjectType> type, float angle, float focus, float minDist, float maxDist, bool furthest, RadarFilter filter, bool cbotTypes)
 {
-    CObject     *pObj;
+    return RadarSearch(pThis, thisPosition, thisAngle, type, angle, focus, minDist, maxDist, furthest, filter, cbotTypes, m_objects.size());
+}
+
+std::vector<CObject*> CObjectManager::RadarSearch(CObject* pThis, Math::Vector thisPosition, float thisAngle, const std::vector<ObjectType>& type, float angle, float focus, float minDist, float maxDist, bool furthest, RadarFilter filter, bool cbotTypes, std::size_t maxCount)
+{
     Math::Vector    iPos, oPos;
     float       iAngle, d, a;
     ObjectType  oType;
@@ -291,16 +337,16 @@ std::vector<CObject*> CObjectManager::RadarAll(CObject* pThis, Math::Vector this
     RadarFilter filter_flying = static_cast<RadarFilter>(filter & (FILTER_ONLYLANDING | FILTER_ONLYFLYING));
     RadarFilter filter_enemy = static_cast<RadarFilter>(filter & (FILTER_FRIENDLY | FILTER_ENEMY | FILTER_NEUTRAL));
 
-    // Use a multimap to allow for multiple objects at exactly the same distance
-    // from the origin to be returned.
-    std::multimap<float, CObject*> best;
+    // Only objects from grid cells within maxDist can match
+    std::vector<CObject*> candidates;
+    m_grid.GetObjectsInRange(iPos, maxDist, candidates);
 
-    for ( auto it = m_objects.begin() ; it != m_objects.end() ; ++it )
+    std::vector<std::pair<float, CObject*>> best;
+
+    for (CObject* pObj : candidates)
     {
-        pObj = it->second.get();
         if ( pObj == pThis )  continue; // pThis may be nullptr but it doesn't matter
 
-        if (pObj == nullptr) continue;
         if (IsObjectBeingTransported(pObj))  continue;
         if ( !pObj->GetDetectable() )  continue;
         if ( pObj->GetProxyActivate() )  continue;
@@ -398,24 +444,34 @@ std::vector<CObject*> CObjectManager::RadarAll(CObject* pThis, Math::Vector this
         a = Math::RotateAngle(oPos.x-iPos.x, iPos.z-oPos.z);  // CW !
         if ( Math::TestAngle(a, iAngle-focus/2.0f, iAngle+focus/2.0f) || focus >= Math::PI*2.0f )
         {
-            best.insert(std::make_pair(d, pObj));
+            best.push_back(std::make_pair(d, pObj));
         }
     }
 
-    std::vector<CObject*> sortedBest;
-    if (!furthest)
+    // Objects at exactly the same distance are ordered by id,
+    // the same order in which they were found when scanning all objects
+    auto compare = [furthest](const std::pair<float, CObject*>& a, const std::pair<float, CObject*>& b)
     {
-        for (auto it = best.begin(); it != best.end(); ++it)
-        {
-            sortedBest.push_back(it->second);
-        }
+        if (a.first != b.first)
+            return furthest ? a.first > b.first : a.first < b.first;
+        return furthest ? a.second->GetID() > b.second->GetID() : a.second->GetID() < b.second->GetID();
+    };
+
+    if (best.size() > maxCount)
+    {
+        std::partial_sort(best.begin(), best.begin() + maxCount, best.end(), compare);
+        best.resize(maxCount);
     }
     else
     {
-        for (auto it = best.rbegin(); it != best.rend(); ++it)
-        {
-            sortedBest.push_back(it->second);
-        }
+        std::sort(best.begin(), best.end(), compare);
+    }
+
+    std::vector<CObject*> sortedBest;
+    sortedBest.reserve(best.size());
+    for (const auto& it : best)
+    {
+        sortedBest.push_back(it.second);
     }
 
     return sortedBest;
@@ -423,25 +479,31 @@ std::vector<CObject*> CObjectManager::RadarAll(CObject* pThis, Math::Vector this
 
 CObject* CObjectManager::Radar(CObject* pThis, ObjectType type, float angle, float focus, float minDist, float maxDist, bool furthest, RadarFilter filter, bool cbotTypes)
 {
-    std::vector<CObject*> best = RadarAll(pThis, type, angle, focus, minDist, maxDist, furthest, filter, cbotTypes);
-    return best.size() > 0 ? best[0] : nullptr;
+    std::vector<ObjectType> types;
+    if (type != OBJECT_NULL)
+        types.push_back(type);
+    return Radar(pThis, types, angle, focus, minDist, maxDist, furthest, filter, cbotTypes);
 }
 
 CObject* CObjectManager::Radar(CObject* pThis, std::vector<ObjectType> type, float angle, float focus, float minDist, float maxDist, bool furthest, RadarFilter filter, bool cbotTypes)
 {
-    std::vector<CObject*> best = RadarAll(pThis, type, angle, focus, minDist, maxDist, furthest, filter, cbotTypes);
-    return best.size() > 0 ? best[0] : nullptr;
+    Math::Vector iPos;
+    float iAngle;
+    GetRadarOrigin(pThis, iPos, iAngle);
+    return Radar(pThis, iPos, iAngle, type, angle, focus, minDist, maxDist, furthest, filter, cbotTypes);
 }
 
 CObject* CObjectManager::Radar(CObject* pThis, Math::Vector thisPosition, float thisAngle, ObjectType type, float angle, float focus, float minDist, float maxDist, bool furthest, RadarFilter filter, bool cbotTypes)
 {
-    std::vector<CObject*> best = RadarAll(pThis, thisPosition, thisAngle, type, angle, focus, minDist, maxDist, furthest, filter, cbotTypes);
-    return best.size() > 0 ? best[0] : nullptr;
+    std::vector<ObjectType> types;
+    if (type != OBJECT_NULL)
+        types.push_back(type);
+    return Radar(pThis, thisPosition, thisAngle, types, angle, focus, minDist, maxDist, furthest, filter, cbotTypes);
 }
 
 CObject* CObjectManager::Radar(CObject* pThis, Math::Vector thisPosition, float thisAngle, std::vector<ObjectType> type, float angle, float focus, float minDist, float maxDist, bool furthest, RadarFilter filter, bool cbotTypes)
 {
-    std::vector<CObject*> best = RadarAll(pThis, thisPosition, thisAngle, type, angle, focus, minDist, maxDist, furthest, filter, cbotTypes);
+    std::vector<CObject*> best = RadarSearch(pThis, thisPosition, thisAngle, type, angle, focus, minDist, maxDist, furthest, filter, cbotTypes, 1);
     return best.size() > 0 ? best[0] : nullptr;
 }
 
@@ -30,6 +30,7 @@
 #include "math/vector.h"
 
 #include "object/object_create_params.h"
+#include "object/object_grid.h"
 #include "object/object_interface_type.h"
 #include "object/object_type.h"
 
@@ -50,6 +51,8 @@ class CTerrain;
 
 class CObject;
 class CObjectFactory;
+class CNavigationGrid;
+class CBroadPhase;
 
 enum RadarFilter
 {
@@ -154,7 +157,9 @@ public:
                    Gfx::CTerrain* terrain,
                    Gfx::COldModelManager* oldModelManager,
                    Gfx::CModelManager* modelManager,
-                   Gfx::CParticle* particle);
+                   Gfx::CParticle* particle,
+                   CNavigationGrid* navigationGrid,
+                   CBroadPhase* broadPhase);
     virtual ~CObjectManager();
 
     //! Creates an object
@@ -168,6 +173,11 @@ public:
     //! Deletes all objects
     void      DeleteAllObjects();
 
+    //! Updates the spatial index after the object has moved
+    void      UpdateObjectPosition(CObject* instance);
+    //! Updates the navigation grid after the object changed shape
+    void      UpdateObjectShape(CObject* instance);
+
     //! Finds object by id (CObject::GetID())
     CObject*  GetObjectById(unsigned int id);
 
@@ -194,6 +204,10 @@ public:
         return CObjectContainerProxy(m_objects, m_activeObjectIterators);
     }
 
+    //! Appends objects which may be within \a radius of \a center on the XZ plane
+    /** This is a coarse lookup in the spatial grid, callers still have to check the distance */
+    void GetObjectsInRange(const Math::Vector& center, float radius, std::vector<CObject*>& result);
+
     //! Finds an object, like radar() in CBot
     //@{
     std::vector<CObject*> RadarAll(CObject* pThis,
@@ -306,9 +320,25 @@ private:
     //! Prevents creation of overcharged power cells
     float ClampPower(ObjectType type, float power);
     void CleanRemovedObjectsIfNeeded();
+    //! Common implementation of RadarAll() and Radar(), returns at most \a maxCount best objects
+    std::vector<CObject*> RadarSearch(CObject* pThis,
+                    Math::Vector thisPosition,
+                    float thisAngle,
+                    const std::vector<ObjectType>& type,
+                    float angle,
+                    float focus,
+                    float minDist,
+                    float maxDist,
+                    bool furthest,
+                    RadarFilter filter,
+                    bool cbotTypes,
+                    std::size_t maxCount);
 
 private:
     CObjectMap m_objects;
+    CObjectGrid m_grid;
+    CNavigationGrid* m_navigationGrid;
+    CBroadPhase* m_broadPhase;
     std::unique_ptr<CObjectFactory> m_objectFactory;
     int m_nextId;
     int m_activeObjectIterators;
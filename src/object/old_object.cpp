@@ -1498,6 +1498,11 @@ void COldObject::SetPartPosition(int part, const Math::Vector &pos)
             m_lightMan->SetLightPos(m_shadowLight, lightPos);
         }
     }
+
+    if ( part == 0 && CObjectManager::IsCreated() )
+    {
+        CObjectManager::GetInstancePointer()->UpdateObjectPosition(this);
+    }
 }
 
 Math::Vector COldObject::GetPartPosition(int part) const
@@ -1516,6 +1521,11 @@ void COldObject::SetPartRotation(int part, const Math::Vector &angle)
     {
         m_engine->SetObjectShadowSpotAngle(m_objectPart[0].object, m_objectPart[0].angle.y);
     }
+
+    if ( part == 0 && CObjectManager::IsCreated() )
+    {
+        CObjectManager::GetInstancePointer()->UpdateObjectShape(this);
+    }
 }
 
 Math::Vector COldObject::GetPartRotation(int part) const
@@ -1580,6 +1590,11 @@ void COldObject::SetPartScale(int part, float zoom)
     m_objectPart[part].bZoom = ( m_objectPart[part].zoom.x != 1.0f ||
                                  m_objectPart[part].zoom.y != 1.0f ||
                                  m_objectPart[part].zoom.z != 1.0f );
+
+    if ( part == 0 && CObjectManager::IsCreated() )
+    {
+        CObjectManager::GetInstancePointer()->UpdateObjectShape(this);
+    }
 }
 
 void COldObject::SetPartScale(int part, Math::Vector zoom)
@@ -1590,6 +1605,11 @@ void COldObject::SetPartScale(int part, Math::Vector zoom)
     m_objectPart[part].bZoom = ( m_objectPart[part].zoom.x != 1.0f ||
                                  m_objectPart[part].zoom.y != 1.0f ||
                                  m_objectPart[part].zoom.z != 1.0f );
+
+    if ( part == 0 && CObjectManager::IsCreated() )
+    {
+        CObjectManager::GetInstancePointer()->UpdateObjectShape(this);
+    }
 }
 
 Math::Vector COldObject::GetPartScale(int part) const
@@ -1605,6 +1625,11 @@ void COldObject::SetPartScaleX(int part, float zoom)
     m_objectPart[part].bZoom = ( m_objectPart[part].zoom.x != 1.0f ||
                                  m_objectPart[part].zoom.y != 1.0f ||
                                  m_objectPart[part].zoom.z != 1.0f );
+
+    if ( part == 0 && CObjectManager::IsCreated() )
+    {
+        CObjectManager::GetInstancePointer()->UpdateObjectShape(this);
+    }
 }
 
 void COldObject::SetPartScaleY(int part, float zoom)
@@ -1833,6 +1858,11 @@ void COldObject::SetTransporter(CObject* transporter)
 
     // Invisible shadow if the object is transported.
     m_engine->SetObjectShadowSpotHide(m_objectPart[0].object, (m_transporter != nullptr));
+
+    if ( CObjectManager::IsCreated() )
+    {
+        CObjectManager::GetInstancePointer()->UpdateObjectShape(this);
+    }
 }
 
 CObject* COldObject::GetTransporter()
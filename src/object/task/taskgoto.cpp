@@ -28,8 +28,11 @@
 #include "graphics/engine/terrain.h"
 #include "graphics/engine/water.h"
 
+#include "level/robotmain.h"
+
 #include "math/geometry.h"
 
+#include "object/navigation_graph.h"
 #include "object/object_manager.h"
 #include "object/old_object.h"
 
@@ -47,7 +50,7 @@ const float FLY_DIST_GROUND = 80.0f;    // minimum distance to remain on the gro
 const float FLY_DEF_HEIGHT  = 50.0f;    // default flying height
 
 // Settings that define goto() accuracy:
-const float BM_DIM_STEP     = 5.0f;     // Size of one pixel on the bitmap. Setting 5 means that 5x5 square (in game units) will be represented by 1 px on the bitmap. Decreasing this value will make a bigger bitmap, and may increase accuracy. TODO: Check how it actually impacts goto() accuracy
+const float BM_DIM_STEP     = NAVIGATION_CELL_SIZE;     // Size of one pixel on the bitmap. Setting 5 means that 5x5 square (in game units) will be represented by 1 px on the bitmap. Decreasing this value will make a bigger bitmap, and may increase accuracy. TODO: Check how it actually impacts goto() accuracy
 const float SAFETY_MARGIN   = 1.5f;     // Smallest distance between two objects. Smaller = less "no route to destination", but higher probability of collisions between objects.
 // Changing SAFETY_MARGIN (old value was 4.0f) seems to have fixed many issues with goto(). TODO: maybe we could make it even smaller? Did changing it introduce any new bugs?
 
@@ -1633,6 +1636,8 @@ int CTaskGoto::PathFindingShortcut()
 {
     int     i;
 
+    if ( m_bmArray != nullptr )  BitmapRefresh();  // the robot moved since the search
+
     for ( i=m_bmTotal ; i>=m_bmIndex+2 ; i-- )  // tries from the last
     {
         if ( BitmapTestLine(m_bmPoints[m_bmIndex], m_bmPoints[i]) )
@@ -1648,20 +1653,11 @@ int CTaskGoto::PathFindingShortcut()
 
 void CTaskGoto::PathFindingStart()
 {
-    Math::Vector    min, max;
-
     BitmapOpen();
-    BitmapObject();
-
-    min = m_object->GetPosition();
-    max = m_goal;
-    if ( min.x > max.x )  Math::Swap(min.x, max.x);
-    if ( min.z > max.z )  Math::Swap(min.z, max.z);
-    min.x -= 10.0f*BM_DIM_STEP;
-    min.z -= 10.0f*BM_DIM_STEP;
-    max.x += 10.0f*BM_DIM_STEP;
-    max.z += 10.0f*BM_DIM_STEP;
-    BitmapTerrain(min, max);
+    if ( m_navLayer < 0 )
+    {
+        BitmapObject();
+    }
 
     if ( LeakSearch(m_leakPos, m_leakDelay) )
     {
@@ -1688,6 +1684,18 @@ void CTaskGoto::PathFindingInit()
         m_bmIter[i] = -1;
     }
     m_bmStep = 0;
+    m_bmCorridor.clear();
+    PathFindingReset();
+}
+
+// Empties the queue of the search, to start it again.
+
+void CTaskGoto::PathFindingReset()
+{
+    if ( m_bmArray != nullptr )
+    {
+        memset(m_bmArray.get() + m_bmLine*m_bmSize, 0, m_bmLine*m_bmSize);  // rank 1
+    }
     for (auto& bucket : m_bfsQueue)
     {
         bucket.clear();
@@ -1699,6 +1707,88 @@ void CTaskGoto::PathFindingInit()
     m_bfsQueueCountSkipped = 0;
 }
 
+// Takes the path found by an earlier search between the same cells,
+// if it's still free. The graph drops it if the grid changed along it,
+// here it is checked against the exceptions of this robot.
+
+bool CTaskGoto::PathFindingCached(const Math::Vector &start, const Math::Vector &goal, float goalRadius)
+{
+    if ( m_navGraph == nullptr )  return false;
+
+    const int startCell = static_cast<int>((start.z+1600.0f)/BM_DIM_STEP)*m_bmSize + static_cast<int>((start.x+1600.0f)/BM_DIM_STEP);
+    const int goalCell  = static_cast<int>((goal.z+1600.0f)/BM_DIM_STEP)*m_bmSize + static_cast<int>((goal.x+1600.0f)/BM_DIM_STEP);
+
+    std::vector<Math::Vector> points;
+    Math::Vector cachedGoal;
+    if ( !m_navGraph->FindPath(startCell, goalCell, goalRadius, points, cachedGoal) )  return false;
+
+    // The last segment may go into the goal, other ones must be free.
+    Math::Vector previous = start;
+    for ( std::size_t i = 0; i+1 < points.size(); i++ )
+    {
+        const bool free = BitmapTestLine(previous, points[i]);
+        previous = points[i];
+        if ( !free )
+        {
+            m_navGraph->ForgetPath(startCell, goalCell, goalRadius);
+            return false;
+        }
+    }
+
+    m_bmPoints[0] = start;
+    for ( std::size_t i = 0; i < points.size(); i++ )
+    {
+        m_bmPoints[i+1] = points[i];
+    }
+    m_bmTotal = points.size();
+    m_bmPoints[m_bmTotal] = points.back() - cachedGoal + goal;
+
+    GetLogger()->Debug("Reused cached path to goal with %d nodes\n", m_bmTotal + 1);
+    return true;
+}
+
+// Keeps the path just found for next searches between the same cells.
+
+void CTaskGoto::PathFindingStore(const Math::Vector &start, const Math::Vector &goal, float goalRadius)
+{
+    if ( m_navGraph == nullptr )  return;
+
+    const int startCell = static_cast<int>((start.z+1600.0f)/BM_DIM_STEP)*m_bmSize + static_cast<int>((start.x+1600.0f)/BM_DIM_STEP);
+    const int goalCell  = static_cast<int>((goal.z+1600.0f)/BM_DIM_STEP)*m_bmSize + static_cast<int>((goal.x+1600.0f)/BM_DIM_STEP);
+
+    std::vector<Math::Vector> points(m_bmPoints+1, m_bmPoints+m_bmTotal+1);
+    m_navGraph->StorePath(startCell, goalCell, goalRadius, start, points, goal);
+}
+
+// Finds a coarse route over the navigation graph,
+// and restricts the detailed search to chunks around it.
+
+void CTaskGoto::PathFindingRoute(int startX, int startY, int goalX, int goalY)
+{
+    m_bmCorridor.clear();
+    if ( m_navGraph == nullptr )  return;
+
+    std::vector<int> chunks;
+    auto isFree = [this](int x, int y) { return BitmapTestDotIsVisitable(x, y); };
+    if ( !m_navGraph->FindRoute(startX, startY, goalX, goalY, isFree, chunks) )  return;
+
+    const int count = m_navGrid->GetChunkCount();
+    m_bmCorridor.resize(count*count, false);
+    for ( int chunk : chunks )
+    {
+        const int cx = chunk % count;
+        const int cy = chunk / count;
+        for ( int y = std::max(0, cy-1); y <= std::min(count-1, cy+1); y++ )
+        {
+            for ( int x = std::max(0, cx-1); x <= std::min(count-1, cx+1); x++ )
+            {
+                m_bmCorridor[y*count + x] = true;
+            }
+        }
+    }
+    GetLogger()->Debug("Coarse route goes through %d chunks\n", static_cast<int>(chunks.size()));
+}
+
 static int HeuristicDistance(int nX, int nY, int startX, int startY)
 {
     // 8-way connectivity yields a shortest path that
@@ -1730,6 +1820,7 @@ Error CTaskGoto::PathFindingSearch(const Math::Vector &start, const Math::Vector
                                    float goalRadius)
 {
     m_bmStep ++;
+    BitmapRefresh();
 
     // Relative postion and distance to neighbors.
     static const int dXs[8] = {-1, 0, 1, -1, 1, -1, 0, 1};
@@ -1751,6 +1842,11 @@ Error CTaskGoto::PathFindingSearch(const Math::Vector &start, const Math::Vector
             m_bmTotal = 1;
             return ERR_OK;
         }
+        if (m_bmStep == 1) // First try
+        {
+            if (PathFindingCached(start, goal, goalRadius)) return ERR_OK;
+            PathFindingRoute(startX, startY, goalX, goalY);
+        }
         // Enqueue the goal node
         if ( goalX >= 0 && goalX < m_bmSize &&
             goalY >= 0 && goalY < m_bmSize )
@@ -1782,6 +1878,7 @@ Error CTaskGoto::PathFindingSearch(const Math::Vector &start, const Math::Vector
                     float floatX = (x + 0.5f) * BM_DIM_STEP - 1600.0f;
                     float floatY = (y + 0.5f) * BM_DIM_STEP - 1600.0f;
                     if (std::hypot(floatX-goal.x, floatY-goal.z) <= goalRadius &&
+                        BitmapTestCorridor(x, y) &&
                         BitmapTestDotIsVisitable(x, y) &&
                         !BitmapTestDot(1, x, y))
                     {
@@ -1958,6 +2055,7 @@ Error CTaskGoto::PathFindingSearch(const Math::Vector &start, const Math::Vector
             {
                 if (!m_bfsQueue[i].empty()) GetLogger()->Debug("    %lu: %lu\n", i, m_bfsQueue[i].size());
             }
+            PathFindingStore(start, goal, goalRadius);
             return ERR_OK;
         }
 
@@ -1966,7 +2064,7 @@ Error CTaskGoto::PathFindingSearch(const Math::Vector &start, const Math::Vector
         {
             const int nX = x + dXs[i];
             const int nY = y + dYs[i];
-            if (BitmapTestDotIsVisitable(nX, nY))
+            if (BitmapTestCorridor(nX, nY) && BitmapTestDotIsVisitable(nX, nY))
             {
                 const int neighborIndexInMap = nY * m_bmSize + nX;
                 const int32_t newDistance = distance + dDist[i];
@@ -1998,6 +2096,15 @@ Error CTaskGoto::PathFindingSearch(const Math::Vector &start, const Math::Vector
         if ( m_bmIterCounter >= NB_ITER )  return ERR_CONTINUE;
     }
 
+    if (!m_bmCorridor.empty())
+    {
+        // No path close to the coarse route, search everywhere.
+        GetLogger()->Debug("No path along the coarse route, searching again without it\n");
+        m_bmCorridor.clear();
+        PathFindingReset();
+        return ERR_CONTINUE;
+    }
+
     return ERR_GOTO_IMPOSSIBLE;
 }
 
@@ -2115,51 +2222,36 @@ void CTaskGoto::BitmapObject()
     }
 }
 
-// Adds a section of land in the bitmap.
+// Brings the shared navigation grid up to date
+// and finds the cells covered by the robot and its cargo.
 
-void CTaskGoto::BitmapTerrain(const Math::Vector &min, const Math::Vector &max)
+void CTaskGoto::BitmapRefresh()
 {
-    int     minx, miny, maxx, maxy;
+    m_navGrid->Refresh();
 
-    minx = static_cast<int>((min.x+1600.0f)/BM_DIM_STEP);
-    miny = static_cast<int>((min.z+1600.0f)/BM_DIM_STEP);
-    maxx = static_cast<int>((max.x+1600.0f)/BM_DIM_STEP);
-    maxy = static_cast<int>((max.z+1600.0f)/BM_DIM_STEP);
+    m_navExcluded.clear();
+    if ( m_navLayer < 0 )  return;
 
-    BitmapTerrain(minx, miny, maxx, maxy);
+    std::vector<int> cells;
+    m_navGrid->GetObjectCells(m_object, m_navLayer, cells);
+    if ( m_bmCargoObject != nullptr )
+    {
+        m_navGrid->GetObjectCells(m_bmCargoObject, m_navLayer, cells);
+    }
+    for (int cell : cells)
+    {
+        m_navExcluded[cell] ++;
+    }
 }
 
-// Adds a section of land in the bitmap.
+// Returns how the robot moves over the terrain.
 
-void CTaskGoto::BitmapTerrain(int minx, int miny, int maxx, int maxy)
+CNavigationGrid::TerrainProfile CTaskGoto::GetTerrainProfile()
 {
-    ObjectType  type;
-    Math::Vector    p;
-    float       aLimit, angle, h;
-    int         x, y;
-    bool        bAcceptWater, bFly;
-
-    if ( minx > maxx )  Math::Swap(minx, maxx);
-    if ( miny > maxy )  Math::Swap(miny, maxy);
-
-    if ( minx < 0          )  minx = 0;
-    if ( miny < 0          )  miny = 0;
-    if ( maxx > m_bmSize-1 )  maxx = m_bmSize-1;
-    if ( maxy > m_bmSize-1 )  maxy = m_bmSize-1;
+    CNavigationGrid::TerrainProfile profile;
+    profile.slopeLimit = 20.0f*Math::PI/180.0f;
 
-    if ( minx > m_bmMinX )  minx = m_bmMinX;
-    if ( miny > m_bmMinY )  miny = m_bmMinY;
-    if ( maxx < m_bmMaxX )  maxx = m_bmMaxX;
-    if ( maxy < m_bmMaxY )  maxy = m_bmMaxY;
-
-    if ( minx >= m_bmMinX && maxx <= m_bmMaxX &&
-         miny >= m_bmMinY && maxy <= m_bmMaxY )  return;
-
-    aLimit = 20.0f*Math::PI/180.0f;
-    bAcceptWater = false;
-    bFly = false;
-
-    type = m_object->GetType();
+    ObjectType type = m_object->GetType();
 
     if ( type == OBJECT_MOBILEwa ||
          type == OBJECT_MOBILEwb ||
@@ -2169,7 +2261,7 @@ void CTaskGoto::BitmapTerrain(int minx, int miny, int maxx, int maxy)
          type == OBJECT_MOBILEwt ||
          type == OBJECT_MOBILEtg )  // wheels?
     {
-        aLimit = 20.0f*Math::PI/180.0f;
+        profile.slopeLimit = 20.0f*Math::PI/180.0f;
     }
 
     if ( type == OBJECT_MOBILEta ||
@@ -2178,7 +2270,7 @@ void CTaskGoto::BitmapTerrain(int minx, int miny, int maxx, int maxy)
          type == OBJECT_MOBILEti ||
          type == OBJECT_MOBILEts )  // caterpillars?
     {
-        aLimit = 35.0f*Math::PI/180.0f;
+        profile.slopeLimit = 35.0f*Math::PI/180.0f;
     }
 
     if ( type == OBJECT_MOBILErt ||
@@ -2187,19 +2279,19 @@ void CTaskGoto::BitmapTerrain(int minx, int miny, int maxx, int maxy)
          type == OBJECT_MOBILErs ||
          type == OBJECT_MOBILErp )  // large caterpillars?
     {
-        aLimit = 35.0f*Math::PI/180.0f;
+        profile.slopeLimit = 35.0f*Math::PI/180.0f;
     }
 
     if ( type == OBJECT_MOBILEsa ||
          type == OBJECT_MOBILEst )  // submarine caterpillars?
     {
-        aLimit = 35.0f*Math::PI/180.0f;
-        bAcceptWater = true;
+        profile.slopeLimit = 35.0f*Math::PI/180.0f;
+        profile.acceptWater = true;
     }
 
     if ( type == OBJECT_MOBILEdr )  // designer caterpillars?
     {
-        aLimit = 35.0f*Math::PI/180.0f;
+        profile.slopeLimit = 35.0f*Math::PI/180.0f;
     }
 
     if ( type == OBJECT_MOBILEfa ||
@@ -2209,8 +2301,8 @@ void CTaskGoto::BitmapTerrain(int minx, int miny, int maxx, int maxy)
          type == OBJECT_MOBILEfi ||
          type == OBJECT_MOBILEft )  // flying?
     {
-        aLimit = 15.0f*Math::PI/180.0f;
-        bFly = true;
+        profile.slopeLimit = 15.0f*Math::PI/180.0f;
+        profile.flying = true;
     }
 
     if ( type == OBJECT_MOBILEia ||
@@ -2219,63 +2311,20 @@ void CTaskGoto::BitmapTerrain(int minx, int miny, int maxx, int maxy)
          type == OBJECT_MOBILEis ||
          type == OBJECT_MOBILEii )  // insect legs?
     {
-        aLimit = 60.0f*Math::PI/180.0f;
-    }
-
-    for ( y=miny ; y<=maxy ; y++ )
-    {
-        for ( x=minx ; x<=maxx ; x++ )
-        {
-            if ( x >= m_bmMinX && x <= m_bmMaxX &&
-                 y >= m_bmMinY && y <= m_bmMaxY )  continue;
-
-            p.x = x*BM_DIM_STEP-1600.0f;
-            p.z = y*BM_DIM_STEP-1600.0f;
-
-            if ( bFly )  // flying robot?
-            {
-                h = m_terrain->GetFloorLevel(p, true);
-                if ( h >= m_terrain->GetFlyingMaxHeight()-5.0f )
-                {
-                    BitmapSetDot(0, x, y);
-                }
-                continue;
-            }
-
-            if ( !bAcceptWater )  // not going underwater?
-            {
-                h = m_terrain->GetFloorLevel(p, true);
-                if ( h < m_water->GetLevel()-2.0f )  // under water (*)?
-                {
-//?                 BitmapSetDot(0, x, y);
-                    BitmapSetCircle(p, BM_DIM_STEP*1.0f);
-                    continue;
-                }
-            }
-
-            angle = m_terrain->GetFineSlope(p);
-            if ( angle > aLimit )
-            {
-                BitmapSetDot(0, x, y);
-            }
-        }
+        profile.slopeLimit = 60.0f*Math::PI/180.0f;
     }
 
-    m_bmMinX = minx;
-    m_bmMinY = miny;
-    m_bmMaxX = maxx;
-    m_bmMaxY = maxy;  // expanded rectangular area
+    return profile;
 }
 
-// (*)  Accepts that a robot is 50cm under water, for example Tropica 3!
-
 // Opens an empty bitmap.
 
 bool CTaskGoto::BitmapOpen()
 {
-    m_bmSize = static_cast<int>(3200.0f/BM_DIM_STEP);
-    if (m_bmArray.get() == nullptr) m_bmArray = MakeUniqueArray<unsigned char>(m_bmSize*m_bmSize/8*2);
-    memset(m_bmArray.get(), 0, m_bmSize*m_bmSize/8*2);
+    m_navGrid = m_main->GetNavigationGrid();
+    m_bmSize = m_navGrid->GetSize();
+    if (m_bmArray.get() == nullptr) m_bmArray = MakeUniqueArray<unsigned char>(m_bmSize*m_bmSize/8*3);
+    memset(m_bmArray.get(), 0, m_bmSize*m_bmSize/8*3);
     if (m_bfsDistances.get() == nullptr) m_bfsDistances = MakeUniqueArray<int32_t>(m_bmSize*m_bmSize);
     for (auto& bucket : m_bfsQueue)
     {
@@ -2286,10 +2335,16 @@ bool CTaskGoto::BitmapOpen()
     m_bmOffset = m_bmSize/2;
     m_bmLine = m_bmSize/8;
 
-    m_bmMinX = m_bmSize;  // non-existent rectangular area
-    m_bmMinY = m_bmSize;
-    m_bmMaxX = 0;
-    m_bmMaxY = 0;
+    m_navProfile = GetTerrainProfile();
+    m_navLayer = -1;
+    if ( !m_object->Implements(ObjectInterfaceType::Flying) || m_altitude <= 0.0f )
+    {
+        // Flying robots keep their own obstacles, as they only avoid objects at their altitude.
+        float iRadius = m_object->GetFirstCrashSphere().sphere.radius;
+        m_navLayer = m_navGrid->GetObstacleLayer(iRadius+SAFETY_MARGIN);
+    }
+    m_navGraph = m_navLayer < 0 ? nullptr : m_navGrid->GetGraph(m_navProfile, m_navLayer);
+    BitmapRefresh();
 
     return true;
 }
@@ -2325,7 +2380,7 @@ void CTaskGoto::BitmapSetCircle(const Math::Vector &pos, float radius)
     }
 }
 
-// Removes a circle in the bitmap.
+// Removes a circle in the bitmap, overriding the terrain and shared obstacles.
 //TODO this method is almost same as above one
 void CTaskGoto::BitmapClearCircle(const Math::Vector &pos, float radius)
 {
@@ -2343,6 +2398,7 @@ void CTaskGoto::BitmapClearCircle(const Math::Vector &pos, float radius)
             d = Math::Point(static_cast<float>(ix-cx), static_cast<float>(iy-cy)).Length();
             if ( d > r )  continue;
             BitmapClearDot(0, ix, iy);
+            BitmapSetDot(2, ix, iy);
         }
     }
 }
@@ -2372,6 +2428,7 @@ void CTaskGoto::BitmapClearDot(int rank, int x, int y)
 }
 
 // Tests a point in the bitmap.
+// Rank 0 tests all obstacles: terrain, shared grid and own ones.
 // x:y: 0..m_bmSize-1
 
 bool CTaskGoto::BitmapTestDot(int rank, int x, int y)
@@ -2379,13 +2436,9 @@ bool CTaskGoto::BitmapTestDot(int rank, int x, int y)
     if ( x < 0 || x >= m_bmSize ||
          y < 0 || y >= m_bmSize )  return false;
 
-    if ( x < m_bmMinX || x > m_bmMaxX ||
-         y < m_bmMinY || y > m_bmMaxY )
-    {
-        BitmapTerrain(x-10,y-10, x+10,y+10);  // remade a layer
-    }
+    if ( rank == 0 )  return !BitmapTestDotIsVisitable(x, y);
 
-    return m_bmArray[rank*m_bmLine*m_bmSize + m_bmLine*y + x/8] & (1<<x%8);
+    return BitmapTestBit(rank, x, y);
 }
 
 bool CTaskGoto::BitmapTestDotIsVisitable(int x, int y)
@@ -2393,11 +2446,35 @@ bool CTaskGoto::BitmapTestDotIsVisitable(int x, int y)
     if ( x < 0 || x >= m_bmSize ||
          y < 0 || y >= m_bmSize )  return false;
 
-    if ( x < m_bmMinX || x > m_bmMaxX ||
-         y < m_bmMinY || y > m_bmMaxY )
-    {
-        BitmapTerrain(x-10,y-10, x+10,y+10);  // remade a layer
-    }
+    if ( BitmapTestBit(2, x, y) )  return true;  // cleared around the departure
+    if ( BitmapTestBit(0, x, y) )  return false;
+
+    if ( m_navGrid->IsTerrainBlocked(x, y, m_navProfile) )  return false;
+    if ( m_navLayer < 0 )  return true;
+
+    int count = m_navGrid->GetObstacleCount(m_navLayer, x, y);
+    if ( count == 0 )  return true;
+
+    auto it = m_navExcluded.find(y*m_bmSize + x);
+    if ( it != m_navExcluded.end() )  count -= it->second;
+    return count <= 0;
+}
+
+// Tests a point stored in the bit table only.
+
+bool CTaskGoto::BitmapTestBit(int rank, int x, int y)
+{
+    return m_bmArray[rank*m_bmLine*m_bmSize + m_bmLine*y + x/8] & (1<<x%8);
+}
+
+// Tests if the point is in the chunks the search is restricted to.
+
+bool CTaskGoto::BitmapTestCorridor(int x, int y)
+{
+    if ( m_bmCorridor.empty() )  return true;
+    if ( x < 0 || x >= m_bmSize ||
+         y < 0 || y >= m_bmSize )  return false;
 
-    return !(m_bmArray[m_bmLine*y + x/8] & (1<<x%8));
+    const int count = m_navGrid->GetChunkCount();
+    return m_bmCorridor[(y/NAVIGATION_CHUNK_SIZE)*count + x/NAVIGATION_CHUNK_SIZE];
 }
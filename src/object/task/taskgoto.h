@@ -23,9 +23,12 @@
 
 #include "math/vector.h"
 
+#include "object/navigation_grid.h"
+
 #include <array>
 #include <cstdint>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 namespace Math
@@ -35,6 +38,7 @@ struct Point;
 
 
 class CObject;
+class CNavigationGraph;
 
 const int MAXPOINTS = 50000;
 const int NUMQUEUEBUCKETS = 32;
@@ -105,12 +109,16 @@ protected:
     int         PathFindingShortcut();
     void        PathFindingStart();
     void        PathFindingInit();
+    void        PathFindingReset();
+    bool        PathFindingCached(const Math::Vector &start, const Math::Vector &goal, float goalRadius);
+    void        PathFindingStore(const Math::Vector &start, const Math::Vector &goal, float goalRadius);
+    void        PathFindingRoute(int startX, int startY, int goalX, int goalY);
     Error       PathFindingSearch(const Math::Vector &start, const Math::Vector &goal, float goalRadius);
 
     bool        BitmapTestLine(const Math::Vector &start, const Math::Vector &goal);
     void        BitmapObject();
-    void        BitmapTerrain(const Math::Vector &min, const Math::Vector &max);
-    void        BitmapTerrain(int minx, int miny, int maxx, int maxy);
+    void        BitmapRefresh();
+    CNavigationGrid::TerrainProfile GetTerrainProfile();
     bool        BitmapOpen();
     bool        BitmapClose();
     void        BitmapSetCircle(const Math::Vector &pos, float radius);
@@ -119,6 +127,8 @@ protected:
     void        BitmapClearDot(int rank, int x, int y);
     bool        BitmapTestDot(int rank, int x, int y);
     bool        BitmapTestDotIsVisitable(int x, int y);
+    bool        BitmapTestBit(int rank, int x, int y);
+    bool        BitmapTestCorridor(int x, int y);
 
 protected:
     Math::Vector        m_goal;
@@ -143,7 +153,13 @@ protected:
     int             m_bmSize = 0;       // width or height of the table
     int             m_bmOffset = 0;     // m_bmSize/2
     int             m_bmLine = 0;       // increment line m_bmSize/8
-    std::unique_ptr<unsigned char[]> m_bmArray;      // Bit table
+    std::unique_ptr<unsigned char[]> m_bmArray;      // Bit table: 0 = own obstacles, 1 = enqueued, 2 = cleared
+    CNavigationGrid* m_navGrid = nullptr;   // shared terrain and obstacles
+    CNavigationGrid::TerrainProfile m_navProfile;
+    int             m_navLayer = -1;    // obstacle layer of m_navGrid, -1 if obstacles are in the bit table
+    std::unordered_map<int, int> m_navExcluded;  // cells of m_navLayer covered by the robot and its cargo
+    CNavigationGraph* m_navGraph = nullptr; // coarse routes and path cache, nullptr if obstacles are in the bit table
+    std::vector<bool> m_bmCorridor;     // chunks the search may go through, empty if not restricted
     std::unique_ptr<int32_t[]> m_bfsDistances; // Distances to the goal for breadth-first search.
     std::array<std::vector<uint32_t>, NUMQUEUEBUCKETS + 1> m_bfsQueue; // Priority queue with indices to nodes. Nodes are sorted into buckets. The last bucket contains oversized costs.
     int             m_bfsQueueMin = 0;  // Front of the queue. This value mod 8 is the index to the bucket with the next node to be expanded.
@@ -151,8 +167,6 @@ protected:
     int             m_bfsQueueCountPopped = 0; // Number of nodes extacted from the queue.
     int             m_bfsQueueCountRepeated = 0; // Number of nodes re-inserted into the queue.
     int             m_bfsQueueCountSkipped = 0; // Number of nodes skipped because of unexpected distance (likely re-added).
-    int             m_bmMinX = 0, m_bmMinY = 0;
-    int             m_bmMaxX = 0, m_bmMaxY = 0;
     int             m_bmTotal = 0;      // index of final point in m_bmPoints
     int             m_bmIndex = 0;      // index in m_bmPoints
     Math::Vector        m_bmPoints[MAXPOINTS+2];
@@ -0,0 +1,193 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2023, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+#include "physics/broad_phase.h"
+
+#include "common/profiler.h"
+
+#include "math/geometry.h"
+
+#include "object/object.h"
+#include "object/object_manager.h"
+
+#include "object/interface/jostleable_object.h"
+
+#include <algorithm>
+
+
+namespace
+{
+
+//! How far objects can move during a frame without making the candidates of Update() incomplete
+const float MOVE_MARGIN = 4.0f;
+
+} // namespace
+
+CBroadPhase::CBroadPhase()
+    : m_maxReach(0.0f),
+      m_candidatesValid(false)
+{
+}
+
+CBroadPhase::~CBroadPhase()
+{
+}
+
+float CBroadPhase::ComputeReach(CObject* object)
+{
+    Math::Vector pos = object->GetPosition();
+    float reach = 0.0f;
+
+    for (const auto& crashSphere : object->GetAllCrashSpheres())
+    {
+        reach = std::max(reach, Math::Distance(crashSphere.sphere.pos, pos) + crashSphere.sphere.radius);
+    }
+
+    if (object->Implements(ObjectInterfaceType::Jostleable))
+    {
+        Math::Sphere jostlingSphere = dynamic_cast<CJostleableObject&>(*object).GetJostlingSphere();
+        reach = std::max(reach, Math::Distance(jostlingSphere.pos, pos) + jostlingSphere.radius);
+    }
+
+    // See the waypoint and target checks in CPhysics::ObjectAdapt()
+    ObjectType type = object->GetType();
+    if (type == OBJECT_WAYPOINT) reach = std::max(reach, 4.0f);
+    if (type == OBJECT_TARGET2)  reach = std::max(reach, 10.0f*1.5f);
+
+    return reach;
+}
+
+float CBroadPhase::GetReach(CObject* object)
+{
+    auto it = m_objects.find(object->GetID());
+    if (it != m_objects.end()) return it->second.reach;
+
+    // Created after the last Update()
+    ObjectState& state = m_objects[object->GetID()];
+    state.reach = ComputeReach(object);
+    state.pos = object->GetPosition();
+    m_maxReach = std::max(m_maxReach, state.reach);
+    return state.reach;
+}
+
+void CBroadPhase::Update()
+{
+    CProfiler::StartPerformanceCounter(PCNT_UPDATE_COLLISION);
+
+    m_objects.clear();
+    m_maxReach = 0.0f;
+
+    CObjectManager* objMan = CObjectManager::GetInstancePointer();
+    for (CObject* object : objMan->GetAllObjects())
+    {
+        ObjectState& state = m_objects[object->GetID()];
+        state.reach = ComputeReach(object);
+        state.pos = object->GetPosition();
+        m_maxReach = std::max(m_maxReach, state.reach);
+    }
+
+    // Only movable objects call CPhysics::ObjectAdapt()
+    for (CObject* object : objMan->GetAllObjects())
+    {
+        if (!object->Implements(ObjectInterfaceType::Movable)) continue;
+        if (!object->GetCollisions()) continue;
+
+        ObjectState& state = m_objects[object->GetID()];
+        FindInGrid(object, state.pos, state.reach + 2.0f*MOVE_MARGIN, state.candidates);
+        state.hasCandidates = true;
+    }
+
+    m_candidatesValid = true;
+
+    CProfiler::StopPerformanceCounter(PCNT_UPDATE_COLLISION);
+}
+
+void CBroadPhase::GetCandidates(CObject* object, const Math::Vector& pos, float radius, std::vector<int>& candidates)
+{
+    CProfiler::StartPerformanceCounter(PCNT_UPDATE_COLLISION);
+
+    auto it = m_objects.find(object->GetID());
+    if (m_candidatesValid && it != m_objects.end() && it->second.hasCandidates &&
+        Math::DistanceProjected(pos, it->second.pos) + radius <= it->second.reach + MOVE_MARGIN)
+    {
+        candidates.clear();
+        CObjectManager* objMan = CObjectManager::GetInstancePointer();
+        for (int id : it->second.candidates)
+        {
+            CObject* other = objMan->GetObjectById(id);
+            if (other == nullptr) continue;  // deleted in the meantime
+
+            float distance = Math::DistanceProjected(other->GetPosition(), pos);
+            if (distance > radius + GetReach(other)) continue;
+
+            candidates.push_back(id);
+        }
+    }
+    else
+    {
+        FindInGrid(object, pos, radius, candidates);
+    }
+
+    CProfiler::StopPerformanceCounter(PCNT_UPDATE_COLLISION);
+}
+
+void CBroadPhase::FindInGrid(CObject* object, const Math::Vector& pos, float radius, std::vector<int>& candidates)
+{
+    candidates.clear();
+
+    m_nearObjects.clear();
+    CObjectManager::GetInstancePointer()->GetObjectsInRange(pos, radius + m_maxReach, m_nearObjects);
+
+    for (CObject* other : m_nearObjects)
+    {
+        if (other == object) continue;
+
+        float distance = Math::DistanceProjected(other->GetPosition(), pos);
+        if (distance > radius + GetReach(other)) continue;
+
+        candidates.push_back(other->GetID());
+    }
+
+    // Keep the order in which CObjectManager::GetAllObjects() returns them
+    std::sort(candidates.begin(), candidates.end());
+}
+
+void CBroadPhase::AddObject(CObject* object)
+{
+    // Not in the candidates of any object
+    m_candidatesValid = false;
+}
+
+void CBroadPhase::UpdateObject(CObject* object)
+{
+    if (!m_candidatesValid) return;
+
+    auto it = m_objects.find(object->GetID());
+    if (it == m_objects.end()) return;
+
+    if (Math::DistanceProjected(object->GetPosition(), it->second.pos) > MOVE_MARGIN)
+        m_candidatesValid = false;
+}
+
+void CBroadPhase::Clear()
+{
+    m_objects.clear();
+    m_maxReach = 0.0f;
+    m_candidatesValid = false;
+}
@@ -0,0 +1,100 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2023, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+/**
+ * \file physics/broad_phase.h
+ * \brief Broad phase of collision detection between objects
+ */
+
+#pragma once
+
+#include "math/vector.h"
+
+#include <unordered_map>
+#include <vector>
+
+class CObject;
+
+/**
+ * \class CBroadPhase
+ * \brief Finds objects that a moving object can possibly touch
+ *
+ * Once per frame, Update() computes the reach of every object - the radius
+ * around its position that contains all of its crash spheres, its jostling
+ * sphere and the trigger distance of waypoints and targets. It then builds,
+ * for every movable object, the list of objects close enough to touch it even
+ * if both move by up to MOVE_MARGIN during the frame. CPhysics::ObjectAdapt()
+ * only tests objects from GetCandidates(), which filters that list.
+ *
+ * CObjectManager reports created and moved objects through AddObject() and
+ * UpdateObject(). If an object is created, or moves further than MOVE_MARGIN
+ * from where it was in Update(), the lists may be incomplete, so for the rest
+ * of the frame GetCandidates() looks around the object in the object grid
+ * instead. The reach does not depend on the object's rotation, so it stays
+ * valid for the whole frame; objects created during the frame get their reach
+ * computed when they are first found.
+ */
+class CBroadPhase
+{
+public:
+    CBroadPhase();
+    ~CBroadPhase();
+
+    //! Recomputes the reach of all objects and the candidates of movable objects, called once per frame
+    void Update();
+
+    //! Returns ids of objects which can touch the sphere (\a pos, \a radius), sorted by id
+    /** \a object itself is not included */
+    void GetCandidates(CObject* object, const Math::Vector& pos, float radius, std::vector<int>& candidates);
+
+    //! Called by CObjectManager when an object is created
+    void AddObject(CObject* object);
+    //! Called by CObjectManager when an object moves
+    void UpdateObject(CObject* object);
+    //! Called by CObjectManager when all objects are deleted
+    void Clear();
+
+private:
+    //! State of one object since the last Update()
+    struct ObjectState
+    {
+        //! Radius around the position containing everything the object can touch with
+        float reach = 0.0f;
+        //! Position in Update()
+        Math::Vector pos;
+        //! Ids of objects which can touch this one, sorted
+        std::vector<int> candidates;
+        //! True if candidates were computed, only movable objects with collisions have them
+        bool hasCandidates = false;
+    };
+
+    float GetReach(CObject* object);
+    static float ComputeReach(CObject* object);
+    void FindInGrid(CObject* object, const Math::Vector& pos, float radius, std::vector<int>& candidates);
+
+private:
+    //! State of each object, by object id
+    std::unordered_map<int, ObjectState> m_objects;
+    //! Largest reach of all objects
+    float m_maxReach;
+    //! False once an object was created or moved too far since Update()
+    bool m_candidatesValid;
+    //! Temporary buffer for grid lookups
+    std::vector<CObject*> m_nearObjects;
+};
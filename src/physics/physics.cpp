@@ -55,6 +55,8 @@
 
 #include "object/task/task.h"
 
+#include "physics/broad_phase.h"
+
 #include "sound/sound.h"
 
 
@@ -77,6 +79,7 @@ CPhysics::CPhysics(COldObject* object)
     m_water     = m_engine->GetWater();
     m_terrain   = CRobotMain::GetInstancePointer()->GetTerrain();
     m_camera    = CRobotMain::GetInstancePointer()->GetCamera();
+    m_broadPhase = CRobotMain::GetInstancePointer()->GetBroadPhase();
     m_sound     = CApplication::GetInstancePointer()->GetSound();
     m_motion    = nullptr;
 
@@ -2520,9 +2523,13 @@ int CPhysics::ObjectAdapt(const Math::Vector &pos, const Math::Vector &angle)
     iPos = iiPos + (pos - m_object->GetPosition());
     iType = m_object->GetType();
 
-    for (CObject* pObj : CObjectManager::GetInstancePointer()->GetAllObjects())
+    m_broadPhase->GetCandidates(m_object, iPos, iRad, m_collisionCandidates);
+
+    CObjectManager* objMan = CObjectManager::GetInstancePointer();
+    for (int id : m_collisionCandidates)
     {
-        if ( pObj == m_object )  continue;  // yourself?
+        CObject* pObj = objMan->GetObjectById(id);
+        if ( pObj == nullptr )  continue;  // deleted in the meantime?
         if (IsObjectBeingTransported(pObj))  continue;
         if ( pObj->Implements(ObjectInterfaceType::Destroyable) && dynamic_cast<CDestroyableObject&>(*pObj).GetDying() == DeathType::Exploding )  continue;  // is exploding?
 
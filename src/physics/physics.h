@@ -33,9 +33,12 @@
 
 #include "object/interface/trace_drawing_object.h"
 
+#include <vector>
+
 
 class CObject;
 class COldObject;
+class CBroadPhase;
 class CMotion;
 class CSoundInterface;
 class CLevelParserLine;
@@ -204,6 +207,8 @@ protected:
     Gfx::CWater*        m_water;
     Gfx::CCamera*       m_camera;
     CSoundInterface*    m_sound;
+    CBroadPhase*        m_broadPhase;
+    std::vector<int>    m_collisionCandidates;  // buffer for ObjectAdapt()
 
     COldObject*         m_object;
     CMotion*            m_motion;
@@ -44,6 +44,8 @@
 #include "ui/controls/interface.h"
 #include "ui/controls/list.h"
 
+#include <algorithm>
+
 #include <libintl.h>
 
 const int CBOT_IPF = 100;       // CBOT: default number of instructions / frame
@@ -240,7 +242,10 @@ bool CScript::Compile()
         m_botProg = MakeUnique<CBot::CBotProgram>(m_object->GetBotVar());
     }
 
-    if ( m_botProg->Compile(m_script.get(), functionList, this) )
+    // Compile functions only depend on the type of the object (see cFire()),
+    // so robots of the same type running the same text share the compiled code
+    std::string cacheKey = StrUtils::ToString<int>(m_object->GetType());
+    if ( m_botProg->Compile(m_script.get(), functionList, this, cacheKey) )
     {
         if (functionList.empty())
         {
@@ -312,6 +317,7 @@ bool CScript::Run()
 
     m_bRun = true;
     m_bContinue = false;
+    m_concurrentRun = ConcurrentRun::NONE;
     m_ipf = CBOT_IPF;
     m_errMode = ERM_STOP;
 
@@ -363,7 +369,28 @@ bool CScript::Continue()
         return false;
     }
 
-    if ( m_botProg->Run(this, m_ipf) )
+    bool finished = false;
+    switch (m_concurrentRun)
+    {
+        case ConcurrentRun::NONE:
+            finished = m_botProg->Run(this, m_ipf);
+            break;
+
+        case ConcurrentRun::SUSPENDED:
+            break;
+
+        case ConcurrentRun::DEFERRED:
+            // executes the deferred operation and the rest of the time slice
+            finished = m_botProg->Run(this, std::max(m_botProg->GetTimerLeft(), 1));
+            break;
+
+        case ConcurrentRun::FINISHED:
+            finished = true;
+            break;
+    }
+    m_concurrentRun = ConcurrentRun::NONE;
+
+    if ( finished )
     {
         m_botProg->GetError(m_error, m_cursor1, m_cursor2);
         if ( m_cursor1 < 0 || m_cursor1 > m_len ||
@@ -390,6 +417,26 @@ bool CScript::Continue()
     return false;
 }
 
+// Starts the next time slice of Continue() on a worker thread,
+// concurrently with other programs (see CBotProgram::RunConcurrent).
+// The game is not modified; Continue() then completes the time slice.
+
+void CScript::ContinueConcurrent()
+{
+    if (m_botProg == nullptr)  return;
+    if ( !m_bRun || m_bStepMode )  return;
+    if ( m_concurrentRun != ConcurrentRun::NONE )  return;  // not continued yet
+
+    if ( m_botProg->RunConcurrent(this, m_ipf) )
+    {
+        m_concurrentRun = ConcurrentRun::FINISHED;
+    }
+    else
+    {
+        m_concurrentRun = m_botProg->IsDeferred() ? ConcurrentRun::DEFERRED : ConcurrentRun::SUSPENDED;
+    }
+}
+
 // Continues the execution of current program.
 // Returns true when execution is finished.
 
@@ -439,6 +486,7 @@ void CScript::Stop()
     }
 
     m_bRun = false;
+    m_concurrentRun = ConcurrentRun::NONE;
 }
 
 // Indicates whether the program runs.
@@ -73,6 +73,7 @@ public:
     bool        GetStepMode();
     bool        Run();
     bool        Continue();
+    void        ContinueConcurrent();
     bool        Step();
     void        Stop();
     bool        IsRunning();
@@ -102,6 +103,15 @@ protected:
     bool        Compile();
 
 protected:
+    //! What ContinueConcurrent() left for the next Continue()
+    enum class ConcurrentRun
+    {
+        NONE,       //!< nothing, Continue() runs a whole time slice
+        SUSPENDED,  //!< time slice used up
+        DEFERRED,   //!< stopped before an operation that has to run on the main thread
+        FINISHED,   //!< program finished
+    };
+
     COldObject*          m_object = nullptr;
     CTaskExecutorObject* m_taskExecutor = nullptr;
 
@@ -120,6 +130,7 @@ protected:
     bool    m_bStepMode = false;        // step by step
     bool    m_bContinue = false;        // external function to continue
     bool    m_bCompile = false;     // compilation ok?
+    ConcurrentRun m_concurrentRun = ConcurrentRun::NONE;
     std::string m_title = "";        // script title
     std::string m_mainFunction = "";
     std::string m_filename = "";     // file name
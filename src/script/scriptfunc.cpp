@@ -3535,7 +3535,7 @@ void CScriptFunctions::Init()
     bc->AddItem("x", CBotTypFloat);
     bc->AddItem("y", CBotTypFloat);
     bc->AddItem("z", CBotTypFloat);
-    bc->AddFunction("point", rPointConstructor, cPointConstructor);
+    bc->AddFunction("point", rPointConstructor, cPointConstructor, true);
 
     // Adds the class Object.
     bc = CBotClass::Create("object", nullptr);
@@ -3586,8 +3586,8 @@ void CScriptFunctions::Init()
     CBotProgram::AddFunction("detect",    rDetect,    cDetect);
     CBotProgram::AddFunction("direction", rDirection, cDirection);
     CBotProgram::AddFunction("produce",   rProduce,   cProduce);
-    CBotProgram::AddFunction("distance",  rDistance,  cDistance);
-    CBotProgram::AddFunction("distance2d",rDistance2d,cDistance);
+    CBotProgram::AddFunction("distance",  rDistance,  cDistance, true);
+    CBotProgram::AddFunction("distance2d",rDistance2d,cDistance, true);
     CBotProgram::AddFunction("space",     rSpace,     cSpace);
     CBotProgram::AddFunction("flatspace", rFlatSpace, cFlatSpace);
     CBotProgram::AddFunction("flatground",rFlatGround,cFlatGround);
@@ -53,6 +53,9 @@ bool rMessage(CBotVar* var, CBotVar* result, int& exception, void* user)
 
 int main(int argc, char* argv[])
 {
+    // With --stats, print memory pool statistics after each function
+    bool printStats = (argc > 1 && std::string(argv[1]) == "--stats");
+
     // Read program code from stdin
     std::string code = "";
     std::string line;
@@ -101,8 +104,16 @@ int main(int argc, char* argv[])
 
         std::cerr << "Running program: " << func << std::endl;
 
+        CBotMemoryPool::ResetStats();
         while (!program->Run(nullptr)); // Run the program
 
+        if (printStats)
+        {
+            CBotMemoryPool::Stats stats = CBotMemoryPool::GetStats();
+            std::cerr << "Allocations: " << stats.allocations << " (" << stats.reused << " reused), "
+                      << stats.live << " live, " << stats.pooled << " pooled" << std::endl;
+        }
+
         CBotError error;
         int cursor1, cursor2;
         program->GetError(error, cursor1, cursor2);
@@ -0,0 +1,83 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2023, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+#include "CBot/CBotMemoryPool.h"
+
+#include "CBot/CBotToken.h"
+#include "CBot/CBotVar/CBotVar.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+
+namespace CBot
+{
+
+TEST(CBotMemoryPoolTest, FreedBlocksAreReused)
+{
+    void* first = CBotMemoryPool::Allocate(40);
+    CBotMemoryPool::Free(first, 40);
+
+    CBotMemoryPool::ResetStats();
+    void* second = CBotMemoryPool::Allocate(40);
+    EXPECT_EQ(first, second);
+
+    CBotMemoryPool::Stats stats = CBotMemoryPool::GetStats();
+    EXPECT_EQ(1, stats.allocations);
+    EXPECT_EQ(1, stats.reused);
+
+    CBotMemoryPool::Free(second, 40);
+}
+
+TEST(CBotMemoryPoolTest, LargeBlocksAreNotPooled)
+{
+    CBotMemoryPool::ResetStats();
+    void* block = CBotMemoryPool::Allocate(4096);
+    CBotMemoryPool::Free(block, 4096);
+    EXPECT_EQ(0, CBotMemoryPool::GetStats().allocations);
+}
+
+TEST(CBotMemoryPoolTest, SimpleVariablesUsePool)
+{
+    CBotMemoryPool::ResetStats();
+    long live = CBotMemoryPool::GetStats().live;
+    {
+        std::unique_ptr<CBotVar> var(CBotVar::Create("test", CBotTypInt));
+        var->SetValInt(42);
+        // the variable and its token
+        EXPECT_EQ(live + 2, CBotMemoryPool::GetStats().live);
+    }
+    EXPECT_EQ(live, CBotMemoryPool::GetStats().live);
+    EXPECT_EQ(2, CBotMemoryPool::GetStats().allocations);
+}
+
+TEST(CBotMemoryPoolTest, BlocksFreedOnAnotherThreadAreCounted)
+{
+    long live = CBotMemoryPool::GetStats().live;
+    void* block = CBotMemoryPool::Allocate(40);
+    EXPECT_EQ(live + 1, CBotMemoryPool::GetStats().live);
+
+    std::thread other([block]() { CBotMemoryPool::Free(block, 40); });
+    other.join();
+
+    EXPECT_EQ(live, CBotMemoryPool::GetStats().live);
+    EXPECT_GE(CBotMemoryPool::GetStats().pooled, 0);
+}
+
+} // namespace CBot
@@ -18,10 +18,15 @@
  */
 
 #include "CBot/CBot.h"
+#include "CBot/CBotVar/CBotVarClass.h"
 
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
 #include <limits>
 #include <stdexcept>
+#include <thread>
 
 extern bool g_cbotTestSaveState;
 bool g_cbotTestSaveState = false;
@@ -219,12 +224,14 @@ private:
     }
 
 protected:
-    std::unique_ptr<CBotProgram> ExecuteTest(const std::string& code, CBotError expectedError = CBotNoErr)
+    std::unique_ptr<CBotProgram> ExecuteTest(const std::string& code, CBotError expectedError = CBotNoErr,
+                                             CBotProgram::Engine engine = CBotProgram::Engine::TREE)
     {
         CBotError expectedCompileError = expectedError < 6000 ? expectedError : CBotNoErr;
         CBotError expectedRuntimeError = expectedError >= 6000 ? expectedError : CBotNoErr;
 
         auto program = std::unique_ptr<CBotProgram>(new CBotProgram());
+        program->SetEngine(engine);
         std::vector<std::string> tests;
         program->Compile(code, tests);
 
@@ -318,6 +325,13 @@ protected:
         }
         return program; // Take it if you want, destroy on exit otherwise
     }
+
+    //! Runs the test on the instruction tree, then on the bytecode engine
+    void ExecuteTestAllEngines(const std::string& code, CBotError expectedError = CBotNoErr)
+    {
+        ExecuteTest(code, expectedError, CBotProgram::Engine::TREE);
+        ExecuteTest(code, expectedError, CBotProgram::Engine::BYTECODE);
+    }
 };
 
 TEST_F(CBotUT, EmptyTest)
@@ -908,6 +922,29 @@ TEST_F(CBotUT, Arrays)
     );
 }
 
+TEST_F(CBotUT, ArraysLarge)
+{
+    ExecuteTest(
+        "extern void ArraysLarge()\n"
+        "{\n"
+        "    int a[];\n"
+        "    for (int i = 0; i < 300; i++) a[i] = i * 2;\n"
+        "    ASSERT(sizeof(a) == 300);\n"
+        "    int sum = 0;\n"
+        "    for (int i = 0; i < sizeof(a); i++) sum += a[i];\n"
+        "    ASSERT(sum == 89700);\n"
+        "    a[1500] = 1;\n"
+        "    ASSERT(sizeof(a) == 1501);\n"
+        "    ASSERT(a[299] == 598);\n"
+        "    ASSERT(a[1500] == 1);\n"
+        "    string s[];\n"
+        "    s[2] = \"x\";\n"
+        "    ASSERT(sizeof(s) == 3);\n"
+        "    ASSERT(s[2] == \"x\");\n"
+        "}\n"
+    );
+}
+
 TEST_F(CBotUT, ArraysInClasses)
 {
     ExecuteTest(
@@ -987,6 +1024,31 @@ TEST_F(CBotUT, FunctionRecursion)
     );
 }
 
+TEST_F(CBotUT, FunctionRecursionLocalVars)
+{
+    ExecuteTest(
+        "int sum(int depth)\n"
+        "{\n"
+        "    int total = 0;\n"
+        "    for (int i = 0; i < 3; i++)\n"
+        "    {\n"
+        "        int local = i + depth;\n"
+        "        if (depth > 0 && i == 1) total += sum(depth - 1);\n"
+        "        ASSERT(local == i + depth);\n"
+        "        total += local;\n"
+        "    }\n"
+        "    return total;\n"
+        "}\n"
+        "\n"
+        "extern void FunctionRecursionLocalVars()\n"
+        "{\n"
+        "    ASSERT(sum(0) == 3);\n"
+        "    ASSERT(sum(1) == 9);\n"
+        "    ASSERT(sum(2) == 18);\n"
+        "}\n"
+    );
+}
+
 TEST_F(CBotUT, FunctionRecursionStackOverflow)
 {
     ExecuteTest(
@@ -1144,6 +1206,38 @@ TEST_F(CBotUT, PublicFunctions)
     );
 }
 
+TEST_F(CBotUT, PublicFunctionsRecompiled)
+{
+    const std::string publicCode =
+        "public int test()\n"
+        "{\n"
+        "    return 1337;\n"
+        "}\n";
+    auto publicProgram = ExecuteTest(publicCode);
+
+    auto program = ExecuteTest(
+        "extern void TestPublic()\n"
+        "{\n"
+        "    for (int i = 0; i < 3; ++i) ASSERT(test() == 1337);\n"
+        "}\n"
+    );
+
+    auto runAgain = [&program]()
+    {
+        program->Start("TestPublic");
+        while (!program->Run(nullptr, 0));
+        return program->GetError();
+    };
+
+    // The call sites must not use the function they were resolved to before
+    std::vector<std::string> externFunctions;
+    publicProgram->Compile(publicCode, externFunctions);
+    EXPECT_EQ(CBotNoErr, runAgain());
+
+    publicProgram.reset();
+    EXPECT_EQ(CBotErrUndefFunc, runAgain());
+}
+
 TEST_F(CBotUT, ClassConstructor)
 {
     ExecuteTest(
@@ -1536,6 +1630,36 @@ TEST_F(CBotUT, ClassInheritanceVars)
     );
 }
 
+TEST_F(CBotUT, ClassInheritanceFieldWrites)
+{
+    ExecuteTest(
+        "public class Counter {\n"
+        "    int count = 0;\n"
+        "    int total = 0;\n"
+        "    void Add(int v) { count++; this.total += v; }\n"
+        "}\n"
+        "public class Queue extends Counter {\n"
+        "    int items[];\n"
+        "    int head = 0;\n"
+        "    void Push(int v) { items[count] = v; Add(v); }\n"
+        "    int Pop() { return items[head++]; }\n"
+        "}\n"
+        "extern void ClassInheritanceFieldWrites()\n"
+        "{\n"
+        "    Queue q();\n"
+        "    for (int i = 1; i <= 10; i++) q.Push(i);\n"
+        "    ASSERT(q.count == 10);\n"
+        "    ASSERT(q.total == 55);\n"
+        "    ASSERT(q.Pop() == 1);\n"
+        "    ASSERT(q.Pop() == 2);\n"
+        "    ASSERT(q.head == 2);\n"
+        "    Counter c = q;\n"
+        "    c.total = 0;\n"
+        "    ASSERT(q.total == 0);\n"
+        "}\n"
+    );
+}
+
 TEST_F(CBotUT, ClassInheritanceMethods)
 {
     ExecuteTest(
@@ -3327,3 +3451,406 @@ TEST_F(CBotUT, ClassTestSaveInheritedMembers)
         "}\n"
     );
 }
+
+TEST_F(CBotUT, BytecodeEngineArithmetic)
+{
+    ExecuteTestAllEngines(
+        "int IntOps(int a, int b)\n"
+        "{\n"
+        "    return (a + b) * (a - b) / 3 % 7 + (a << 2) - (b >> 1) + (-a >>> 28) + (a & b) + (a | b) + (a ^ b) + ~b + a ** 2;\n"
+        "}\n"
+        "float FloatOps(float a, int b)\n"
+        "{\n"
+        "    return a * b + a / 4 - b % 3.5 + a ** 2 - -a;\n"
+        "}\n"
+        "bool BoolOps(int a, float b, bool c)\n"
+        "{\n"
+        "    return (a < b) == c && a <= b || !(a >= b) ^ (a != 3) & c | a == b;\n"
+        "}\n"
+        "float Assignments(int a)\n"
+        "{\n"
+        "    int x = a, y;\n"
+        "    float f = 2.5;\n"
+        "    x += 3; x -= 1; x *= 5; x /= 2; x %= 100;\n"
+        "    x <<= 2; x >>= 1; x >>>= 1; x &= 0xFF; x |= 0x100; x ^= 0x11;\n"
+        "    x += f;\n"
+        "    f += x;\n"
+        "    y = x = x + 1;\n"
+        "    int r = y + x++ + ++x + x-- + --x;\n"
+        "    f++;\n"
+        "    return r + f;\n"
+        "}\n"
+        "extern void BytecodeEngineArithmetic()\n"
+        "{\n"
+        "    ASSERT(IntOps(10, 3) == 174);\n"
+        "    ASSERT(IntOps(-7, 2) == 8);\n"
+        "    ASSERT(FloatOps(2.5, 4) == 18.875);\n"
+        "    ASSERT(BoolOps(2, 2.5, true));\n"
+        "    ASSERT(!BoolOps(3, 2.5, true));\n"
+        "    ASSERT(Assignments(7) == 1602.5);\n"
+        "}\n"
+    );
+}
+
+TEST_F(CBotUT, BytecodeEngineControlFlow)
+{
+    ExecuteTestAllEngines(
+        "int Loops(int n)\n"
+        "{\n"
+        "    int sum = 0;\n"
+        "    for (int i = 0, j = n; i < n; i++, j--)\n"
+        "    {\n"
+        "        if (i % 2 == 0) continue;\n"
+        "        sum += i * j;\n"
+        "    }\n"
+        "    int k = 0;\n"
+        "    while (true)\n"
+        "    {\n"
+        "        if (++k > 5) break;\n"
+        "        sum += k;\n"
+        "    }\n"
+        "    do { sum--; k--; } while (k > 0);\n"
+        "    outer: for (int a = 0; a < 10; a++)\n"
+        "    {\n"
+        "        for (int b = 0; b < 10; b++)\n"
+        "        {\n"
+        "            if (b == 3) continue outer;\n"
+        "            if (a == 4) break outer;\n"
+        "            sum += 100;\n"
+        "        }\n"
+        "    }\n"
+        "    return sum;\n"
+        "}\n"
+        "int ShortCircuit(int a)\n"
+        "{\n"
+        "    int calls = 0;\n"
+        "    if (a > 0 && ++calls > 0) calls += 10;\n"
+        "    if (a > 0 || ++calls > 0) calls += 100;\n"
+        "    return a > 5 ? calls : -calls;\n"
+        "}\n"
+        "float Fibonacci(int n)\n"
+        "{\n"
+        "    float a = 0, b = 1;\n"
+        "    for (int i = 0; i < n; i++) { float t = a + b; a = b; b = t; }\n"
+        "    return a;\n"
+        "}\n"
+        "int NoReturnValue(int a)\n"
+        "{\n"
+        "    if (a > 0) return 1;\n"
+        "    return 0;\n"
+        "}\n"
+        "extern void BytecodeEngineControlFlow()\n"
+        "{\n"
+        "    ASSERT(Loops(6) == 1228);\n"
+        "    ASSERT(ShortCircuit(10) == 111);\n"
+        "    ASSERT(ShortCircuit(-1) == -101);\n"
+        "    ASSERT(Fibonacci(20) == 6765);\n"
+        "    ASSERT(NoReturnValue(5) == 1);\n"
+        "    ASSERT(NoReturnValue(-5) == 0);\n"
+        "}\n"
+    );
+}
+
+TEST_F(CBotUT, BytecodeEngineNan)
+{
+    ExecuteTestAllEngines(
+        "bool IsNan(float a)\n"
+        "{\n"
+        "    return a == nan;\n"
+        "}\n"
+        "bool Compare(float a, float b)\n"
+        "{\n"
+        "    return a != b;\n"
+        "}\n"
+        "extern void BytecodeEngineNan()\n"
+        "{\n"
+        "    ASSERT(IsNan(nan));\n"
+        "    ASSERT(!IsNan(1.0));\n"
+        "    ASSERT(!Compare(nan, nan));\n"
+        "    ASSERT(Compare(nan, 1.0));\n"
+        "}\n"
+    );
+}
+
+TEST_F(CBotUT, BytecodeEngineRuntimeErrors)
+{
+    ExecuteTestAllEngines(
+        "int Div(int a, int b) { return a / b; }\n"
+        "extern void TestDivZero() { Div(1, 0); }\n",
+        CBotErrZeroDiv
+    );
+    ExecuteTestAllEngines(
+        "float Mod(float a, float b) { float r = a; r %= b; return r; }\n"
+        "extern void TestModZero() { Mod(1.5, 0); }\n",
+        CBotErrZeroDiv
+    );
+    ExecuteTestAllEngines(
+        "float Add(float a, float b) { return a + b; }\n"
+        "extern void TestNan() { Add(nan, 1); }\n",
+        CBotErrNan
+    );
+    ExecuteTestAllEngines(
+        "int Undefined(int a) { int x; if (a > 0) x = 1; return x; }\n"
+        "extern void TestNotInit() { Undefined(0); }\n",
+        CBotErrNotInit
+    );
+}
+
+TEST_F(CBotUT, BytecodeEngineFallback)
+{
+    // functions using features not supported by the bytecode engine keep running on the tree
+    ExecuteTestAllEngines(
+        "int Helper(int a) { return a * 2; }\n"
+        "string Text(int a) { string s = \"n=\" + a; return s; }\n"
+        "int Calls(int a) { int r = 0; for (int i = 0; i < a; i++) r += Helper(i); return r; }\n"
+        "extern void BytecodeEngineFallback()\n"
+        "{\n"
+        "    ASSERT(Text(3) == \"n=3\");\n"
+        "    ASSERT(Calls(4) == 12);\n"
+        "}\n"
+    );
+}
+
+TEST_F(CBotUT, CompileCacheSharesCode)
+{
+    const std::string code =
+        "int Twice(int a) { return a * 2; }\n"
+        "extern void CompileCacheSharesCode()\n"
+        "{\n"
+        "    int r = 0;\n"
+        "    for (int i = 0; i < 3; i++) r += Twice(i);\n"
+        "    ASSERT(r == 6);\n"
+        "}\n";
+
+    std::vector<std::string> externs1, externs2;
+    auto program1 = std::unique_ptr<CBotProgram>(new CBotProgram());
+    auto program2 = std::unique_ptr<CBotProgram>(new CBotProgram());
+    ASSERT_TRUE(program1->Compile(code, externs1, nullptr, "key"));
+    ASSERT_TRUE(program2->Compile(code, externs2, nullptr, "key"));
+    EXPECT_EQ(externs1, externs2);
+    EXPECT_EQ(program1->GetFunctions(), program2->GetFunctions());
+
+    // run both at once, each with its own execution state
+    ASSERT_TRUE(program1->Start(externs1[0]));
+    ASSERT_TRUE(program2->Start(externs2[0]));
+    bool done1 = false, done2 = false;
+    while (!done1 || !done2)
+    {
+        if (!done1) done1 = program1->Run(nullptr, 0);
+        if (!done2) done2 = program2->Run(nullptr, 0);
+    }
+    EXPECT_EQ(program1->GetError(), CBotNoErr);
+    EXPECT_EQ(program2->GetError(), CBotNoErr);
+
+    // the code stays alive as long as any program uses it
+    program1.reset();
+    ASSERT_TRUE(program2->Start(externs2[0]));
+    while (!program2->Run(nullptr, 0));
+    EXPECT_EQ(program2->GetError(), CBotNoErr);
+
+    // a different key or source gets its own code
+    std::vector<std::string> externs3;
+    auto program3 = std::unique_ptr<CBotProgram>(new CBotProgram());
+    ASSERT_TRUE(program3->Compile(code, externs3, nullptr, "other"));
+    EXPECT_NE(program2->GetFunctions(), program3->GetFunctions());
+}
+
+TEST_F(CBotUT, CompileCacheSkipsPublicCode)
+{
+    // public functions and classes are registered globally, such programs are always compiled
+    const std::string code =
+        "public void CompileCachePublic() {}\n"
+        "extern void CompileCacheSkipsPublicCode() {}\n";
+
+    std::vector<std::string> externs1, externs2;
+    auto program1 = std::unique_ptr<CBotProgram>(new CBotProgram());
+    ASSERT_TRUE(program1->Compile(code, externs1, nullptr, "key"));
+    auto program2 = std::unique_ptr<CBotProgram>(new CBotProgram());
+    EXPECT_FALSE(program2->Compile(code, externs2, nullptr, "key"));
+    EXPECT_EQ(program2->GetError(), CBotErrRedefFunc);
+}
+
+TEST_F(CBotUT, CompileCacheRuntimeErrorPosition)
+{
+    // errors in shared code are reported in the program running it
+    const std::string code =
+        "int Fail(int a) { return 1 / a; }\n"
+        "extern void CompileCacheRuntimeErrorPosition()\n"
+        "{\n"
+        "    Fail(0);\n"
+        "}\n";
+
+    std::vector<std::string> externs1, externs2;
+    auto program1 = std::unique_ptr<CBotProgram>(new CBotProgram());
+    auto program2 = std::unique_ptr<CBotProgram>(new CBotProgram());
+    ASSERT_TRUE(program1->Compile(code, externs1, nullptr, "key"));
+    ASSERT_TRUE(program2->Compile(code, externs2, nullptr, "key"));
+
+    program1.reset();
+    ASSERT_TRUE(program2->Start(externs2[0]));
+    while (!program2->Run(nullptr, 0));
+    CBotError error;
+    int start, end;
+    program2->GetError(error, start, end);
+    EXPECT_EQ(error, CBotErrZeroDiv);
+    EXPECT_EQ(code.substr(start, end - start), "/");
+}
+
+TEST_F(CBotUT, InstanceFindAndCounts)
+{
+    CBotClass* pClass = CBotClass::Create("InstanceCountClass", nullptr);
+    CBotVar* var = CBotVar::Create("a", CBotTypResult(CBotTypClass, pClass));
+    CBotVarClass* instance = var->GetPointer();
+    ASSERT_NE(instance, nullptr);
+
+    EXPECT_EQ(CBotVarClass::GetInstanceCounts()["InstanceCountClass"], 1);
+
+    instance->SetIdent(123456);
+    EXPECT_EQ(CBotVarClass::Find(123456), instance);
+    instance->SetIdent(123457);
+    EXPECT_EQ(CBotVarClass::Find(123456), nullptr);
+    EXPECT_EQ(CBotVarClass::Find(123457), instance);
+
+    // restored identifiers are not reused for new instances
+    CBotVar* other = CBotVar::Create("b", CBotTypResult(CBotTypClass, pClass));
+    EXPECT_EQ(CBotVarClass::Find(123457), instance);
+    EXPECT_EQ(CBotVarClass::GetInstanceCounts()["InstanceCountClass"], 2);
+
+    delete other;
+    delete var;
+    EXPECT_EQ(CBotVarClass::Find(123457), nullptr);
+    EXPECT_EQ(CBotVarClass::GetInstanceCounts().count("InstanceCountClass"), 0u);
+}
+
+TEST_F(CBotUT, RunConcurrentDefersUnsafeCalls)
+{
+    static std::atomic<int> calls{0};
+    static std::atomic<int> concurrentCalls{0};
+    calls = concurrentCalls = 0;
+    CBotProgram::AddFunction("RunConcurrentCall",
+        [](CBotVar* var, CBotVar* result, int& exception, void* user)
+        {
+            if (CBotProgram::IsRunningConcurrently()) concurrentCalls++;
+            calls++;
+            return true;
+        },
+        [](CBotVar*& var, void* user) { return CBotTypResult(CBotTypVoid); });
+
+    const std::string code =
+        "float Add(float a, float b) { return a + b; }\n"
+        "extern void RunConcurrentDefersUnsafeCalls()\n"
+        "{\n"
+        "    float[] a;\n"
+        "    for (int i = 0; i < 50; i++) a[i] = sqrt(16);\n"
+        "    float r = 0;\n"
+        "    for (int i = 0; i < sizeof(a); i++) r = Add(r, a[i]);\n"
+        "    RunConcurrentCall();\n"
+        "    ASSERT(r == 200);\n"
+        "}\n";
+
+    const int count = 4;
+    std::unique_ptr<CBotProgram> programs[count];
+    bool done[count];
+    for (int i = 0; i < count; i++)
+    {
+        std::vector<std::string> externs;
+        programs[i].reset(new CBotProgram());
+        ASSERT_TRUE(programs[i]->Compile(code, externs, nullptr, "key"));
+        if (i % 2 == 1) programs[i]->SetEngine(CBotProgram::Engine::BYTECODE);
+        ASSERT_TRUE(programs[i]->Start(externs[0]));
+        done[i] = false;
+    }
+
+    int deferred = 0;
+    for (int frame = 0; frame < 1000 && std::count(done, done + count, false) > 0; frame++)
+    {
+        std::vector<std::thread> threads;
+        bool finished[count];
+        for (int i = 0; i < count; i++)
+        {
+            if (done[i]) continue;
+            threads.emplace_back([&, i]() { finished[i] = programs[i]->RunConcurrent(nullptr, 20); });
+        }
+        for (std::thread& thread : threads) thread.join();
+
+        // what was deferred runs in order, with the rest of the time slice
+        for (int i = 0; i < count; i++)
+        {
+            if (done[i]) continue;
+            done[i] = finished[i];
+            if (!done[i] && programs[i]->IsDeferred())
+            {
+                deferred++;
+                done[i] = programs[i]->Run(nullptr, std::max(programs[i]->GetTimerLeft(), 1));
+            }
+        }
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        EXPECT_TRUE(done[i]);
+        EXPECT_EQ(programs[i]->GetError(), CBotNoErr);
+    }
+    EXPECT_GE(deferred, count);
+    EXPECT_EQ(calls, count);
+    EXPECT_EQ(concurrentCalls, 0);
+}
+
+TEST_F(CBotUT, ContextsAreIsolated)
+{
+    const std::string code =
+        "public class ContextClass\n"
+        "{\n"
+        "    int value = ContextValue;\n"
+        "    int Get() { return value; }\n"
+        "}\n"
+        "public int ContextTwice(int x) { return 2 * x; }\n"
+        "extern void ContextsAreIsolated()\n"
+        "{\n"
+        "    ContextClass c = new ContextClass();\n"
+        "    ContextResult(ContextTwice(c.Get()));\n"
+        "}\n";
+
+    // each thread runs its own engine, with the same names meaning different things
+    auto simulate = [&code](long value, long& result)
+    {
+        CBotContext context;
+        CBotContext::Scope scope(context);
+        CBotProgram::Init();
+        CBotProgram::DefineNum("ContextValue", value);
+        CBotProgram::AddFunction("ContextResult",
+            [](CBotVar* var, CBotVar* result, int& exception, void* user)
+            {
+                *static_cast<long*>(user) = var->GetValInt();
+                return true;
+            },
+            [](CBotVar*& var, void* user) { return CBotTypResult(CBotTypVoid); });
+
+        std::vector<std::string> externs;
+        CBotProgram program;
+        if (!program.Compile(code, externs, nullptr) || !program.Start(externs[0])) return;
+        while (!program.Run(&result, 10));
+        if (program.GetError() != CBotNoErr) result = -1;
+    };
+
+    const int count = 4;
+    long results[count] = {};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < count; i++)
+    {
+        threads.emplace_back(simulate, i + 1, std::ref(results[i]));
+    }
+    for (std::thread& thread : threads) thread.join();
+
+    for (int i = 0; i < count; i++)
+    {
+        EXPECT_EQ(results[i], 2 * (i + 1));
+    }
+
+    // nothing leaked into the default context
+    EXPECT_EQ(CBotClass::Find("ContextClass"), nullptr);
+    std::vector<std::string> externs;
+    CBotProgram program;
+    EXPECT_FALSE(program.Compile(code, externs, nullptr));
+    EXPECT_EQ(program.GetError(), CBotErrUndefVar);
+}
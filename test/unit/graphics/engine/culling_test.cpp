@@ -0,0 +1,125 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2023, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+
+#include "graphics/engine/culling.h"
+
+#include "math/geometry.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+
+using namespace Gfx;
+
+class CCullingGridUT : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        Math::Matrix proj, view;
+        Math::LoadProjectionMatrix(proj, Math::PI / 2.0f, 1.0f, 1.0f, 500.0f);
+        Math::LoadViewMatrix(view, Math::Vector(0.0f, 50.0f, -200.0f), Math::Vector(0.0f, 0.0f, 0.0f), Math::Vector(0.0f, 1.0f, 0.0f));
+
+        // The z axis is flipped as in CEngine::CullObjects()
+        Math::Matrix scale;
+        scale.Set(3, 3, -1.0f);
+        m_frustum.Set(Math::MultiplyMatrices(proj, Math::MultiplyMatrices(scale, view)));
+    }
+
+    //! Returns the spheres found by testing each of them
+    std::vector<int> CullOneByOne()
+    {
+        std::vector<int> result;
+        for (int id = 0; id < static_cast<int>(m_spheres.size()); id++)
+        {
+            if (m_grid.Contains(id) && m_frustum.ContainsSphere(m_spheres[id].pos, m_spheres[id].radius))
+                result.push_back(id);
+        }
+        return result;
+    }
+
+    std::vector<int> Cull()
+    {
+        std::vector<int> result;
+        m_grid.Cull(m_frustum, result);
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    void Update(int id, const Math::Sphere& sphere)
+    {
+        if (id >= static_cast<int>(m_spheres.size()))
+            m_spheres.resize(id + 1);
+        m_spheres[id] = sphere;
+        m_grid.Update(id, sphere);
+    }
+
+    CCullingGrid m_grid;
+    CullingFrustum m_frustum;
+    std::vector<Math::Sphere> m_spheres;
+};
+
+TEST_F(CCullingGridUT, FindsSpheresInFrustum)
+{
+    Update(0, Math::Sphere(Math::Vector(0.0f, 0.0f, 0.0f), 5.0f));       // in front of the camera
+    Update(1, Math::Sphere(Math::Vector(0.0f, 0.0f, -400.0f), 5.0f));    // behind the camera
+    Update(2, Math::Sphere(Math::Vector(1000.0f, 0.0f, 0.0f), 5.0f));    // far on the side
+    Update(3, Math::Sphere(Math::Vector(1000.0f, 0.0f, 0.0f), 2000.0f)); // large enough to reach the view
+
+    EXPECT_EQ(std::vector<int>({0, 3}), Cull());
+}
+
+TEST_F(CCullingGridUT, MatchesTestingEachSphere)
+{
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> position(-800.0f, 800.0f);
+    std::uniform_real_distribution<float> radius(0.5f, 30.0f);
+
+    for (int id = 0; id < 2000; id++)
+        Update(id, Math::Sphere(Math::Vector(position(random), 0.1f * position(random), position(random)), radius(random)));
+
+    EXPECT_EQ(CullOneByOne(), Cull());
+
+    // Move some spheres, remove others
+    for (int id = 0; id < 2000; id += 3)
+        Update(id, Math::Sphere(Math::Vector(position(random), 0.0f, position(random)), radius(random)));
+    for (int id = 1; id < 2000; id += 7)
+        m_grid.Remove(id);
+
+    EXPECT_EQ(CullOneByOne(), Cull());
+    EXPECT_LT(m_grid.GetSphereTestCount(), 2000);
+}
+
+TEST_F(CCullingGridUT, ShrinksCellBoundsAfterRemoval)
+{
+    Update(0, Math::Sphere(Math::Vector(10.0f, 0.0f, 1000.0f), 1.0f));
+    Update(1, Math::Sphere(Math::Vector(10.0f, 0.0f, 1000.0f), 2000.0f));
+
+    // Only the large sphere reaches the view, but the cell is crossing the frustum
+    EXPECT_EQ(std::vector<int>({1}), Cull());
+    EXPECT_EQ(2, m_grid.GetSphereTestCount());
+
+    m_grid.Remove(1);
+
+    EXPECT_TRUE(Cull().empty());
+    EXPECT_EQ(1, m_grid.GetCellTestCount());
+    EXPECT_EQ(0, m_grid.GetSphereTestCount());
+}
@@ -0,0 +1,202 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2023, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+
+#include "common/make_unique.h"
+
+#include "graphics/engine/engine.h"
+#include "graphics/engine/particle.h"
+#include "graphics/engine/terrain.h"
+
+#include "math/func.h"
+
+#include <gtest/gtest.h>
+#include <hippomocks.h>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+
+using namespace Gfx;
+using namespace HippoMocks;
+
+namespace
+{
+
+// There is no robot main and no water, CParticle does without them
+class CParticleForTest : public CParticle
+{
+public:
+    CParticleForTest(CEngine* engine, CTerrain* terrain)
+        : CParticle(engine)
+    {
+        m_terrain = terrain;
+    }
+};
+
+} // anonymous namespace
+
+class CParticleUT : public testing::Test
+{
+protected:
+    ~CParticleUT() NOEXCEPT
+    {}
+
+    void SetUp() override
+    {
+        m_engine = m_mocks.Mock<CEngine>();
+        m_terrain = m_mocks.Mock<CTerrain>();
+
+        m_mocks.OnCall(m_engine, CEngine::GetPause).Return(false);
+        m_mocks.OnCall(m_engine, CEngine::GetEyePt).Return(Math::Vector(0.0f, 0.0f, 0.0f));
+        m_mocks.OnCall(m_engine, CEngine::GetWater).Return(nullptr);
+        m_mocks.OnCall(m_terrain, CTerrain::GetWind).Return(Math::Vector(0.0f, 0.0f, 0.0f));
+        m_mocks.OnCall(m_terrain, CTerrain::GetFloorLevel).Return(0.0f);
+
+        m_particle = MakeUnique<CParticleForTest>(m_engine, m_terrain);
+    }
+
+    MockRepository m_mocks;
+    CEngine* m_engine = nullptr;
+    CTerrain* m_terrain = nullptr;
+    std::unique_ptr<CParticleForTest> m_particle;
+};
+
+TEST_F(CParticleUT, MovesParticlesBySpeed)
+{
+    int channel[5];
+    for (int i = 0; i < 5; i++)
+    {
+        Math::Vector pos(static_cast<float>(i), 10.0f, 0.0f);
+        Math::Vector speed(1.0f, 2.0f, static_cast<float>(-i));
+        channel[i] = m_particle->CreateParticle(pos, speed, Math::Point(1.0f, 1.0f), PARTIGAS, 10.0f);
+        ASSERT_NE(-1, channel[i]);
+    }
+
+    m_particle->FrameParticle(0.5f);
+    m_particle->FrameParticle(0.5f);
+
+    for (int i = 0; i < 5; i++)
+    {
+        Math::Vector pos;
+        ASSERT_TRUE(m_particle->GetPosition(channel[i], pos));
+        EXPECT_FLOAT_EQ(static_cast<float>(i) + 1.0f, pos.x);
+        EXPECT_FLOAT_EQ(12.0f, pos.y);
+        EXPECT_FLOAT_EQ(static_cast<float>(-i), pos.z);
+    }
+}
+
+TEST_F(CParticleUT, RemovesParticlesAtEndOfLife)
+{
+    int shortLived = m_particle->CreateParticle(Math::Vector(), Math::Vector(), Math::Point(1.0f, 1.0f), PARTIGAS, 1.0f);
+    int longLived  = m_particle->CreateParticle(Math::Vector(), Math::Vector(), Math::Point(1.0f, 1.0f), PARTIGAS, 3.0f);
+
+    Math::Vector pos;
+    m_particle->FrameParticle(0.6f);
+    m_particle->FrameParticle(0.6f);
+    EXPECT_TRUE(m_particle->GetPosition(shortLived, pos));
+    m_particle->FrameParticle(0.6f);  // age is checked before it is increased
+    EXPECT_FALSE(m_particle->GetPosition(shortLived, pos));
+    EXPECT_TRUE(m_particle->GetPosition(longLived, pos));
+}
+
+TEST_F(CParticleUT, GrowsPastOnePage)
+{
+    const int count = 10*PARTIPAGE;
+    for (int i = 0; i < count; i++)
+        ASSERT_NE(-1, m_particle->CreateParticle(Math::Vector(), Math::Vector(), Math::Point(1.0f, 1.0f), PARTIGAS));
+
+    EXPECT_EQ(count, m_particle->GetLiveCount());
+    EXPECT_EQ(count, m_particle->GetPeakCount());
+    EXPECT_EQ(count, m_particle->GetCapacity());
+    EXPECT_EQ(0, m_particle->GetDroppedCount());
+
+    m_particle->DeleteParticle(PARTIGAS);
+    EXPECT_EQ(0, m_particle->GetLiveCount());
+    EXPECT_EQ(count, m_particle->GetPeakCount());
+}
+
+TEST_F(CParticleUT, ReplacesOldestEffectOverBudget)
+{
+    m_particle->SetBudget(3);
+
+    int channel[3];
+    for (int i = 0; i < 3; i++)
+        channel[i] = m_particle->CreateParticle(Math::Vector(), Math::Vector(), Math::Point(1.0f, 1.0f), PARTIGAS, 1.0f+i);
+
+    m_particle->FrameParticle(0.5f);
+
+    // The first one is closest to its end of life
+    int newChannel = m_particle->CreateParticle(Math::Vector(), Math::Vector(), Math::Point(1.0f, 1.0f), PARTIGAS);
+    EXPECT_NE(-1, newChannel);
+    EXPECT_EQ(3, m_particle->GetLiveCount());
+    EXPECT_EQ(0, m_particle->GetDroppedCount());
+
+    Math::Vector pos;
+    EXPECT_FALSE(m_particle->GetPosition(channel[0], pos));
+    EXPECT_TRUE(m_particle->GetPosition(channel[1], pos));
+    EXPECT_TRUE(m_particle->GetPosition(channel[2], pos));
+    EXPECT_TRUE(m_particle->GetPosition(newChannel, pos));
+}
+
+TEST_F(CParticleUT, DropsWhenNothingCanBeReplaced)
+{
+    m_particle->SetBudget(2);
+
+    // Robot lights are kept by their robot, interface particles are never replaced
+    EXPECT_NE(-1, m_particle->CreateParticle(Math::Vector(), Math::Vector(), Math::Point(1.0f, 1.0f), PARTISELY));
+    EXPECT_NE(-1, m_particle->CreateParticle(Math::Vector(), Math::Vector(), Math::Point(1.0f, 1.0f), PARTIGAS,
+                                             1.0f, 0.0f, 0.0f, SH_INTERFACE));
+
+    EXPECT_EQ(-1, m_particle->CreateParticle(Math::Vector(), Math::Vector(), Math::Point(1.0f, 1.0f), PARTIGAS));
+    EXPECT_EQ(-1, m_particle->CreateParticle(Math::Vector(), Math::Vector(), Math::Point(1.0f, 1.0f), PARTIGLINT));
+    EXPECT_EQ(2, m_particle->GetLiveCount());
+    EXPECT_EQ(2, m_particle->GetDroppedCount());
+}
+
+// Not a check, run with --gtest_also_run_disabled_tests --gtest_filter=*FrameParticleBenchmark to measure
+TEST_F(CParticleUT, DISABLED_FrameParticleBenchmark)
+{
+    const ParticleType types[] = { PARTIEXPLOT, PARTIFIRE, PARTISMOKE1, PARTIBLOOD,
+                                   PARTIVAPOR, PARTIGAS, PARTIFLAME, PARTIEXPLOG1 };
+    const int typeCount = sizeof(types)/sizeof(types[0]);
+    const int frames = 1000;
+
+    std::chrono::steady_clock::duration spent{};
+    for (int frame = 0; frame < frames; frame++)
+    {
+        // A small explosion every frame keeps a few hundred particles alive
+        for (int i = 0; i < 8; i++)
+        {
+            Math::Vector speed((Math::Rand()-0.5f)*30.0f, Math::Rand()*30.0f, (Math::Rand()-0.5f)*30.0f);
+            float mass = (i % 2 == 0) ? 20.0f : 0.0f;
+            m_particle->CreateParticle(Math::Vector(0.0f, 5.0f, 0.0f), speed, Math::Point(2.0f, 2.0f),
+                                       types[(frame+i) % typeCount], 0.5f+Math::Rand()*2.0f, mass);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        m_particle->FrameParticle(1.0f/60.0f);
+        spent += std::chrono::steady_clock::now() - start;
+    }
+
+    EXPECT_GT(m_particle->GetLiveCount(), 0);
+
+    float perFrame = std::chrono::duration<float, std::micro>(spent).count() / frames;
+    std::cout << "FrameParticle with synthetic explosions: " << perFrame << " us per frame" << std::endl;
+}
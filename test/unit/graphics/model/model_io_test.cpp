@@ -0,0 +1,116 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2023, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+
+#include "graphics/model/model.h"
+#include "graphics/model/model_input.h"
+#include "graphics/model/model_output.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+using namespace Gfx;
+
+namespace
+{
+
+ModelTriangle MakeTriangle(float offset, const std::string& tex1Name)
+{
+    ModelTriangle triangle;
+    triangle.p1.coord = Math::Vector(offset, 1.0f, 2.0f);
+    triangle.p2.coord = Math::Vector(3.0f, offset, 4.0f);
+    triangle.p3.coord = Math::Vector(5.0f, 6.0f, offset);
+    triangle.p1.texCoord2 = Math::Point(0.25f, 0.75f);
+    triangle.diffuse = Color(0.5f, 0.25f, 0.125f, 1.0f);
+    triangle.tex1Name = tex1Name;
+    triangle.variableTex2 = false;
+    triangle.transparentMode = ModelTransparentMode::MapBlackToAlpha;
+    triangle.specialMark = ModelSpecialMark::Part2;
+    triangle.doubleSided = true;
+    return triangle;
+}
+
+} // anonymous namespace
+
+TEST(ModelIOTest, BinaryFormatKeepsAllModelData)
+{
+    CModel model;
+
+    CModelMesh mainMesh;
+    mainMesh.AddTriangle(MakeTriangle(1.0f, "objects/lem.png"));
+    mainMesh.AddTriangle(MakeTriangle(2.0f, "objects/lem.png"));
+    model.AddMesh("main", std::move(mainMesh));
+
+    CModelMesh wheelMesh;
+    wheelMesh.SetPosition(Math::Vector(1.0f, 2.0f, 3.0f));
+    wheelMesh.SetRotation(Math::Vector(0.5f, 0.0f, 0.0f));
+    wheelMesh.SetScale(Math::Vector(2.0f, 2.0f, 2.0f));
+    wheelMesh.SetParent("main");
+    wheelMesh.AddTriangle(MakeTriangle(3.0f, "objects/wheel.png"));
+    model.AddMesh("wheel", std::move(wheelMesh));
+
+    ModelCrashSphere crashSphere;
+    crashSphere.position = Math::Vector(0.0f, 1.0f, 0.0f);
+    crashSphere.radius = 4.0f;
+    crashSphere.sound = "boumm";
+    crashSphere.hardness = 0.5f;
+    model.AddCrashSphere(crashSphere);
+
+    ModelShadowSpot shadowSpot;
+    shadowSpot.radius = 5.0f;
+    shadowSpot.intensity = 0.75f;
+    model.SetShadowSpot(shadowSpot);
+
+    std::stringstream stream;
+    ModelOutput::Write(model, stream, ModelFormat::Binary);
+    CModel result = ModelInput::Read(stream, ModelFormat::Binary);
+
+    ASSERT_EQ(2, result.GetMeshCount());
+    EXPECT_FALSE(result.HasCameraCollisionSphere());
+
+    ASSERT_TRUE(result.HasShadowSpot());
+    EXPECT_EQ(5.0f, result.GetShadowSpot().radius);
+    EXPECT_EQ(0.75f, result.GetShadowSpot().intensity);
+
+    ASSERT_EQ(1, result.GetCrashSphereCount());
+    EXPECT_EQ("boumm", result.GetCrashSpheres()[0].sound);
+    EXPECT_EQ(4.0f, result.GetCrashSpheres()[0].radius);
+
+    const CModelMesh* wheel = result.GetMesh("wheel");
+    ASSERT_NE(nullptr, wheel);
+    EXPECT_EQ("main", wheel->GetParent());
+    EXPECT_EQ(2.0f, wheel->GetScale().y);
+    EXPECT_EQ(0.5f, wheel->GetRotation().x);
+
+    const CModelMesh* main = result.GetMesh("main");
+    ASSERT_NE(nullptr, main);
+    ASSERT_EQ(2, main->GetTriangleCount());
+
+    const ModelTriangle& triangle = main->GetTriangles()[1];
+    EXPECT_EQ(2.0f, triangle.p1.coord.x);
+    EXPECT_EQ(2.0f, triangle.p2.coord.y);
+    EXPECT_EQ(0.75f, triangle.p1.texCoord2.y);
+    EXPECT_EQ(0.25f, triangle.diffuse.g);
+    EXPECT_EQ("objects/lem.png", triangle.tex1Name);
+    EXPECT_FALSE(triangle.variableTex2);
+    EXPECT_EQ(ModelTransparentMode::MapBlackToAlpha, triangle.transparentMode);
+    EXPECT_EQ(ModelSpecialMark::Part2, triangle.specialMark);
+    EXPECT_TRUE(triangle.doubleSided);
+}
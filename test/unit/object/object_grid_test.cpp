@@ -0,0 +1,83 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2023, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+#include "object/object_grid.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <limits>
+
+// The grid never dereferences the objects, so any distinct addresses will do
+static CObject* FakeObject(int n)
+{
+    static char storage[16];
+    return reinterpret_cast<CObject*>(&storage[n]);
+}
+
+static bool Contains(const std::vector<CObject*>& objects, CObject* object)
+{
+    return std::find(objects.begin(), objects.end(), object) != objects.end();
+}
+
+TEST(ObjectGridTest, FindsOnlyNearbyObjects)
+{
+    CObjectGrid grid;
+    grid.Insert(FakeObject(0), Math::Vector(0.0f, 0.0f, 0.0f));
+    grid.Insert(FakeObject(1), Math::Vector(500.0f, 0.0f, 500.0f));
+
+    std::vector<CObject*> result;
+    grid.GetObjectsInRange(Math::Vector(10.0f, 0.0f, 10.0f), 50.0f, result);
+    EXPECT_TRUE(Contains(result, FakeObject(0)));
+    EXPECT_FALSE(Contains(result, FakeObject(1)));
+}
+
+TEST(ObjectGridTest, FollowsMovedObjects)
+{
+    CObjectGrid grid;
+    grid.Insert(FakeObject(0), Math::Vector(0.0f, 0.0f, 0.0f));
+    grid.Update(FakeObject(0), Math::Vector(-700.0f, 0.0f, 300.0f));
+
+    std::vector<CObject*> result;
+    grid.GetObjectsInRange(Math::Vector(0.0f, 0.0f, 0.0f), 50.0f, result);
+    EXPECT_FALSE(Contains(result, FakeObject(0)));
+
+    result.clear();
+    grid.GetObjectsInRange(Math::Vector(-700.0f, 0.0f, 300.0f), 1.0f, result);
+    EXPECT_TRUE(Contains(result, FakeObject(0)));
+
+    grid.Remove(FakeObject(0));
+    result.clear();
+    grid.GetObjectsInRange(Math::Vector(-700.0f, 0.0f, 300.0f), 1.0f, result);
+    EXPECT_TRUE(result.empty());
+}
+
+TEST(ObjectGridTest, KeepsObjectsOutsideTheMap)
+{
+    CObjectGrid grid;
+    grid.Insert(FakeObject(0), Math::Vector(10000.0f, 0.0f, -10000.0f));
+
+    std::vector<CObject*> result;
+    grid.GetObjectsInRange(Math::Vector(10000.0f, 0.0f, -10000.0f), 1.0f, result);
+    EXPECT_TRUE(Contains(result, FakeObject(0)));
+
+    result.clear();
+    grid.GetObjectsInRange(Math::Vector(0.0f, 0.0f, 0.0f), std::numeric_limits<float>::infinity(), result);
+    EXPECT_TRUE(Contains(result, FakeObject(0)));
+}